@@ -37,6 +37,7 @@ MINIMAL_TASKS = [
     'libc-debug',
     'libc_optz',
     'libc_optz-debug',
+    'libc_simd',
     'libc++abi',
     'libc++abi-except',
     'libc++abi-noexcept',
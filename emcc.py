@@ -1350,6 +1350,10 @@ def parse_args(newargs):
       settings.BULK_MEMORY = 1
     elif arg == '-mno-bulk-memory':
       settings.BULK_MEMORY = 0
+    elif arg in ('-msimd128', '-mrelaxed-simd'):
+      settings.WASM_SIMD = 1
+    elif arg == '-mno-simd128':
+      settings.WASM_SIMD = 0
     elif arg == '-fexceptions':
       # TODO Currently -fexceptions only means Emscripten EH. Switch to wasm
       # exception handling by default when -fexceptions is given when wasm
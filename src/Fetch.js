@@ -46,6 +46,24 @@ var Fetch = {
 
   init() {
     Fetch.xhrs = new HandleAllocator();
+    // State of the scheduler, see fetchSchedule().
+    Fetch.origins = new Map();
+    Fetch.jobsByKey = new Map();
+    Fetch.maxPerOrigin = 0;
+    Fetch.dedup = false;
+    Fetch.stats = {
+      queued: 0,
+      inFlight: 0,
+      waiting: 0,
+      started: 0,
+      completed: 0,
+      deduplicated: 0,
+      cancelled: 0,
+      bytesReceived: 0,
+      // The total time during which requests were in flight, in ms.
+      activeTime: 0,
+      activeSince: 0,
+    };
 #if FETCH_SUPPORT_INDEXEDDB
 #if PTHREADS
     if (ENVIRONMENT_IS_PTHREAD) return;
@@ -265,6 +283,14 @@ function fetchXHR(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
   var fetchAttrStreamData = !!(fetchAttributes & {{{ cDefs.EMSCRIPTEN_FETCH_STREAM_DATA }}});
   var fetchAttrSynchronous = !!(fetchAttributes & {{{ cDefs.EMSCRIPTEN_FETCH_SYNCHRONOUS }}});
 
+#if ASSERTIONS
+  assert(!fetchAttrStreamData || !fetchAttrSynchronous, 'EMSCRIPTEN_FETCH_STREAM_DATA is not supported together with EMSCRIPTEN_FETCH_SYNCHRONOUS');
+#endif
+  if (fetchAttrStreamData && !fetchAttrSynchronous) {
+    fetchStream(fetch, onsuccess, onerror, onprogress, onreadystatechange);
+    return;
+  }
+
   var userNameStr = userName ? UTF8ToString(userName) : undefined;
   var passwordStr = password ? UTF8ToString(password) : undefined;
 
@@ -277,9 +303,6 @@ function fetchXHR(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
   xhr.open(requestMethod, url_, !fetchAttrSynchronous, userNameStr, passwordStr);
   if (!fetchAttrSynchronous) xhr.timeout = timeoutMsecs; // XHR timeout field is only accessible in async XHRs, and must be set after .open() but before .send().
   xhr.url_ = url_; // Save the url for debugging purposes (and for comparing to the responseURL that server side advertised)
-#if ASSERTIONS
-  assert(!fetchAttrStreamData, 'streaming uses moz-chunked-arraybuffer which is no longer supported; TODO: rewrite using fetch()');
-#endif
   xhr.responseType = 'arraybuffer';
 
   if (overriddenMimeType) {
@@ -391,22 +414,10 @@ function fetchXHR(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
     if (!Fetch.xhrs.has(id)) {
       return;
     }
-    var ptrLen = (fetchAttrLoadToMemory && fetchAttrStreamData && xhr.response) ? xhr.response.byteLength : 0;
-    var ptr = 0;
-    if (ptrLen > 0 && fetchAttrLoadToMemory && fetchAttrStreamData) {
-#if FETCH_DEBUG
-      dbg(`fetch: allocating ${ptrLen} bytes in Emscripten heap for xhr data`);
-#endif
-#if ASSERTIONS
-      assert(onprogress, 'When doing a streaming fetch, you should have an onprogress handler registered to receive the chunks!');
-#endif
-      // Allocate byte data in Emscripten heap for the streamed memory block (freed immediately after onprogress call)
-      ptr = _malloc(ptrLen);
-      HEAPU8.set(new Uint8Array(/** @type{Array<number>} */(xhr.response)), ptr);
-    }
-    {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.data, 'ptr', '*') }}}
-    writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}}, ptrLen);
-    writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.dataOffset }}}, e.loaded - ptrLen);
+    // Streamed data is delivered by fetchStream(), so no data bytes here.
+    {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.data, 0, '*') }}}
+    writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}}, 0);
+    writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.dataOffset }}}, e.loaded);
     writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.totalBytes }}}, e.total);
     {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.readyState, 'xhr.readyState', 'i16') }}}
     // If loading files from a source that does not give HTTP status code, assume success if we get data bytes
@@ -414,9 +425,6 @@ function fetchXHR(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
     {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.status, 'xhr.status', 'i16') }}}
     if (xhr.statusText) stringToUTF8(xhr.statusText, fetch + {{{ C_STRUCTS.emscripten_fetch_t.statusText }}}, 64);
     onprogress?.(fetch, xhr, e);
-    if (ptr) {
-      _free(ptr);
-    }
   };
   xhr.onreadystatechange = (e) => {
     // check if xhr was aborted by user and don't try to call back
@@ -443,6 +451,511 @@ function fetchXHR(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
   }
 }
 
+// Performs an EMSCRIPTEN_FETCH_STREAM_DATA transfer using fetch(). The response
+// body is read from a ReadableStream and handed to onprogress one chunk at a
+// time, copied into the stream buffer of the fetch, which is reused for every
+// chunk. The request object that is stored in Fetch.xhrs mimics the parts of
+// XMLHttpRequest that the rest of the fetch code uses.
+function fetchStream(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
+  var url_ = UTF8ToString({{{ makeGetValue('fetch', C_STRUCTS.emscripten_fetch_t.url, '*') }}});
+  var fetch_attr = fetch + {{{ C_STRUCTS.emscripten_fetch_t.__attributes }}};
+  var requestMethod = UTF8ToString(fetch_attr + {{{ C_STRUCTS.emscripten_fetch_attr_t.requestMethod }}});
+  requestMethod ||= 'GET';
+  var timeoutMsecs = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.timeoutMSecs, 'u32') }}};
+  var userName = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.userName, '*') }}};
+  var password = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.password, '*') }}};
+  var requestHeaders = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.requestHeaders, '*') }}};
+  var dataPtr = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.requestData, '*') }}};
+  var dataLength = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.requestDataSize, '*') }}};
+  var withCredentials = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.withCredentials, 'u8') }}};
+  var buffer = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.streamBuffer, '*') }}};
+  var bufferSize = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.streamBufferSize, '*') }}};
+#if ASSERTIONS
+  var fetchAttributes = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.attributes, 'u32') }}};
+  assert(!(fetchAttributes & {{{ cDefs.EMSCRIPTEN_FETCH_PERSIST_FILE }}}), 'EMSCRIPTEN_FETCH_STREAM_DATA is not supported together with EMSCRIPTEN_FETCH_PERSIST_FILE');
+  assert(!buffer || bufferSize, 'a streamBuffer was given without a streamBufferSize');
+#endif
+
+  var ownedBuffer = 0;
+  if (!buffer) {
+    bufferSize ||= {{{ cDefs.EMSCRIPTEN_FETCH_DEFAULT_STREAM_BUFFER_SIZE }}};
+    // Freed in fetchFree(), when the fetch is closed.
+    buffer = ownedBuffer = _malloc(bufferSize);
+    {{{ makeSetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.streamBuffer, 'buffer', '*') }}};
+    {{{ makeSetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.streamBufferSize, 'bufferSize', '*') }}};
+  }
+
+  var headers = new Headers();
+  if (requestHeaders) {
+    for (;;) {
+      var key = {{{ makeGetValue('requestHeaders', 0, '*') }}};
+      if (!key) break;
+      var value = {{{ makeGetValue('requestHeaders', POINTER_SIZE, '*') }}};
+      if (!value) break;
+      requestHeaders += {{{ 2 * POINTER_SIZE }}};
+      headers.append(UTF8ToString(key), UTF8ToString(value));
+    }
+  }
+  if (userName) {
+    // fetch() has no equivalent of the user and password arguments of
+    // XMLHttpRequest.open(), so send the credentials ourselves.
+    var credentials = UTF8ToString(userName) + ':' + (password ? UTF8ToString(password) : '');
+    headers.set('Authorization', 'Basic ' + btoa(credentials));
+  }
+
+  var req = {
+    readyState: 1, // OPENED
+    status: 0,
+    statusText: '',
+    responseHeaders: '',
+    controller: new AbortController(),
+    ownedBuffer,
+    // The most recently read chunk of the response, and how much of it has
+    // been delivered to onprogress so far.
+    chunk: null,
+    chunkPos: 0,
+    paused: false,
+    delivering: false,
+    reading: false,
+    abort() {
+      req.controller.abort();
+      // Unlike XMLHttpRequest, aborting does not run any of our handlers, so
+      // release the keepalive that startFetch() took here.
+      {{{ runtimeKeepalivePop() }}}
+    },
+    getAllResponseHeaders() {
+      return req.responseHeaders;
+    },
+    setPaused(paused) {
+      req.paused = paused;
+      if (!paused && !req.delivering && !req.reading && reader) deliver();
+    },
+  };
+  var id = Fetch.xhrs.allocate(req);
+#if FETCH_DEBUG
+  dbg(`fetch: id=${id}, streaming "${url_}" into a ${bufferSize} byte buffer`);
+#endif
+  {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.id, 'id', 'u32') }}};
+
+  var reader;
+  var loaded = 0;
+  var total = 0;
+  var timer = timeoutMsecs ? setTimeout(() => req.controller.abort(), timeoutMsecs) : 0;
+
+  var setReadyState = (readyState) => {
+    req.readyState = readyState;
+    {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.readyState, 'readyState', 'i16') }}}
+    {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.status, 'req.status', 'i16') }}}
+    if (req.statusText) stringToUTF8(req.statusText, fetch + {{{ C_STRUCTS.emscripten_fetch_t.statusText }}}, 64);
+  };
+
+  var finish = (success, e) => {
+    clearTimeout(timer);
+    {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.data, 0, '*') }}}
+    writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}}, 0);
+    writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.dataOffset }}}, 0);
+    if (success) writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.totalBytes }}}, loaded);
+    setReadyState(4); // DONE
+    onreadystatechange?.(fetch, req);
+    // The fetch may have been closed from within onreadystatechange.
+    if (!Fetch.xhrs.has(id)) return;
+#if FETCH_DEBUG
+    dbg(`fetch: streaming "${url_}" ${success ? 'succeeded' : 'failed'} with status ${req.status} after ${loaded} bytes`);
+#endif
+    (success ? onsuccess : onerror)?.(fetch, req, e);
+  };
+
+  var fail = (e) => {
+    req.reading = false;
+    // Ignore errors caused by emscripten_fetch_close() aborting the request.
+    if (Fetch.xhrs.has(id)) finish(false, e);
+  };
+
+  // Hand the current chunk to onprogress, one buffer full at a time, and then
+  // read the next one. This stops whenever the consumer pauses the transfer,
+  // in which case the rest of the chunk stays pending until it is resumed.
+  var deliver = () => {
+    req.delivering = true;
+    while (req.chunk && !req.paused) {
+      var len = Math.min(req.chunk.length - req.chunkPos, bufferSize);
+      HEAPU8.set(req.chunk.subarray(req.chunkPos, req.chunkPos + len), buffer);
+      req.chunkPos += len;
+      if (req.chunkPos == req.chunk.length) req.chunk = null;
+      {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.data, 'buffer', '*') }}}
+      writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}}, len);
+      writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.dataOffset }}}, loaded);
+      writeI53ToI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.totalBytes }}}, total);
+      loaded += len;
+      onprogress?.(fetch, req);
+      // The fetch may have been closed from within onprogress.
+      if (!Fetch.xhrs.has(id)) return;
+      {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.data, 0, '*') }}}
+    }
+    req.delivering = false;
+    if (req.chunk || req.paused || req.reading) return;
+    req.reading = true;
+    reader.read().then(({done, value}) => {
+      req.reading = false;
+      if (!Fetch.xhrs.has(id)) return;
+      if (done) {
+        finish(true);
+        return;
+      }
+      if (req.readyState < 3) {
+        setReadyState(3); // LOADING
+        onreadystatechange?.(fetch, req);
+      }
+      req.chunk = value;
+      req.chunkPos = 0;
+      if (!req.delivering) deliver();
+    }, fail);
+  };
+
+  var init = {
+    method: requestMethod,
+    headers,
+    credentials: withCredentials ? 'include' : 'same-origin',
+    signal: req.controller.signal,
+  };
+  if (dataPtr && dataLength) init.body = HEAPU8.slice(dataPtr, dataPtr + dataLength);
+  // `fetch` is the pointer to the emscripten_fetch_t here.
+  globalThis.fetch(url_, init).then((response) => {
+    if (!Fetch.xhrs.has(id)) return;
+    req.status = response.status;
+    req.statusText = response.statusText;
+    req.responseHeaders = '';
+    response.headers.forEach((value, key) => req.responseHeaders += `${key}: ${value}\r\n`);
+    total = Number(response.headers.get('Content-Length')) || 0;
+    setReadyState(2); // HEADERS_RECEIVED
+    onreadystatechange?.(fetch, req);
+    if (!Fetch.xhrs.has(id)) return;
+    if (!response.ok) {
+      response.body?.cancel();
+      finish(false);
+      return;
+    }
+    if (!response.body) {
+      finish(true);
+      return;
+    }
+    reader = response.body.getReader();
+    deliver();
+  }, fail);
+}
+
+// Network requests are started through fetchSchedule(), which limits the
+// number of requests in flight per origin (see
+// emscripten_fetch_set_max_concurrent_per_origin), starts queued requests in
+// priority order, and optionally lets identical GET requests share a single
+// request (see emscripten_fetch_set_deduplication).
+//
+// Each fetch that goes through the scheduler is represented by a job. Until a
+// job's request is started, Fetch.xhrs holds a placeholder for it so that the
+// fetch has an id, and so that it can be closed (i.e. cancelled) as usual.
+// Jobs that wait for an identical request are kept in the `followers` of the
+// job that makes the request, and receive a copy of its response.
+function fetchOrigin(url) {
+  try {
+    return new URL(url, globalThis.location?.href).origin;
+  } catch (e) {
+    // Not a URL that we can resolve (e.g. a relative URL in node), so count
+    // it as its own origin.
+    return '';
+  }
+}
+
+// Returns the key under which identical requests are deduplicated, or null
+// if the fetch must make a request of its own.
+function fetchDedupKey(fetch, url_) {
+  var fetch_attr = fetch + {{{ C_STRUCTS.emscripten_fetch_t.__attributes }}};
+  var fetchAttributes = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.attributes, 'u32') }}};
+  var requestMethod = UTF8ToString(fetch_attr + {{{ C_STRUCTS.emscripten_fetch_attr_t.requestMethod }}}) || 'GET';
+  var dataPtr = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.requestData, '*') }}};
+  if (requestMethod != 'GET' || dataPtr ||
+      (fetchAttributes & ({{{ cDefs.EMSCRIPTEN_FETCH_STREAM_DATA }}} | {{{ cDefs.EMSCRIPTEN_FETCH_PERSIST_FILE }}}))) {
+    return null;
+  }
+  var key = [
+    url_,
+    fetchAttributes & {{{ cDefs.EMSCRIPTEN_FETCH_LOAD_TO_MEMORY }}},
+    {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.timeoutMSecs, 'u32') }}},
+    {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.withCredentials, 'u8') }}},
+  ];
+  for (var field of [{{{ C_STRUCTS.emscripten_fetch_attr_t.userName }}},
+                     {{{ C_STRUCTS.emscripten_fetch_attr_t.password }}},
+                     {{{ C_STRUCTS.emscripten_fetch_attr_t.overriddenMimeType }}}]) {
+    key.push(UTF8ToString({{{ makeGetValue('fetch_attr + field', 0, '*') }}}));
+  }
+  var requestHeaders = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.requestHeaders, '*') }}};
+  if (requestHeaders) {
+    for (var str; (str = {{{ makeGetValue('requestHeaders', 0, '*') }}}); requestHeaders += {{{ POINTER_SIZE }}}) {
+      key.push(UTF8ToString(str));
+    }
+  }
+  return JSON.stringify(key);
+}
+
+function fetchSchedule(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
+  var url = {{{ makeGetValue('fetch', C_STRUCTS.emscripten_fetch_t.url, '*') }}};
+  var fetch_attr = fetch + {{{ C_STRUCTS.emscripten_fetch_t.__attributes }}};
+  var fetchAttributes = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.attributes, 'u32') }}};
+  if (!url || (fetchAttributes & {{{ cDefs.EMSCRIPTEN_FETCH_SYNCHRONOUS }}})) {
+    // Synchronous requests cannot wait in a queue.
+    fetchXHR(fetch, onsuccess, onerror, onprogress, onreadystatechange);
+    return;
+  }
+  var url_ = UTF8ToString(url);
+  var priority = {{{ makeGetValue('fetch_attr', C_STRUCTS.emscripten_fetch_attr_t.priority, 'i32') }}};
+  var job = {
+    fetch, onsuccess, onerror, onprogress, onreadystatechange,
+    // Index into the per-origin queues, which are ordered from high to low
+    // priority.
+    queue: {{{ cDefs.EMSCRIPTEN_FETCH_PRIORITY_HIGH }}} - Math.max(Math.min(priority, {{{ cDefs.EMSCRIPTEN_FETCH_PRIORITY_HIGH }}}), {{{ cDefs.EMSCRIPTEN_FETCH_PRIORITY_LOW }}}),
+    followers: [],
+    loaded: 0,
+    state: 'queued',
+  };
+  var placeholder = {
+    readyState: 0, // UNSENT
+    job,
+    responseHeaders: '',
+    // Cancellation is handled by fetchUnschedule().
+    abort() {},
+    getAllResponseHeaders() {
+      return placeholder.responseHeaders;
+    },
+  };
+  if (fetchAttributes & {{{ cDefs.EMSCRIPTEN_FETCH_STREAM_DATA }}}) {
+    // Allow the transfer to be paused before it starts.
+    placeholder.setPaused = (paused) => job.paused = paused;
+  }
+  job.id = Fetch.xhrs.allocate(placeholder);
+  {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.id, 'job.id', 'u32') }}};
+  // The fetch may have come from a failed IndexedDB lookup, which leaves it
+  // DONE.
+  {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.readyState, 0, 'i16') }}};
+
+  var key = Fetch.dedup ? fetchDedupKey(fetch, url_) : null;
+  var primary = key && Fetch.jobsByKey.get(key);
+  if (primary) {
+#if FETCH_DEBUG
+    dbg(`fetch: id=${job.id}, waiting for the identical request of id=${primary.id} to "${url_}"`);
+#endif
+    job.state = 'waiting';
+    job.primary = primary;
+    primary.followers.push(job);
+    Fetch.stats.waiting++;
+    if (primary.state == 'queued' && job.queue < primary.queue) {
+      // Make sure that a request is not held back by a lower priority
+      // duplicate of it.
+      var queues = Fetch.origins.get(primary.origin).queues;
+      queues[primary.queue].splice(queues[primary.queue].indexOf(primary), 1);
+      primary.queue = job.queue;
+      queues[primary.queue].push(primary);
+    }
+    return;
+  }
+  job.key = key;
+  if (key) Fetch.jobsByKey.set(key, job);
+  job.origin = fetchOrigin(url_);
+  fetchEnqueue(job);
+}
+
+function fetchEnqueue(job) {
+  var origin = Fetch.origins.get(job.origin);
+  if (!origin) {
+    origin = {inFlight: 0, queues: [[], [], []]};
+    Fetch.origins.set(job.origin, origin);
+  }
+  job.state = 'queued';
+  origin.queues[job.queue].push(job);
+  Fetch.stats.queued++;
+  fetchPump(job.origin);
+}
+
+// Starts as many of the queued requests to the given origin as its limit
+// allows.
+function fetchPump(originName) {
+  var origin = Fetch.origins.get(originName);
+  while (!Fetch.maxPerOrigin || origin.inFlight < Fetch.maxPerOrigin) {
+    var queue = origin.queues.find((q) => q.length);
+    if (!queue) break;
+    var job = queue.shift();
+    Fetch.stats.queued--;
+    origin.inFlight++;
+    fetchStartJob(job);
+  }
+  if (!origin.inFlight) Fetch.origins.delete(originName);
+}
+
+function fetchStartJob(job) {
+  var fetch = job.fetch;
+  var stats = Fetch.stats;
+  if (!stats.inFlight++) stats.activeSince = performance.now();
+  stats.started++;
+  job.state = 'running';
+
+  // Copies the state of the request to the fetches that wait for it, and
+  // calls the given callback of each. `done` is set for the final callback,
+  // after which the followers no longer wait.
+  var updateFollowers = (callback, xhr, e, done) => {
+    for (var follower of job.followers.slice()) {
+      // The follower may have been closed by an earlier callback.
+      if (follower.state != 'waiting') continue;
+      var dst = follower.fetch;
+      HEAPU8.copyWithin(dst + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}},
+                        fetch + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}},
+                        fetch + {{{ C_STRUCTS.emscripten_fetch_t.statusText }}} + 64);
+      Fetch.xhrs.get(follower.id).readyState = xhr.readyState;
+      if (done) follower.state = 'done';
+      follower[callback]?.(dst, xhr, e);
+    }
+  };
+
+  var onprogress = (fetch, xhr, e) => {
+    var loaded = readI53FromI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.dataOffset }}}) +
+                 readI53FromI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}});
+    if (loaded > job.loaded) {
+      stats.bytesReceived += loaded - job.loaded;
+      job.loaded = loaded;
+    }
+    updateFollowers('onprogress', xhr, e);
+    job.onprogress?.(fetch, xhr, e);
+  };
+
+  var onreadystatechange = (fetch, xhr, e) => {
+    if (xhr.readyState >= 2) {
+      for (var follower of job.followers) {
+        Fetch.xhrs.get(follower.id).responseHeaders = xhr.getAllResponseHeaders();
+      }
+    }
+    updateFollowers('onreadystatechange', xhr, e);
+    job.onreadystatechange?.(fetch, xhr, e);
+  };
+
+  var complete = (callback) => (fetch, xhr, e) => {
+    var total = readI53FromI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.totalBytes }}});
+    if (callback == 'onsuccess' && total > job.loaded) {
+      stats.bytesReceived += total - job.loaded;
+      job.loaded = total;
+    }
+    stats.completed++;
+    fetchJobDone(job);
+    // Hand each of the fetches that waited for this request its own copy of
+    // the response, before the callback of this fetch gets a chance to close
+    // it.
+    var data = {{{ makeGetValue('fetch', C_STRUCTS.emscripten_fetch_t.data, '*') }}};
+    var numBytes = readI53FromI64(fetch + {{{ C_STRUCTS.emscripten_fetch_t.numBytes }}});
+    for (var follower of job.followers) {
+      var ptr = 0;
+      if (data && numBytes) {
+        ptr = _malloc(numBytes);
+        HEAPU8.copyWithin(ptr, data, data + numBytes);
+      }
+      {{{ makeSetValue('follower.fetch', C_STRUCTS.emscripten_fetch_t.data, 'ptr', '*') }}};
+      stats.waiting--;
+      stats.deduplicated++;
+    }
+    updateFollowers(callback, xhr, e, true);
+    job[callback]?.(fetch, xhr, e);
+  };
+
+  Fetch.xhrs.free(job.id);
+  {{{ makeSetValue('fetch', C_STRUCTS.emscripten_fetch_t.id, 0, 'u32') }}};
+  fetchXHR(fetch, complete('onsuccess'), complete('onerror'), onprogress, onreadystatechange);
+  var id = {{{ makeGetValue('fetch', C_STRUCTS.emscripten_fetch_t.id, 'u32') }}};
+  if (id && Fetch.xhrs.has(id)) {
+    var req = Fetch.xhrs.get(id);
+    req.job = job;
+    if (job.paused) req.setPaused(true);
+  }
+  job.id = id;
+}
+
+// Called when the request of a running job finishes or is aborted.
+function fetchJobDone(job) {
+  var stats = Fetch.stats;
+  job.state = 'done';
+  if (job.key) Fetch.jobsByKey.delete(job.key);
+  if (!--stats.inFlight) stats.activeTime += performance.now() - stats.activeSince;
+  Fetch.origins.get(job.origin).inFlight--;
+  fetchPump(job.origin);
+}
+
+// Called when a fetch is closed, to cancel its job if it has not finished.
+function fetchUnschedule(job) {
+  var stats = Fetch.stats;
+  var state = job.state;
+  if (state == 'done') return;
+  job.state = 'done';
+  stats.cancelled++;
+  if (state == 'waiting') {
+    var followers = job.primary.followers;
+    followers.splice(followers.indexOf(job), 1);
+    stats.waiting--;
+    {{{ runtimeKeepalivePop() }}}
+    return;
+  }
+  if (state == 'queued') {
+    var origin = Fetch.origins.get(job.origin);
+    var queue = origin.queues[job.queue];
+    queue.splice(queue.indexOf(job), 1);
+    stats.queued--;
+    // Nothing else will release the keepalive that startFetch() took for
+    // this fetch.
+    {{{ runtimeKeepalivePop() }}}
+  }
+  // Hand the request over to the first of the fetches that were waiting for
+  // it, if any.
+  var next = job.followers.shift();
+  if (next) {
+    next.followers = job.followers;
+    for (var follower of next.followers) follower.primary = next;
+    next.key = job.key;
+    next.origin = job.origin;
+    next.queue = Math.min(job.queue, next.queue);
+    if (next.key) Fetch.jobsByKey.set(next.key, next);
+    stats.waiting--;
+  } else if (job.key) {
+    Fetch.jobsByKey.delete(job.key);
+  }
+  if (state == 'running') {
+    // The request has been aborted.
+    fetchJobDone(job);
+  } else if (!Fetch.origins.get(job.origin).inFlight) {
+    fetchPump(job.origin);
+  }
+  if (next) {
+    fetchEnqueue(next);
+  }
+}
+
+function fetchSetMaxConcurrentPerOrigin(maxRequests) {
+  Fetch.maxPerOrigin = maxRequests;
+  for (var origin of [...Fetch.origins.keys()]) {
+    fetchPump(origin);
+  }
+}
+
+function fetchSetDeduplication(enabled) {
+  Fetch.dedup = !!enabled;
+}
+
+function fetchGetStats(ptr) {
+  var stats = Fetch.stats;
+  var activeTime = stats.activeTime;
+  if (stats.inFlight) activeTime += performance.now() - stats.activeSince;
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.queued, 'stats.queued', 'u32') }}};
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.inFlight, 'stats.inFlight', 'u32') }}};
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.waiting, 'stats.waiting', 'u32') }}};
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.started, 'stats.started', 'u32') }}};
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.completed, 'stats.completed', 'u32') }}};
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.deduplicated, 'stats.deduplicated', 'u32') }}};
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.cancelled, 'stats.cancelled', 'u32') }}};
+  writeI53ToI64(ptr + {{{ C_STRUCTS.emscripten_fetch_stats_t.bytesReceived }}}, stats.bytesReceived);
+  {{{ makeSetValue('ptr', C_STRUCTS.emscripten_fetch_stats_t.bytesPerSecond, 'activeTime ? stats.bytesReceived * 1000 / activeTime : 0', 'double') }}};
+}
+
 function startFetch(fetch, successcb, errorcb, progresscb, readystatechangecb) {
   // Avoid shutting down the runtime since we want to wait for the async
   // response.
@@ -507,7 +1020,7 @@ function startFetch(fetch, successcb, errorcb, progresscb, readystatechangecb) {
 #if FETCH_DEBUG
     dbg(`fetch: starting (uncached) XHR: ${e}`);
 #endif
-    fetchXHR(fetch, reportSuccess, reportError, reportProgress, reportReadyStateChange);
+    fetchSchedule(fetch, reportSuccess, reportError, reportProgress, reportReadyStateChange);
   };
 
 #if FETCH_SUPPORT_INDEXEDDB
@@ -542,7 +1055,7 @@ function startFetch(fetch, successcb, errorcb, progresscb, readystatechangecb) {
 #if FETCH_DEBUG
     dbg(`fetch: starting (cached) XHR: ${e}`);
 #endif
-    fetchXHR(fetch, cacheResultAndReportSuccess, reportError, reportProgress, reportReadyStateChange);
+    fetchSchedule(fetch, cacheResultAndReportSuccess, reportError, reportProgress, reportReadyStateChange);
   };
 
   var requestMethod = UTF8ToString(fetch_attr + {{{ C_STRUCTS.emscripten_fetch_attr_t.requestMethod }}});
@@ -559,7 +1072,7 @@ function startFetch(fetch, successcb, errorcb, progresscb, readystatechangecb) {
   } else if (!fetchAttrReplace) {
     fetchLoadCachedData(Fetch.dbInstance, fetch, reportSuccess, fetchAttrNoDownload ? reportError : (fetchAttrPersistFile ? performCachedXhr : performUncachedXhr));
   } else if (!fetchAttrNoDownload) {
-    fetchXHR(fetch, fetchAttrPersistFile ? cacheResultAndReportSuccess : reportSuccess, reportError, reportProgress, reportReadyStateChange);
+    fetchSchedule(fetch, fetchAttrPersistFile ? cacheResultAndReportSuccess : reportSuccess, reportError, reportProgress, reportReadyStateChange);
   } else {
 #if FETCH_DEBUG
     dbg('fetch: Invalid combination of flags passed.');
@@ -568,7 +1081,7 @@ function startFetch(fetch, successcb, errorcb, progresscb, readystatechangecb) {
   }
   return fetch;
 #else // !FETCH_SUPPORT_INDEXEDDB
-  fetchXHR(fetch, reportSuccess, reportError, reportProgress, reportReadyStateChange);
+  fetchSchedule(fetch, reportSuccess, reportError, reportProgress, reportReadyStateChange);
   return fetch;
 #endif // ~FETCH_SUPPORT_INDEXEDDB
 }
@@ -584,6 +1097,15 @@ function fetchGetResponseHeaders(id, dst, dstSizeBytes) {
   return Math.min(lengthBytes, dstSizeBytes);
 }
 
+function fetchSetPaused(id, paused) {
+  if (!Fetch.xhrs.has(id)) return 0;
+  var req = Fetch.xhrs.get(id);
+  // Only streaming transfers (see fetchStream) can be paused.
+  if (!req.setPaused) return 0;
+  req.setPaused(!!paused);
+  return 1;
+}
+
 //Delete the xhr JS object, allowing it to be garbage collected.
 function fetchFree(id) {
 #if FETCH_DEBUG
@@ -596,5 +1118,13 @@ function fetchFree(id) {
     if (xhr.readyState > 0 && xhr.readyState < 4) {
       xhr.abort();
     }
+    // Remove the fetch from the scheduler if it has not finished yet.
+    if (xhr.job) {
+      fetchUnschedule(xhr.job);
+    }
+    // Free the stream buffer if fetchStream() allocated it.
+    if (xhr.ownedBuffer) {
+      _free(xhr.ownedBuffer);
+    }
   }
 }
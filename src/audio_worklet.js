@@ -27,17 +27,61 @@ function createWasmAudioWorkletProcessor(audioParams) {
       globalThis.HEAPU32 = Module['HEAPU32'];
       globalThis.HEAPF32 = Module['HEAPF32'];
 
-      // Capture the Wasm function callback to invoke.
       let opts = args.processorOptions;
-      this.callbackFunction = Module['wasmTable'].get(opts['cb']);
-      this.userData = opts['ud'];
+      // Nodes created with emscripten_create_audio_ring_worklet_node() play
+      // back an emscripten_audio_ring_t instead of calling out to Wasm.
+      if (this.ring = opts['ring']) {
+        this.ringCapacity = {{{ makeGetValue('this.ring', C_STRUCTS.emscripten_audio_ring_t.capacity, 'u32') }}};
+        this.ringNumChannels = {{{ makeGetValue('this.ring', C_STRUCTS.emscripten_audio_ring_t.numChannels, 'u32') }}};
+        // The data pointer is read on the main thread, which has HEAPU64
+        // under MEMORY64.
+        this.ringData = {{{ getHeapOffset("opts['data']", 'float') }}};
+      } else {
+        // Capture the Wasm function callback to invoke.
+        this.callbackFunction = Module['wasmTable'].get(opts['cb']);
+        this.userData = opts['ud'];
+      }
     }
 
     static get parameterDescriptors() {
       return audioParams;
     }
 
+    // Copies the next render quantum from the ring straight to the channels
+    // of the first output. This is the consumer side of the single-producer/
+    // single-consumer ring implemented in system/lib/libc/emscripten_audio_ring.c,
+    // so keep the two in sync.
+    processRing(outputList) {
+      let ring = this.ring,
+        capacity = this.ringCapacity,
+        numChannels = this.ringNumChannels,
+        // The write index is published by the producer after the samples, so
+        // load it atomically before reading any of them. The read index is
+        // only modified by us.
+        write = Atomics.load(HEAPU32, {{{ getHeapOffset('ring + ' + C_STRUCTS.emscripten_audio_ring_t.writeIndex, 'u32') }}}),
+        read = {{{ makeGetValue('ring', C_STRUCTS.emscripten_audio_ring_t.readIndex, 'u32') }}},
+        output = outputList[0] || [],
+        frames = output.length ? output[0].length : 128,
+        n = Math.min((write - read) >>> 0, frames),
+        pos = read & (capacity - 1),
+        first = Math.min(n, capacity - pos),
+        c, src, dst;
+
+      for (c = 0; dst = output[c]; ++c) {
+        src = this.ringData + Math.min(c, numChannels - 1) * capacity;
+        dst.set(HEAPF32.subarray(src + pos, src + pos + first));
+        if (n > first) dst.set(HEAPF32.subarray(src, src + n - first), first);
+        if (n < frames) dst.fill(0, n);
+      }
+      if (n < frames) Atomics.add(HEAPU32, {{{ getHeapOffset('ring + ' + C_STRUCTS.emscripten_audio_ring_t.underruns, 'u32') }}}, 1);
+      // Hand the consumed slots back to the producer only after the copy.
+      Atomics.store(HEAPU32, {{{ getHeapOffset('ring + ' + C_STRUCTS.emscripten_audio_ring_t.readIndex, 'u32') }}}, read + n);
+      return true;
+    }
+
     process(inputList, outputList, parameters) {
+      if (this.ring) return this.processRing(outputList);
+
       // Marshal all inputs and parameters to the Wasm memory on the thread stack,
       // then perform the wasm audio worklet call,
       // and finally marshal audio output data back.
@@ -100,14 +144,10 @@ function createWasmAudioWorkletProcessor(audioParams) {
       // Call out to Wasm callback to perform audio processing
       if (didProduceAudio = this.callbackFunction(numInputs, inputsPtr, numOutputs, outputsPtr, numParams, paramsPtr, this.userData)) {
         // Read back the produced audio data to all outputs and their channels.
-        // (A garbage-free function TypedArray.copy(dstTypedArray, dstOffset,
-        // srcTypedArray, srcOffset, count) would sure be handy..  but web does
-        // not have one, so manually copy all bytes in)
+        // subarray() only creates a view on the heap, so this is a bulk copy.
         for (i of outputList) {
           for (j of i) {
-            for (k = 0; k < 128; ++k) {
-              j[k] = HEAPF32[outputDataPtr++];
-            }
+            j.set(HEAPF32.subarray(outputDataPtr, outputDataPtr += 128));
           }
         }
       }
@@ -51,9 +51,15 @@ function load(f) {
 // Basic utilities
 load('utility.js');
 
-// Load default settings
-load('./settings.js');
-load('./settings_internal.js');
+// Load default settings.  These are evaluated in their own context and then
+// copied onto the global object so that, unlike top level `var` declarations,
+// the resulting global properties remain configurable (see `usedSettings`
+// below).
+for (const f of ['./settings.js', './settings_internal.js']) {
+  const defaults = {};
+  vm.runInNewContext(read(f), defaults, {filename: find(f)});
+  Object.assign(global, defaults);
+}
 
 const argv = process.argv.slice(2);
 const symbolsOnlyArg = argv.indexOf('--symbols-only');
@@ -70,18 +76,48 @@ Object.assign(global, settings);
 
 globalThis.symbolsOnly = symbolsOnlyArg != -1;
 
+// In symbols-only mode we record which settings are actually read while
+// loading and processing the JS libraries.  The symbol information can only
+// depend on those settings, which allows the caller to reuse the result for
+// any other set of settings that agrees on them.  This must be set up before
+// any setting is read, including the fixups just below.
+let recordSettingReads = true;
+if (symbolsOnly) {
+  globalThis.usedSettings = new Set();
+  for (const key of Object.keys(settings)) {
+    let value = global[key];
+    Object.defineProperty(global, key, {
+      get() {
+        if (recordSettingReads) {
+          usedSettings.add(key);
+        }
+        return value;
+      },
+      set(newValue) {
+        value = newValue;
+      },
+      configurable: true,
+      enumerable: true,
+    });
+  }
+}
+
 // In case compiler.js is run directly (as in gen_sig_info)
 // ALL_INCOMING_MODULE_JS_API might not be populated yet.
 if (!ALL_INCOMING_MODULE_JS_API.length) {
   ALL_INCOMING_MODULE_JS_API = INCOMING_MODULE_JS_API;
 }
 
+// Converting a setting in place does not depend on its value, so these reads
+// are not recorded.
+recordSettingReads = false;
 EXPORTED_FUNCTIONS = new Set(EXPORTED_FUNCTIONS);
 WASM_EXPORTS = new Set(WASM_EXPORTS);
 SIDE_MODULE_EXPORTS = new Set(SIDE_MODULE_EXPORTS);
 INCOMING_MODULE_JS_API = new Set(INCOMING_MODULE_JS_API);
 ALL_INCOMING_MODULE_JS_API = new Set(ALL_INCOMING_MODULE_JS_API);
 WEAK_IMPORTS = new Set(WEAK_IMPORTS);
+recordSettingReads = true;
 if (symbolsOnly) {
   INCLUDE_FULL_LIBRARY = 1;
 }
@@ -11,7 +11,7 @@ function headlessCanvas() {
       switch (which) {
         case 'webgl':
         case 'experimental-webgl': {
-          return {
+          var ctx = {
             /* ClearBufferMask */
             DEPTH_BUFFER_BIT               : 0x00000100,
             STENCIL_BUFFER_BIT             : 0x00000400,
@@ -435,7 +435,7 @@ function headlessCanvas() {
               this.items[id] = {
                 which: 'buffer',
               };
-              return id;
+              return this.items[id];
             },
             deleteBuffer: function(){},
             bindBuffer: function(){},
@@ -454,6 +454,8 @@ function headlessCanvas() {
                 case /* GL_MAX_VARYING_VECTORS              */ 0x8DFC: return 32;
                 case /* GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS */ 0x8B4D: return 32;
                 case /* GL_ARRAY_BUFFER_BINDING             */ 0x8894: return 0;
+                case /* GL_MAX_VERTEX_ATTRIBS               */ 0x8869: return 16;
+                case /* GL_CURRENT_PROGRAM                  */ 0x8B8D: return null;
                 default: console.log('getParameter ' + pname + '?'); return 0;
               }
             },
@@ -466,11 +468,11 @@ function headlessCanvas() {
                 which: 'shader',
                 type,
               };
-              return id;
+              return this.items[id];
             },
             getShaderParameter: function(shader, pname) {
               switch (pname) {
-                case /* GL_SHADER_TYPE    */ 0x8B4F: return this.items[shader].type;
+                case /* GL_SHADER_TYPE    */ 0x8B4F: return shader.type;
                 case /* GL_COMPILE_STATUS */ 0x8B81: return true;
                 default: throw 'getShaderParameter ' + pname;
               }
@@ -483,10 +485,10 @@ function headlessCanvas() {
                 which: 'program',
                 shaders: [],
               };
-              return id;
+              return this.items[id];
             },
             attachShader: function(program, shader) {
-              this.items[program].shaders.push(shader);
+              program.shaders.push(shader);
             },
             bindAttribLocation: function(){},
             linkProgram: function(){},
@@ -513,7 +515,7 @@ function headlessCanvas() {
               this.items[id] = {
                 which: 'texture',
               };
-              return id;
+              return this.items[id];
             },
             deleteTexture: function(){},
             boundTextures: {},
@@ -525,8 +527,11 @@ function headlessCanvas() {
             texImage2D: function(){},
             compressedTexImage2D: function(){},
             useProgram: function(){},
-            getUniformLocation: function() {
-              return null;
+            getUniformLocation: function(program, name) {
+              return {
+                which: 'uniformLocation',
+                name,
+              };
             },
             getActiveUniform: function(program, index) {
               return {
@@ -536,8 +541,11 @@ function headlessCanvas() {
               };
             },
             clear: function(){},
+            uniform1f: function(){},
             uniform4fv: function(){},
             uniform1i: function(){},
+            uniformMatrix3fv: function(){},
+            uniformMatrix4fv: function(){},
             getAttribLocation: function() { return 1 },
             vertexAttribPointer: function(){},
             enableVertexAttribArray: function(){},
@@ -548,13 +556,16 @@ function headlessCanvas() {
             depthRange: function(){},
             bufferSubData: function(){},
             blendFunc: function(){},
+            blendFuncSeparate: function(){},
+            blendEquation: function(){},
+            blendEquationSeparate: function(){},
             createFramebuffer: function() {
               var id = this.id++;
               this.items[id] = {
                 which: 'framebuffer',
                 shaders: [],
               };
-              return id;
+              return this.items[id];
             },
             bindFramebuffer: function(){},
             framebufferTexture2D: function(){},
@@ -567,7 +578,7 @@ function headlessCanvas() {
                 which: 'renderbuffer',
                 shaders: [],
               };
-              return id;
+              return this.items[id];
             },
             bindRenderbuffer: function(){},
             renderbufferStorage: function(){},
@@ -576,7 +587,22 @@ function headlessCanvas() {
             colorMask: function(){},
             lineWidth: function(){},
             vertexAttrib4fv: function(){},
+            flush: function(){},
+            finish: function(){},
           };
+          // Count the calls that reach the context, so that tests can check
+          // which calls the GL library forwards.
+          ctx.callCounts = {};
+          Object.keys(ctx).forEach(function(name) {
+            var func = ctx[name];
+            if (typeof func != 'function') return;
+            ctx.callCounts[name] = 0;
+            ctx[name] = function() {
+              ctx.callCounts[name]++;
+              return func.apply(this, arguments);
+            };
+          });
+          return ctx;
         }
         case '2d': {
           return {
@@ -282,6 +282,20 @@ function(${args}) {
               body = `return ${body}`;
             }
             const rtnType = sig && sig.length ? sig[0] : null;
+            const numArgs = args ? args.split(',').length : 0;
+            // Synchronously proxied functions with a known signature and only
+            // Number arguments (which is the case for most syscalls) can use the
+            // allocation-free fast path.
+            const plainArgs = !args || (!args.includes('...') && !args.includes('='));
+            if (sync && sig && !MEMORY64 && plainArgs && numArgs <= 6 && !sig.slice(1).includes('j')) {
+              deps.push('$proxyToMainThreadFast');
+              return `
+function(${args}) {
+if (ENVIRONMENT_IS_PTHREAD)
+  return proxyToMainThreadFast(${proxiedFunctionTable.length}, ${numArgs}${args ? ', ' : ''}${args});
+${body}
+}\n`;
+            }
             const proxyFunc =
               MEMORY64 && rtnType == 'p' ? 'proxyToMainThreadPtr' : 'proxyToMainThread';
             deps.push('$' + proxyFunc);
@@ -735,6 +749,7 @@ var proxiedFunctionTable = [
         deps: symbolDeps,
         asyncFuncs,
         extraLibraryFuncs,
+        usedSettings: Array.from(usedSettings).sort(),
       }),
     );
   } else {
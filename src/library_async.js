@@ -29,6 +29,12 @@ addToLibrary({
     'malloc', 'free',
 #endif
   ],
+#if ASYNCIFY_PROFILE
+  $Asyncify__postset: () => {
+    addAtExit('Asyncify.printProfile();');
+    return "Module['getAsyncifyProfile'] = () => Asyncify.getProfile();";
+  },
+#endif
 
   $Asyncify: {
     //
@@ -50,6 +56,18 @@ addToLibrary({
         let sig = original.sig;
         if (typeof original == 'function') {
           let isAsyncifyImport = original.isAsync || importPattern.test(x);
+#if ASYNCIFY_PROFILE
+          // Remember which import we are inside of, so that an unwind can be
+          // attributed to it.
+          if (isAsyncifyImport) {
+            let inner = original;
+            imports[x] = original = (...args) => {
+              Asyncify.currImport = x;
+              return inner(...args);
+            };
+            original.sig = sig;
+          }
+#endif
 #if ASYNCIFY == 2
           // Wrap async imports with a suspending WebAssembly function.
           if (isAsyncifyImport) {
@@ -202,6 +220,129 @@ addToLibrary({
     callStackId: 0,
     asyncPromiseHandlers: null, // { resolve, reject } pair for when *all* asynchronicity is done
     sleepCallbacks: [], // functions to call every time we sleep
+#if !USE_ASAN && !USE_LSAN
+    // Data buffers that are free for reuse.  Only one sleep can be in flight at
+    // a time, so in practice this holds at most a single buffer.  (In sanitizer
+    // builds we free the buffers eagerly, as the leak checker cannot see
+    // pointers that are only held by JS.)
+    dataPool: [],
+#endif
+#if ASYNCIFY_PROFILE
+    // The asyncify import that was most recently called into.
+    currImport: null,
+    profile: {
+      imports: {},
+      exports: {},
+      saveSizes: {},
+      functions: new Set(),
+      unwinds: 0,
+      rewinds: 0,
+      rewindTime: 0,
+    },
+    // The import and export that the in-progress unwind belongs to, and the
+    // time at which its rewind began.
+    profileCurr: null,
+
+    getProfileEntry(table, name) {
+      return table[name] ||= { unwinds: 0, rewinds: 0, rewindTime: 0 };
+    },
+
+    // Record the names of all the wasm functions that are currently on the
+    // stack.  These are the functions that must be instrumented in order for
+    // this unwind to work, which is what ASYNCIFY_ONLY needs to list.
+    profileStackFunctions() {
+      var limit = Error.stackTraceLimit;
+      Error.stackTraceLimit = Infinity;
+      var stack = new Error().stack;
+      Error.stackTraceLimit = limit;
+      for (var line of stack.split('\n')) {
+        // Chrome/node:  "    at foo(int) (wasm://wasm/1234:wasm-function[5]:0x1a)"
+        // Firefox:      "foo(int)@http://localhost/a.wasm:wasm-function[5]:0x1a"
+        var m = line.match(/^\s*at (.+) \(.*wasm-function\[\d+\]/) ||
+                line.match(/^(.+)@.*wasm-function\[\d+\]/);
+        // Functions that have no entry in the name section show up as `$funcN`
+        // or `wasm-function[N]`, which we cannot put in a list.
+        if (m && !m[1].startsWith('$') && !m[1].startsWith('wasm-function[')) {
+          Asyncify.profile.functions.add(m[1]);
+        }
+      }
+    },
+
+    profileUnwind() {
+      var profile = Asyncify.profile;
+      var importName = Asyncify.currImport || '<unknown>';
+      var exportName = Asyncify.exportCallStack[0];
+      profile.unwinds++;
+      Asyncify.getProfileEntry(profile.imports, importName).unwinds++;
+      Asyncify.getProfileEntry(profile.exports, exportName).unwinds++;
+      Asyncify.profileStackFunctions();
+      Asyncify.profileCurr = { importName, exportName, start: 0 };
+    },
+
+    profileSaveSize(ptr) {
+      // The stack pointer in the data header has been advanced past everything
+      // that was saved during the unwind.
+      var stackStart = ptr + {{{ C_STRUCTS.asyncify_data_s.__size__ }}};
+      var stackEnd = {{{ makeGetValue('ptr', C_STRUCTS.asyncify_data_s.stack_ptr, '*') }}};
+      var size = stackEnd - stackStart;
+      // Bucket by the next power of two.
+      var bucket = size ? 2 ** Math.ceil(Math.log2(size)) : 0;
+      Asyncify.profile.saveSizes[bucket] = (Asyncify.profile.saveSizes[bucket] || 0) + 1;
+    },
+
+    profileRewindStart() {
+      if (Asyncify.profileCurr) Asyncify.profileCurr.start = performance.now();
+    },
+
+    profileRewindEnd() {
+      var curr = Asyncify.profileCurr;
+      if (!curr) return;
+      Asyncify.profileCurr = null;
+      var profile = Asyncify.profile;
+      var time = performance.now() - curr.start;
+      profile.rewinds++;
+      profile.rewindTime += time;
+      for (var entry of [Asyncify.getProfileEntry(profile.imports, curr.importName),
+                         Asyncify.getProfileEntry(profile.exports, curr.exportName)]) {
+        entry.rewinds++;
+        entry.rewindTime += time;
+      }
+    },
+
+    getProfile() {
+      var profile = Asyncify.profile;
+      return {
+        'unwinds': profile.unwinds,
+        'rewinds': profile.rewinds,
+        'rewindTime': profile.rewindTime,
+        'imports': profile.imports,
+        'exports': profile.exports,
+        'saveSizes': profile.saveSizes,
+        // Lists that can be passed back to the compiler so that only what was
+        // actually used gets instrumented.
+        'suggestedImports': Object.keys(profile.imports).filter((x) => x != '<unknown>').sort(),
+        'suggestedOnly': Array.from(profile.functions).sort(),
+      };
+    },
+
+    printProfile() {
+      var profile = Asyncify.getProfile();
+      var print = (x) => err(`[asyncify-profile] ${x}`);
+      var describe = (entry) => `${entry.unwinds} unwinds, ${entry.rewinds} rewinds, ${entry.rewindTime.toFixed(3)} ms rewinding`;
+      print(`total: ${describe(profile)}`);
+      for (var [name, entry] of Object.entries(profile.imports)) {
+        print(`import ${name}: ${describe(entry)}`);
+      }
+      for (var [name, entry] of Object.entries(profile.exports)) {
+        print(`export ${name}: ${describe(entry)}`);
+      }
+      for (var [bucket, count] of Object.entries(profile.saveSizes)) {
+        print(`saved <= ${bucket} bytes: ${count}`);
+      }
+      print(`-sASYNCIFY_IMPORTS=${JSON.stringify(profile.suggestedImports)}`);
+      print(`-sASYNCIFY_ONLY=${JSON.stringify(profile.suggestedOnly)}`);
+    },
+#endif
 
     getCallStackId(funcName) {
       var id = Asyncify.callStackNameToId[funcName];
@@ -228,6 +369,11 @@ addToLibrary({
         Asyncify.state = Asyncify.State.Normal;
 #if ASYNCIFY_DEBUG
         dbg('ASYNCIFY: stop unwind');
+#endif
+#if ASYNCIFY_PROFILE
+        // Fibers manage their own data buffers, which do not have the layout
+        // that allocateData() creates, so we only measure handleSleep unwinds.
+        if (Asyncify.profileCurr) Asyncify.profileSaveSize(Asyncify.currData);
 #endif
         {{{ runtimeKeepalivePush(); }}}
         // Keep the runtime alive so that a re-wind can be done later.
@@ -257,12 +403,24 @@ addToLibrary({
       // The Asyncify ABI only interprets the first two fields, the rest is for the runtime.
       // We also embed a stack in the same memory region here, right next to the structure.
       // This struct is also defined as asyncify_data_t in emscripten/fiber.h
+#if !USE_ASAN && !USE_LSAN
+      var ptr = Asyncify.dataPool.pop() || _malloc({{{ C_STRUCTS.asyncify_data_s.__size__ }}} + Asyncify.StackSize);
+#else
       var ptr = _malloc({{{ C_STRUCTS.asyncify_data_s.__size__ }}} + Asyncify.StackSize);
+#endif
       Asyncify.setDataHeader(ptr, ptr + {{{ C_STRUCTS.asyncify_data_s.__size__ }}}, Asyncify.StackSize);
       Asyncify.setDataRewindFunc(ptr);
       return ptr;
     },
 
+    freeData(ptr) {
+#if !USE_ASAN && !USE_LSAN
+      Asyncify.dataPool.push(ptr);
+#else
+      _free(ptr);
+#endif
+    },
+
     setDataHeader(ptr, stack, stackSize) {
       {{{ makeSetValue('ptr', C_STRUCTS.asyncify_data_s.stack_ptr, 'stack', '*') }}};
       {{{ makeSetValue('ptr', C_STRUCTS.asyncify_data_s.stack_limit, 'stack + stackSize', '*') }}};
@@ -346,6 +504,9 @@ addToLibrary({
           dbg(`ASYNCIFY: start rewind ${Asyncify.currData}`);
 #endif
           Asyncify.state = Asyncify.State.Rewinding;
+#if ASYNCIFY_PROFILE
+          Asyncify.profileRewindStart();
+#endif
           runAndAbortIfError(() => _asyncify_start_rewind(Asyncify.currData));
           if (typeof Browser != 'undefined' && Browser.mainLoop.func) {
             Browser.mainLoop.resume();
@@ -390,8 +551,10 @@ addToLibrary({
         if (!reachedCallback) {
           // A true async operation was begun; start a sleep.
           Asyncify.state = Asyncify.State.Unwinding;
-          // TODO: reuse, don't alloc/free every sleep
           Asyncify.currData = Asyncify.allocateData();
+#if ASYNCIFY_PROFILE
+          Asyncify.profileUnwind();
+#endif
 #if ASYNCIFY_DEBUG
           dbg(`ASYNCIFY: start unwind ${Asyncify.currData}`);
 #endif
@@ -407,7 +570,10 @@ addToLibrary({
 #endif
         Asyncify.state = Asyncify.State.Normal;
         runAndAbortIfError(_asyncify_stop_rewind);
-        _free(Asyncify.currData);
+#if ASYNCIFY_PROFILE
+        Asyncify.profileRewindEnd();
+#endif
+        Asyncify.freeData(Asyncify.currData);
         Asyncify.currData = null;
         // Call all sleep callbacks now that the sleep-resume is all done.
         Asyncify.sleepCallbacks.forEach(callUserCallback);
@@ -907,6 +907,9 @@ var LibraryBrowser = {
 #endif
 #if EXIT_RUNTIME && !MINIMAL_RUNTIME
     '$maybeExit',
+#endif
+#if GL_PROFILE
+    '$GLProfiler',
 #endif
   ],
   $setMainLoop__docs: `
@@ -1002,6 +1005,9 @@ var LibraryBrowser = {
 #if FULL_ES2 || LEGACY_GL_EMULATION
       GL.newRenderingFrameStarted();
 #endif
+#if GL_PROFILE
+      GLProfiler.endFrame();
+#endif
 
 #if PTHREADS && OFFSCREEN_FRAMEBUFFER && GL_SUPPORT_EXPLICIT_SWAP_CONTROL
       // If the current GL context is a proxied regular WebGL context, and was initialized with implicit swap mode on the main thread, and we are on the parent thread,
@@ -14,21 +14,46 @@ var LibraryFetch = {
   _emscripten_fetch_get_response_headers_length: fetchGetResponseHeadersLength,
   _emscripten_fetch_get_response_headers__deps: ['$lengthBytesUTF8', '$stringToUTF8'],
   _emscripten_fetch_get_response_headers: fetchGetResponseHeaders,
+  _emscripten_fetch_free__deps: ['free', '$fetchUnschedule'],
   _emscripten_fetch_free: fetchFree,
+  _emscripten_fetch_set_paused: fetchSetPaused,
+  _emscripten_fetch_get_stats__deps: ['$writeI53ToI64'],
+  _emscripten_fetch_get_stats: fetchGetStats,
+  emscripten_fetch_set_max_concurrent_per_origin__deps: ['$fetchPump'],
+  emscripten_fetch_set_max_concurrent_per_origin: fetchSetMaxConcurrentPerOrigin,
+  emscripten_fetch_set_deduplication: fetchSetDeduplication,
 
 #if FETCH_SUPPORT_INDEXEDDB
   $fetchDeleteCachedData: fetchDeleteCachedData,
   $fetchLoadCachedData: fetchLoadCachedData,
   $fetchCacheData: fetchCacheData,
 #endif
+  $fetchXHR__deps: ['$fetchStream'],
   $fetchXHR: fetchXHR,
+  $fetchStream__deps: ['malloc', '$writeI53ToI64', '$stringToUTF8', '$UTF8ToString'],
+  $fetchStream: fetchStream,
+  $fetchOrigin: fetchOrigin,
+  $fetchDedupKey__deps: ['$UTF8ToString'],
+  $fetchDedupKey: fetchDedupKey,
+  $fetchSchedule__deps: ['$fetchXHR', '$fetchOrigin', '$fetchDedupKey', '$fetchEnqueue'],
+  $fetchSchedule: fetchSchedule,
+  $fetchEnqueue__deps: ['$fetchPump'],
+  $fetchEnqueue: fetchEnqueue,
+  $fetchPump__deps: ['$fetchStartJob'],
+  $fetchPump: fetchPump,
+  $fetchStartJob__deps: ['malloc', '$fetchXHR', '$fetchJobDone', '$readI53FromI64'],
+  $fetchStartJob: fetchStartJob,
+  $fetchJobDone__deps: ['$fetchPump'],
+  $fetchJobDone: fetchJobDone,
+  $fetchUnschedule__deps: ['$fetchEnqueue', '$fetchPump', '$fetchJobDone'],
+  $fetchUnschedule: fetchUnschedule,
 
   emscripten_start_fetch: startFetch,
   emscripten_start_fetch__deps: [
     'malloc',
     'free',
     '$Fetch',
-    '$fetchXHR',
+    '$fetchSchedule',
     '$callUserCallback',
     '$writeI53ToI64',
     '$stringToUTF8',
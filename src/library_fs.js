@@ -37,6 +37,7 @@ addToLibrary({
 if (!Module['noFSInit'] && !FS.init.initialized)
   FS.init();
 FS.ignorePermissions = false;
+FS.invalidateLookupCache();
 `)
     addAtExit('FS.quit();');
     return `
@@ -51,7 +52,18 @@ FS.staticInit();` +
     devices: {},
     streams: [],
     nextInode: 1,
+    // Hash table of all nodes by parent and name, chained through
+    // node.name_next. Its size is a power of two, and it is doubled whenever
+    // it holds more nodes than it has buckets.
     nameTable: null,
+    nameTableCount: 0,
+    // The results of resolving the directories that paths lead through, by
+    // absolute path, see lookupPath(). Cleared whenever a node is removed or
+    // any other change could make a result stale.
+    lookupCache: new Map(),
+    // The operations of lazy data files, by the stream operations of the files
+    // they wrap, see createLazyDataFile().
+    lazyFileOps: new Map(),
     currentPath: '/',
     initialized: false,
     // Whether we are currently ignoring permissions. Useful when preparing the
@@ -197,8 +209,20 @@ FS.staticInit();` +
       // start at the root
       var current = FS.root;
       var current_path = '/';
+      var i = 0;
 
-      for (var i = 0; i < parts.length; i++) {
+      // All components but the last are resolved the same way regardless of
+      // the options, so the directory that contains the last component can be
+      // taken from the cache, leaving only the last component to look up.
+      var dirPath = parts.length > 1 ? path.slice(0, path.lastIndexOf('/')) : null;
+      var cached = dirPath && FS.lookupCache.get(dirPath);
+      if (cached) {
+        current = cached.node;
+        current_path = cached.path;
+        i = parts.length - 1;
+      }
+
+      for (; i < parts.length; i++) {
         var islast = (i === parts.length-1);
         if (islast && opts.parent) {
           // stop resolving
@@ -231,10 +255,24 @@ FS.staticInit();` +
             }
           }
         }
+
+        if (i === parts.length - 2) {
+          if (FS.lookupCache.size >= FS.maxLookupCacheSize) {
+            FS.lookupCache.clear();
+          }
+          FS.lookupCache.set(dirPath, { node: current, path: current_path });
+        }
       }
 
       return { path: current_path, node: current };
     },
+    maxLookupCacheSize: 65536,
+    // Called when a change to the file system could make a cached lookup
+    // stale: a node was removed or renamed, a mount was added or removed, or
+    // permissions changed, which the cached lookups did not check.
+    invalidateLookupCache() {
+      FS.lookupCache.clear();
+    },
     getPath(node) {
       var path;
       while (true) {
@@ -261,28 +299,48 @@ FS.staticInit();` +
       for (var i = 0; i < name.length; i++) {
         hash = ((hash << 5) - hash + name.charCodeAt(i)) | 0;
       }
-      return ((parentid + hash) >>> 0) % FS.nameTable.length;
+      return ((parentid + hash) >>> 0) & (FS.nameTable.length - 1);
     },
     hashAddNode(node) {
+      if (++FS.nameTableCount > FS.nameTable.length) {
+        FS.resizeNameTable(FS.nameTable.length * 2);
+      }
       var hash = FS.hashName(node.parent.id, node.name);
       node.name_next = FS.nameTable[hash];
       FS.nameTable[hash] = node;
     },
     hashRemoveNode(node) {
+      FS.invalidateLookupCache();
       var hash = FS.hashName(node.parent.id, node.name);
       if (FS.nameTable[hash] === node) {
         FS.nameTable[hash] = node.name_next;
+        FS.nameTableCount--;
       } else {
         var current = FS.nameTable[hash];
         while (current) {
           if (current.name_next === node) {
             current.name_next = node.name_next;
+            FS.nameTableCount--;
             break;
           }
           current = current.name_next;
         }
       }
     },
+    resizeNameTable(size) {
+      var oldTable = FS.nameTable;
+      FS.nameTable = new Array(size);
+      for (var i = 0; i < oldTable.length; i++) {
+        var node = oldTable[i];
+        while (node) {
+          var next = node.name_next;
+          var hash = FS.hashName(node.parent.id, node.name);
+          node.name_next = FS.nameTable[hash];
+          FS.nameTable[hash] = node;
+          node = next;
+        }
+      }
+    },
     lookupNode(parent, name) {
       var errCode = FS.mayLookup(parent);
       if (errCode) {
@@ -604,6 +662,7 @@ FS.staticInit();` +
       } else if (node) {
         // set as a mountpoint
         node.mounted = mount;
+        FS.invalidateLookupCache();
 
         // add the new mount to the current mount's children
         if (node.mount) {
@@ -641,6 +700,7 @@ FS.staticInit();` +
 
       // no longer a mountpoint
       node.mounted = null;
+      FS.invalidateLookupCache();
 
       // remove this mount from the child mounts
       var idx = node.mount.mounts.indexOf(mount);
@@ -935,6 +995,7 @@ FS.staticInit();` +
         mode: (mode & {{{ cDefs.S_IALLUGO }}}) | (node.mode & ~{{{ cDefs.S_IALLUGO }}}),
         timestamp: Date.now()
       });
+      FS.invalidateLookupCache();
     },
     lchmod(path, mode) {
       FS.chmod(path, mode, true);
@@ -1570,6 +1631,62 @@ FS.staticInit();` +
         FS.chmod(node, mode);
       }
     },
+    // Creates a file of the given size whose contents are only requested from
+    // getContents(), which returns a Uint8Array that the file can own, when
+    // they are first read, written, mapped or truncated. This lets the file
+    // packager create the files of large packages without loading them.
+    createLazyDataFile(parent, name, size, getContents, canRead, canWrite) {
+      var path = name;
+      if (parent) {
+        parent = typeof parent == 'string' ? parent : FS.getPath(parent);
+        path = name ? PATH.join2(parent, name) : parent;
+      }
+      var node = FS.create(path, FS_getMode(canRead, canWrite));
+      var node_ops = node.node_ops;
+      var stream_ops = node.stream_ops;
+      // Files share their wrapped operations, so that creating one does not
+      // allocate anything but the closure of getContents.
+      var ops = FS.lazyFileOps.get(stream_ops);
+      if (!ops) {
+        ops = {
+          node_ops: Object.assign({}, node_ops, {
+            setattr(node, attr) {
+              if (attr.size !== undefined) FS.loadLazyFile(node);
+              return node_ops.setattr(node, attr);
+            },
+          }),
+          stream_ops: {},
+          original: { node_ops, stream_ops },
+        };
+        for (let key in stream_ops) {
+          ops.stream_ops[key] = key == 'llseek' ? stream_ops[key] : (stream, ...args) => {
+            FS.loadLazyFile(stream.node);
+            stream.stream_ops = stream.node.stream_ops;
+            return stream_ops[key](stream, ...args);
+          };
+        }
+        FS.lazyFileOps.set(stream_ops, ops);
+      }
+      node.node_ops = ops.node_ops;
+      node.stream_ops = ops.stream_ops;
+      node.usedBytes = size;
+      node.lazy = { ops, getContents };
+      return node;
+    },
+    loadLazyFile(node) {
+      var lazy = node.lazy;
+      if (!lazy) return;
+      try {
+        var contents = lazy.getContents();
+      } catch (e) {
+        throw new FS.ErrnoError({{{ cDefs.EIO }}});
+      }
+      node.lazy = null;
+      node.node_ops = lazy.ops.original.node_ops;
+      node.stream_ops = lazy.ops.original.stream_ops;
+      node.contents = contents;
+      node.usedBytes = contents.length;
+    },
     createDevice(parent, name, input, output) {
       var path = PATH.join2(typeof parent == 'string' ? parent : FS.getPath(parent), name);
       var mode = FS_getMode(!!input, !!output);
@@ -13,6 +13,9 @@
     }
     return '';
   }
+  // Emulated state that is only applied to the WebGL context when drawing has
+  // to draw the pending immediate mode batch before it changes.
+  globalThis.flushImmediateBatch = () => GL_IMMEDIATE_BATCHING ? 'GLImmediate.flushBatch();' : '';
   null;
 }}}
 
@@ -615,6 +618,7 @@ var LibraryGLEmulation = {
         }
 #endif
         if (GL.currProgram != program) {
+          {{{ flushImmediateBatch() }}}
           GLImmediate.currentRenderer = null; // This changes the FFP emulation shader program, need to recompute that.
           GL.currProgram = program;
           GLImmediate.fixedFunctionProgram = 0;
@@ -649,6 +653,9 @@ var LibraryGLEmulation = {
 
       var glBindBuffer = _glBindBuffer;
       _glBindBuffer = _emscripten_glBindBuffer = (target, buffer) => {
+        // The pending batch is drawn with the buffer bindings that are tracked
+        // in JS, which change before the context sees the new binding.
+        {{{ flushImmediateBatch() }}}
         glBindBuffer(target, buffer);
         if (target == GLctx.ARRAY_BUFFER) {
           if (GLEmulation.currentVao) {
@@ -1964,6 +1971,18 @@ var LibraryGLEmulation = {
     lastProgram: null, // ""
     lastStride: -1, // ""
 
+#if GL_IMMEDIATE_BATCHING
+    // Consecutive glBegin()/glEnd() groups that render with the same state are
+    // collected here and drawn together, see batchBeginEnd().
+    batch: null,
+    // Vertices per primitive of the modes whose groups can be concatenated:
+    // GL_POINTS, GL_LINES, GL_TRIANGLES and GL_QUADS.
+    batchPrimitiveSizes: [1, 2, 0, 0, 3, 0, 0, 4],
+    // Number of glBegin()/glEnd() groups, and of the draw calls and vertices
+    // that were issued for them.
+    batchStats: { groups: 0, draws: 0, vertices: 0 },
+#endif
+
     // The following data structures are used for OpenGL Immediate Mode matrix routines.
     matrix: [],
     matrixStack: [],
@@ -2764,6 +2783,7 @@ var LibraryGLEmulation = {
       var glTexEnvf = (typeof _glTexEnvf != 'undefined') ? _glTexEnvf : () => {};
       /** @suppress {checkTypes} */
       _glTexEnvf = _emscripten_glTexEnvf = (target, pname, param) => {
+        {{{ flushImmediateBatch() }}}
         GLImmediate.TexEnvJIT.hook_texEnvf(target, pname, param);
         // Don't call old func, since we are the implementor.
         //glTexEnvf(target, pname, param);
@@ -2773,6 +2793,7 @@ var LibraryGLEmulation = {
       /** @suppress {checkTypes} */
       _glTexEnvi = _emscripten_glTexEnvi = (target, pname, param) => {
         {{{ fromPtr('param') }}}
+        {{{ flushImmediateBatch() }}}
         GLImmediate.TexEnvJIT.hook_texEnvi(target, pname, param);
         // Don't call old func, since we are the implementor.
         //glTexEnvi(target, pname, param);
@@ -2782,6 +2803,7 @@ var LibraryGLEmulation = {
       /** @suppress {checkTypes} */
       _glTexEnvfv = _emscripten_glTexEnvfv = (target, pname, param) => {
         {{{ fromPtr('param') }}}
+        {{{ flushImmediateBatch() }}}
         GLImmediate.TexEnvJIT.hook_texEnvfv(target, pname, param);
         // Don't call old func, since we are the implementor.
         //glTexEnvfv(target, pname, param);
@@ -2862,6 +2884,21 @@ var LibraryGLEmulation = {
 
       GL.generateTempBuffers(true, GL.currentContext);
 
+#if GL_IMMEDIATE_BATCHING
+      GLImmediate.batch = {
+        data: new Float32Array(GL.MAX_TEMP_BUFFER_SIZE >> 2),
+        count: 0, // number of vertices
+        maxCount: 0,
+        renderer: null,
+        mode: -1,
+        stride: 0,
+        clientAttributes: null,
+        enabledClientAttributes: null,
+        flushScheduled: false,
+      };
+      GLImmediate.hookContextForBatching(GLctx);
+#endif
+
       GLImmediate.clientColor = new Float32Array([1, 1, 1, 1]);
     },
 
@@ -3074,7 +3111,135 @@ var LibraryGLEmulation = {
       renderer.cleanup();
 #endif
 #endif
-    }
+    },
+
+#if GL_IMMEDIATE_BATCHING
+    // Appends the glBegin()/glEnd() group that is ending to the pending batch.
+    // Returns false if the group has to be drawn on its own instead, which is
+    // the case for the strip, loop and fan modes.
+    batchBeginEnd() {
+      var batch = GLImmediate.batch;
+      var stats = GLImmediate.batchStats;
+      stats.groups++;
+      var primitiveSize = GLImmediate.batchPrimitiveSizes[GLImmediate.mode];
+      if (!primitiveSize) {
+        GLImmediate.flushBatch();
+        stats.draws++;
+        stats.vertices += GLImmediate.lastVertex;
+        return false;
+      }
+      var renderer = GLImmediate.getRenderer();
+      var stride = GLImmediate.stride;
+      // Incomplete primitives at the end of a group are not drawn, and would
+      // misalign the primitives of the groups that follow it.
+      var count = GLImmediate.lastVertex - GLImmediate.lastVertex % primitiveSize;
+      if (!count) return true;
+      if (batch.count && (renderer != batch.renderer || GLImmediate.mode != batch.mode || stride != batch.stride
+                          || batch.count + count > batch.maxCount || !GLImmediate.sameBatchLayout())) {
+        GLImmediate.flushBatch();
+      }
+      if (!batch.count) {
+        // Indices are 16-bit, so this also keeps GL_QUADS within the static
+        // quad index buffer.
+        batch.maxCount = Math.min((GL.MAX_TEMP_BUFFER_SIZE / stride)|0, 0x10000);
+        if (count > batch.maxCount) {
+          stats.draws++;
+          stats.vertices += GLImmediate.lastVertex;
+          return false;
+        }
+        batch.renderer = renderer;
+        batch.mode = GLImmediate.mode;
+        batch.stride = stride;
+        // The group's attribute state is fresh for each glBegin(), so it can
+        // be kept as is for drawing the batch later.
+        batch.clientAttributes = GLImmediate.clientAttributes;
+        batch.enabledClientAttributes = GLImmediate.enabledClientAttributes;
+        if (!batch.flushScheduled) {
+          // Draw whatever is still pending before control returns to the
+          // browser and the frame is presented.
+          batch.flushScheduled = true;
+          queueMicrotask(() => {
+            batch.flushScheduled = false;
+            GLImmediate.flushBatch();
+          });
+        }
+      }
+      batch.data.set(GLImmediate.tempData.subarray(0, (count * stride) >> 2), (batch.count * stride) >> 2);
+      batch.count += count;
+      return true;
+    },
+
+    // Whether the attributes of the ending group are at the same offsets within
+    // a vertex as those of the pending batch. The renderer is the same for
+    // both, so they have the same attributes enabled.
+    sameBatchLayout() {
+      var attributes = GLImmediate.liveClientAttributes;
+      var batchAttributes = GLImmediate.batch.clientAttributes;
+      for (var i = 0; i < attributes.length; i++) {
+        if (attributes[i].offset != batchAttributes[attributes[i].name].offset) return false;
+      }
+      return true;
+    },
+
+    flushBatch() {
+      var batch = GLImmediate.batch;
+      var count = batch?.count;
+      if (!count) return;
+      // Reset first, as the draw below goes through the hooked context.
+      batch.count = 0;
+      // This can run in the middle of any other GL call, so restore everything
+      // that is swapped out for drawing the batch afterwards.
+      var mode = GLImmediate.mode;
+      var vertexData = GLImmediate.vertexData;
+      var vertexCounter = GLImmediate.vertexCounter;
+      var stride = GLImmediate.stride;
+      var firstVertex = GLImmediate.firstVertex;
+      var lastVertex = GLImmediate.lastVertex;
+      var clientAttributes = GLImmediate.clientAttributes;
+      var enabledClientAttributes = GLImmediate.enabledClientAttributes;
+      var currentRenderer = GLImmediate.currentRenderer;
+      GLImmediate.mode = batch.mode;
+      GLImmediate.vertexData = batch.data;
+      GLImmediate.vertexCounter = (count * batch.stride) >> 2;
+      GLImmediate.stride = batch.stride;
+      GLImmediate.firstVertex = 0;
+      GLImmediate.lastVertex = count;
+      GLImmediate.clientAttributes = batch.clientAttributes;
+      GLImmediate.enabledClientAttributes = batch.enabledClientAttributes;
+      GLImmediate.currentRenderer = batch.renderer;
+      GLImmediate.flush();
+      GLImmediate.mode = mode;
+      GLImmediate.vertexData = vertexData;
+      GLImmediate.vertexCounter = vertexCounter;
+      GLImmediate.stride = stride;
+      GLImmediate.firstVertex = firstVertex;
+      GLImmediate.lastVertex = lastVertex;
+      GLImmediate.clientAttributes = clientAttributes;
+      GLImmediate.enabledClientAttributes = enabledClientAttributes;
+      GLImmediate.currentRenderer = currentRenderer;
+      GLImmediate.batchStats.draws++;
+      GLImmediate.batchStats.vertices += count;
+    },
+
+    // Any call that reaches the WebGL context might change state that the
+    // pending batch is drawn with, or read back what it renders, so draw the
+    // batch first.
+    hookContextForBatching(ctx) {
+      for (var f in ctx) {
+        if (typeof ctx[f] == 'function') {
+          GLImmediate.hookContextFunctionForBatching(f, ctx);
+        }
+      }
+    },
+
+    hookContextFunctionForBatching(f, ctx) {
+      var orig = ctx[f];
+      ctx[f] = function(...args) {
+        if (GLImmediate.batch.count) GLImmediate.flushBatch();
+        return orig.apply(this, args);
+      };
+    },
+#endif
   },
 
   $GLImmediateSetup__deps: ['$GLImmediate', () => 'GLImmediate.matrixLib = ' + read('gl-matrix.js') + ';\n'],
@@ -3106,8 +3271,15 @@ var LibraryGLEmulation = {
     GLImmediate.prepareClientAttributes(GLImmediate.rendererComponents[GLImmediate.VERTEX], true);
     GLImmediate.firstVertex = 0;
     GLImmediate.lastVertex = GLImmediate.vertexCounter / (GLImmediate.stride >> 2);
+#if GL_IMMEDIATE_BATCHING
+    if (!GLImmediate.batchBeginEnd()) {
+      GLImmediate.flush();
+      GLImmediate.disableBeginEndClientAttributes();
+    }
+#else
     GLImmediate.flush();
     GLImmediate.disableBeginEndClientAttributes();
+#endif
     GLImmediate.mode = -1;
 
     // Pop the old state:
@@ -3212,6 +3384,7 @@ var LibraryGLEmulation = {
       GLImmediate.vertexCounter++;
       GLImmediate.addRendererComponent(GLImmediate.COLOR, 4, GLctx.UNSIGNED_BYTE);
     } else {
+      {{{ flushImmediateBatch() }}}
       GLImmediate.clientColor[0] = r;
       GLImmediate.clientColor[1] = g;
       GLImmediate.clientColor[2] = b;
@@ -3280,6 +3453,7 @@ var LibraryGLEmulation = {
                                   {{{ makeGetValue('p', '3', 'i8') }}}),
 
   glFogf: (pname, param) => { // partial support, TODO
+    {{{ flushImmediateBatch() }}}
     switch (pname) {
       case 0xB63: // GL_FOG_START
         GLEmulation.fogStart = param; break;
@@ -3312,6 +3486,7 @@ var LibraryGLEmulation = {
   },
   glFogfv__deps: ['glFogf'],
   glFogfv: (pname, param) => { // partial support, TODO
+    {{{ flushImmediateBatch() }}}
     switch (pname) {
       case 0xB66: // GL_FOG_COLOR
         GLEmulation.fogColor[0] = {{{ makeGetValue('param', '0', 'float') }}};
@@ -3326,6 +3501,7 @@ var LibraryGLEmulation = {
   },
   glFogiv__deps: ['glFogf'],
   glFogiv: (pname, param) => {
+    {{{ flushImmediateBatch() }}}
     switch (pname) {
       case 0xB66: // GL_FOG_COLOR
         GLEmulation.fogColor[0] = ({{{ makeGetValue('param', '0', 'i32') }}}/2147483647)/2.0+0.5;
@@ -3341,12 +3517,14 @@ var LibraryGLEmulation = {
   glFogxv: 'glFogiv',
 
   glPointSize: (size) => {
+    {{{ flushImmediateBatch() }}}
     GLEmulation.pointSize = size;
   },
 
   glPolygonMode: () => {}, // TODO
 
   glAlphaFunc: (func, ref) => {
+    {{{ flushImmediateBatch() }}}
     switch(func) {
       case 0x200: // GL_NEVER
       case 0x201: // GL_LESS
@@ -3482,6 +3660,7 @@ var LibraryGLEmulation = {
   // client attributes enabled, and we use webgl-friendly modes (no GL_QUADS),
   // then no need for emulation
   glDrawArrays: (mode, first, count) => {
+    {{{ flushImmediateBatch() }}}
     if (GLImmediate.totalEnabledClientAttributes == 0 && mode <= 6) {
       GLctx.drawArrays(mode, first, count);
       return;
@@ -3499,6 +3678,7 @@ var LibraryGLEmulation = {
 
   // start, end are given if we come from glDrawRangeElements
   glDrawElements: (mode, count, type, indices, start, end) => {
+    {{{ flushImmediateBatch() }}}
     if (GLImmediate.totalEnabledClientAttributes == 0 && mode <= 6 && GLctx.currentElementArrayBufferBinding) {
       GLctx.drawElements(mode, count, type, indices);
       return;
@@ -3617,6 +3797,7 @@ var LibraryGLEmulation = {
       GL.recordError(0x504/*GL_STACK_UNDERFLOW*/);
       return;
     }
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrix[GLImmediate.currentMatrix] = GLImmediate.matrixStack[GLImmediate.currentMatrix].pop();
@@ -3624,12 +3805,14 @@ var LibraryGLEmulation = {
 
   glLoadIdentity__deps: ['$GL', '$GLImmediateSetup'],
   glLoadIdentity: () => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.identity(GLImmediate.matrix[GLImmediate.currentMatrix]);
   },
 
   glLoadMatrixd: (matrix) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F64', 'matrix', 'matrix+' + (16*8)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
@@ -3639,12 +3822,14 @@ var LibraryGLEmulation = {
 #if GL_DEBUG
     if (GL.debug) dbg('glLoadMatrixf receiving: ' + Array.prototype.slice.call(HEAPF32.subarray(matrix >> 2, (matrix >> 2) + 16)));
 #endif
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F32', 'matrix', 'matrix+' + (16*4)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
   },
 
   glLoadTransposeMatrixd: (matrix) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F64', 'matrix', 'matrix+' + (16*8)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
@@ -3652,6 +3837,7 @@ var LibraryGLEmulation = {
   },
 
   glLoadTransposeMatrixf: (matrix) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.set({{{ makeHEAPView('F32', 'matrix', 'matrix+' + (16*4)) }}}, GLImmediate.matrix[GLImmediate.currentMatrix]);
@@ -3659,6 +3845,7 @@ var LibraryGLEmulation = {
   },
 
   glMultMatrixd: (matrix) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3666,6 +3853,7 @@ var LibraryGLEmulation = {
   },
 
   glMultMatrixf: (matrix) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3673,6 +3861,7 @@ var LibraryGLEmulation = {
   },
 
   glMultTransposeMatrixd: (matrix) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     var colMajor = GLImmediate.matrixLib.mat4.create();
@@ -3682,6 +3871,7 @@ var LibraryGLEmulation = {
   },
 
   glMultTransposeMatrixf: (matrix) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     var colMajor = GLImmediate.matrixLib.mat4.create();
@@ -3691,6 +3881,7 @@ var LibraryGLEmulation = {
   },
 
   glFrustum: (left, right, bottom, top_, nearVal, farVal) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3699,6 +3890,7 @@ var LibraryGLEmulation = {
   glFrustumf: 'glFrustum',
 
   glOrtho: (left, right, bottom, top_, nearVal, farVal) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.multiply(GLImmediate.matrix[GLImmediate.currentMatrix],
@@ -3707,6 +3899,7 @@ var LibraryGLEmulation = {
   glOrthof: 'glOrtho',
 
   glScaled: (x, y, z) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.scale(GLImmediate.matrix[GLImmediate.currentMatrix], [x, y, z]);
@@ -3714,6 +3907,7 @@ var LibraryGLEmulation = {
   glScalef: 'glScaled',
 
   glTranslated: (x, y, z) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.translate(GLImmediate.matrix[GLImmediate.currentMatrix], [x, y, z]);
@@ -3721,6 +3915,7 @@ var LibraryGLEmulation = {
   glTranslatef: 'glTranslated',
 
   glRotated: (angle, x, y, z) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.rotate(GLImmediate.matrix[GLImmediate.currentMatrix], angle*Math.PI/180, [x, y, z]);
@@ -3733,6 +3928,7 @@ var LibraryGLEmulation = {
 #endif
 
   glClipPlane: (pname, param) => {
+    {{{ flushImmediateBatch() }}}
     if ((pname >= 0x3000) && (pname < 0x3006)  /* GL_CLIP_PLANE0 to GL_CLIP_PLANE5 */) {
       var clipPlaneId = pname - 0x3000;
 
@@ -3750,6 +3946,7 @@ var LibraryGLEmulation = {
   },
 
   glLightfv: (light, pname, param) => {
+    {{{ flushImmediateBatch() }}}
     if ((light >= 0x4000) && (light < 0x4008)  /* GL_LIGHT0 to GL_LIGHT7 */) {
       var lightId = light - 0x4000;
 
@@ -3783,6 +3980,7 @@ var LibraryGLEmulation = {
   },
 
   glLightModelf: (pname, param) => {
+    {{{ flushImmediateBatch() }}}
     if (pname == 0x0B52) { // GL_LIGHT_MODEL_TWO_SIDE
       GLEmulation.lightModelTwoSide = (param != 0) ? true : false;
     } else {
@@ -3791,6 +3989,7 @@ var LibraryGLEmulation = {
   },
 
   glLightModelfv: (pname, param) => { // TODO: GL_LIGHT_MODEL_LOCAL_VIEWER
+    {{{ flushImmediateBatch() }}}
     if (pname == 0x0B53) { // GL_LIGHT_MODEL_AMBIENT
       GLEmulation.lightModelAmbient[0] = {{{ makeGetValue('param', '0', 'float') }}};
       GLEmulation.lightModelAmbient[1] = {{{ makeGetValue('param', '4', 'float') }}};
@@ -3802,6 +4001,7 @@ var LibraryGLEmulation = {
   },
 
   glMaterialfv: (face, pname, param) => {
+    {{{ flushImmediateBatch() }}}
     if ((face != 0x0404) && (face != 0x0408)) { throw 'glMaterialfv: TODO' + face; } // only GL_FRONT and GL_FRONT_AND_BACK supported
 
     if (pname == 0x1200) { // GL_AMBIENT
@@ -3858,6 +4058,7 @@ var LibraryGLEmulation = {
   // GLU
 
   gluPerspective: (fov, aspect, near, far) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrix[GLImmediate.currentMatrix] =
@@ -3866,6 +4067,7 @@ var LibraryGLEmulation = {
   },
 
   gluLookAt: (ex, ey, ez, cx, cy, cz, ux, uy, uz) => {
+    {{{ flushImmediateBatch() }}}
     GLImmediate.matricesModified = true;
     GLImmediate.matrixVersion[GLImmediate.currentMatrix] = (GLImmediate.matrixVersion[GLImmediate.currentMatrix] + 1)|0;
     GLImmediate.matrixLib.mat4.lookAt(GLImmediate.matrix[GLImmediate.currentMatrix], [ex, ey, ez],
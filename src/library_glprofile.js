@@ -0,0 +1,299 @@
+/**
+ * @license
+ * Copyright 2024 The Emscripten Authors
+ * SPDX-License-Identifier: MIT
+ */
+
+// Implementation of emscripten/gl_profile.h. With -sGL_PROFILE, the wasm
+// imports of the WebGL and WebGPU libraries are wrapped so that every call
+// from compiled code is counted and timed, see GLProfiler.instrumentWasmImports
+// which is called as the module is created.
+
+addToLibrary({
+#if GL_PROFILE
+  $GLProfiler__deps: [
+#if LibraryManager.has('library_webgl.js')
+    '$GL', '$computeUnpackAlignedImageSize', '$colorChannelsInGlTextureFormat', '$heapObjectForWebGLType',
+#endif
+  ],
+  $GLProfiler__postset: `
+    Module['getGLProfile'] = () => GLProfiler.getProfile();
+    Module['getGLProfileTrace'] = () => GLProfiler.getTrace();
+  `,
+  $GLProfiler: {
+    // Totals of the frame in progress, and its statistics for each entry point
+    // by name.
+    frame: null,
+    functions: {},
+    // The same for the last frame that ended.
+    lastFrame: null,
+    lastFunctions: null,
+    // The largest value of each of the totals in any frame that ended.
+    maxFrame: null,
+    frameCount: 0,
+    frameStart: 0,
+    // Events in the Chrome trace event format. With GL_PROFILE=2 this includes
+    // every call, so the number of events that are kept is limited.
+    traceEvents: [],
+    maxTraceEvents: 1 << 20,
+    droppedTraceEvents: 0,
+
+    // Functions that return the number of bytes that a call to the entry point
+    // of the same name uploads, given the arguments of the call.
+    uploadSizes: {
+#if LibraryManager.has('library_webgl.js')
+      glBufferData: (target, size, data) => data ? size : 0,
+      glBufferSubData: (target, offset, size) => size,
+      glTexImage2D: (target, level, internalFormat, width, height, border, format, type, pixels) =>
+        GLProfiler.imageSize(width, height, 1, format, type, pixels),
+      glTexSubImage2D: (target, level, xoffset, yoffset, width, height, format, type, pixels) =>
+        GLProfiler.imageSize(width, height, 1, format, type, pixels),
+      glCompressedTexImage2D: (target, level, internalFormat, width, height, border, imageSize, data) =>
+        GLProfiler.compressedImageSize(imageSize, data),
+      glCompressedTexSubImage2D: (target, level, xoffset, yoffset, width, height, format, imageSize, data) =>
+        GLProfiler.compressedImageSize(imageSize, data),
+#if MAX_WEBGL_VERSION >= 2
+      glTexImage3D: (target, level, internalFormat, width, height, depth, border, format, type, pixels) =>
+        GLProfiler.imageSize(width, height, depth, format, type, pixels),
+      glTexSubImage3D: (target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels) =>
+        GLProfiler.imageSize(width, height, depth, format, type, pixels),
+      glCompressedTexImage3D: (target, level, internalFormat, width, height, depth, border, imageSize, data) =>
+        GLProfiler.compressedImageSize(imageSize, data),
+      glCompressedTexSubImage3D: (target, level, xoffset, yoffset, zoffset, width, height, depth, format, imageSize, data) =>
+        GLProfiler.compressedImageSize(imageSize, data),
+#endif
+#endif
+#if USE_WEBGPU
+      // The buffer offset before the size is an i64, which is passed as two
+      // arguments without WASM_BIGINT, so take the last argument.
+      wgpuQueueWriteBuffer: (...args) => args[args.length - 1],
+      wgpuQueueWriteTexture: (queueId, destinationPtr, data, dataSize) => dataSize,
+#endif
+    },
+
+#if LibraryManager.has('library_webgl.js')
+    imageSize(width, height, depth, format, type, pixels) {
+      // With a pixel unpack buffer bound, `pixels` is an offset into it rather
+      // than a pointer to data in memory.
+      if (!pixels || GLctx.currentPixelUnpackBufferBinding) return 0;
+      var sizePerPixel = colorChannelsInGlTextureFormat(format) * heapObjectForWebGLType(type).BYTES_PER_ELEMENT;
+      return computeUnpackAlignedImageSize(width, height, sizePerPixel, GL.unpackAlignment) * depth;
+    },
+
+    compressedImageSize(imageSize, data) {
+      if (!data || GLctx.currentPixelUnpackBufferBinding) return 0;
+      return imageSize;
+    },
+#endif
+
+#if FULL_ES2
+    // Bytes of client-side vertex and index data that draws have uploaded to
+    // the current context so far.
+    streamedBytes() {
+      var context = GL.currentContext;
+      return (context?.streamingVertexBuffer?.uploadedBytes || 0) +
+             (context?.streamingIndexBuffer?.uploadedBytes || 0);
+    },
+#endif
+
+    instrumentWasmImports(imports) {
+      GLProfiler.frame = GLProfiler.newFrame();
+      GLProfiler.frameStart = performance.now();
+      var drawPattern = /^(glDraw(Arrays|Elements|RangeElements)|glMultiDraw|wgpu(RenderPass|RenderBundle)EncoderDraw)/;
+      for (let [x, original] of Object.entries(imports)) {
+        // The emscripten_gl* aliases are what glGetProcAddress() returns, and
+        // are counted together with the functions they alias.
+        let name = x.replace(/^emscripten_/, '');
+        if (typeof original != 'function' || !/^(gl|wgpu)[A-Z]/.test(name)) continue;
+        let isDraw = drawPattern.test(name);
+        let uploadSize = GLProfiler.uploadSizes[name];
+#if FULL_ES2
+        let streams = isDraw && name.startsWith('gl');
+#endif
+        imports[x] = (...args) => {
+          var bytes = uploadSize ? Number(uploadSize(...args)) : 0;
+#if FULL_ES2
+          if (streams) bytes -= GLProfiler.streamedBytes();
+#endif
+          var start = performance.now();
+          var ret = original(...args);
+          var end = performance.now();
+#if FULL_ES2
+          if (streams) bytes += GLProfiler.streamedBytes();
+#endif
+          GLProfiler.record(name, isDraw, bytes, start, end);
+          return ret;
+        };
+        imports[x].sig = original.sig;
+      }
+    },
+
+    newFrame: () => ({ time: 0, calls: 0, drawCalls: 0, uploadedBytes: 0 }),
+
+    record(name, isDraw, bytes, start, end) {
+      var time = end - start;
+      var frame = GLProfiler.frame;
+      var entry = GLProfiler.functions[name] ||= { time: 0, calls: 0, drawCalls: 0, uploadedBytes: 0 };
+      frame.time += time;
+      frame.calls++;
+      frame.uploadedBytes += bytes;
+      entry.time += time;
+      entry.calls++;
+      entry.uploadedBytes += bytes;
+      if (isDraw) {
+        frame.drawCalls++;
+        entry.drawCalls++;
+      }
+#if GL_PROFILE == 2
+      GLProfiler.addTraceEvent({
+        'name': name,
+        'cat': name.startsWith('gl') ? 'webgl' : 'webgpu',
+        'ph': 'X',
+        // Timestamps and durations are in microseconds.
+        'ts': start * 1000,
+        'dur': time * 1000,
+        'pid': 0,
+        'tid': 0,
+        'args': { 'uploadedBytes': bytes },
+      });
+#endif
+    },
+
+    addTraceEvent(event) {
+      if (GLProfiler.traceEvents.length < GLProfiler.maxTraceEvents) {
+        GLProfiler.traceEvents.push(event);
+      } else {
+        GLProfiler.droppedTraceEvents++;
+      }
+    },
+
+    endFrame() {
+      var now = performance.now();
+      var frame = GLProfiler.frame;
+      var max = GLProfiler.maxFrame ||= GLProfiler.newFrame();
+      for (var key in max) {
+        max[key] = Math.max(max[key], frame[key]);
+      }
+      GLProfiler.addTraceEvent({
+        'name': 'frame',
+        'cat': 'frame',
+        'ph': 'X',
+        'ts': GLProfiler.frameStart * 1000,
+        'dur': (now - GLProfiler.frameStart) * 1000,
+        'pid': 0,
+        'tid': 0,
+        'args': { 'frame': GLProfiler.frameCount },
+      });
+      GLProfiler.addTraceEvent({
+        'name': 'frame totals',
+        'cat': 'frame',
+        'ph': 'C',
+        'ts': now * 1000,
+        'pid': 0,
+        'tid': 0,
+        'args': {
+          'time': frame.time,
+          'calls': frame.calls,
+          'drawCalls': frame.drawCalls,
+          'uploadedBytes': frame.uploadedBytes,
+        },
+      });
+      GLProfiler.lastFrame = frame;
+      GLProfiler.lastFunctions = GLProfiler.functions;
+      GLProfiler.frame = GLProfiler.newFrame();
+      GLProfiler.functions = {};
+      GLProfiler.frameCount++;
+      GLProfiler.frameStart = now;
+    },
+
+    writeStats(stats, ptr) {
+      {{{ makeSetValue('ptr', C_STRUCTS.emscripten_gl_profile_t.time, 'stats.time', 'double') }}};
+      {{{ makeSetValue('ptr', C_STRUCTS.emscripten_gl_profile_t.calls, 'stats.calls', 'i32') }}};
+      {{{ makeSetValue('ptr', C_STRUCTS.emscripten_gl_profile_t.draw_calls, 'stats.drawCalls', 'i32') }}};
+      {{{ makeSetValue('ptr', C_STRUCTS.emscripten_gl_profile_t.uploaded_bytes, 'stats.uploadedBytes', 'i32') }}};
+    },
+
+    exportStats: (stats) => ({
+      'time': stats.time,
+      'calls': stats.calls,
+      'drawCalls': stats.drawCalls,
+      'uploadedBytes': stats.uploadedBytes,
+    }),
+
+    getProfile() {
+      var functions = {};
+      for (var name in GLProfiler.lastFunctions) {
+        functions[name] = GLProfiler.exportStats(GLProfiler.lastFunctions[name]);
+      }
+      return {
+        'frameCount': GLProfiler.frameCount,
+        'lastFrame': GLProfiler.lastFrame && GLProfiler.exportStats(GLProfiler.lastFrame),
+        'maxFrame': GLProfiler.maxFrame && GLProfiler.exportStats(GLProfiler.maxFrame),
+        'functions': functions,
+      };
+    },
+
+    getTrace: () => ({
+      'traceEvents': GLProfiler.traceEvents,
+      'displayTimeUnit': 'ms',
+      'otherData': { 'droppedEvents': GLProfiler.droppedTraceEvents },
+    }),
+  },
+#endif
+
+  emscripten_gl_profile_end_frame: () => {
+#if GL_PROFILE
+    GLProfiler.endFrame();
+#endif
+  },
+
+  emscripten_gl_profile_get_frame_count: () => {
+#if GL_PROFILE
+    return GLProfiler.frameCount;
+#else
+    return 0;
+#endif
+  },
+
+  emscripten_gl_profile_get_last_frame: (stats) => {
+#if GL_PROFILE
+    if (!GLProfiler.lastFrame) return -1;
+    GLProfiler.writeStats(GLProfiler.lastFrame, stats);
+    return 0;
+#else
+    return -1;
+#endif
+  },
+
+  emscripten_gl_profile_get_max_frame: (stats) => {
+#if GL_PROFILE
+    if (!GLProfiler.maxFrame) return -1;
+    GLProfiler.writeStats(GLProfiler.maxFrame, stats);
+    return 0;
+#else
+    return -1;
+#endif
+  },
+
+  emscripten_gl_profile_get_function: (name, stats) => {
+#if GL_PROFILE
+    if (!GLProfiler.lastFunctions) return -1;
+    var entry = GLProfiler.lastFunctions[UTF8ToString(name)];
+    GLProfiler.writeStats(entry || GLProfiler.newFrame(), stats);
+    return 0;
+#else
+    return -1;
+#endif
+  },
+
+#if GL_PROFILE
+  emscripten_gl_profile_get_trace__deps: ['$stringToNewUTF8'],
+#endif
+  emscripten_gl_profile_get_trace: () => {
+#if GL_PROFILE
+    return stringToNewUTF8(JSON.stringify(GLProfiler.getTrace()));
+#else
+    return 0;
+#endif
+  },
+});
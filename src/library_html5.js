@@ -2480,8 +2480,14 @@ var LibraryHTML5 = {
 
   emscripten_cancel_animation_frame: (id) => cancelAnimationFrame(id),
 
+#if GL_PROFILE
+  emscripten_request_animation_frame_loop__deps: ['$GLProfiler'],
+#endif
   emscripten_request_animation_frame_loop: (cb, userData) => {
     function tick(timeStamp) {
+#if GL_PROFILE
+      GLProfiler.endFrame();
+#endif
       if ({{{ makeDynCall('idp', 'cb') }}}(timeStamp, userData)) {
         requestAnimationFrame(tick);
       }
@@ -4,8 +4,10 @@
     makeImportExport: (snake_case, CamelCase) => {
       return `
 LibraryHTML5WebGPU.emscripten_webgpu_import_${snake_case}__deps = ['$WebGPU', '$JsValStore'];
+// Imported objects get an empty wrapper, for the types that keep state in it
+// (e.g. the mapping state of buffers).
 LibraryHTML5WebGPU.emscripten_webgpu_import_${snake_case} = (handle) =>
-  WebGPU.mgr${CamelCase}.create(JsValStore.get(handle));
+  WebGPU.mgr${CamelCase}.create(JsValStore.get(handle), {});
 
 LibraryHTML5WebGPU.emscripten_webgpu_export_${snake_case}__deps = ['$WebGPU', '$JsValStore'];
 LibraryHTML5WebGPU.emscripten_webgpu_export_${snake_case} = (handle) =>
@@ -23,9 +23,29 @@ addToLibrary({
     },
     DB_VERSION: 21,
     DB_STORE_NAME: 'FILE_DATA',
+    // Files larger than this are stored in chunks of this size, see
+    // storeRemoteEntry().
+    CHUNK_SIZE: 1024 * 1024,
     // reuse all of the core MEMFS functionality
-    mount: (...args) => MEMFS.mount(...args),
+    mount: (mount) => {
+      // MEMFS records the changes made to the mount here, see
+      // MEMFS.markChanged(). Until the mount has been synced in full once, the
+      // database may have entries that the mount does not, so the first sync
+      // compares the whole tree.
+      mount.changes = IDBFS.newChanges();
+      mount.synced = false;
+      return MEMFS.mount(mount);
+    },
+    newChanges: () => ({ nodes: new Map(), removed: new Set(), paused: false }),
     syncfs: (mount, populate, callback) => {
+      if (!populate && mount.synced) {
+        return IDBFS.syncChanges(mount, callback);
+      }
+
+      // Changes made while the sync is in progress are left for the next one.
+      mount.changes = IDBFS.newChanges();
+      mount.synced = false;
+
       IDBFS.getLocalSet(mount, (err, local) => {
         if (err) return callback(err);
 
@@ -35,10 +55,77 @@ addToLibrary({
           var src = populate ? remote : local;
           var dst = populate ? local : remote;
 
-          IDBFS.reconcile(src, dst, callback);
+          IDBFS.reconcile(src, dst, (err) => {
+            mount.synced = !err;
+            callback(err);
+          });
         });
       });
     },
+    // Writes the changes that were made to the mount since it was last synced
+    // to the database, without comparing the rest of the tree.
+    syncChanges: (mount, callback) => {
+      var changes = mount.changes;
+      if (!changes.nodes.size && !changes.removed.size) {
+        return callback(null);
+      }
+      mount.changes = IDBFS.newChanges();
+
+      var errored = false;
+      function done(err) {
+        if (err && !errored) {
+          errored = true;
+          // The changes are lost, so compare the whole tree next time.
+          mount.synced = false;
+          return callback(err);
+        }
+      };
+
+      IDBFS.getDB(mount.mountpoint, (err, db) => {
+        if (err) return done(err);
+
+        try {
+          var transaction = db.transaction([IDBFS.DB_STORE_NAME], 'readwrite');
+          var store = transaction.objectStore(IDBFS.DB_STORE_NAME);
+        } catch (e) {
+          return done(e);
+        }
+
+        transaction.onerror = transaction.onabort = (e) => {
+          done(e.target.error);
+          e.preventDefault();
+        };
+
+        transaction.oncomplete = (e) => {
+          if (!errored) {
+            callback(null);
+          }
+        };
+
+        // Requests run in the order they are made, so do the removals first,
+        // as the same path may have been created again since. A removed path
+        // can have been a directory that was moved elsewhere, along with
+        // everything in it.
+        for (var path of changes.removed) {
+          IDBFS.removeRemoteEntry(store, path, done);
+          IDBFS.removeRemoteTree(store, path);
+        }
+
+        for (var [node, range] of changes.nodes) {
+          // Nodes that were removed since they changed are not stored.
+          if (IDBFS.isLinked(node)) {
+            IDBFS.storeRemoteNode(store, node, range, done);
+          }
+        }
+      });
+    },
+    // Whether `node` is still part of the tree of its mount.
+    isLinked: (node) => {
+      for (; !FS.isRoot(node); node = node.parent) {
+        if (node.parent.contents[node.name] !== node) return false;
+      }
+      return true;
+    },
     quit: () => {
       Object.values(IDBFS.dbs).forEach((value) => value.close());
       IDBFS.dbs = {};
@@ -116,7 +203,7 @@ addToLibrary({
         entries[path] = { 'timestamp': stat.mtime };
       }
 
-      return callback(null, { type: 'local', entries: entries });
+      return callback(null, { type: 'local', mount, entries });
     },
     getRemoteSet: (mount, callback) => {
       var entries = {};
@@ -172,6 +259,45 @@ addToLibrary({
         return callback(new Error('node type not supported'));
       }
     },
+    // Stores a changed node of a mount that is otherwise in sync with the
+    // database. For large files, only the chunks in the changed range of
+    // bytes are written, if the database already has the file in chunks.
+    storeRemoteNode: (store, node, range, callback) => {
+      var path = FS.getPath(node);
+      var stat = node.node_ops.getattr(node);
+      if (FS.isDir(stat.mode)) {
+        return IDBFS.storeRemoteEntry(store, path, { 'timestamp': stat.mtime, 'mode': stat.mode }, callback);
+      } else if (!FS.isFile(stat.mode)) {
+        return callback(new Error('node type not supported'));
+      }
+
+      node.contents = MEMFS.getFileDataAsTypedArray(node);
+      var entry = { 'timestamp': stat.mtime, 'mode': stat.mode, 'contents': node.contents };
+      if (node.contents.length <= IDBFS.CHUNK_SIZE || range.end === Infinity) {
+        return IDBFS.storeRemoteEntry(store, path, entry, callback);
+      }
+
+      var req = store.get(path);
+      req.onsuccess = (event) => {
+        var stored = event.target.result;
+        if (stored?.['chunkSize'] !== IDBFS.CHUNK_SIZE) {
+          return IDBFS.storeRemoteEntry(store, path, entry, callback);
+        }
+        var chunks = Math.ceil(node.contents.length / IDBFS.CHUNK_SIZE);
+        var first = Math.floor(range.start / IDBFS.CHUNK_SIZE);
+        var last = Math.min(Math.ceil(range.end / IDBFS.CHUNK_SIZE), chunks);
+        try {
+          IDBFS.storeRemoteChunks(store, path, node.contents, first, last);
+        } catch (e) {
+          return callback(e);
+        }
+        IDBFS.storeRemoteEntry(store, path, entry, callback, /*storeChunks=*/false);
+      };
+      req.onerror = (e) => {
+        callback(e.target.error);
+        e.preventDefault();
+      };
+    },
     storeLocalEntry: (path, entry, callback) => {
       try {
         if (FS.isDir(entry['mode'])) {
@@ -190,6 +316,14 @@ addToLibrary({
 
       callback(null);
     },
+    withoutChanges: (mount, func) => {
+      mount.changes.paused = true;
+      try {
+        func();
+      } finally {
+        mount.changes.paused = false;
+      }
+    },
     removeLocalEntry: (path, callback) => {
       try {
         var stat = FS.stat(path);
@@ -207,14 +341,55 @@ addToLibrary({
     },
     loadRemoteEntry: (store, path, callback) => {
       var req = store.get(path);
-      req.onsuccess = (event) => callback(null, event.target.result);
+      req.onsuccess = (event) => {
+        var entry = event.target.result;
+        if (!entry['chunkSize']) {
+          return callback(null, entry);
+        }
+        var chunksReq = store.getAll(IDBFS.chunkRange(path, 0));
+        chunksReq.onsuccess = (event) => {
+          var contents = new Uint8Array(entry['size']);
+          var offset = 0;
+          for (var chunk of event.target.result) {
+            contents.set(chunk, offset);
+            offset += chunk.length;
+          }
+          callback(null, { 'timestamp': entry['timestamp'], 'mode': entry['mode'], 'contents': contents });
+        };
+        chunksReq.onerror = req.onerror;
+      };
       req.onerror = (e) => {
         callback(e.target.error);
         e.preventDefault();
       };
     },
-    storeRemoteEntry: (store, path, entry, callback) => {
+    // The keys of the chunks of the file at `path`, from chunk `first` on.
+    chunkRange: (path, first) => IDBKeyRange.bound([path, first], [path, Infinity]),
+    storeRemoteChunks: (store, path, contents, first, last) => {
+      for (var i = first; i < last; i++) {
+        // Copy the chunk, as storing a view stores its whole buffer.
+        store.put(contents.slice(i * IDBFS.CHUNK_SIZE, (i + 1) * IDBFS.CHUNK_SIZE), [path, i]);
+      }
+    },
+    // Files larger than CHUNK_SIZE are stored as an entry with their size
+    // instead of their contents, and the contents in chunks keyed by
+    // [path, index], so that changing part of a large file only rewrites the
+    // chunks it changed, see storeRemoteNode(). The chunks have no timestamp,
+    // so they are not in the timestamp index that getRemoteSet() reads.
+    storeRemoteEntry: (store, path, entry, callback, storeChunks = true) => {
       try {
+        var contents = entry['contents'];
+        var chunks = 0;
+        if (contents && contents.length > IDBFS.CHUNK_SIZE) {
+          chunks = Math.ceil(contents.length / IDBFS.CHUNK_SIZE);
+          if (storeChunks) {
+            IDBFS.storeRemoteChunks(store, path, contents, 0, chunks);
+          }
+          entry = { 'timestamp': entry['timestamp'], 'mode': entry['mode'], 'size': contents.length, 'chunkSize': IDBFS.CHUNK_SIZE };
+        }
+        if (FS.isFile(entry['mode'])) {
+          store.delete(IDBFS.chunkRange(path, chunks));
+        }
         var req = store.put(entry, path);
       } catch (e) {
         callback(e);
@@ -227,6 +402,7 @@ addToLibrary({
       };
     },
     removeRemoteEntry: (store, path, callback) => {
+      store.delete(IDBFS.chunkRange(path, 0));
       var req = store.delete(path);
       req.onsuccess = (event) => callback();
       req.onerror = (e) => {
@@ -234,6 +410,11 @@ addToLibrary({
         e.preventDefault();
       };
     },
+    // Removes the entries of everything below the directory at `path`.
+    removeRemoteTree: (store, path) => {
+      store.delete(IDBKeyRange.bound(path + '/', path + '/\uffff'));
+      store.delete(IDBKeyRange.bound([path + '/'], [path + '/\uffff']));
+    },
     reconcile: (src, dst, callback) => {
       var total = 0;
 
@@ -289,7 +470,9 @@ addToLibrary({
         if (dst.type === 'local') {
           IDBFS.loadRemoteEntry(store, path, (err, entry) => {
             if (err) return done(err);
-            IDBFS.storeLocalEntry(path, entry, done);
+            // The mount is being brought in sync with the database, so this is
+            // not a change to be written back to it.
+            IDBFS.withoutChanges(dst.mount, () => IDBFS.storeLocalEntry(path, entry, done));
           });
         } else {
           IDBFS.loadLocalEntry(path, (err, entry) => {
@@ -303,7 +486,7 @@ addToLibrary({
       // parent directories
       remove.sort().reverse().forEach((path) => {
         if (dst.type === 'local') {
-          IDBFS.removeLocalEntry(path, done);
+          IDBFS.withoutChanges(dst.mount, () => IDBFS.removeLocalEntry(path, done));
         } else {
           IDBFS.removeRemoteEntry(store, path, done);
         }
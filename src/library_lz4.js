@@ -11,7 +11,14 @@ addToLibrary({
     DIR_MODE: {{{ cDefs.S_IFDIR }}} | 511 /* 0777 */,
     FILE_MODE: {{{ cDefs.S_IFREG }}} | 511 /* 0777 */,
     CHUNK_SIZE: -1,
+    // The MiniLZ4 codec from third_party/mini-lz4.js, loaded on first use.
     codec: null,
+    // Decompressed chunks of all packages, in the order they were last used,
+    // see getChunk(). The chunks of a package have the keys from its
+    // firstChunk on.
+    cache: new Map(),
+    cacheBytes: 0,
+    nextChunk: 0,
     init() {
       if (LZ4.codec) return;
       LZ4.codec = (function() {
@@ -24,13 +31,10 @@ addToLibrary({
       LZ4.init();
       var compressedData = pack['compressedData'];
       if (!compressedData) compressedData = LZ4.codec.compressPackage(pack['data']);
-      assert(compressedData['cachedIndexes'].length === compressedData['cachedChunks'].length);
-      for (var i = 0; i < compressedData['cachedIndexes'].length; i++) {
-        compressedData['cachedIndexes'][i] = -1;
-        compressedData['cachedChunks'][i] = compressedData['data'].subarray(compressedData['cachedOffset'] + i*LZ4.CHUNK_SIZE,
-                                                                      compressedData['cachedOffset'] + (i+1)*LZ4.CHUNK_SIZE);
-        assert(compressedData['cachedChunks'][i].length === LZ4.CHUNK_SIZE);
-      }
+      // Packages from older file packagers do not record their chunk size.
+      compressedData['chunkSize'] ||= LZ4.CHUNK_SIZE;
+      compressedData.firstChunk = LZ4.nextChunk;
+      LZ4.nextChunk += compressedData['offsets'].length;
       pack['metadata'].files.forEach((file) => {
         var dir = PATH.dirname(file.filename);
         var name = PATH.basename(file.filename);
@@ -58,14 +62,162 @@ addToLibrary({
               var dep = getUniqueRunDependency('fp ' + fullname);
               addRunDependency(dep);
               var finish = () => removeRunDependency(dep);
+#if LZ4_WORKERS
+              LZ4.readFileInWorkers(fullname, (byteArray) => plugin['handle'](byteArray, fullname, finish, finish));
+#else
               var byteArray = FS.readFile(fullname);
               plugin['handle'](byteArray, fullname, finish, finish);
+#endif
               handled = true;
             }
           });
         });
       }
     },
+    // Returns the decompressed data of a chunk of a package. Decompressed
+    // chunks are cached, up to LZ4_CACHE_SIZE bytes in total.
+    getChunk(compressedData, chunkIndex) {
+      if (!compressedData['successes'][chunkIndex]) {
+        // uncompressed
+        var start = compressedData['offsets'][chunkIndex];
+        return compressedData['data'].subarray(start, start + compressedData['chunkSize']);
+      }
+      var key = compressedData.firstChunk + chunkIndex;
+      var chunk = LZ4.cache.get(key);
+      if (chunk) {
+        // Move the chunk to the end, as the most recently used.
+        LZ4.cache.delete(key);
+        LZ4.cache.set(key, chunk);
+        return chunk;
+      }
+      if (compressedData['debug']) {
+        out('decompressing chunk ' + chunkIndex);
+        Module['decompressedChunks'] = (Module['decompressedChunks'] || 0) + 1;
+      }
+      chunk = LZ4.decompressChunk(compressedData, chunkIndex);
+      LZ4.addToCache(key, chunk);
+#if LZ4_WORKERS
+      LZ4.readAhead(compressedData, chunkIndex + 1);
+#endif
+      return chunk;
+    },
+    decompressChunk(compressedData, chunkIndex) {
+      var chunkSize = compressedData['chunkSize'];
+      var start = compressedData['offsets'][chunkIndex];
+      var compressed = compressedData['data'].subarray(start, start + compressedData['sizes'][chunkIndex]);
+      var chunk = new Uint8Array(chunkSize);
+      var originalSize = LZ4.codec.uncompress(compressed, chunk);
+      if (chunkIndex < compressedData['successes'].length-1) assert(originalSize === chunkSize); // all but the last chunk must be full-size
+      return chunk;
+    },
+    addToCache(key, chunk) {
+      LZ4.cache.set(key, chunk);
+      LZ4.cacheBytes += chunk.length;
+      // Drop the least recently used chunks, but always keep the new one.
+      for (var [oldKey, oldChunk] of LZ4.cache) {
+        if (LZ4.cacheBytes <= {{{ LZ4_CACHE_SIZE }}} || oldKey === key) break;
+        LZ4.cache.delete(oldKey);
+        LZ4.cacheBytes -= oldChunk.length;
+      }
+    },
+    isCached: (compressedData, chunkIndex) => LZ4.cache.has(compressedData.firstChunk + chunkIndex),
+#if LZ4_WORKERS
+    workers: [],
+    nextWorker: 0,
+    // Callbacks waiting for chunks that workers are decompressing, by key.
+    pending: new Map(),
+    startWorkers() {
+      if (LZ4.workers.length) return true;
+      if (typeof Worker == 'undefined') return false;
+      var source = 'var assert = (x, message) => { if (!x) throw new Error(message) };\n' +
+        {{{ JSON.stringify(read('../third_party/mini-lz4.js')) }}} + `
+        onmessage = (e) => {
+          var [key, compressed, chunkSize] = e.data;
+          var chunk = new Uint8Array(chunkSize);
+          try {
+            MiniLZ4.uncompress(compressed, chunk);
+          } catch (e) {
+            chunk = null;
+          }
+          postMessage([key, chunk], chunk ? [chunk.buffer] : []);
+        };`;
+      var url = URL.createObjectURL(new Blob([source], { type: 'text/javascript' }));
+      for (var i = 0; i < {{{ LZ4_WORKERS }}}; i++) {
+        var worker = new Worker(url);
+        worker.onmessage = (e) => {
+          var [key, chunk] = e.data;
+          var callbacks = LZ4.pending.get(key);
+          LZ4.pending.delete(key);
+          callbacks.forEach((callback) => callback(chunk));
+        };
+        LZ4.workers.push(worker);
+      }
+      URL.revokeObjectURL(url);
+      return true;
+    },
+    // Decompresses a chunk in a worker, and calls `callback` with the
+    // decompressed data, or null if decompressing failed.
+    decompressInWorker(compressedData, chunkIndex, callback) {
+      var key = compressedData.firstChunk + chunkIndex;
+      var callbacks = LZ4.pending.get(key);
+      if (callbacks) {
+        callbacks.push(callback);
+        return;
+      }
+      LZ4.pending.set(key, [callback]);
+      var start = compressedData['offsets'][chunkIndex];
+      // Copy the compressed chunk, so that its buffer can be transferred.
+      var compressed = compressedData['data'].slice(start, start + compressedData['sizes'][chunkIndex]);
+      var worker = LZ4.workers[LZ4.nextWorker++ % LZ4.workers.length];
+      worker.postMessage([key, compressed, compressedData['chunkSize']], [compressed.buffer]);
+    },
+    // Decompresses the chunks from `first` on into the cache in the workers,
+    // so that reads that go on past the chunk they are in find them there.
+    // How far ahead is limited by the number of workers and the cache size.
+    readAhead(compressedData, first) {
+      if (!LZ4.startWorkers()) return;
+      var count = Math.min({{{ LZ4_WORKERS * 4 }}}, Math.floor({{{ LZ4_CACHE_SIZE }}} / 2 / compressedData['chunkSize']));
+      var end = Math.min(first + count, compressedData['offsets'].length);
+      for (let i = first; i < end; i++) {
+        let key = compressedData.firstChunk + i;
+        if (!compressedData['successes'][i] || LZ4.cache.has(key) || LZ4.pending.has(key)) continue;
+        LZ4.decompressInWorker(compressedData, i, (chunk) => {
+          if (chunk && !LZ4.cache.has(key)) LZ4.addToCache(key, chunk);
+        });
+      }
+    },
+    // Reads the whole of a file, with its chunks decompressed by all the
+    // workers in parallel.
+    readFileInWorkers(path, callback) {
+      if (!LZ4.startWorkers()) {
+        return callback(FS.readFile(path));
+      }
+      var node = FS.lookupPath(path).node;
+      var compressedData = node.contents.compressedData;
+      var chunkSize = compressedData['chunkSize'];
+      var start = node.contents.start;
+      var end = node.contents.end;
+      var result = new Uint8Array(end - start);
+      var remaining = 1;
+      var copyChunk = (chunkIndex, chunk) => {
+        var chunkStart = chunkIndex * chunkSize;
+        var from = Math.max(start, chunkStart);
+        var to = Math.min(end, chunkStart + chunkSize);
+        result.set(chunk.subarray(from - chunkStart, to - chunkStart), from - start);
+        if (--remaining == 0) callback(result);
+      };
+      for (let i = Math.floor(start / chunkSize); i * chunkSize < end; i++) {
+        remaining++;
+        if (!compressedData['successes'][i] || LZ4.isCached(compressedData, i)) {
+          copyChunk(i, LZ4.getChunk(compressedData, i));
+        } else {
+          LZ4.decompressInWorker(compressedData, i, (chunk) => copyChunk(i, chunk || LZ4.decompressChunk(compressedData, i)));
+        }
+      }
+      // Finish once all chunks are copied, including when none needed workers.
+      if (--remaining == 0) callback(result);
+    },
+#endif
     createNode(parent, name, mode, dev, contents, mtime) {
       var node = FS.createNode(parent, name, mode);
       node.mode = mode;
@@ -140,41 +292,16 @@ addToLibrary({
         if (length <= 0) return 0;
         var contents = stream.node.contents;
         var compressedData = contents.compressedData;
+        var chunkSize = compressedData['chunkSize'];
         var written = 0;
         while (written < length) {
           var start = contents.start + position + written; // start index in uncompressed data
           var desired = length - written;
           //out('current read: ' + ['start', start, 'desired', desired]);
-          var chunkIndex = Math.floor(start / LZ4.CHUNK_SIZE);
-          var compressedStart = compressedData['offsets'][chunkIndex];
-          var compressedSize = compressedData['sizes'][chunkIndex];
-          var currChunk;
-          if (compressedData['successes'][chunkIndex]) {
-            var found = compressedData['cachedIndexes'].indexOf(chunkIndex);
-            if (found >= 0) {
-              currChunk = compressedData['cachedChunks'][found];
-            } else {
-              // decompress the chunk
-              compressedData['cachedIndexes'].pop();
-              compressedData['cachedIndexes'].unshift(chunkIndex);
-              currChunk = compressedData['cachedChunks'].pop();
-              compressedData['cachedChunks'].unshift(currChunk);
-              if (compressedData['debug']) {
-                out('decompressing chunk ' + chunkIndex);
-                Module['decompressedChunks'] = (Module['decompressedChunks'] || 0) + 1;
-              }
-              var compressed = compressedData['data'].subarray(compressedStart, compressedStart + compressedSize);
-              //var t = Date.now();
-              var originalSize = LZ4.codec.uncompress(compressed, currChunk);
-              //out('decompress time: ' + (Date.now() - t));
-              if (chunkIndex < compressedData['successes'].length-1) assert(originalSize === LZ4.CHUNK_SIZE); // all but the last chunk must be full-size
-            }
-          } else {
-            // uncompressed
-            currChunk = compressedData['data'].subarray(compressedStart, compressedStart + LZ4.CHUNK_SIZE);
-          }
-          var startInChunk = start % LZ4.CHUNK_SIZE;
-          var endInChunk = Math.min(startInChunk + desired, LZ4.CHUNK_SIZE);
+          var chunkIndex = Math.floor(start / chunkSize);
+          var currChunk = LZ4.getChunk(compressedData, chunkIndex);
+          var startInChunk = start % chunkSize;
+          var endInChunk = Math.min(startInChunk + desired, chunkSize);
           buffer.set(currChunk.subarray(startInChunk, endInChunk), offset + written);
           var currWritten = endInChunk - startInChunk;
           written += currWritten;
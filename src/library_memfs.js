@@ -5,7 +5,11 @@
  */
 
 addToLibrary({
-  $MEMFS__deps: ['$FS', '$mmapAlloc'],
+  $MEMFS__deps: ['$FS', '$mmapAlloc',
+#if LibraryManager.has('library_idbfs.js')
+    '$PATH',
+#endif
+  ],
   $MEMFS: {
     ops_table: null,
     mount(mount) {
@@ -88,10 +92,48 @@ addToLibrary({
       if (parent) {
         parent.contents[name] = node;
         parent.timestamp = node.timestamp;
+#if LibraryManager.has('library_idbfs.js')
+        MEMFS.markChanged(node);
+        MEMFS.markChanged(parent);
+#endif
       }
       return node;
     },
 
+#if LibraryManager.has('library_idbfs.js')
+    // IDBFS mounts keep track of the nodes that changed since they were last
+    // synced, in mount.changes, so that syncing them does not have to compare
+    // the whole tree. For files, [start, end) is the range of bytes that
+    // changed, if any.
+    markChanged(node, start = 0, end = 0) {
+      var changes = node.mount.changes;
+      if (!changes || changes.paused || FS.isRoot(node)) return;
+      var range = changes.nodes.get(node);
+      if (!range) {
+        changes.nodes.set(node, { start, end });
+      } else if (start < end) {
+        range.start = range.start < range.end ? Math.min(range.start, start) : start;
+        range.end = Math.max(range.end, end);
+      }
+    },
+    // Marks a node and everything below it as changed in full, as when it was
+    // moved to a different path.
+    markTreeChanged(node) {
+      MEMFS.markChanged(node, 0, Infinity);
+      if (FS.isDir(node.mode)) {
+        for (var name in node.contents) {
+          MEMFS.markTreeChanged(node.contents[name]);
+        }
+      }
+    },
+    markRemoved(parent, name) {
+      var changes = parent.mount.changes;
+      if (!changes || changes.paused) return;
+      changes.removed.add(PATH.join2(FS.getPath(parent), name));
+      MEMFS.markChanged(parent);
+    },
+#endif
+
     // Given a file node, returns its file data converted to a typed array.
     getFileDataAsTypedArray(node) {
       if (!node.contents) return new Uint8Array(0);
@@ -162,6 +204,13 @@ addToLibrary({
         return attr;
       },
       setattr(node, attr) {
+#if LibraryManager.has('library_idbfs.js')
+        if (attr.size !== undefined) {
+          MEMFS.markChanged(node, Math.min(attr.size, node.usedBytes), Math.max(attr.size, node.usedBytes));
+        } else {
+          MEMFS.markChanged(node);
+        }
+#endif
         if (attr.mode !== undefined) {
           node.mode = attr.mode;
         }
@@ -192,6 +241,9 @@ addToLibrary({
             }
           }
         }
+#if LibraryManager.has('library_idbfs.js')
+        MEMFS.markRemoved(old_node.parent, old_node.name);
+#endif
         // do the internal rewiring
         delete old_node.parent.contents[old_node.name];
         old_node.parent.timestamp = Date.now()
@@ -199,8 +251,15 @@ addToLibrary({
         new_dir.contents[new_name] = old_node;
         new_dir.timestamp = old_node.parent.timestamp;
         old_node.parent = new_dir;
+#if LibraryManager.has('library_idbfs.js')
+        MEMFS.markChanged(new_dir);
+        MEMFS.markTreeChanged(old_node);
+#endif
       },
       unlink(parent, name) {
+#if LibraryManager.has('library_idbfs.js')
+        MEMFS.markRemoved(parent, name);
+#endif
         delete parent.contents[name];
         parent.timestamp = Date.now();
       },
@@ -209,6 +268,9 @@ addToLibrary({
         for (var i in node.contents) {
           throw new FS.ErrnoError({{{ cDefs.ENOTEMPTY }}});
         }
+#if LibraryManager.has('library_idbfs.js')
+        MEMFS.markRemoved(parent, name);
+#endif
         delete parent.contents[name];
         parent.timestamp = Date.now();
       },
@@ -271,6 +333,10 @@ addToLibrary({
         if (!length) return 0;
         var node = stream.node;
         node.timestamp = Date.now();
+#if LibraryManager.has('library_idbfs.js')
+        // Writing past the end of the file also fills the gap before it.
+        MEMFS.markChanged(node, Math.min(position, node.usedBytes), position + length);
+#endif
 
         if (buffer.subarray && (!node.contents || node.contents.subarray)) { // This write is from a typed array to a typed array?
           if (canOwn) {
@@ -319,6 +385,11 @@ addToLibrary({
         return position;
       },
       allocate(stream, offset, length) {
+#if LibraryManager.has('library_idbfs.js')
+        if (offset + length > stream.node.usedBytes) {
+          MEMFS.markChanged(stream.node, stream.node.usedBytes, offset + length);
+        }
+#endif
         MEMFS.expandFileStorage(stream.node, offset + length);
         stream.node.usedBytes = Math.max(stream.node.usedBytes, offset + length);
       },
@@ -960,7 +960,7 @@ var LibraryPThread = {
   $proxyToMainThreadPtr: (...args) => BigInt(proxyToMainThread(...args)),
 #endif
 
-  $proxyToMainThread__deps: ['$withStackSave', '_emscripten_run_on_main_thread_js'].concat(i53ConversionDeps),
+  $proxyToMainThread__deps: ['stackSave', 'stackAlloc', 'stackRestore', '_emscripten_run_on_main_thread_js', '_emscripten_proxy_slot_acquire', '_emscripten_proxy_slot_run'].concat(i53ConversionDeps),
   $proxyToMainThread__docs: '/** @type{function(number, (number|boolean), ...number)} */',
   $proxyToMainThread: (funcIndex, emAsmAddr, sync, ...callArgs) => {
     // EM_ASM proxying is done by passing a pointer to the address of the EM_ASM
@@ -972,35 +972,71 @@ var LibraryPThread = {
     // The serialization buffer contains the number of call params, and then
     // all the args here.
     // We also pass 'sync' to C separately, since C needs to look at it.
-    // Allocate a buffer, which will be copied by the C code.
-    return withStackSave(() => {
-      // First passed parameter specifies the number of arguments to the function.
-      // When BigInt support is enabled, we must handle types in a more complex
-      // way, detecting at runtime if a value is a BigInt or not (as we have no
-      // type info here). To do that, add a "prefix" before each value that
-      // indicates if it is a BigInt, which effectively doubles the number of
-      // values we serialize for proxying. TODO: pack this?
-      var serializedNumCallArgs = callArgs.length {{{ WASM_BIGINT ? "* 2" : "" }}};
-      var args = stackAlloc(serializedNumCallArgs * 8);
-      var b = {{{ getHeapOffset('args', 'i64') }}};
-      for (var i = 0; i < callArgs.length; i++) {
-        var arg = callArgs[i];
+    // When BigInt support is enabled, we must handle types in a more complex
+    // way, detecting at runtime if a value is a BigInt or not (as we have no
+    // type info here). To do that, add a "prefix" before each value that
+    // indicates if it is a BigInt, which effectively doubles the number of
+    // values we serialize for proxying. TODO: pack this?
+    var serializedNumCallArgs = callArgs.length {{{ WASM_BIGINT ? "* 2" : "" }}};
+    // Synchronous calls write their arguments straight into the calling
+    // thread's proxy slot. The slot is only unavailable for nested proxied
+    // calls, or calls with a very large number of arguments. Otherwise
+    // allocate a buffer on the stack, which will be copied by the C code if
+    // needed.
+    var args = sync && __emscripten_proxy_slot_acquire(serializedNumCallArgs);
+    var sp = 0;
+    if (!args) {
+      sp = stackSave();
+      args = stackAlloc(serializedNumCallArgs * 8);
+    }
+    var b = {{{ getHeapOffset('args', 'i64') }}};
+    for (var i = 0; i < callArgs.length; i++) {
+      var arg = callArgs[i];
 #if WASM_BIGINT
-        if (typeof arg == 'bigint') {
-          // The prefix is non-zero to indicate a bigint.
-          HEAP64[b + 2*i] = 1n;
-          HEAP64[b + 2*i + 1] = arg;
-        } else {
-          // The prefix is zero to indicate a JS Number.
-          HEAP64[b + 2*i] = 0n;
-          HEAPF64[b + 2*i + 1] = arg;
-        }
+      if (typeof arg == 'bigint') {
+        // The prefix is non-zero to indicate a bigint.
+        HEAP64[b + 2*i] = 1n;
+        HEAP64[b + 2*i + 1] = arg;
+      } else {
+        // The prefix is zero to indicate a JS Number.
+        HEAP64[b + 2*i] = 0n;
+        HEAPF64[b + 2*i + 1] = arg;
+      }
 #else
-        HEAPF64[b + i] = arg;
+      HEAPF64[b + i] = arg;
 #endif
-      }
-      return __emscripten_run_on_main_thread_js(funcIndex, emAsmAddr, serializedNumCallArgs, args, sync);
-    });
+    }
+    if (!sp) {
+      return __emscripten_proxy_slot_run(funcIndex, emAsmAddr, serializedNumCallArgs, 0);
+    }
+    var rtn = __emscripten_run_on_main_thread_js(funcIndex, emAsmAddr, serializedNumCallArgs, args, sync);
+    stackRestore(sp);
+    return rtn;
+  },
+
+  // Fast path for synchronously proxied JS library functions that take at most
+  // six arguments, none of which can be a BigInt according to the signature of
+  // the function. That covers nearly all of the syscalls. The jsifier emits
+  // calls to this function instead of proxyToMainThread for such functions.
+  // The arguments are written to the proxy slot of the calling thread as plain
+  // doubles, without the rest parameter array or BigInt tagging of the generic
+  // path, and are read back on the main thread by
+  // _emscripten_receive_numbers_on_main_thread_js.
+  $proxyToMainThreadFast__deps: ['$proxyToMainThread', '_emscripten_proxy_slot_acquire', '_emscripten_proxy_slot_run'],
+  $proxyToMainThreadFast: (funcIndex, numCallArgs, a0, a1, a2, a3, a4, a5) => {
+    var args = __emscripten_proxy_slot_acquire(numCallArgs);
+    if (!args) {
+      // The slot is in use by a proxied call further up the stack.
+      return proxyToMainThread(funcIndex, 0, 1, ...[a0, a1, a2, a3, a4, a5].slice(0, numCallArgs));
+    }
+    var b = {{{ getHeapOffset('args', 'double') }}};
+    HEAPF64[b] = a0;
+    HEAPF64[b + 1] = a1;
+    HEAPF64[b + 2] = a2;
+    HEAPF64[b + 3] = a3;
+    HEAPF64[b + 4] = a4;
+    HEAPF64[b + 5] = a5;
+    return __emscripten_proxy_slot_run(funcIndex, 0, numCallArgs, 1);
   },
 
   // Reuse global JS array to avoid creating JS garbage for each proxied call
@@ -1064,6 +1100,21 @@ var LibraryPThread = {
     return rtn;
   },
 
+  _emscripten_receive_numbers_on_main_thread_js__deps: ['$PThread'],
+  _emscripten_receive_numbers_on_main_thread_js: (funcIndex, callingThread, numCallArgs, args) => {
+    var func = proxiedFunctionTable[funcIndex];
+#if ASSERTIONS
+    assert(func.length == numCallArgs, 'Call args mismatch in _emscripten_receive_numbers_on_main_thread_js');
+#endif
+    var b = {{{ getHeapOffset('args', 'double') }}};
+    PThread.currentProxiedOperationCallerThread = callingThread;
+    // Unused trailing slots are ignored by the callee since func.length ==
+    // numCallArgs.
+    var rtn = func(HEAPF64[b], HEAPF64[b + 1], HEAPF64[b + 2], HEAPF64[b + 3], HEAPF64[b + 4], HEAPF64[b + 5]);
+    PThread.currentProxiedOperationCallerThread = 0;
+    return rtn;
+  },
+
   $establishStackSpace__internal: true,
   $establishStackSpace__deps: ['stackRestore'],
   $establishStackSpace: () => {
@@ -268,9 +268,11 @@ sigs = {
   __syscall_poll__sig: 'ipii',
   __syscall_readlinkat__sig: 'iippp',
   __syscall_recvfrom__sig: 'iippipp',
+  __syscall_recvmmsg__sig: 'iippip',
   __syscall_recvmsg__sig: 'iipiiii',
   __syscall_renameat__sig: 'iipip',
   __syscall_rmdir__sig: 'ip',
+  __syscall_sendmmsg__sig: 'iippi',
   __syscall_sendmsg__sig: 'iipippi',
   __syscall_sendto__sig: 'iippipp',
   __syscall_shutdown__sig: 'iiiiiii',
@@ -321,6 +323,8 @@ sigs = {
   _emscripten_fetch_free__sig: 'vi',
   _emscripten_fetch_get_response_headers__sig: 'pipp',
   _emscripten_fetch_get_response_headers_length__sig: 'pi',
+  _emscripten_fetch_get_stats__sig: 'vp',
+  _emscripten_fetch_set_paused__sig: 'iii',
   _emscripten_fs_load_embedded_files__sig: 'vp',
   _emscripten_get_now_is_monotonic__sig: 'i',
   _emscripten_get_progname__sig: 'vpi',
@@ -328,6 +332,7 @@ sigs = {
   _emscripten_notify_mailbox_postmessage__sig: 'vppp',
   _emscripten_push_main_loop_blocker__sig: 'vppp',
   _emscripten_push_uncounted_main_loop_blocker__sig: 'vppp',
+  _emscripten_receive_numbers_on_main_thread_js__sig: 'dipip',
   _emscripten_receive_on_main_thread_js__sig: 'dippip',
   _emscripten_runtime_keepalive_clear__sig: 'v',
   _emscripten_set_offscreencanvas_size__sig: 'ipii',
@@ -606,6 +611,7 @@ sigs = {
   emscripten_console_log__sig: 'vp',
   emscripten_console_warn__sig: 'vp',
   emscripten_create_audio_context__sig: 'ip',
+  emscripten_create_audio_ring_worklet_node__sig: 'iippp',
   emscripten_create_wasm_audio_worklet_node__sig: 'iipppp',
   emscripten_create_wasm_audio_worklet_processor_async__sig: 'vippp',
   emscripten_create_worker__sig: 'ip',
@@ -625,6 +631,8 @@ sigs = {
   emscripten_exit_pointerlock__sig: 'i',
   emscripten_exit_soft_fullscreen__sig: 'i',
   emscripten_exit_with_live_runtime__sig: 'v',
+  emscripten_fetch_set_deduplication__sig: 'vi',
+  emscripten_fetch_set_max_concurrent_per_origin__sig: 'vi',
   emscripten_fiber_swap__sig: 'vpp',
   emscripten_force_exit__sig: 'vi',
   emscripten_get_battery_status__sig: 'ip',
@@ -654,6 +662,12 @@ sigs = {
   emscripten_get_visibility_status__sig: 'ip',
   emscripten_get_window_title__sig: 'p',
   emscripten_get_worker_queue_size__sig: 'ii',
+  emscripten_gl_profile_end_frame__sig: 'v',
+  emscripten_gl_profile_get_frame_count__sig: 'i',
+  emscripten_gl_profile_get_function__sig: 'ipp',
+  emscripten_gl_profile_get_last_frame__sig: 'ip',
+  emscripten_gl_profile_get_max_frame__sig: 'ip',
+  emscripten_gl_profile_get_trace__sig: 'p',
   emscripten_has_asyncify__sig: 'i',
   emscripten_has_threading_support__sig: 'i',
   emscripten_hide_mouse__sig: 'v',
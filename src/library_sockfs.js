@@ -8,7 +8,120 @@ addToLibrary({
   $SOCKFS__postset: () => {
     addAtInit('SOCKFS.root = FS.mount(SOCKFS, {}, null);');
   },
-  $SOCKFS__deps: ['$FS'],
+  // Receive queue of a socket. Incoming messages are copied into a single
+  // growable byte ring, so that recv() can copy them out to the Wasm heap in
+  // bulk, without keeping a typed array alive per message or shifting arrays
+  // around. For datagram sockets, the length and source address of each
+  // message are kept in a parallel ring of records, so that message boundaries
+  // are preserved. Stream sockets only ever receive from a single peer, and
+  // reads may span the data of several messages, as with TCP.
+  $SockRecvQueue: class {
+    constructor(datagram) {
+      this.datagram = datagram;
+      // Both rings have a power of two capacity, and grow when full.
+      this.buf = new Uint8Array(4096);
+      // Offset of the first unread byte in buf, and the number of unread bytes.
+      this.head = 0;
+      this.bytes = 0;
+      this.lens = new Int32Array(64);
+      this.ports = new Int32Array(64);
+      this.addrs = new Array(64);
+      // Index of the first unread record, and the number of unread records.
+      this.first = 0;
+      this.count = 0;
+      // Source of the message that is currently being received.
+      this.addr = undefined;
+      this.port = undefined;
+      // Set when the rest of a datagram had to be discarded because the
+      // receive buffer was too small.
+      this.truncated = false;
+    }
+    // Whether there is nothing to receive. This differs from available()
+    // returning 0 for datagram sockets, where an empty datagram is still a
+    // message that needs to be received.
+    empty() {
+      return this.datagram ? !this.count : !this.bytes;
+    }
+    // Number of bytes that a single receive call can return: the size of the
+    // next datagram, or all buffered data for stream sockets.
+    available() {
+      if (!this.datagram) return this.bytes;
+      if (!this.count) return 0;
+      this.addr = this.addrs[this.first];
+      this.port = this.ports[this.first];
+      return this.lens[this.first];
+    }
+    push(data, addr, port) {
+      var len = data.length;
+      if (this.bytes + len > this.buf.length) {
+        var cap = this.buf.length * 2;
+        while (cap < this.bytes + len) cap *= 2;
+        var buf = new Uint8Array(cap);
+        this.copy(buf, 0, this.bytes);
+        this.buf = buf;
+        this.head = 0;
+      }
+      var cap = this.buf.length,
+        tail = (this.head + this.bytes) & (cap - 1),
+        first = Math.min(len, cap - tail);
+      this.buf.set(first < len ? data.subarray(0, first) : data, tail);
+      if (first < len) this.buf.set(data.subarray(first), 0);
+      this.bytes += len;
+
+      if (!this.datagram) {
+        this.addr = addr;
+        this.port = port;
+        return;
+      }
+      if (this.count == this.lens.length) {
+        var n = this.count, lens = new Int32Array(n * 2), ports = new Int32Array(n * 2), addrs = new Array(n * 2);
+        for (var i = 0; i < n; i++) {
+          var j = (this.first + i) & (n - 1);
+          lens[i] = this.lens[j];
+          ports[i] = this.ports[j];
+          addrs[i] = this.addrs[j];
+        }
+        this.lens = lens;
+        this.ports = ports;
+        this.addrs = addrs;
+        this.first = 0;
+      }
+      var idx = (this.first + this.count++) & (this.lens.length - 1);
+      this.lens[idx] = len;
+      this.ports[idx] = port;
+      this.addrs[idx] = addr;
+    }
+    // Copies the first n unread bytes to dst at the given offset, with at most
+    // two bulk copies, without consuming them.
+    copy(dst, offset, n) {
+      var first = Math.min(n, this.buf.length - this.head);
+      dst.set(this.buf.subarray(this.head, this.head + first), offset);
+      if (n > first) dst.set(this.buf.subarray(0, n - first), offset + first);
+    }
+    // Copies the first n unread bytes to dst at the given offset, and consumes
+    // them.
+    read(dst, offset, n) {
+      this.copy(dst, offset, n);
+      this.skip(n);
+    }
+    skip(n) {
+      this.head = (this.head + n) & (this.buf.length - 1);
+      this.bytes -= n;
+    }
+    // Finishes receiving the current message, of which `remaining` bytes were
+    // not read. The rest of a datagram is discarded, while unread stream data
+    // stays queued for the next receive.
+    done(remaining) {
+      if (!this.datagram) return;
+      this.skip(remaining);
+      this.truncated = remaining > 0;
+      this.addrs[this.first] = undefined;
+      this.first = (this.first + 1) & (this.lens.length - 1);
+      this.count--;
+    }
+  },
+
+  $SOCKFS__deps: ['$FS', '$SockRecvQueue'],
   $SOCKFS: {
     mount(mount) {
       // If Module['websocket'] has already been defined (e.g. for configuring
@@ -61,7 +174,7 @@ addToLibrary({
         error: null, // Used in getsockopt for SOL_SOCKET/SO_ERROR test
         peers: {},
         pending: [],
-        recv_queue: [],
+        recv_queue: new SockRecvQueue(type == {{{ cDefs.SOCK_DGRAM }}}),
 #if SOCKET_WEBRTC
 #else
         sock_ops: SOCKFS.websocket_sock_ops
@@ -108,13 +221,14 @@ addToLibrary({
       },
       read(stream, buffer, offset, length, position /* ignored */) {
         var sock = stream.node.sock;
-        var msg = sock.sock_ops.recvmsg(sock, length);
-        if (!msg) {
-          // socket is closed
-          return 0;
+        if (!(buffer instanceof Uint8Array)) {
+          // Callers usually pass HEAP8. Copy through a byte view of the same
+          // memory, so that the copy doesn't need to convert every element.
+          offset += buffer.byteOffset;
+          buffer = new Uint8Array(buffer.buffer);
         }
-        buffer.set(msg.buffer, offset);
-        return msg.buffer.length;
+        // Returns null if the socket is closed.
+        return sock.sock_ops.recvmsg(sock, buffer, offset, length) || 0;
       },
       write(stream, buffer, offset, length, position /* ignored */) {
         var sock = stream.node.sock;
@@ -283,14 +397,13 @@ addToLibrary({
           Module['websocket'].emit('open', sock.stream.fd);
 
           try {
-            var queued = peer.dgram_send_queue.shift();
-            while (queued) {
+            for (var queued of peer.dgram_send_queue) {
 #if SOCKET_DEBUG
               dbg('websocket sending queued data (' + queued.byteLength + ' bytes): ' + [Array.prototype.slice.call(new Uint8Array(queued))]);
 #endif
               peer.socket.send(queued);
-              queued = peer.dgram_send_queue.shift();
             }
+            peer.dgram_send_queue.length = 0;
           } catch (e) {
             // not much we can do here in the way of proper error handling as we've already
             // lied and said this data was sent. shut it down.
@@ -304,10 +417,11 @@ addToLibrary({
             data = encoder.encode(data); // make a typed array from the string
           } else {
             assert(data.byteLength !== undefined); // must receive an ArrayBuffer
-            if (data.byteLength == 0) {
+            if (data.byteLength == 0 && sock.type !== {{{ cDefs.SOCK_DGRAM }}}) {
               // An empty ArrayBuffer will emit a pseudo disconnect event
               // as recv/recvmsg will return zero which indicates that a socket
               // has performed a shutdown although the connection has not been disconnected yet.
+              // Empty datagrams, on the other hand, are messages of their own.
               return;
             }
             data = new Uint8Array(data); // make a typed array view on the array buffer
@@ -332,7 +446,7 @@ addToLibrary({
             return;
           }
 
-          sock.recv_queue.push({ addr: peer.addr, port: peer.port, data: data });
+          sock.recv_queue.push(data, peer.addr, peer.port);
           Module['websocket'].emit('message', sock.stream.fd);
         };
 
@@ -388,7 +502,7 @@ addToLibrary({
           SOCKFS.websocket_sock_ops.getPeer(sock, sock.daddr, sock.dport) :
           null;
 
-        if (sock.recv_queue.length ||
+        if (sock.recv_queue.bytes ||
             !dest ||  // connection-less sockets are always ready to read
             (dest && dest.socket.readyState === dest.socket.CLOSING) ||
             (dest && dest.socket.readyState === dest.socket.CLOSED)) {  // let recv return 0 once closed
@@ -410,10 +524,8 @@ addToLibrary({
       ioctl(sock, request, arg) {
         switch (request) {
           case {{{ cDefs.FIONREAD }}}:
-            var bytes = 0;
-            if (sock.recv_queue.length) {
-              bytes = sock.recv_queue[0].data.length;
-            }
+            // The size of the next datagram, or all buffered stream data.
+            var bytes = sock.recv_queue.available();
             {{{ makeSetValue('arg', '0', 'bytes', 'i32') }}};
             return 0;
           default:
@@ -619,17 +731,20 @@ addToLibrary({
         }
 
         var data;
+        if (offset == 0 && length == buffer.byteLength && buffer instanceof ArrayBuffer) {
+          // A buffer that holds exactly the message, as created by sendmsg()
+          // to gather its iovecs, can be sent as is. (The Wasm memory itself
+          // never qualifies, since address 0 can't hold a message.)
+          data = buffer;
 #if PTHREADS
-        // WebSockets .send() does not allow passing a SharedArrayBuffer, so clone the portion of the SharedArrayBuffer as a regular
-        // ArrayBuffer that we want to send.
-        if (buffer instanceof SharedArrayBuffer) {
+        } else if (buffer instanceof SharedArrayBuffer) {
+          // WebSockets .send() does not allow passing a SharedArrayBuffer, so clone the portion of the SharedArrayBuffer as a regular
+          // ArrayBuffer that we want to send.
           data = new Uint8Array(new Uint8Array(buffer.slice(offset, offset + length))).buffer;
-        } else {
 #endif
+        } else {
           data = buffer.slice(offset, offset + length);
-#if PTHREADS
         }
-#endif
 
         // if we're emulating a connection-less dgram socket and don't have
         // a cached connection, queue the buffer to send upon connect and
@@ -659,15 +774,17 @@ addToLibrary({
           throw new FS.ErrnoError({{{ cDefs.EINVAL }}});
         }
       },
-      recvmsg(sock, length) {
+      // Returns the number of bytes that the next receive call on the socket
+      // can return, or null if the connection has been closed. Throws EAGAIN
+      // if no data has arrived yet.
+      recvavailable(sock) {
         // http://pubs.opengroup.org/onlinepubs/7908799/xns/recvmsg.html
         if (sock.type === {{{ cDefs.SOCK_STREAM }}} && sock.server) {
           // tcp servers should not be recv()'ing on the listen socket
           throw new FS.ErrnoError({{{ cDefs.ENOTCONN }}});
         }
 
-        var queued = sock.recv_queue.shift();
-        if (!queued) {
+        if (sock.recv_queue.empty()) {
           if (sock.type === {{{ cDefs.SOCK_STREAM }}}) {
             var dest = SOCKFS.websocket_sock_ops.getPeer(sock, sock.daddr, sock.dport);
 
@@ -684,34 +801,43 @@ addToLibrary({
           }
           throw new FS.ErrnoError({{{ cDefs.EAGAIN }}});
         }
-
-        // queued.data will be an ArrayBuffer if it's unadulterated, but if it's
-        // requeued TCP data it'll be an ArrayBufferView
-        var queuedLength = queued.data.byteLength || queued.data.length;
-        var queuedOffset = queued.data.byteOffset || 0;
-        var queuedBuffer = queued.data.buffer || queued.data;
-        var bytesRead = Math.min(length, queuedLength);
-        var res = {
-          buffer: new Uint8Array(queuedBuffer, queuedOffset, bytesRead),
-          addr: queued.addr,
-          port: queued.port
-        };
-
+        return sock.recv_queue.available();
+      },
+      // Receives up to `length` bytes into the Uint8Array `buffer`, usually
+      // HEAPU8, at `offset`. Returns the number of bytes received, or null if
+      // the connection has been closed. The source address of the data is
+      // left in sock.recv_queue.addr and sock.recv_queue.port.
+      recvmsg(sock, buffer, offset, length) {
+        var available = SOCKFS.websocket_sock_ops.recvavailable(sock);
+        if (available === null) return null;
+        var bytesRead = Math.min(length, available);
+        sock.recv_queue.read(buffer, offset, bytesRead);
+        // Datagrams are received whole, so this drops the rest of a datagram
+        // that did not fit, while unread TCP data stays queued.
+        sock.recv_queue.done(available - bytesRead);
 #if SOCKET_DEBUG
-        dbg('websocket read (' + bytesRead + ' bytes): ' + [Array.prototype.slice.call(res.buffer)]);
+        dbg('websocket read (' + bytesRead + ' bytes): ' + [Array.prototype.slice.call(buffer.subarray(offset, offset + bytesRead))]);
 #endif
-
-        // push back any unread data for TCP connections
-        if (sock.type === {{{ cDefs.SOCK_STREAM }}} && bytesRead < queuedLength) {
-          var bytesRemaining = queuedLength - bytesRead;
+        return bytesRead;
+      },
+      // Like recvmsg(), but scatters the data to the `iovcnt` iovecs at `iov`
+      // in the Wasm heap.
+      recvmsgv(sock, iov, iovcnt) {
+        var available = SOCKFS.websocket_sock_ops.recvavailable(sock);
+        if (available === null) return null;
+        var bytesRead = 0;
+        for (var i = 0; bytesRead < available && i < iovcnt; i++) {
+          var iovbase = {{{ makeGetValue('iov', `(${C_STRUCTS.iovec.__size__} * i) + ${C_STRUCTS.iovec.iov_base}`, POINTER_TYPE) }}};
+          var iovlen = {{{ makeGetValue('iov', `(${C_STRUCTS.iovec.__size__} * i) + ${C_STRUCTS.iovec.iov_len}`, 'i32') }}};
+          var length = Math.min(iovlen, available - bytesRead);
+          sock.recv_queue.read(HEAPU8, iovbase, length);
+          bytesRead += length;
+        }
+        sock.recv_queue.done(available - bytesRead);
 #if SOCKET_DEBUG
-          dbg('websocket read: put back ' + bytesRemaining + ' bytes');
+        dbg('websocket read (' + bytesRead + ' bytes into ' + iovcnt + ' buffers)');
 #endif
-          queued.data = new Uint8Array(queuedBuffer, queuedOffset + bytesRead, bytesRemaining);
-          sock.recv_queue.unshift(queued);
-        }
-
-        return res;
+        return bytesRead;
       }
     }
   },
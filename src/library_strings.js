@@ -13,6 +13,12 @@ addToLibrary({
   $UTF8Decoder: "typeof TextDecoder != 'undefined' ? new TextDecoder('utf8') : undefined",
 #endif
 
+#if TEXTDECODER == 2
+  $UTF8Encoder: "new TextEncoder()",
+#elif TEXTDECODER == 1
+  $UTF8Encoder: "typeof TextEncoder != 'undefined' ? new TextEncoder() : undefined",
+#endif
+
   $UTF8ArrayToString__docs: `
   /**
    * Given a pointer 'idx' to a null-terminated UTF8-encoded string in the given
@@ -109,7 +115,9 @@ addToLibrary({
    *   JS JIT optimizations off, so it is worth to consider consistently using one
    * @return {string}
    */`,
-#if TEXTDECODER == 2
+#if WASM_UTF8_DECODING
+  $UTF8ToString__deps: ['$UTF8ArrayToString', 'strnlen', 'emscripten_utf8_to_utf16', 'stackSave', 'stackAlloc', 'stackRestore'],
+#elif TEXTDECODER == 2
   $UTF8ToString__deps: ['$UTF8Decoder'],
 #else
   $UTF8ToString__deps: ['$UTF8ArrayToString'],
@@ -121,7 +129,22 @@ addToLibrary({
 #if CAN_ADDRESS_2GB
     ptr >>>= 0;
 #endif
-#if TEXTDECODER == 2
+#if WASM_UTF8_DECODING
+    if (!ptr) return '';
+    var len = _strnlen(ptr, maxBytesToRead ?? 0x7FFFFFFF);
+    // Long strings are cheapest to decode with TextDecoder, if we have it.
+    if (len > 1024) return UTF8ArrayToString(HEAPU8, ptr, len);
+    if (!len) return '';
+    // Transcode to UTF-16 on the stack, which always fits in 2 bytes per input
+    // byte, and build the string directly from the UTF-16 code units.
+    var sp = stackSave();
+    var buf = stackAlloc(len * 2);
+    var units = _emscripten_utf8_to_utf16(ptr, len, buf);
+    var start = {{{ getHeapOffset('buf', 'u16') }}};
+    var str = String.fromCharCode.apply(null, HEAPU16.subarray(start, start + units));
+    stackRestore(sp);
+    return str;
+#elif TEXTDECODER == 2
     if (!ptr) return '';
     var maxPtr = ptr + maxBytesToRead;
     for (var end = ptr; !(end >= maxPtr) && HEAPU8[end];) ++end;
@@ -153,6 +176,9 @@ addToLibrary({
    *                                   terminator.
    * @return {number} The number of bytes written, EXCLUDING the null terminator.
    */
+#if TEXTDECODER && !SHARED_MEMORY
+  $stringToUTF8Array__deps: ['$UTF8Encoder'],
+#endif
   $stringToUTF8Array: (str, heap, outIdx, maxBytesToWrite) => {
 #if CAN_ADDRESS_2GB
     outIdx >>>= 0;
@@ -167,6 +193,17 @@ addToLibrary({
 
     var startIdx = outIdx;
     var endIdx = outIdx + maxBytesToWrite - 1; // -1 for string null terminator.
+#if TEXTDECODER && !SHARED_MEMORY
+    // For anything but short strings TextEncoder.encodeInto() is faster than
+    // the loop below, despite the garbage created by subarray(). It produces
+    // the same output as the loop: only complete characters are written, and
+    // unpaired surrogates are replaced with U+FFFD.
+    if (str.length > 64 && heap instanceof Uint8Array{{{ TEXTDECODER != 2 ? ' && UTF8Encoder' : '' }}}) {
+      outIdx += UTF8Encoder.encodeInto(str, heap.subarray(outIdx, endIdx)).written;
+      heap[outIdx] = 0;
+      return outIdx - startIdx;
+    }
+#endif
     for (var i = 0; i < str.length; ++i) {
       // Gotcha: charCodeAt returns a 16-bit word that is a UTF-16 encoded code
       // unit, not a Unicode code point of the character! So decode
@@ -177,8 +214,15 @@ addToLibrary({
       // and https://tools.ietf.org/html/rfc3629
       var u = str.charCodeAt(i); // possibly a lead surrogate
       if (u >= 0xD800 && u <= 0xDFFF) {
-        var u1 = str.charCodeAt(++i);
-        u = 0x10000 + ((u & 0x3FF) << 10) | (u1 & 0x3FF);
+        var u1 = str.charCodeAt(i + 1);
+        if (u <= 0xDBFF && (u1 & 0xFC00) == 0xDC00) {
+          u = 0x10000 + ((u & 0x3FF) << 10) | (u1 & 0x3FF);
+          ++i;
+        } else {
+          // Unpaired surrogates can't be encoded in UTF-8. Replace them with
+          // U+FFFD, as TextEncoder does.
+          u = 0xFFFD;
+        }
       }
       if (u <= 0x7F) {
         if (outIdx >= endIdx) break;
@@ -194,9 +238,6 @@ addToLibrary({
         heap[outIdx++] = 0x80 | (u & 63);
       } else {
         if (outIdx + 3 >= endIdx) break;
-#if ASSERTIONS
-        if (u > 0x10FFFF) warnOnce('Invalid Unicode code point ' + ptrToString(u) + ' encountered when serializing a JS string to a UTF-8 string in wasm memory! (Valid unicode code points should be in range 0-0x10FFFF).');
-#endif
         heap[outIdx++] = 0xF0 | (u >> 18);
         heap[outIdx++] = 0x80 | ((u >> 12) & 63);
         heap[outIdx++] = 0x80 | ((u >> 6) & 63);
@@ -244,7 +285,9 @@ addToLibrary({
         len++;
       } else if (c <= 0x7FF) {
         len += 2;
-      } else if (c >= 0xD800 && c <= 0xDFFF) {
+      } else if (c >= 0xD800 && c <= 0xDBFF && (str.charCodeAt(i + 1) & 0xFC00) == 0xDC00) {
+        // A surrogate pair. Unpaired surrogates are encoded as U+FFFD, which
+        // takes 3 bytes.
         len += 4; ++i;
       } else {
         len += 3;
@@ -405,16 +405,15 @@ var SyscallsLibrary = {
   __syscall_recvfrom__deps: ['$getSocketFromFD', '$writeSockaddr', '$DNS'],
   __syscall_recvfrom: (fd, buf, len, flags, addr, addrlen) => {
     var sock = getSocketFromFD(fd);
-    var msg = sock.sock_ops.recvmsg(sock, len);
-    if (!msg) return 0; // socket is closed
+    var bytesRead = sock.sock_ops.recvmsg(sock, HEAPU8, buf, len);
+    if (bytesRead === null) return 0; // socket is closed
     if (addr) {
-      var errno = writeSockaddr(addr, sock.family, DNS.lookup_name(msg.addr), msg.port, addrlen);
+      var errno = writeSockaddr(addr, sock.family, DNS.lookup_name(sock.recv_queue.addr), sock.recv_queue.port, addrlen);
 #if ASSERTIONS
       assert(!errno);
 #endif
     }
-    HEAPU8.set(msg.buffer, buf);
-    return msg.buffer.byteLength;
+    return bytesRead;
   },
   __syscall_sendto__deps: ['$getSocketFromFD', '$getSocketAddress'],
   __syscall_sendto: (fd, message, length, flags, addr, addr_len) => {
@@ -442,9 +441,9 @@ var SyscallsLibrary = {
     }
     return -{{{ cDefs.ENOPROTOOPT }}}; // The option is unknown at the level indicated.
   },
-  __syscall_sendmsg__deps: ['$getSocketFromFD', '$readSockaddr', '$DNS'],
-  __syscall_sendmsg: (fd, message, flags, d1, d2, d3) => {
-    var sock = getSocketFromFD(fd);
+  // Sends the message described by the msghdr at `message` on the socket.
+  $sendSocketMessage__deps: ['$readSockaddr', '$DNS', '$FS'],
+  $sendSocketMessage: (sock, message) => {
     var iov = {{{ makeGetValue('message', C_STRUCTS.msghdr.msg_iov, '*') }}};
     var num = {{{ makeGetValue('message', C_STRUCTS.msghdr.msg_iovlen, 'i32') }}};
     // read the address and port to send to
@@ -453,10 +452,16 @@ var SyscallsLibrary = {
     var namelen = {{{ makeGetValue('message', C_STRUCTS.msghdr.msg_namelen, 'i32') }}};
     if (name) {
       var info = readSockaddr(name, namelen);
-      if (info.errno) return -info.errno;
+      if (info.errno) throw new FS.ErrnoError(info.errno);
       port = info.port;
       addr = DNS.lookup_addr(info.addr) || info.addr;
     }
+    if (num == 1) {
+      // A single buffer can be sent straight from the heap.
+      var iovbase = {{{ makeGetValue('iov', C_STRUCTS.iovec.iov_base, POINTER_TYPE) }}};
+      var iovlen = {{{ makeGetValue('iov', C_STRUCTS.iovec.iov_len, 'i32') }}};
+      return sock.sock_ops.sendmsg(sock, HEAPU8, iovbase, iovlen, addr, port);
+    }
     // concatenate scatter-gather arrays into one message buffer
     var total = 0;
     for (var i = 0; i < num; i++) {
@@ -467,26 +472,22 @@ var SyscallsLibrary = {
     for (var i = 0; i < num; i++) {
       var iovbase = {{{ makeGetValue('iov', `(${C_STRUCTS.iovec.__size__} * i) + ${C_STRUCTS.iovec.iov_base}`, POINTER_TYPE) }}};
       var iovlen = {{{ makeGetValue('iov', `(${C_STRUCTS.iovec.__size__} * i) + ${C_STRUCTS.iovec.iov_len}`, 'i32') }}};
-      for (var j = 0; j < iovlen; j++) {
-        view[offset++] = {{{ makeGetValue('iovbase', 'j', 'i8') }}};
-      }
+      view.set(HEAPU8.subarray(iovbase, iovbase + iovlen), offset);
+      offset += iovlen;
     }
-    // write the buffer
-    return sock.sock_ops.sendmsg(sock, view, 0, total, addr, port);
+    // write the buffer, which holds exactly the message and so is sent as is
+    return sock.sock_ops.sendmsg(sock, view.buffer, 0, total, addr, port);
   },
-  __syscall_recvmsg__deps: ['$getSocketFromFD', '$writeSockaddr', '$DNS'],
-  __syscall_recvmsg: (fd, message, flags, d1, d2, d3) => {
-    var sock = getSocketFromFD(fd);
+  // Receives into the msghdr at `message` from the socket. Returns the number
+  // of bytes received, or null if the socket is closed.
+  $recvSocketMessage__deps: ['$writeSockaddr', '$DNS'],
+  $recvSocketMessage: (sock, message) => {
     var iov = {{{ makeGetValue('message', C_STRUCTS.msghdr.msg_iov, POINTER_TYPE) }}};
     var num = {{{ makeGetValue('message', C_STRUCTS.msghdr.msg_iovlen, 'i32') }}};
-    // get the total amount of data we can read across all arrays
-    var total = 0;
-    for (var i = 0; i < num; i++) {
-      total += {{{ makeGetValue('iov', `(${C_STRUCTS.iovec.__size__} * i) + ${C_STRUCTS.iovec.iov_len}`, 'i32') }}};
-    }
-    // try to read total data
-    var msg = sock.sock_ops.recvmsg(sock, total);
-    if (!msg) return 0; // socket is closed
+    // Copy the data straight from the receive queue of the socket to the
+    // scatter-gather arrays.
+    var bytesRead = sock.sock_ops.recvmsgv(sock, iov, num);
+    if (bytesRead === null) return null;
 
     // TODO honor flags:
     // MSG_OOB
@@ -499,38 +500,72 @@ var SyscallsLibrary = {
     // write the source address out
     var name = {{{ makeGetValue('message', C_STRUCTS.msghdr.msg_name, '*') }}};
     if (name) {
-      var errno = writeSockaddr(name, sock.family, DNS.lookup_name(msg.addr), msg.port);
+      var errno = writeSockaddr(name, sock.family, DNS.lookup_name(sock.recv_queue.addr), sock.recv_queue.port);
 #if ASSERTIONS
       assert(!errno);
 #endif
     }
-    // write the buffer out to the scatter-gather arrays
-    var bytesRead = 0;
-    var bytesRemaining = msg.buffer.byteLength;
-    for (var i = 0; bytesRemaining > 0 && i < num; i++) {
-      var iovbase = {{{ makeGetValue('iov', `(${C_STRUCTS.iovec.__size__} * i) + ${C_STRUCTS.iovec.iov_base}`, POINTER_TYPE) }}};
-      var iovlen = {{{ makeGetValue('iov', `(${C_STRUCTS.iovec.__size__} * i) + ${C_STRUCTS.iovec.iov_len}`, 'i32') }}};
-      if (!iovlen) {
-        continue;
-      }
-      var length = Math.min(iovlen, bytesRemaining);
-      var buf = msg.buffer.subarray(bytesRead, bytesRead + length);
-      HEAPU8.set(buf, iovbase + bytesRead);
-      bytesRead += length;
-      bytesRemaining -= length;
-    }
 
-    // TODO set msghdr.msg_flags
+    // TODO set the remaining msghdr.msg_flags
     // MSG_EOR
     // End of record was received (if supported by the protocol).
     // MSG_OOB
     // Out-of-band data was received.
-    // MSG_TRUNC
-    // Normal data was truncated.
     // MSG_CTRUNC
+    var msgFlags = sock.type === {{{ cDefs.SOCK_DGRAM }}} && sock.recv_queue.truncated ? {{{ cDefs.MSG_TRUNC }}} : 0;
+    {{{ makeSetValue('message', C_STRUCTS.msghdr.msg_flags, 'msgFlags', 'i32') }}};
 
     return bytesRead;
   },
+  __syscall_sendmsg__deps: ['$getSocketFromFD', '$sendSocketMessage'],
+  __syscall_sendmsg: (fd, message, flags, d1, d2, d3) => {
+    var sock = getSocketFromFD(fd);
+    return sendSocketMessage(sock, message);
+  },
+  __syscall_recvmsg__deps: ['$getSocketFromFD', '$recvSocketMessage'],
+  __syscall_recvmsg: (fd, message, flags, d1, d2, d3) => {
+    var sock = getSocketFromFD(fd);
+    var bytesRead = recvSocketMessage(sock, message);
+    return bytesRead === null ? 0 : bytesRead; // 0 if the socket is closed
+  },
+  // Sends up to vlen messages in one call, stopping at the first error.
+  // Returns the number of messages sent, or the error if none was.
+  __syscall_sendmmsg__deps: ['$getSocketFromFD', '$sendSocketMessage', '$FS'],
+  __syscall_sendmmsg: (fd, msgvec, vlen, flags) => {
+    var sock = getSocketFromFD(fd);
+    for (var i = 0; i < vlen; i++) {
+      var hdr = msgvec + i * {{{ C_STRUCTS.mmsghdr.__size__ }}};
+      try {
+        var sent = sendSocketMessage(sock, hdr + {{{ C_STRUCTS.mmsghdr.msg_hdr }}});
+      } catch (e) {
+        // Report errors after the first message on the next call.
+        if (!i || !(e instanceof FS.ErrnoError)) throw e;
+        break;
+      }
+      {{{ makeSetValue('hdr', C_STRUCTS.mmsghdr.msg_len, 'sent', 'i32') }}};
+    }
+    return i;
+  },
+  // Receives as many of vlen messages as are already queued on the socket.
+  // Sockets never block here, so the timeout and MSG_WAITFORONE make no
+  // difference. Returns EAGAIN if there was nothing to receive.
+  __syscall_recvmmsg__deps: ['$getSocketFromFD', '$recvSocketMessage', '$FS'],
+  __syscall_recvmmsg: (fd, msgvec, vlen, flags, timeout) => {
+    var sock = getSocketFromFD(fd);
+    for (var i = 0; i < vlen; i++) {
+      var hdr = msgvec + i * {{{ C_STRUCTS.mmsghdr.__size__ }}};
+      try {
+        var bytesRead = recvSocketMessage(sock, hdr + {{{ C_STRUCTS.mmsghdr.msg_hdr }}});
+      } catch (e) {
+        // Report errors after the first message on the next call.
+        if (!i || !(e instanceof FS.ErrnoError)) throw e;
+        break;
+      }
+      if (bytesRead === null) break; // socket is closed
+      {{{ makeSetValue('hdr', C_STRUCTS.mmsghdr.msg_len, 'bytesRead', 'i32') }}};
+    }
+    return i;
+  },
 #endif // ~PROXY_POSIX_SOCKETS==0
   __syscall_fchdir: (fd) => {
     var stream = SYSCALLS.getStreamFromFD(fd);
@@ -260,7 +260,7 @@ let LibraryWebAudio = {
     });
   },
 
-  emscripten_create_wasm_audio_worklet_node: (contextHandle, name, options, callback, userData) => {
+  $_EmAudioCreateWorkletNode: (contextHandle, name, options, processorOptions) => {
 #if ASSERTIONS
     assert(contextHandle, `Called emscripten_create_wasm_audio_worklet_node() with a null Web Audio Context handle!`);
     assert(EmAudio[contextHandle], `Called emscripten_create_wasm_audio_worklet_node() with a nonexisting/already freed Web Audio Context handle ${contextHandle}!`);
@@ -278,8 +278,8 @@ let LibraryWebAudio = {
       numberOfInputs: HEAP32[options],
       numberOfOutputs: HEAP32[options+1],
       outputChannelCount: HEAPU32[options+2] ? readChannelCountArray(HEAPU32[options+2]>>2, HEAP32[options+1]) : void 0,
-      processorOptions: { 'cb': callback, 'ud': userData }
-    } : void 0;
+      processorOptions
+    } : { processorOptions };
 
 #if WEBAUDIO_DEBUG
     console.log(`Creating AudioWorkletNode "${UTF8ToString(name)}" on context=${contextHandle} with options:`);
@@ -287,6 +287,24 @@ let LibraryWebAudio = {
 #endif
     return emscriptenRegisterAudioObject(new AudioWorkletNode(EmAudio[contextHandle], UTF8ToString(name), opts));
   },
+
+  emscripten_create_wasm_audio_worklet_node__deps: ['$_EmAudioCreateWorkletNode'],
+  emscripten_create_wasm_audio_worklet_node: (contextHandle, name, options, callback, userData) =>
+    _EmAudioCreateWorkletNode(contextHandle, name, options, { 'cb': callback, 'ud': userData }),
+
+  emscripten_create_audio_ring_worklet_node__deps: ['$_EmAudioCreateWorkletNode'],
+  emscripten_create_audio_ring_worklet_node: (contextHandle, name, options, ring) => {
+#if ASSERTIONS
+    assert(ring, 'Called emscripten_create_audio_ring_worklet_node() with a null ring!');
+    assert({{{ makeGetValue('ring', C_STRUCTS.emscripten_audio_ring_t.capacity, 'u32') }}} && {{{ makeGetValue('ring', C_STRUCTS.emscripten_audio_ring_t.numChannels, 'u32') }}}, `Called emscripten_create_audio_ring_worklet_node() with an uninitialized ring ${ring}!`);
+#endif
+    // The ring is read on the audio thread directly from the shared heap, see
+    // processRing() in audio_worklet.js.
+    return _EmAudioCreateWorkletNode(contextHandle, name, options, {
+      'ring': ring,
+      'data': {{{ makeGetValue('ring', C_STRUCTS.emscripten_audio_ring_t.data, '*') }}}
+    });
+  },
 #endif // ~AUDIO_WORKLET
 
   emscripten_current_thread_is_audio_worklet: () => typeof AudioWorkletGlobalScope !== 'undefined',
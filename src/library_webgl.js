@@ -310,6 +310,88 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
       return ret;
     },
 
+#if GL_STATE_CACHE
+    // Number of calls to each GL function that GL_STATE_CACHE dropped because
+    // they would not have changed any state.
+    stateCacheElided: {},
+
+    countElidedCall: (name) => {
+      GL.stateCacheElided[name] = (GL.stateCacheElided[name] || 0) + 1;
+    },
+
+    // Returns the shadow copy of the state of a newly created context. Entries
+    // that are undefined are not known, so the next call that sets them is
+    // always forwarded to WebGL.
+    createStateCache: () => ({
+      // GL_TEXTURE0 is the initial active texture unit.
+      activeTexture: 0x84C0,
+      // Texture bindings by texture unit, and then by target.
+      textures: {},
+      // Buffer bindings by target.
+      buffers: {},
+      program: undefined,
+      // Enabled state by cap.
+      caps: {},
+      // [srcRGB, dstRGB, srcAlpha, dstAlpha]
+      blendFunc: [],
+      // [modeRGB, modeAlpha]
+      blendEquation: [],
+      depthFunc: undefined,
+      depthMask: undefined,
+    }),
+
+    // Returns true, and counts the call as elided, if a glUniform* call that
+    // sets the uniform at `location` of the current program to the given
+    // values would not change it. Otherwise remembers the new values.
+    elideUniform: (name, location, v0, v1, v2, v3) => {
+      var values = GLctx.currentProgram?.uniformValues;
+      if (!values) return false;
+      var cached = values[location];
+      if (cached && cached[0] === v0 && cached[1] === v1 && cached[2] === v2 && cached[3] === v3 && cached.transpose === undefined) {
+        GL.countElidedCall(name);
+        return true;
+      }
+      values[location] = [v0, v1, v2, v3];
+      return false;
+    },
+
+    // Like elideUniform, for the vector and matrix forms of glUniform*, which
+    // set `size` values per uniform read from `heap` starting at `offset`.
+    // Only writes of a single uniform are cached.
+    elideUniformArray: (name, location, count, heap, offset, size, transpose) => {
+      var values = GLctx.currentProgram?.uniformValues;
+      if (!values) return false;
+      if (count != 1) {
+        // The elements of a uniform array have consecutive location IDs, so
+        // forget all of the ones that this call overwrites.
+        for (var i = 0; i < count; i++) {
+          values[location + i] = null;
+        }
+        return false;
+      }
+      var cached = values[location];
+      if (cached && cached.transpose === transpose) {
+        var i = 0;
+        while (i < size && cached[i] === heap[offset + i]) i++;
+        if (i == size) {
+          GL.countElidedCall(name);
+          return true;
+        }
+      }
+      cached = values[location] = heap.slice(offset, offset + size);
+      cached.transpose = transpose;
+      return false;
+    },
+
+    // Forgets the bindings of a deleted texture or buffer, which WebGL unbinds
+    // from the current context. `bindings` maps targets to object IDs.
+    forgetBindings: (bindings, id) => {
+      for (var target in bindings) {
+        if (bindings[target] == id) bindings[target] = undefined;
+      }
+    },
+#endif
+
     // The code path for creating textures, buffers, framebuffers and other
     // objects the same (and not in fast path), so we merge the functions
     // together.
@@ -460,6 +542,11 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
       for (var i = 0; i <= largestIndex; ++i) {
         GL.currentContext.tempVertexBufferCounters1[i] = 0;
       }
+#if FULL_ES2
+      // Client-side data is only reused within a frame.
+      GL.currentContext.streamingVertexBuffer?.uploads.clear();
+      GL.currentContext.streamingIndexBuffer?.uploads.clear();
+#endif
     },
 #endif
 
@@ -516,27 +603,159 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
 
     usedTempBuffers: [],
 
+    // Client-side vertex and index data is streamed into one large buffer per
+    // target. The data of each draw is appended after that of the previous
+    // one, and when the buffer is full it is orphaned (its storage is
+    // reallocated with bufferData()) rather than overwritten, so uploading
+    // never has to wait for the GPU to finish the earlier draws. Within a
+    // frame, data that was already uploaded from the same client pointer is
+    // reused if it has not changed since, so draws that share client arrays
+    // only upload them once.
+    createStreamingBuffer: (target) => ({
+      target,
+      buffer: GLctx.createBuffer(),
+      size: 0,
+      // Where the next upload goes.
+      offset: 0,
+      // A copy of the data in the current storage of the buffer, to detect
+      // changes to client arrays that were already uploaded.
+      shadow: null,
+      shadow32: null,
+      // Uploads since the start of the frame or the last orphaning, as maps
+      // from client pointer to [end pointer, offset in the buffer].
+      uploads: new Map(),
+      // Statistics, for benchmarks and tests.
+      uploadedBytes: 0,
+      reusedBytes: 0,
+      orphanCount: 0,
+    }),
+
+    // Makes sure that `numUploads` uploads of `size` bytes in total fit in the
+    // rest of `stream`, which must be bound to its target. Otherwise orphans
+    // its storage and starts again from the beginning, so that the data of a
+    // single draw never straddles an orphaning.
+    reserveStreamingSpace: (stream, size, numUploads) => {
+      // Each upload may need up to 30 bytes of padding for alignment.
+      size += 32 * numUploads;
+      if (stream.offset + size <= stream.size) return;
+      if (size > stream.size) {
+        stream.size = Math.max(GL.MAX_TEMP_BUFFER_SIZE, 1 << GL.log2ceilLookup(size));
+        stream.shadow = new Uint8Array(stream.size);
+        stream.shadow32 = new Int32Array(stream.shadow.buffer);
+      }
+      GLctx.bufferData(stream.target, stream.size, 0x88E0 /*GL_STREAM_DRAW*/);
+      stream.offset = 0;
+      stream.uploads.clear();
+      stream.orphanCount++;
+    },
+
+    // Returns the offset at which the `size` bytes at `ptr` are found in
+    // `stream`, uploading them if needed. Space must have been reserved with
+    // reserveStreamingSpace(). The offset is congruent to `ptr` modulo 16, so
+    // that it is aligned for any type that the client data was.
+    streamClientData: (stream, ptr, size) => {
+      var upload = stream.uploads.get(ptr);
+      if (upload && ptr + size <= upload[0]) {
+        var offset = upload[1];
+        if (GL.streamedDataUnchanged(stream, offset, ptr, size)) {
+          stream.reusedBytes += size;
+          return offset;
+        }
+      }
+      offset = ((stream.offset + 15) & ~15) + (ptr & 15);
+#if GL_ASSERTIONS
+      assert(offset + size <= stream.size, 'streamClientData called without reserveStreamingSpace');
+#endif
+      var data = HEAPU8.subarray(ptr, ptr + size);
+      stream.shadow.set(data, offset);
+      GLctx.bufferSubData(stream.target, offset, data);
+      stream.offset = offset + size;
+      stream.uploads.set(ptr, [ptr + size, offset]);
+      stream.uploadedBytes += size;
+      return offset;
+    },
+
+    streamedDataUnchanged: (stream, offset, ptr, size) => {
+      var i = 0;
+      if (!((ptr | size) & 3)) {
+        // The offset is then 4-byte aligned as well.
+        var shadow32 = stream.shadow32, heap = HEAP32;
+        var o = offset >> 2, p = {{{ getHeapOffset('ptr', 'i32') }}};
+        for (size >>= 2; i < size; i++) {
+          if (shadow32[o + i] !== heap[p + i]) return false;
+        }
+        return true;
+      }
+      var shadow = stream.shadow;
+      for (; i < size; i++) {
+        if (shadow[offset + i] !== HEAPU8[ptr + i]) return false;
+      }
+      return true;
+    },
+
+    // Returns the largest vertex index in a client-side index array. WebGL 2
+    // always enables primitive restart, with the largest value of the index
+    // type as the restart index, which does not refer to a vertex.
+    maxClientIndex: (type, indices, count) => {
+      var max = -1, restart = -1, heap, p;
+      if (type == 0x1401 /*GL_UNSIGNED_BYTE*/) {
+        heap = HEAPU8, p = indices;
+#if MAX_WEBGL_VERSION >= 2
+        if (GL.currentContext.version >= 2) restart = 0xFF;
+#endif
+      } else if (type == 0x1403 /*GL_UNSIGNED_SHORT*/) {
+        heap = HEAPU16, p = {{{ getHeapOffset('indices', 'u16') }}};
+#if MAX_WEBGL_VERSION >= 2
+        if (GL.currentContext.version >= 2) restart = 0xFFFF;
+#endif
+      } else {
+        heap = HEAPU32, p = {{{ getHeapOffset('indices', 'u32') }}};
+#if MAX_WEBGL_VERSION >= 2
+        if (GL.currentContext.version >= 2) restart = 0xFFFFFFFF;
+#endif
+      }
+      for (var i = 0; i < count; i++) {
+        var index = heap[p + i];
+        if (index > max && index != restart) max = index;
+      }
+      return max;
+    },
+
     preDrawHandleClientVertexAttribBindings: (count) => {
       GL.resetBufferBinding = false;
 
-      // TODO: initial pass to detect ranges we need to upload, might not need
-      // an upload per attrib
+      // Find the range of client memory that the enabled client-side
+      // attributes read from. If they overlap, e.g. because the attributes are
+      // interleaved in a single array, the whole range is uploaded at once.
+      var start = Infinity, end = 0, total = 0;
       for (var i = 0; i < GL.currentContext.maxVertexAttribs; ++i) {
         var cb = GL.currentContext.clientBuffers[i];
         if (!cb.clientside || !cb.enabled) continue;
-
-        GL.resetBufferBinding = true;
-
         var size = GL.calcBufLength(cb.size, cb.type, cb.stride, count);
-        var buf = GL.getTempVertexBuffer(size);
-        GLctx.bindBuffer(0x8892 /*GL_ARRAY_BUFFER*/, buf);
-        GLctx.bufferSubData(0x8892 /*GL_ARRAY_BUFFER*/,
-                                 0,
-                                 HEAPU8.subarray(cb.ptr, cb.ptr + size));
+        start = Math.min(start, cb.ptr);
+        end = Math.max(end, cb.ptr + size);
+        total += size;
+      }
+      if (!total) return;
+      GL.resetBufferBinding = true;
+
+      var stream = GL.currentContext.streamingVertexBuffer ||= GL.createStreamingBuffer(0x8892 /*GL_ARRAY_BUFFER*/);
+      GLctx.bindBuffer(0x8892 /*GL_ARRAY_BUFFER*/, stream.buffer);
+      var merged = end - start <= total;
+      if (merged) {
+        GL.reserveStreamingSpace(stream, end - start, 1);
+        var base = GL.streamClientData(stream, start, end - start) - start;
+      } else {
+        GL.reserveStreamingSpace(stream, total, GL.currentContext.maxVertexAttribs);
+      }
+      for (var i = 0; i < GL.currentContext.maxVertexAttribs; ++i) {
+        var cb = GL.currentContext.clientBuffers[i];
+        if (!cb.clientside || !cb.enabled) continue;
+        var offset = merged ? base + cb.ptr : GL.streamClientData(stream, cb.ptr, GL.calcBufLength(cb.size, cb.type, cb.stride, count));
 #if GL_ASSERTIONS
-        GL.validateVertexAttribPointer(cb.size, cb.type, cb.stride, 0);
+        GL.validateVertexAttribPointer(cb.size, cb.type, cb.stride, offset);
 #endif
-        cb.vertexAttribPointerAdaptor.call(GLctx, i, cb.size, cb.type, cb.normalized, cb.stride, 0);
+        cb.vertexAttribPointerAdaptor.call(GLctx, i, cb.size, cb.type, cb.normalized, cb.stride, offset);
       }
     },
 
@@ -1070,6 +1289,11 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
         version: webGLContextAttributes.majorVersion,
         GLctx: ctx
       };
+#if GL_STATE_CACHE
+      // Kept on the WebGL context, like currentProgram, so that it follows
+      // makeContextCurrent() for free.
+      ctx.stateCache = GL.createStateCache();
+#endif
 
       // Store the created context object so that we can access the context
       // given a canvas without having to pass the parameters again.
@@ -1512,6 +1736,10 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
       GLctx.deleteTexture(texture);
       texture.name = 0;
       GL.textures[id] = null;
+#if GL_STATE_CACHE
+      var units = GLctx.stateCache.textures;
+      for (var unit in units) GL.forgetBindings(units[unit], id);
+#endif
     }
   },
 
@@ -1723,6 +1951,15 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glBindTexture: (target, texture) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GL.textures, texture, 'glBindTexture', 'texture');
+#endif
+#if GL_STATE_CACHE
+    var cache = GLctx.stateCache;
+    var bindings = cache.textures[cache.activeTexture] ||= {};
+    if (bindings[target] === texture) {
+      GL.countElidedCall('glBindTexture');
+      return;
+    }
+    bindings[target] = texture;
 #endif
     GLctx.bindTexture(target, GL.textures[texture]);
   },
@@ -1799,6 +2036,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
       GLctx.deleteBuffer(buffer);
       buffer.name = 0;
       GL.buffers[id] = null;
+#if GL_STATE_CACHE
+      GL.forgetBindings(GLctx.stateCache.buffers, id);
+#endif
 
 #if FULL_ES2 || LEGACY_GL_EMULATION
       if (id == GLctx.currentArrayBufferBinding) GLctx.currentArrayBufferBinding = 0;
@@ -2351,6 +2591,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform1f: (location, v0) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform1f', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform1f', location, v0)) return;
 #endif
     GLctx.uniform1f(webglGetUniformLocation(location), v0);
   },
@@ -2359,6 +2602,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform2f: (location, v0, v1) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform2f', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform2f', location, v0, v1)) return;
 #endif
     GLctx.uniform2f(webglGetUniformLocation(location), v0, v1);
   },
@@ -2367,6 +2613,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform3f: (location, v0, v1, v2) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform3f', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform3f', location, v0, v1, v2)) return;
 #endif
     GLctx.uniform3f(webglGetUniformLocation(location), v0, v1, v2);
   },
@@ -2375,6 +2624,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform4f: (location, v0, v1, v2, v3) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform4f', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform4f', location, v0, v1, v2, v3)) return;
 #endif
     GLctx.uniform4f(webglGetUniformLocation(location), v0, v1, v2, v3);
   },
@@ -2383,6 +2635,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform1i: (location, v0) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform1i', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform1i', location, v0)) return;
 #endif
     GLctx.uniform1i(webglGetUniformLocation(location), v0);
   },
@@ -2391,6 +2646,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform2i: (location, v0, v1) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform2i', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform2i', location, v0, v1)) return;
 #endif
     GLctx.uniform2i(webglGetUniformLocation(location), v0, v1);
   },
@@ -2399,6 +2657,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform3i: (location, v0, v1, v2) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform3i', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform3i', location, v0, v1, v2)) return;
 #endif
     GLctx.uniform3i(webglGetUniformLocation(location), v0, v1, v2);
   },
@@ -2407,6 +2668,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUniform4i: (location, v0, v1, v2, v3) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform4i', 'location');
+#endif
+#if GL_STATE_CACHE
+    if (GL.elideUniform('glUniform4i', location, v0, v1, v2, v3)) return;
 #endif
     GLctx.uniform4i(webglGetUniformLocation(location), v0, v1, v2, v3);
   },
@@ -2421,6 +2685,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform1iv', 'location');
     assert((value & 3) == 0, 'Pointer to integer data passed to glUniform1iv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform1iv', location, count, HEAP32, {{{ getHeapOffset('value', 'i32') }}}, 1)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2462,6 +2729,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform2iv', 'location');
     assert((value & 3) == 0, 'Pointer to integer data passed to glUniform2iv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform2iv', location, count, HEAP32, {{{ getHeapOffset('value', 'i32') }}}, 2)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2504,6 +2774,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform3iv', 'location');
     assert((value & 3) == 0, 'Pointer to integer data passed to glUniform3iv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform3iv', location, count, HEAP32, {{{ getHeapOffset('value', 'i32') }}}, 3)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2547,6 +2820,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform4iv', 'location');
     assert((value & 3) == 0, 'Pointer to integer data passed to glUniform4iv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform4iv', location, count, HEAP32, {{{ getHeapOffset('value', 'i32') }}}, 4)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2591,6 +2867,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform1fv', 'location');
     assert((value & 3) == 0, 'Pointer to float data passed to glUniform1fv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform1fv', location, count, HEAPF32, {{{ getHeapOffset('value', 'float') }}}, 1)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2632,6 +2911,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform2fv', 'location');
     assert((value & 3) == 0, 'Pointer to float data passed to glUniform2fv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform2fv', location, count, HEAPF32, {{{ getHeapOffset('value', 'float') }}}, 2)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2674,6 +2956,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform3fv', 'location');
     assert((value % 4) == 0, 'Pointer to float data passed to glUniform3fv must be aligned to four bytes!' + value);
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform3fv', location, count, HEAPF32, {{{ getHeapOffset('value', 'float') }}}, 3)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2717,6 +3002,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniform4fv', 'location');
     assert((value & 3) == 0, 'Pointer to float data passed to glUniform4fv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniform4fv', location, count, HEAPF32, {{{ getHeapOffset('value', 'float') }}}, 4)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2765,6 +3053,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniformMatrix2fv', 'location');
     assert((value & 3) == 0, 'Pointer to float data passed to glUniformMatrix2fv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniformMatrix2fv', location, count, HEAPF32, {{{ getHeapOffset('value', 'float') }}}, 4, !!transpose)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2809,6 +3100,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniformMatrix3fv', 'location');
     assert((value & 3) == 0, 'Pointer to float data passed to glUniformMatrix3fv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniformMatrix3fv', location, count, HEAPF32, {{{ getHeapOffset('value', 'float') }}}, 9, !!transpose)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2858,6 +3152,9 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GL.validateGLObjectID(GLctx.currentProgram.uniformLocsById, location, 'glUniformMatrix4fv', 'location');
     assert((value & 3) == 0, 'Pointer to float data passed to glUniformMatrix4fv must be aligned to four bytes!');
 #endif
+#if GL_STATE_CACHE
+    if (GL.elideUniformArray('glUniformMatrix4fv', location, count, HEAPF32, {{{ getHeapOffset('value', 'float') }}}, 16, !!transpose)) return;
+#endif
 
 #if MIN_WEBGL_VERSION >= 2 && WEBGL_USE_GARBAGE_FREE_APIS
 #if GL_ASSERTIONS
@@ -2912,6 +3209,14 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GL.buffers, buffer, 'glBindBuffer', 'buffer');
 #endif
+#if GL_STATE_CACHE
+    var bindings = GLctx.stateCache.buffers;
+    if (bindings[target] === buffer) {
+      GL.countElidedCall('glBindBuffer');
+      return;
+    }
+    bindings[target] = buffer;
+#endif
 #if FULL_ES2 || LEGACY_GL_EMULATION
     if (target == 0x8892 /*GL_ARRAY_BUFFER*/) {
       GLctx.currentArrayBufferBinding = buffer;
@@ -3387,6 +3692,11 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GLctx.deleteProgram(program);
     program.name = 0;
     GL.programs[id] = null;
+#if GL_STATE_CACHE
+    // A deleted program stays in use until another one is, but binding its ID
+    // again would now bind null.
+    if (GLctx.stateCache.program === id) GLctx.stateCache.program = undefined;
+#endif
   },
 
   glAttachShader: (program, shader) => {
@@ -3433,6 +3743,10 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     // Invalidate earlier computed uniform->ID mappings, those have now become stale
     program.uniformLocsById = 0; // Mark as null-like so that glGetUniformLocation() knows to populate this again.
     program.uniformSizeAndIdsByName = {};
+#if GL_STATE_CACHE
+    // Linking resets all uniforms to their initial values.
+    program.uniformValues = {};
+#endif
 
 #if GL_EXPLICIT_UNIFORM_LOCATION
     // Collect explicit uniform locations from the vertex and fragment shaders.
@@ -3527,6 +3841,14 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   glUseProgram: (program) => {
 #if GL_ASSERTIONS
     GL.validateGLObjectID(GL.programs, program, 'glUseProgram', 'program');
+#endif
+#if GL_STATE_CACHE
+    var cache = GLctx.stateCache;
+    if (cache.program === program) {
+      GL.countElidedCall('glUseProgram');
+      return;
+    }
+    cache.program = program;
 #endif
     program = GL.programs[program];
     GLctx.useProgram(program);
@@ -3660,6 +3982,11 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
       GLctx.deleteVertexArray(GL.vaos[id]);
       GL.vaos[id] = null;
     }
+#if GL_STATE_CACHE
+    // Deleting the bound VAO reverts to the default one, which has its own
+    // GL_ELEMENT_ARRAY_BUFFER binding.
+    GLctx.stateCache.buffers[0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/] = undefined;
+#endif
 #endif
   },
 
@@ -3675,6 +4002,10 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
 #endif
     GLctx.bindVertexArray(GL.vaos[vao]);
 #endif
+#if GL_STATE_CACHE
+    // The GL_ELEMENT_ARRAY_BUFFER binding is part of the VAO state.
+    GLctx.stateCache.buffers[0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/] = undefined;
+#endif
 #if FULL_ES2 || LEGACY_GL_EMULATION
     var ibo = GLctx.getParameter(0x8895 /*ELEMENT_ARRAY_BUFFER_BINDING*/);
     GLctx.currentElementArrayBufferBinding = ibo ? (ibo.name | 0) : 0;
@@ -3788,20 +4119,20 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
 
   glDrawElements: (mode, count, type, indices) => {
 #if FULL_ES2
-    var buf;
+    var vertexCount = count;
     if (!GLctx.currentElementArrayBufferBinding) {
+      // With client-side indices we can tell how many vertices the draw reads
+      // from client-side attributes.
+      vertexCount = GL.maxClientIndex(type, indices, count) + 1;
+      var stream = GL.currentContext.streamingIndexBuffer ||= GL.createStreamingBuffer(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/);
+      GLctx.bindBuffer(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/, stream.buffer);
       var size = GL.calcBufLength(1, type, 0, count);
-      buf = GL.getTempIndexBuffer(size);
-      GLctx.bindBuffer(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/, buf);
-      GLctx.bufferSubData(0x8893 /*GL_ELEMENT_ARRAY_BUFFER*/,
-                          0,
-                          HEAPU8.subarray(indices, indices + size));
-      // the index is now 0
-      indices = 0;
+      GL.reserveStreamingSpace(stream, size, 1);
+      indices = GL.streamClientData(stream, indices, size);
     }
 
     // bind any client-side buffers
-    GL.preDrawHandleClientVertexAttribBindings(count);
+    GL.preDrawHandleClientVertexAttribBindings(vertexCount);
 #endif
 
     GLctx.drawElements(mode, count, type, indices);
@@ -3905,6 +4236,14 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
   },
 
   glDepthMask: (flag) => {
+#if GL_STATE_CACHE
+    var cache = GLctx.stateCache;
+    if (cache.depthMask === !!flag) {
+      GL.countElidedCall('glDepthMask');
+      return;
+    }
+    cache.depthMask = !!flag;
+#endif
     GLctx.depthMask(!!flag);
   },
 
@@ -3912,6 +4251,97 @@ for (/**@suppress{duplicate}*/var i = 0; i < {{{ GL_POOL_TEMP_BUFFERS_SIZE }}};
     GLctx.sampleCoverage(value, !!invert);
   },
 
+#if GL_STATE_CACHE
+  // These are simple pass-through functions (see glPassthroughFuncs below)
+  // unless GL_STATE_CACHE is set, in which case calls that would not change
+  // the cached state are dropped.
+
+  glEnable: (cap) => {
+    var caps = GLctx.stateCache.caps;
+    if (caps[cap] === true) {
+      GL.countElidedCall('glEnable');
+      return;
+    }
+    caps[cap] = true;
+    GLctx.enable(cap);
+  },
+
+  glDisable: (cap) => {
+    var caps = GLctx.stateCache.caps;
+    if (caps[cap] === false) {
+      GL.countElidedCall('glDisable');
+      return;
+    }
+    caps[cap] = false;
+    GLctx.disable(cap);
+  },
+
+  glActiveTexture: (texture) => {
+    var cache = GLctx.stateCache;
+    if (cache.activeTexture === texture) {
+      GL.countElidedCall('glActiveTexture');
+      return;
+    }
+    cache.activeTexture = texture;
+    GLctx.activeTexture(texture);
+  },
+
+  glBlendFunc: (sfactor, dfactor) => {
+    var f = GLctx.stateCache.blendFunc;
+    if (f[0] === sfactor && f[1] === dfactor && f[2] === sfactor && f[3] === dfactor) {
+      GL.countElidedCall('glBlendFunc');
+      return;
+    }
+    f[0] = f[2] = sfactor;
+    f[1] = f[3] = dfactor;
+    GLctx.blendFunc(sfactor, dfactor);
+  },
+
+  glBlendFuncSeparate: (srcRGB, dstRGB, srcAlpha, dstAlpha) => {
+    var f = GLctx.stateCache.blendFunc;
+    if (f[0] === srcRGB && f[1] === dstRGB && f[2] === srcAlpha && f[3] === dstAlpha) {
+      GL.countElidedCall('glBlendFuncSeparate');
+      return;
+    }
+    f[0] = srcRGB;
+    f[1] = dstRGB;
+    f[2] = srcAlpha;
+    f[3] = dstAlpha;
+    GLctx.blendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+  },
+
+  glBlendEquation: (mode) => {
+    var e = GLctx.stateCache.blendEquation;
+    if (e[0] === mode && e[1] === mode) {
+      GL.countElidedCall('glBlendEquation');
+      return;
+    }
+    e[0] = e[1] = mode;
+    GLctx.blendEquation(mode);
+  },
+
+  glBlendEquationSeparate: (modeRGB, modeAlpha) => {
+    var e = GLctx.stateCache.blendEquation;
+    if (e[0] === modeRGB && e[1] === modeAlpha) {
+      GL.countElidedCall('glBlendEquationSeparate');
+      return;
+    }
+    e[0] = modeRGB;
+    e[1] = modeAlpha;
+    GLctx.blendEquationSeparate(modeRGB, modeAlpha);
+  },
+
+  glDepthFunc: (func) => {
+    var cache = GLctx.stateCache;
+    if (cache.depthFunc === func) {
+      GL.countElidedCall('glDepthFunc');
+      return;
+    }
+    cache.depthFunc = func;
+    GLctx.depthFunc(func);
+  },
+#endif
+
   glMultiDrawArraysWEBGL__sig: 'vippi',
   glMultiDrawArrays: 'glMultiDrawArraysWEBGL',
   glMultiDrawArraysANGLE: 'glMultiDrawArraysWEBGL',
@@ -4210,6 +4640,10 @@ function createGLPassthroughFunctions(lib, funcs) {
         name = cName.slice(0, -1);
       }
       cName = 'gl' + cName[0].toUpperCase() + cName.substr(1);
+#if GL_STATE_CACHE
+      // Implemented in LibraryGL instead, to drop redundant calls.
+      if (cName in lib) return;
+#endif
       assert(!(cName in lib), "Cannot reimplement the existing function " + cName);
       lib[cName] = eval(stub.replace('NAME', name));
       assert(lib[cName + '__sig'] || LibraryManager.library[cName + '__sig'], 'missing sig for ' + cName);
@@ -488,6 +488,10 @@ var LibraryWebGL2 = {
     GL.validateGLObjectID(GL.buffers, buffer, 'glBindBufferBase', 'buffer');
 #endif
     GLctx.bindBufferBase(target, index, GL.buffers[buffer]);
+#if GL_STATE_CACHE
+    // This also binds the buffer to the generic binding point of `target`.
+    GLctx.stateCache.buffers[target] = buffer;
+#endif
   },
 
   glBindBufferRange: (target, index, buffer, offset, ptrsize) => {
@@ -495,6 +499,9 @@ var LibraryWebGL2 = {
     GL.validateGLObjectID(GL.buffers, buffer, 'glBindBufferRange', 'buffer');
 #endif
     GLctx.bindBufferRange(target, index, GL.buffers[buffer], offset, ptrsize);
+#if GL_STATE_CACHE
+    GLctx.stateCache.buffers[target] = buffer;
+#endif
   },
 
   glGetUniformIndices: (program, uniformCount, uniformNames, uniformIndices) => {
@@ -35,6 +35,21 @@ wgpu${type}Reference: (id) => WebGPU.mgr${type}.reference(id),
 wgpu${type}Release: (id) => WebGPU.mgr${type}.release(id),`;
     },
 
+    // Calls setBindGroup on a pass or bundle encoder, passing the dynamic
+    // offsets as a range of the heap rather than an array built per call.
+    makeSetBindGroup: function(encoder) {
+      // WebGPU does not accept views of shared memory, so copy those.
+      var offsets = SHARED_MEMORY ?
+        `HEAPU32.slice(${getHeapOffset('dynamicOffsetsPtr', 'u32')}, ${getHeapOffset('dynamicOffsetsPtr', 'u32')} + dynamicOffsetCount)` :
+        `HEAPU32, ${getHeapOffset('dynamicOffsetsPtr', 'u32')}, dynamicOffsetCount`;
+      return `
+    if (dynamicOffsetCount == 0) {
+      ${encoder}.setBindGroup(groupIndex, group);
+    } else {
+      ${encoder}.setBindGroup(groupIndex, group, ${offsets});
+    }`;
+    },
+
     convertSentinelToUndefined: function(name) {
       return `if (${name} == -1) ${name} = undefined;`;
     },
@@ -50,8 +65,9 @@ wgpu${type}Release: (id) => WebGPU.mgr${type}.release(id),`;
       var h = makeGetValue(`(${struct} + 4)`, offset, 'u32')
       return `${h} * 0x100000000 + ${l}`
     },
-    makeCheck: function(str) {
+    makeCheck: function(str, message) {
       if (!ASSERTIONS) return '';
+      if (message) return `assert(${str}, ${JSON.stringify(message)});`;
       return `assert(${str});`;
     },
     makeCheckDefined: function(name) {
@@ -188,36 +204,72 @@ var LibraryWebGPU = {
     initManagers: () => {
       if (WebGPU.mgrDevice) return;
 
+      // The low bits of an id are the index of the object's slot in the
+      // tables of its manager, and the high bits are the generation of the
+      // slot, which changes every time the slot is freed, so that an id that
+      // was released does not alias the object that reuses its slot. Ids stay
+      // below 2**31 so that they are positive in wasm32 and never 0, which is
+      // the null handle, as slot 0 is never used.
+      var SLOT_BITS = 20;
+      var SLOT_MASK = (1 << SLOT_BITS) - 1;
+      var GENERATION_MASK = (1 << (31 - SLOT_BITS)) - 1;
+
       /** @constructor */
       function Manager() {
-        this.objects = {};
-        this.nextId = 1;
-        this.create = function(object, wrapper = {}) {
-          var id = this.nextId++;
-          {{{ gpu.makeCheck("typeof this.objects[id] == 'undefined'") }}}
-          wrapper.refcount = 1;
-          wrapper.object = object;
-          this.objects[id] = wrapper;
-          return id;
+        // Dense tables indexed by slot. Wrappers hold the extra state that
+        // some types keep along with the object (e.g. buffer mappings).
+        this.objects = [undefined];
+        this.wrappers = [undefined];
+        this.refcounts = [0];
+        this.generations = [0];
+        this.freeSlots = [];
+        this.create = function(object, wrapper) {
+          var slot = this.freeSlots.pop();
+          if (slot === undefined) {
+            slot = this.objects.length;
+            // A larger slot would spill into the generation bits, and the id
+            // would alias the object in another slot.
+            if (slot > SLOT_MASK) abort(`too many live WebGPU objects of one type (${SLOT_MASK})`);
+            this.objects.push(object);
+            this.wrappers.push(wrapper);
+            this.refcounts.push(1);
+            this.generations.push(0);
+          } else {
+            this.objects[slot] = object;
+            this.wrappers[slot] = wrapper;
+            this.refcounts[slot] = 1;
+          }
+          if (wrapper) wrapper.object = object;
+          return (this.generations[slot] << SLOT_BITS) | slot;
+        };
+#if ASSERTIONS
+        this.isLive = function(id) {
+          var slot = id & SLOT_MASK;
+          return slot > 0 && slot < this.objects.length &&
+                 this.refcounts[slot] > 0 && this.generations[slot] == id >>> SLOT_BITS;
         };
+#endif
         this.get = function(id) {
-          if (!id) return undefined;
-          var o = this.objects[id];
-          {{{ gpu.makeCheckDefined('o') }}}
-          return o.object;
+          // Slot 0 holds undefined, which is what the null handle maps to.
+          {{{ gpu.makeCheck('!id || this.isLive(id)', 'invalid or released WebGPU handle') }}}
+          return this.objects[id & SLOT_MASK];
+        };
+        this.getWrapper = function(id) {
+          {{{ gpu.makeCheck('this.isLive(id)', 'invalid or released WebGPU handle') }}}
+          return this.wrappers[id & SLOT_MASK];
         };
         this.reference = function(id) {
-          var o = this.objects[id];
-          {{{ gpu.makeCheckDefined('o') }}}
-          o.refcount++;
+          {{{ gpu.makeCheck('this.isLive(id)', 'invalid or released WebGPU handle') }}}
+          this.refcounts[id & SLOT_MASK]++;
         };
         this.release = function(id) {
-          var o = this.objects[id];
-          {{{ gpu.makeCheckDefined('o') }}}
-          {{{ gpu.makeCheck('o.refcount > 0') }}}
-          o.refcount--;
-          if (o.refcount <= 0) {
-            delete this.objects[id];
+          {{{ gpu.makeCheck('this.isLive(id)', 'invalid or released WebGPU handle') }}}
+          var slot = id & SLOT_MASK;
+          if (--this.refcounts[slot] <= 0) {
+            this.objects[slot] = undefined;
+            this.wrappers[slot] = undefined;
+            this.generations[slot] = (this.generations[slot] + 1) & GENERATION_MASK;
+            this.freeSlots.push(slot);
           }
         };
       }
@@ -735,7 +787,7 @@ var LibraryWebGPU = {
   // *Destroy
 
   wgpuBufferDestroy: (bufferId) => {
-    var bufferWrapper = WebGPU.mgrBuffer.objects[bufferId];
+    var bufferWrapper = WebGPU.mgrBuffer.getWrapper(bufferId);
     {{{ gpu.makeCheckDefined('bufferWrapper') }}}
     if (bufferWrapper.onUnmap) {
       for (var i = 0; i < bufferWrapper.onUnmap.length; ++i) {
@@ -767,7 +819,7 @@ var LibraryWebGPU = {
   wgpuDeviceDestroy: (deviceId) => WebGPU.mgrDevice.get(deviceId).destroy(),
 
   wgpuDeviceGetLimits: (deviceId, limitsOutPtr) => {
-    var device = WebGPU.mgrDevice.objects[deviceId].object;
+    var device = WebGPU.mgrDevice.get(deviceId);
     var limitsPtr = {{{ C_STRUCTS.WGPUSupportedLimits.limits }}};
     function setLimitValueU32(name, limitOffset) {
       var limitValue = device.limits[name];
@@ -816,7 +868,7 @@ var LibraryWebGPU = {
   },
 
   wgpuDeviceGetQueue: (deviceId) => {
-    var queueId = WebGPU.mgrDevice.objects[deviceId].queueId;
+    var queueId = WebGPU.mgrDevice.getWrapper(deviceId).queueId;
 #if ASSERTIONS
     assert(queueId, 'wgpuDeviceGetQueue: queue was missing or null');
 #endif
@@ -1937,7 +1989,7 @@ var LibraryWebGPU = {
   // And library_webgpu assumes that size_t is always 32bit in emscripten.
   wgpuBufferGetConstMappedRange__deps: ['$warnOnce', 'memalign', 'free'],
   wgpuBufferGetConstMappedRange: (bufferId, offset, size) => {
-    var bufferWrapper = WebGPU.mgrBuffer.objects[bufferId];
+    var bufferWrapper = WebGPU.mgrBuffer.getWrapper(bufferId);
     {{{ gpu.makeCheckDefined('bufferWrapper') }}}
 
     if (size === 0) warnOnce('getMappedRange size=0 no longer means WGPU_WHOLE_MAP_SIZE');
@@ -1969,7 +2021,7 @@ var LibraryWebGPU = {
   // And library_webgpu assumes that size_t is always 32bit in emscripten.
   wgpuBufferGetMappedRange__deps: ['$warnOnce', 'memalign', 'free'],
   wgpuBufferGetMappedRange: (bufferId, offset, size) => {
-    var bufferWrapper = WebGPU.mgrBuffer.objects[bufferId];
+    var bufferWrapper = WebGPU.mgrBuffer.getWrapper(bufferId);
     {{{ gpu.makeCheckDefined('bufferWrapper') }}}
 
     if (size === 0) warnOnce('getMappedRange size=0 no longer means WGPU_WHOLE_MAP_SIZE');
@@ -2008,7 +2060,7 @@ var LibraryWebGPU = {
   // And library_webgpu assumes that size_t is always 32bit in emscripten.
   wgpuBufferMapAsync__deps: ['$callUserCallback'],
   wgpuBufferMapAsync: (bufferId, mode, offset, size, callback, userdata) => {
-    var bufferWrapper = WebGPU.mgrBuffer.objects[bufferId];
+    var bufferWrapper = WebGPU.mgrBuffer.getWrapper(bufferId);
     {{{ gpu.makeCheckDefined('bufferWrapper') }}}
     bufferWrapper.mapMode = mode;
     bufferWrapper.onUnmap = [];
@@ -2050,7 +2102,7 @@ var LibraryWebGPU = {
   },
 
   wgpuBufferUnmap: (bufferId) => {
-    var bufferWrapper = WebGPU.mgrBuffer.objects[bufferId];
+    var bufferWrapper = WebGPU.mgrBuffer.getWrapper(bufferId);
     {{{ gpu.makeCheckDefined('bufferWrapper') }}}
 
     if (!bufferWrapper.onUnmap) {
@@ -2152,15 +2204,7 @@ var LibraryWebGPU = {
   wgpuComputePassEncoderSetBindGroup: (passId, groupIndex, groupId, dynamicOffsetCount, dynamicOffsetsPtr) => {
     var pass = WebGPU.mgrComputePassEncoder.get(passId);
     var group = WebGPU.mgrBindGroup.get(groupId);
-    if (dynamicOffsetCount == 0) {
-      pass.setBindGroup(groupIndex, group);
-    } else {
-      var offsets = [];
-      for (var i = 0; i < dynamicOffsetCount; i++, dynamicOffsetsPtr += 4) {
-        offsets.push({{{ gpu.makeGetU32('dynamicOffsetsPtr', 0) }}});
-      }
-      pass.setBindGroup(groupIndex, group, offsets);
-    }
+    {{{ gpu.makeSetBindGroup('pass') }}}
   },
   wgpuComputePassEncoderSetLabel: (passId, labelPtr) => {
     var pass = WebGPU.mgrComputePassEncoder.get(passId);
@@ -2216,15 +2260,7 @@ var LibraryWebGPU = {
   wgpuRenderPassEncoderSetBindGroup: (passId, groupIndex, groupId, dynamicOffsetCount, dynamicOffsetsPtr) => {
     var pass = WebGPU.mgrRenderPassEncoder.get(passId);
     var group = WebGPU.mgrBindGroup.get(groupId);
-    if (dynamicOffsetCount == 0) {
-      pass.setBindGroup(groupIndex, group);
-    } else {
-      var offsets = [];
-      for (var i = 0; i < dynamicOffsetCount; i++, dynamicOffsetsPtr += 4) {
-        offsets.push({{{ gpu.makeGetU32('dynamicOffsetsPtr', 0) }}});
-      }
-      pass.setBindGroup(groupIndex, group, offsets);
-    }
+    {{{ gpu.makeSetBindGroup('pass') }}}
   },
   wgpuRenderPassEncoderSetBlendConstant: (passId, colorPtr) => {
     var pass = WebGPU.mgrRenderPassEncoder.get(passId);
@@ -2341,15 +2377,7 @@ var LibraryWebGPU = {
   wgpuRenderBundleEncoderSetBindGroup: (bundleId, groupIndex, groupId, dynamicOffsetCount, dynamicOffsetsPtr) => {
     var pass = WebGPU.mgrRenderBundleEncoder.get(bundleId);
     var group = WebGPU.mgrBindGroup.get(groupId);
-    if (dynamicOffsetCount == 0) {
-      pass.setBindGroup(groupIndex, group);
-    } else {
-      var offsets = [];
-      for (var i = 0; i < dynamicOffsetCount; i++, dynamicOffsetsPtr += 4) {
-        offsets.push({{{ gpu.makeGetU32('dynamicOffsetsPtr', 0) }}});
-      }
-      pass.setBindGroup(groupIndex, group, offsets);
-    }
+    {{{ gpu.makeSetBindGroup('pass') }}}
   },
   wgpuRenderBundleEncoderSetIndexBuffer: (bundleId, bufferId, format, offset, size) => {
     var pass = WebGPU.mgrRenderBundleEncoder.get(bundleId);
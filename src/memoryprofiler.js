@@ -79,6 +79,18 @@ var emscriptenMemoryProfiler = {
   // The 2D drawing context on the canvas.
   drawContext: null,
 
+  // Snapshots of the allocator's heap statistics, taken at every UI update if
+  // the allocator implements emscripten_get_heap_stats(). Each sample is an
+  // array of the size_t fields of emscripten_heap_stats_t, see
+  // emscripten/heap_stats.h.
+  heapStatsSamples: [],
+
+  // The number of samples to keep and chart.
+  maxHeapStatsSamples: 300,
+
+  // The canvas DOM element to which to chart the heap statistics over time.
+  heapStatsCanvas: null,
+
   // Converts number f to string with at most two decimals, without redundant trailing zeros.
   truncDec(f = 0) {
     var str = f.toFixed(2);
@@ -272,7 +284,7 @@ var emscriptenMemoryProfiler = {
     var div;
     if (!emscriptenMemoryProfiler.memoryprofiler_summary) {
       div = document.createElement("div");
-      div.innerHTML = "<div style='border: 2px solid black; padding: 2px;'><canvas style='border: 1px solid black; margin-left: auto; margin-right: auto; display: block;' id='memoryprofiler_canvas' width='100%' height='50'></canvas><input type='checkbox' id='showHeapResizes' onclick='emscriptenMemoryProfiler.updateUi()'>Display heap and sbrk() resizes. Filter sbrk() and heap resize callstacks by keywords: <input type='text' id='sbrkFilter'>(reopen page with ?sbrkFilter=foo,bar query params to prepopulate this list)<br/>Track all allocation sites larger than <input id='memoryprofiler_min_tracked_alloc_size' type=number value="+emscriptenMemoryProfiler.trackedCallstackMinSizeBytes+"></input> bytes, and all allocation sites with more than <input id='memoryprofiler_min_tracked_alloc_count' type=number value="+emscriptenMemoryProfiler.trackedCallstackMinAllocCount+"></input> outstanding allocations. (visit this page via URL query params foo.html?trackbytes=1000&trackcount=100 to apply custom thresholds starting from page load)<br/><div id='memoryprofiler_summary'></div><input id='memoryprofiler_clear_alloc_stats' type='button' value='Clear alloc stats' ></input><br />Sort allocations by:<select id='memoryProfilerSort'><option value='bytes'>Bytes</option><option value='count'>Count</option><option value='fixed'>Fixed</option></select><div id='memoryprofiler_ptrs'></div>";
+      div.innerHTML = "<div style='border: 2px solid black; padding: 2px;'><canvas style='border: 1px solid black; margin-left: auto; margin-right: auto; display: block;' id='memoryprofiler_canvas' width='100%' height='50'></canvas><canvas style='border: 1px solid black; margin-left: auto; margin-right: auto; display: block;' id='memoryprofiler_heapstats_canvas' width='100%' height='100'></canvas><input type='checkbox' id='showHeapResizes' onclick='emscriptenMemoryProfiler.updateUi()'>Display heap and sbrk() resizes. Filter sbrk() and heap resize callstacks by keywords: <input type='text' id='sbrkFilter'>(reopen page with ?sbrkFilter=foo,bar query params to prepopulate this list)<br/>Track all allocation sites larger than <input id='memoryprofiler_min_tracked_alloc_size' type=number value="+emscriptenMemoryProfiler.trackedCallstackMinSizeBytes+"></input> bytes, and all allocation sites with more than <input id='memoryprofiler_min_tracked_alloc_count' type=number value="+emscriptenMemoryProfiler.trackedCallstackMinAllocCount+"></input> outstanding allocations. (visit this page via URL query params foo.html?trackbytes=1000&trackcount=100 to apply custom thresholds starting from page load)<br/><div id='memoryprofiler_summary'></div><input id='memoryprofiler_clear_alloc_stats' type='button' value='Clear alloc stats' ></input><br />Sort allocations by:<select id='memoryProfilerSort'><option value='bytes'>Bytes</option><option value='count'>Count</option><option value='fixed'>Fixed</option></select><div id='memoryprofiler_ptrs'></div>";
     }
     var populateHtmlBody = function() {
       if (div) {
@@ -297,6 +309,7 @@ var emscriptenMemoryProfiler = {
       self.canvas = document.getElementById('memoryprofiler_canvas');
       self.canvas.width = document.documentElement.clientWidth - 32;
       self.drawContext = self.canvas.getContext('2d');
+      self.heapStatsCanvas = document.getElementById('memoryprofiler_heapstats_canvas');
 
       self.updateUi();
       setInterval(() => emscriptenMemoryProfiler.updateUi(), self.uiUpdateIntervalMsecs);
@@ -453,6 +466,58 @@ var emscriptenMemoryProfiler = {
     return html;
   },
 
+  // Appends a sample of emscripten_get_heap_stats() to heapStatsSamples, and
+  // returns it, or returns null if the allocator does not support it.
+  sampleHeapStats() {
+    var self = emscriptenMemoryProfiler;
+    if (typeof _emscripten_get_heap_stats != 'function') return null;
+    // heap_size .. largest_free_block, and the two size class histograms.
+    var numFields = 8 + 2 * 32;
+    var sp = stackSave();
+    var ptr = stackAlloc(numFields * {{{ POINTER_SIZE }}});
+    var sample = null;
+    if (_emscripten_get_heap_stats(ptr) == 0) {
+      sample = [];
+      for (var i = 0; i < numFields; ++i) {
+        sample.push({{{ makeGetValue('ptr', 'i * ' + POINTER_SIZE, '*') }}});
+      }
+      self.heapStatsSamples.push(sample);
+      if (self.heapStatsSamples.length > self.maxHeapStatsSamples) self.heapStatsSamples.shift();
+    }
+    stackRestore(sp);
+    return sample;
+  },
+
+  // Charts the footprint, allocated bytes and free bytes of the heap over the
+  // collected samples.
+  drawHeapStats() {
+    var self = emscriptenMemoryProfiler;
+    var canvas = self.heapStatsCanvas;
+    if (!canvas) return;
+    if (canvas.width != self.canvas.width) canvas.width = self.canvas.width;
+    var ctx = canvas.getContext('2d');
+    ctx.fillStyle = '#FFFFFF';
+    ctx.fillRect(0, 0, canvas.width, canvas.height);
+    var samples = self.heapStatsSamples;
+    var max = 1;
+    for (var s of samples) max = Math.max(max, s[1], s[2]);
+    function plot(field, color) {
+      ctx.strokeStyle = color;
+      ctx.lineWidth = 2;
+      ctx.beginPath();
+      for (var i = 0; i < samples.length; ++i) {
+        var x = i * canvas.width / self.maxHeapStatsSamples;
+        var y = canvas.height - samples[i][field] * canvas.height / max;
+        if (i == 0) ctx.moveTo(x, y);
+        else ctx.lineTo(x, y);
+      }
+      ctx.stroke();
+    }
+    plot(1, '#202020'); // footprint
+    plot(4, '#0000FF'); // allocated_bytes
+    plot(6, '#70FF70'); // free_bytes
+  },
+
   // Main UI update entry point.
   updateUi() {
     // It is common to set 'overflow: hidden;' on canvas pages that do WebGL. When MemoryProfiler is being used, there will be a long block of text on the page, so force-enable scrolling.
@@ -517,6 +582,21 @@ var emscriptenMemoryProfiler = {
     html += '<br />OpenAL audio data: ' + self.formatBytes(self.countOpenALAudioDataSize()) + ' (outside HEAP)';
     html += '<br /># of total malloc()s/free()s performed in app lifetime: ' + self.totalTimesMallocCalled + '/' + self.totalTimesFreeCalled + ' (currently alive pointers: ' + (self.totalTimesMallocCalled-self.totalTimesFreeCalled) + ')';
 
+    var stats = self.sampleHeapStats();
+    if (stats) {
+      var fragmentation = stats[6] ? 1 - stats[7] / stats[6] : 0;
+      html += '<br />Allocator: ' + colorBar('#202020') + 'footprint: ' + self.formatBytes(stats[1]) + ' (peak ' + self.formatBytes(stats[2]) + '), ';
+      html += colorBar('#0000FF') + stats[3] + ' allocations: ' + self.formatBytes(stats[4]) + ', ';
+      html += colorBar('#70FF70') + stats[5] + ' free blocks: ' + self.formatBytes(stats[6]) + ', largest free block: ' + self.formatBytes(stats[7]) + ', fragmentation: ' + (fragmentation * 100).toFixed(2) + '%';
+      var classes = '';
+      for (var i = 0; i < 32; ++i) {
+        var allocs = stats[8 + i], frees = stats[8 + 32 + i];
+        if (allocs || frees) classes += ' [' + self.formatBytes(2 ** i) + ', ' + self.formatBytes(2 ** (i + 1)) + '): ' + allocs + '/' + frees + ';';
+      }
+      html += '<br />Allocations/free blocks by size:' + classes;
+      self.drawHeapStats();
+    }
+
     // Background clear
     self.drawContext.fillStyle = "#FFFFFF";
     self.drawContext.fillRect(0, 0, self.canvas.width, self.canvas.height);
@@ -120,6 +120,7 @@ globalThis.LibraryManager = {
         'library_glew.js',
         'library_idbstore.js',
         'library_async.js',
+        'library_glprofile.js',
       ]);
       if (USE_SDL != 2) {
         libraries.push('library_sdl.js');
@@ -168,6 +169,10 @@ globalThis.LibraryManager = {
       libraries.push('library_html5_webgpu.js');
     }
 
+    if (USE_WEBGPU || GL_PROFILE) {
+      libraries.push('library_glprofile.js');
+    }
+
     if (!STRICT) {
       libraries.push('library_legacy.js');
     }
@@ -377,6 +382,7 @@ function exportRuntime() {
     'FS_createFolder',
     'FS_createPath',
     'FS_createLazyFile',
+    'FS_createLazyDataFile',
     'FS_createLink',
     'FS_createDevice',
     'FS_readFile',
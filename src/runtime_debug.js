@@ -35,6 +35,7 @@ function isExportedByForceFilesystem(name) {
 #if !WASMFS
          // The old FS has some functionality that WasmFS lacks.
          name === 'FS_createLazyFile' ||
+         name === 'FS_createLazyDataFile' ||
          name === 'FS_createDevice' ||
 #endif
          name === 'removeRunDependency';
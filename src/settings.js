@@ -242,6 +242,21 @@ var MEMORY_GROWTH_GEOMETRIC_CAP = 96*1024*1024;
 // [link]
 var MEMORY_GROWTH_LINEAR_STEP = -1;
 
+// If set together with ALLOW_MEMORY_GROWTH, the memory is created at its
+// MAXIMUM_MEMORY size right away instead of being grown on demand. Engines
+// reserve the address space for the memory and only commit pages once they are
+// touched, so in practice memory usage still grows with the size of the heap,
+// but the memory never has to be resized. This removes the cost of calling into
+// JS from sbrk() to grow memory, and in builds with pthreads it avoids the
+// GROWABLE_HEAP_* checks that JS code otherwise needs before every heap access
+// to find out whether the memory was grown by another thread.
+// The downside is that the whole of MAXIMUM_MEMORY has to be available as
+// address space at startup, which may fail on 32-bit devices and is subject
+// to browser limits. For that reason MAXIMUM_MEMORY must be set explicitly,
+// and is best not much larger than what the application really needs.
+// [link]
+var RESERVE_MAXIMUM_MEMORY = false;
+
 // The "architecture" to compile for. 0 means the default wasm32, 1 is
 // the full end-to-end wasm64 mode, and 2 is wasm64 for clang/lld but lowered to
 // wasm32 in Binaryen (such that it can run on wasm32 engines, while internally
@@ -436,6 +451,15 @@ var GL_ASSERTIONS = false;
 // [link]
 var TRACE_WEBGL_CALLS = false;
 
+// Counts and times the calls that compiled code makes into the WebGL and
+// WebGPU libraries, per entry point and per frame, along with the bytes of
+// buffer and texture data that they upload. The statistics are available
+// through emscripten/gl_profile.h, and from JS as Module.getGLProfile(). If 2,
+// every call is also recorded as an event for the Chrome trace that
+// emscripten_gl_profile_get_trace() and Module.getGLProfileTrace() return.
+// [link]
+var GL_PROFILE = 0;
+
 // Enables more verbose debug printing of WebGL related operations. As with
 // LIBRARY_DEBUG, this is toggleable at runtime with option GL.debug.
 // [link]
@@ -446,7 +470,9 @@ var GL_DEBUG = false;
 // [link]
 var GL_TESTING = false;
 
-// How large GL emulation temp buffers are
+// How large GL emulation temp buffers are. This is also the initial size of
+// the buffers that FULL_ES2 streams client-side vertex and index data through,
+// which grow as needed to fit the data of a single draw.
 // [link]
 var GL_MAX_TEMP_BUFFER_SIZE = 2097152;
 
@@ -500,6 +526,19 @@ var GL_SUPPORT_SIMPLE_ENABLE_EXTENSIONS = true;
 // [link]
 var GL_TRACK_ERRORS = true;
 
+// If true, the GL library keeps a shadow copy of the most commonly changed
+// pieces of context state (texture, buffer and program bindings, enabled caps,
+// blend and depth state, and the uniform values of each program), and drops
+// the calls that would not change it instead of forwarding them to WebGL. This
+// helps code that re-issues redundant state changes every frame, as is common
+// in engines ported from desktop GL. The number of dropped calls of each
+// function is counted in GL.stateCacheElided.
+// Note that state changed by calling the WebGL context directly from JS is not
+// seen by the cache, and that GL errors from dropped calls are not raised
+// again. Not compatible with LEGACY_GL_EMULATION.
+// [link]
+var GL_STATE_CACHE = false;
+
 // If true, GL contexts support the explicitSwapControl context creation flag.
 // Set to 0 to save a little bit of space on projects that do not need it.
 // [link]
@@ -571,6 +610,16 @@ var LEGACY_GL_EMULATION = false;
 // [link]
 var GL_FFP_ONLY = false;
 
+// If you specified LEGACY_GL_EMULATION = 1, set this to 1 to draw consecutive
+// glBegin()/glEnd() groups that render with the same state with a single draw
+// call, instead of one draw call per group. Groups of the GL_POINTS, GL_LINES,
+// GL_TRIANGLES and GL_QUADS modes are collected until the next call that could
+// change how they render, and any that are still pending are drawn before
+// control returns to the browser. If LEGACY_GL_EMULATION = 0, this setting has
+// no effect.
+// [link]
+var GL_IMMEDIATE_BATCHING = false;
+
 // If you want to create the WebGL context up front in JS code, set this to 1
 // and set Module['preinitializedWebGLContext'] to a precreated WebGL context.
 // WebGL initialization afterwards will use this GL context to render.
@@ -683,6 +732,23 @@ var ENVIRONMENT = 'web,webview,worker,node';
 // [link]
 var LZ4 = false;
 
+// Maximum number of bytes of decompressed chunks of LZ4-compressed packages
+// that are kept in memory for further reads. The least recently used chunks
+// are dropped first. The cache is shared by all packages.
+// [link]
+var LZ4_CACHE_SIZE = 1024*1024;
+
+// Number of web workers that decompress chunks of LZ4-compressed packages in
+// parallel. The chunks that follow a chunk that a read decompressed are
+// decompressed ahead in the workers, into the cache, and the files that
+// --use-preload-plugins hands to preload plugins are decompressed by all of
+// the workers at once. Reads that miss the cache still decompress on the main
+// thread. As each chunk is sent to a worker and back, this is only worth it
+// with chunks much larger than the default, see --lz4-chunk-size in the file
+// packager. 0 means that everything is decompressed on the main thread.
+// [link]
+var LZ4_WORKERS = 0;
+
 // Emscripten (JavaScript-based) exception handling options.
 // The three options below (DISABLE_EXCEPTION_CATCHING,
 // EXCEPTION_CATCHING_ALLOWED, and DISABLE_EXCEPTION_THROWING) only pertain to
@@ -921,6 +987,19 @@ var ASYNCIFY_LAZY_LOAD_CODE = false;
 // [link]
 var ASYNCIFY_DEBUG = 0;
 
+// Runtime profiling of asyncify unwinds and rewinds.  When enabled the runtime
+// counts unwinds and rewinds per import and per export, records a histogram of
+// the number of bytes saved per unwind, and measures the time spent rewinding.
+// The wasm functions seen on the stack during each unwind are also recorded.
+// The collected data is available via ``Module.getAsyncifyProfile()`` and is
+// printed when the runtime exits, along with suggested ``ASYNCIFY_IMPORTS``
+// and ``ASYNCIFY_ONLY`` lists that cover all the unwinds that were observed.
+// The function names are only available when the wasm has a name section (for
+// example, when building with ``--profiling-funcs``).
+// Only supported for ASYNCIFY==1 mode.
+// [link]
+var ASYNCIFY_PROFILE = false;
+
 // Specify which of the exports will have JSPI applied to them and return a
 // promise.
 // Only supported for ASYNCIFY==2 mode.
@@ -1741,6 +1820,15 @@ var EVAL_CTORS = 0;
 // [link]
 var TEXTDECODER = 1;
 
+// If enabled, UTF8ToString() finds the end of strings and transcodes strings of
+// up to 1KB to UTF-16 in Wasm (using the routines from emscripten/utf8.h),
+// rather than looping over the bytes in JS. This is mostly useful in
+// combination with -msimd128, which enables SIMD versions of those routines,
+// and in builds with shared memory, where TextDecoder first needs to copy the
+// string out of the heap. Longer strings still use TextDecoder if available.
+// [link]
+var WASM_UTF8_DECODING = false;
+
 // Embind specific: If enabled, assume UTF-8 encoded data in std::string binding.
 // Disable this to support binary data transfer.
 // [link]
@@ -262,6 +262,9 @@ var PTHREADS = false;
 
 var BULK_MEMORY = false;
 
+// Set when -msimd128 or -mrelaxed-simd is passed.
+var WASM_SIMD = false;
+
 var MINIFY_WHITESPACE = true;
 
 var ASYNCIFY_IMPORTS_EXCEPT_JS_LIBS = [];
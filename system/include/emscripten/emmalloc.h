@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <emscripten/heap_stats.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -127,6 +128,11 @@ size_t emmalloc_compute_free_dynamic_memory_fragmentation_map(size_t freeMemoryS
 // to stdout.
 void emmalloc_dump_free_dynamic_memory_fragmentation_map(void);
 
+// emmalloc's implementation of emscripten_get_heap_stats(), see
+// emscripten/heap_stats.h. Also available when emmalloc is used underneath
+// another allocator, as with -sMALLOC=mimalloc.
+int emmalloc_get_heap_stats(emscripten_heap_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,10 +21,14 @@ extern "C" {
 // handler.
 #define EMSCRIPTEN_FETCH_LOAD_TO_MEMORY  1
 
-// If passed, the intermediate streamed bytes will be passed in to the
-// onprogress() handler. If not specified, the onprogress() handler will still
-// be called, but without data bytes.  Note: Firefox only as it depends on
-// 'moz-chunked-arraybuffer'.
+// If passed, the response body is read incrementally using fetch() and passed
+// in to the onprogress() handler one chunk at a time, instead of being
+// buffered in full. The chunks are copied into the streamBuffer given in
+// emscripten_fetch_attr_t (see below), and the onsuccess() handler receives
+// no data. Use emscripten_fetch_pause() to apply backpressure. Not supported
+// together with EMSCRIPTEN_FETCH_SYNCHRONOUS or EMSCRIPTEN_FETCH_PERSIST_FILE.
+// If not specified, the onprogress() handler will still be called, but without
+// data bytes.
 #define EMSCRIPTEN_FETCH_STREAM_DATA 2
 
 // If passed, the final download will be stored in IndexedDB. If not specified,
@@ -65,6 +69,19 @@ extern "C" {
 // fetch to test or wait for its completion.
 #define EMSCRIPTEN_FETCH_WAITABLE 128
 
+// The size of the stream buffer that is allocated for
+// EMSCRIPTEN_FETCH_STREAM_DATA transfers if the caller does not supply one.
+#define EMSCRIPTEN_FETCH_DEFAULT_STREAM_BUFFER_SIZE 65536
+
+// Priority classes for the 'priority' field of emscripten_fetch_attr_t. When
+// the number of concurrent requests to an origin is limited (see
+// emscripten_fetch_set_max_concurrent_per_origin()), queued requests of a
+// higher priority class are started before those of a lower one. Requests of
+// the same class are started in the order they were issued.
+#define EMSCRIPTEN_FETCH_PRIORITY_LOW    -1
+#define EMSCRIPTEN_FETCH_PRIORITY_NORMAL  0
+#define EMSCRIPTEN_FETCH_PRIORITY_HIGH    1
+
 struct emscripten_fetch_t;
 
 // Specifies the parameters for a newly initiated fetch operation.
@@ -133,6 +150,24 @@ typedef struct emscripten_fetch_attr_t {
   // Specifies the length of the buffer pointed by 'requestData'. Leave as 0 if
   // no request body needs to be sent.
   size_t requestDataSize;
+
+  // If EMSCRIPTEN_FETCH_STREAM_DATA is specified, the response body is copied
+  // into this buffer one chunk of at most 'streamBufferSize' bytes at a time,
+  // and each chunk is passed to the onprogress() handler with 'data' pointing
+  // into this buffer. The buffer is reused for every chunk, so the contents are
+  // only valid until the onprogress() handler returns. The memory is provided
+  // by the user and must stay valid until the fetch finishes or is closed. If
+  // null, a buffer of 'streamBufferSize' bytes (or
+  // EMSCRIPTEN_FETCH_DEFAULT_STREAM_BUFFER_SIZE bytes if that is zero) is
+  // allocated, and freed by emscripten_fetch_close().
+  char *streamBuffer;
+
+  // The size of 'streamBuffer' in bytes.
+  size_t streamBufferSize;
+
+  // One of the EMSCRIPTEN_FETCH_PRIORITY_* classes. Defaults to
+  // EMSCRIPTEN_FETCH_PRIORITY_NORMAL.
+  int32_t priority;
 } emscripten_fetch_attr_t;
 
 typedef struct emscripten_fetch_t {
@@ -152,8 +187,9 @@ typedef struct emscripten_fetch_t {
   // In onprogress() handler:
   //   - If the EMSCRIPTEN_FETCH_STREAM_DATA attribute was specified for the
   //     transfer, this points to a partial chunk of bytes related to the
-  //     transfer. Otherwise this will be null.
-  // The data buffer provided here has identical lifetime with the
+  //     transfer, inside the stream buffer. This is only valid until the
+  //     onprogress() handler returns. Otherwise this will be null.
+  // The data buffer provided in onsuccess() has identical lifetime with the
   // emscripten_fetch_t object itself, and is freed by calling
   // emscripten_fetch_close() on the emscripten_fetch_t pointer.
   const char *data;
@@ -218,6 +254,69 @@ EMSCRIPTEN_RESULT emscripten_fetch_wait(emscripten_fetch_t * _Nonnull fetch, dou
 // in the calling thread before this function returns.
 EMSCRIPTEN_RESULT emscripten_fetch_close(emscripten_fetch_t * _Nonnull fetch);
 
+// Stops delivering chunks of an EMSCRIPTEN_FETCH_STREAM_DATA transfer to the
+// onprogress() handler, e.g. because the consumer of the data cannot keep up.
+// This can be called from within onprogress(), in which case that is the last
+// chunk delivered until emscripten_fetch_resume() is called. While paused, the
+// response stream is not read from, so the browser in turn stops reading from
+// the network once its internal queue is full. Returns
+// EMSCRIPTEN_RESULT_NOT_SUPPORTED if the fetch is not streaming.
+// This must be called on the same thread as the fetch originated on.
+EMSCRIPTEN_RESULT emscripten_fetch_pause(emscripten_fetch_t * _Nonnull fetch);
+
+// Resumes delivering chunks of a transfer paused with emscripten_fetch_pause().
+// This must be called on the same thread as the fetch originated on.
+EMSCRIPTEN_RESULT emscripten_fetch_resume(emscripten_fetch_t * _Nonnull fetch);
+
+// Limits the number of network requests that may be in progress at the same
+// time for each origin. Further requests to an origin that is at its limit are
+// queued until one of its requests finishes, and are then started in priority
+// order (see EMSCRIPTEN_FETCH_PRIORITY_*). Closing a queued fetch with
+// emscripten_fetch_close() removes it from the queue. Pass 0 (the default) for
+// no limit. Synchronous fetches are never queued.
+// The limit applies to the fetches issued on the calling thread.
+void emscripten_fetch_set_max_concurrent_per_origin(unsigned int maxRequests);
+
+// If enabled, a GET request that is identical to one that is already queued or
+// in progress (same URL, headers, credentials and attributes) does not make a
+// request of its own, but receives a copy of the response of the earlier one.
+// Fetches with a request body, EMSCRIPTEN_FETCH_STREAM_DATA or
+// EMSCRIPTEN_FETCH_PERSIST_FILE are never deduplicated. Disabled by default.
+// This applies to the fetches issued on the calling thread.
+void emscripten_fetch_set_deduplication(EM_BOOL enabled);
+
+typedef struct emscripten_fetch_stats_t {
+  // Number of fetches that are waiting for their origin to drop below its
+  // concurrency limit.
+  uint32_t queued;
+
+  // Number of network requests that are currently in progress.
+  uint32_t inFlight;
+
+  // Number of fetches that are waiting for an identical request to finish.
+  uint32_t waiting;
+
+  // Total number of network requests that were started and that finished
+  // (successfully or not).
+  uint32_t started;
+  uint32_t completed;
+
+  // Total number of fetches that were served by the request of another fetch,
+  // and that were closed before they finished.
+  uint32_t deduplicated;
+  uint32_t cancelled;
+
+  // Total number of bytes of response bodies received from the network.
+  uint64_t bytesReceived;
+
+  // Average download rate, measured over the time that at least one network
+  // request was in progress.
+  double bytesPerSecond;
+} emscripten_fetch_stats_t;
+
+// Fills in 'stats' with the state of the fetches issued on the calling thread.
+EMSCRIPTEN_RESULT emscripten_fetch_get_stats(emscripten_fetch_stats_t * _Nonnull stats);
+
 // Gets the size (in bytes) of the response headers as plain text.
 // This must be called on the same thread as the fetch originated on.
 // Note that this will return 0 if readyState < HEADERS_RECEIVED.
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Per-frame statistics of the calls that compiled code makes into the WebGL
+// (gl*) and WebGPU (wgpu*) libraries. Only available when linking with
+// -sGL_PROFILE; otherwise the functions below report failure.
+//
+// A frame ends right before each call of the emscripten_set_main_loop() or
+// emscripten_request_animation_frame_loop() callback, and when
+// emscripten_gl_profile_end_frame() is called, so the first frame also
+// contains the calls made during startup. The profile is kept separately for
+// each thread.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct emscripten_gl_profile_t {
+  // Milliseconds spent in JS inside the entry points.
+  double time;
+  // Number of calls to the entry points.
+  uint32_t calls;
+  // Number of those calls that were draw calls (glDraw*, glMultiDraw* and
+  // wgpu*EncoderDraw*).
+  uint32_t draw_calls;
+  // Bytes of buffer and texture data uploaded by the calls. This includes the
+  // client-side vertex and index data that -sFULL_ES2 draws upload.
+  uint32_t uploaded_bytes;
+} emscripten_gl_profile_t;
+
+// Ends the current frame. Only needed when rendering from callbacks that are
+// not driven by the main loop functions mentioned above.
+void emscripten_gl_profile_end_frame(void);
+
+// Returns the number of frames that have ended so far.
+int emscripten_gl_profile_get_frame_count(void);
+
+// Fills in `stats` with the totals of the most recently ended frame. Returns 0
+// on success, or -1 if no frame has ended yet or -sGL_PROFILE is not set.
+int emscripten_gl_profile_get_last_frame(emscripten_gl_profile_t *stats);
+
+// Fills in `stats` with the largest value that each field has had in any frame
+// that has ended, which is what per-frame budgets are usually checked
+// against. Returns 0 on success, or -1 as above.
+int emscripten_gl_profile_get_max_frame(emscripten_gl_profile_t *stats);
+
+// Fills in `stats` with the calls that the most recently ended frame made to
+// the entry point `name`, e.g. "glDrawElements" or "wgpuQueueWriteBuffer".
+// draw_calls is the same as calls for draw entry points, and 0 otherwise.
+// Returns 0 on success, or -1 as above.
+int emscripten_gl_profile_get_function(const char *name, emscripten_gl_profile_t *stats);
+
+// Returns the calls recorded so far in the Chrome trace event format, which
+// can be loaded into chrome://tracing or https://ui.perfetto.dev. Each call is
+// a complete ("X") event, and each frame is a "frame" event plus a counter
+// event with its totals. Calls are only recorded with -sGL_PROFILE=2, and at
+// most 1048576 of them are kept. The returned string is allocated with
+// malloc() and must be freed by the caller. Returns NULL if -sGL_PROFILE is
+// not set.
+char *emscripten_gl_profile_get_trace(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -37,6 +37,21 @@ size_t emscripten_get_heap_size(void);
 // Returns the max size of the WebAssembly heap.
 size_t emscripten_get_heap_max(void);
 
+// Like sbrk(), but serves small requests from a chunk of memory that is private
+// to the calling thread, so that threads allocating concurrently only contend
+// on the global program break once per chunk. This is intended for allocators
+// that keep per-thread arenas. Unlike sbrk(), consecutive calls do not return
+// contiguous memory if another thread called sbrk() in between, and memory
+// cannot be given back. Returns (void*)-1 and sets errno on failure. In builds
+// without shared memory this is the same as sbrk().
+//
+// None of the allocators that come with Emscripten use this: dlmalloc and
+// emmalloc take a global lock for every allocation anyway and expect sbrk()
+// to hand out contiguous memory, and mimalloc gets its segments from emmalloc.
+// It only helps custom allocators that refill per-thread arenas without taking
+// a global lock.
+void *emscripten_thread_sbrk(size_t size);
+
 // Direct access to the system allocator.  Use these to access that underlying
 // allocator when intercepting/wrapping the allocator API.  Works with with both
 // dlmalloc and emmalloc.
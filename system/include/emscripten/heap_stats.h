@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+// Allocator independent heap statistics, implemented by dlmalloc, emmalloc and
+// mimalloc. The statistics are gathered by walking the heap when
+// emscripten_get_heap_stats() is called, so they cost nothing until they are
+// asked for, and can be used in release builds.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of buckets in the size class histograms. Bucket i counts blocks with a
+// usable size in [2^i, 2^(i+1)) bytes, and the last bucket also counts
+// everything larger.
+#define EMSCRIPTEN_HEAP_STATS_SIZE_CLASSES 32
+
+// All fields are size_t and are read by index from JS by src/memoryprofiler.js,
+// so new fields must be added at the end.
+typedef struct emscripten_heap_stats_t {
+  // Current size of the WebAssembly memory.
+  size_t heap_size;
+  // Bytes that the allocator has obtained with sbrk(), and the highest value
+  // this has ever had.
+  size_t footprint;
+  size_t peak_footprint;
+  // Number of live allocations, and the sum of their usable sizes.
+  size_t num_allocations;
+  size_t allocated_bytes;
+  // Number of free blocks within the footprint, the sum of their sizes, and
+  // the size of the largest of them.
+  size_t num_free_blocks;
+  size_t free_bytes;
+  size_t largest_free_block;
+  // Histograms of live allocations and of free blocks by size class.
+  size_t allocations_by_size_class[EMSCRIPTEN_HEAP_STATS_SIZE_CLASSES];
+  size_t free_blocks_by_size_class[EMSCRIPTEN_HEAP_STATS_SIZE_CLASSES];
+} emscripten_heap_stats_t;
+
+// Fills in `stats` with a snapshot of the heap. This walks all blocks of the
+// heap while holding the allocator lock, so it takes time proportional to the
+// number of blocks. mimalloc keeps a separate heap per thread, and there only
+// the blocks of the calling thread's heap are counted as allocations and free
+// blocks, while the footprint covers the whole process.
+// Returns 0 on success, or -1 if the allocator does not support this (e.g.
+// with -sMALLOC=none).
+int emscripten_get_heap_stats(emscripten_heap_stats_t *stats);
+
+// Returns the size class (the histogram bucket) of a block of `size` bytes.
+static inline int emscripten_heap_stats_size_class(size_t size) {
+  if (!size) {
+    return 0;
+  }
+  int size_class = (int)(sizeof(size_t) * 8 - 1) - __builtin_clzl(size);
+  return size_class < EMSCRIPTEN_HEAP_STATS_SIZE_CLASSES ? size_class : EMSCRIPTEN_HEAP_STATS_SIZE_CLASSES - 1;
+}
+
+// Returns how fragmented the free memory is, from 0 when it is all in a single
+// block, towards 1 when it is split into many small blocks.
+static inline double emscripten_heap_stats_fragmentation(const emscripten_heap_stats_t *stats) {
+  if (!stats->free_bytes) {
+    return 0;
+  }
+  return 1.0 - (double)stats->largest_free_block / stats->free_bytes;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <uchar.h>
+
+// UTF-8 to UTF-16 transcoding. This is also used by UTF8ToString when building
+// with -sWASM_UTF8_DECODING, and has a Wasm SIMD fast path for runs of ASCII
+// when linking with -msimd128.
+//
+// Malformed input is handled like TextDecoder does: each maximal invalid UTF-8
+// subsequence is replaced by U+FFFD.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Transcodes the `len` bytes of UTF-8 at `src` to UTF-16 at `dst`, and returns
+// the number of UTF-16 code units written. This is never more than `len`, so
+// `dst` must have room for `len` code units. NUL bytes are transcoded like any
+// other character.
+size_t emscripten_utf8_to_utf16(const char *src, size_t len, char16_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
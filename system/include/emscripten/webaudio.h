@@ -129,6 +129,56 @@ typedef struct EmscriptenAudioWorkletNodeCreateOptions
 // userData4: A custom userdata pointer to pass to the callback function. This value will be passed on to the call to the given EmscriptenWorkletNodeProcessCallback callback function.
 EMSCRIPTEN_AUDIO_WORKLET_NODE_T emscripten_create_wasm_audio_worklet_node(EMSCRIPTEN_WEBAUDIO_T audioContext, const char *name, const EmscriptenAudioWorkletNodeCreateOptions *options, EmscriptenWorkletNodeProcessCallback processCallback, void *userData4);
 
+// A wait-free single-producer/single-consumer ring buffer of planar float audio in the shared Wasm heap. Use it to feed an
+// AudioWorkletNode from a pthread or a Wasm Worker without going through postMessage: the producer calls
+// emscripten_audio_ring_write*() and the consumer is either an AudioWorkletNode created with
+// emscripten_create_audio_ring_worklet_node(), which copies the data out in bulk on the audio thread without calling into Wasm,
+// or a Wasm process callback that calls emscripten_audio_ring_read().
+// Exactly one thread may write to a ring and exactly one thread may read from it at a time.
+typedef struct emscripten_audio_ring_t
+{
+	_Atomic uint32_t writeIndex; // Total number of frames written. Only modified by the producer.
+	_Atomic uint32_t readIndex; // Total number of frames read. Only modified by the consumer.
+	_Atomic uint32_t underruns; // Number of times the consumer wanted more frames than were available. The missing frames are output as silence.
+	_Atomic uint32_t overruns; // Number of times the producer tried to write more frames than there was space for. The excess frames are dropped.
+	uint32_t capacity; // Capacity of the ring in frames. Always a power of two.
+	uint32_t numChannels;
+	// numChannels*capacity floats, where data[channelIndex*capacity+i] locates the i'th sample slot of channel channelIndex.
+	float *data;
+} emscripten_audio_ring_t;
+
+// Initializes the given ring to hold up to 'capacity' frames of 'numChannels' channels, using 'data' as storage, which must
+// point to at least numChannels*capacity floats. 'capacity' must be a power of two. Returns EM_FALSE if the parameters are invalid.
+EM_BOOL emscripten_audio_ring_init(emscripten_audio_ring_t *ring, float *data, uint32_t capacity, uint32_t numChannels);
+
+// Allocates and initializes a new ring, including its storage. The capacity is rounded up to the next power of two.
+// Returns null on failure. Free the ring with emscripten_audio_ring_destroy() once no thread is using it anymore.
+emscripten_audio_ring_t *emscripten_audio_ring_create(uint32_t capacity, uint32_t numChannels);
+void emscripten_audio_ring_destroy(emscripten_audio_ring_t *ring);
+
+// Returns the number of frames that can currently be written without overrunning. Call from the producer thread.
+uint32_t emscripten_audio_ring_write_available(const emscripten_audio_ring_t *ring);
+// Returns the number of frames that can currently be read. Call from the consumer thread.
+uint32_t emscripten_audio_ring_read_available(const emscripten_audio_ring_t *ring);
+
+// Writes numFrames frames to the ring, reading channel c from channels[c][0..numFrames-1]. Returns the number of frames written.
+// If not all frames fit, the remaining ones are dropped and the overrun counter is incremented. Never blocks.
+uint32_t emscripten_audio_ring_write(emscripten_audio_ring_t *ring, const float *const *channels, uint32_t numFrames);
+// Like emscripten_audio_ring_write(), but reads numFrames frames of interleaved samples from 'samples'.
+uint32_t emscripten_audio_ring_write_interleaved(emscripten_audio_ring_t *ring, const float *samples, uint32_t numFrames);
+
+// Reads numFrames frames from the ring into 'dst', which receives numChannels planar channels of numFrames samples each, i.e.
+// in the same layout as AudioSampleFrame::data when numFrames is 128. Returns the number of frames read. If fewer frames were
+// available, the rest of 'dst' is filled with silence and the underrun counter is incremented. Never blocks.
+uint32_t emscripten_audio_ring_read(emscripten_audio_ring_t *ring, float *dst, uint32_t numFrames);
+
+// Instantiates the given AudioWorkletProcessor as an AudioWorkletNode that plays back the contents of the given ring, instead
+// of calling a Wasm process callback. Each render quantum is copied directly from the ring to the node's first output with
+// TypedArray.set(). If the output has more channels than the ring, the last ring channel is repeated to the remaining ones.
+// The processor must have been created with emscripten_create_wasm_audio_worklet_processor_async(), and the ring must stay
+// alive until the node has been destroyed.
+EMSCRIPTEN_AUDIO_WORKLET_NODE_T emscripten_create_audio_ring_worklet_node(EMSCRIPTEN_WEBAUDIO_T audioContext, const char *name, const EmscriptenAudioWorkletNodeCreateOptions *options, emscripten_audio_ring_t *ring);
+
 // Returns EM_TRUE if the current thread is executing a Wasm AudioWorklet, EM_FALSE otherwise.
 // Note that calling this function can be relatively slow as it incurs a Wasm->JS transition,
 // so avoid calling it in hot paths.
@@ -10,6 +10,8 @@
 #define UNSIGNED_MORECORE 1
 /* we can only grow the heap up anyhow, so don't try to trim */
 #define MORECORE_CANNOT_TRIM 1
+/* used by emscripten_get_heap_stats() */
+#define MALLOC_INSPECT_ALL 1
 #ifndef DLMALLOC_DEBUG
 /* dlmalloc has many checks, calls to abort() increase code size,
    leave them only in debug builds */
@@ -6087,6 +6089,38 @@ extern __typeof(free) emscripten_builtin_free __attribute__((alias("dlfree")));
 extern __typeof(memalign) emscripten_builtin_memalign __attribute__((alias("dlmemalign")));
 #endif
 
+#if defined(__EMSCRIPTEN__) && !ONLY_MSPACES
+#include <emscripten/heap.h>
+#include <emscripten/heap_stats.h>
+
+static void heap_stats_handler(void* start, void* end, size_t used_bytes, void* arg) {
+    emscripten_heap_stats_t* stats = (emscripten_heap_stats_t*)arg;
+    if (used_bytes) {
+        ++stats->num_allocations;
+        stats->allocated_bytes += used_bytes;
+        ++stats->allocations_by_size_class[emscripten_heap_stats_size_class(used_bytes)];
+    } else {
+        size_t size = (char*)end - (char*)start;
+        ++stats->num_free_blocks;
+        stats->free_bytes += size;
+        if (size > stats->largest_free_block)
+            stats->largest_free_block = size;
+        ++stats->free_blocks_by_size_class[emscripten_heap_stats_size_class(size)];
+    }
+}
+
+int emscripten_get_heap_stats(emscripten_heap_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->heap_size = emscripten_get_heap_size();
+    /* The footprint is read outside of the lock that inspect_all takes, so it
+       may be slightly out of date in multithreaded programs. */
+    stats->footprint = dlmalloc_footprint();
+    stats->peak_footprint = dlmalloc_max_footprint();
+    dlmalloc_inspect_all(heap_stats_handler, stats);
+    return 0;
+}
+#endif
+
 /* -------------------- Alternative MORECORE functions ------------------- */
 
 /*
@@ -59,6 +59,7 @@
 #include <malloc.h>
 #include <stdio.h>
 #include <emscripten/heap.h>
+#include <emscripten/heap_stats.h>
 #include <emscripten/threading.h>
 
 #ifdef __EMSCRIPTEN_TRACING__
@@ -95,6 +96,10 @@ static_assert(alignof(max_align_t) == 8, "max_align_t must be correct");
 // each size field is unused. Free regions are distinguished by used regions by having the FREE_REGION_FLAG bit present
 // in the size field. I.e. for free regions, the size field is odd, and for used regions, the size field reads even.
 #define FREE_REGION_FLAG 0x1u
+// Free regions may additionally have the ZERO_TAIL_FLAG bit present in their ceiling size field. This marks that the
+// payload of the region is known to be all zeroes from a recorded address onwards, up to the ceiling size field. See
+// free_region_zero_tail() below.
+#define ZERO_TAIL_FLAG 0x2u
 
 // Attempts to malloc() more than this many bytes would cause an overflow when calculating the size of a region,
 // therefore allocations larger than this are short-circuited immediately on entry.
@@ -161,6 +166,19 @@ static Region freeRegionBuckets[NUM_FREE_BUCKETS];
 // that contains free memory of desired size.
 static BUCKET_BITMASK_T freeRegionBucketsUsed = 0;
 
+// The highest address that sbrk() has ever returned to us. Memory above this address has never been handed out by
+// sbrk(), and so is still zero-initialized, as all fresh WebAssembly memory is. This assumes that other users of
+// sbrk() do not shrink the heap with negative increments, the same assumption that trimming the heap makes.
+static uint8_t *sbrkHighWaterMark = NULL;
+
+// The number of bytes currently claimed from sbrk(), and the highest that has ever been, for heap statistics.
+static size_t claimedBytes = 0;
+static size_t peakClaimedBytes = 0;
+
+// The zero tail of the free region that the most recent successful allocation was carved from, or NULL if that
+// region had no known zero bytes. Used by calloc() to skip clearing memory that is already zero.
+static uint8_t *lastAllocationZeroTail = NULL;
+
 // Amount of bytes taken up by allocation header data
 #define REGION_HEADER_SIZE (2*sizeof(size_t))
 
@@ -251,7 +269,7 @@ static int compute_free_list_bucket(size_t allocSize) {
   return bucketIndex;
 }
 
-#define DECODE_CEILING_SIZE(size) ((size_t)((size) & ~FREE_REGION_FLAG))
+#define DECODE_CEILING_SIZE(size) ((size_t)((size) & ~(FREE_REGION_FLAG | ZERO_TAIL_FLAG)))
 
 static Region *prev_region(Region *region) {
   size_t prevRegionSize = ((size_t*)region)[-1];
@@ -314,6 +332,34 @@ static void create_free_region(void *ptr, size_t size) {
   ((size_t*)ptr)[(size/sizeof(size_t))-1] = size | FREE_REGION_FLAG;
 }
 
+// Free regions that are larger than sizeof(Region) have room for one more word after the free list pointers, which is
+// used to record the address from which the rest of the region payload is known to be zero. This is set up for fresh
+// memory claimed from sbrk(), and is carried over when free regions are split, shrunk or merged with a freed region
+// in front of them, so that calloc() only needs to clear the bytes below this address.
+// Returns NULL if no part of the free region is known to be zero.
+static uint8_t *free_region_zero_tail(Region *r) {
+  if (!(region_ceiling_size(r) & ZERO_TAIL_FLAG)) {
+    return NULL;
+  }
+  return *(uint8_t**)((uint8_t*)r + offsetof(Region, _at_the_end_of_this_struct_size));
+}
+
+// Records that the payload of the given free region is all zeroes from zeroTail up to its ceiling size field. Must
+// be called after create_free_region(), which resets the zero tail.
+static void set_free_region_zero_tail(Region *r, uint8_t *zeroTail) {
+  assert(region_is_free(r));
+  // The region header and the zero tail word itself are never zero.
+  uint8_t *minZeroTail = (uint8_t*)r + sizeof(Region);
+  if (zeroTail < minZeroTail) {
+    zeroTail = minZeroTail;
+  }
+  if (r->size <= sizeof(Region) || zeroTail >= region_payload_end_ptr(r)) {
+    return; // No room to record the zero tail, or no bytes are known to be zero.
+  }
+  *(uint8_t**)((uint8_t*)r + offsetof(Region, _at_the_end_of_this_struct_size)) = zeroTail;
+  *(size_t*)region_payload_end_ptr(r) |= ZERO_TAIL_FLAG;
+}
+
 static void prepend_to_free_list(Region *region, Region *prependTo) {
   assert(region);
   assert(prependTo);
@@ -436,6 +482,19 @@ static int validate_memory_regions() {
           i, fr, fr->size, size_of_region_from_ceiling(fr), fr->prev, fr->next);
         return 1;
       }
+#ifdef EMMALLOC_MEMVALIDATE
+      // calloc() relies on the zero tail, so verify that the memory really is zero.
+      uint8_t *zeroTail = free_region_zero_tail(fr);
+      if (zeroTail) {
+        for (uint8_t *p = zeroTail; p < region_payload_end_ptr(fr); ++p) {
+          if (*p) {
+            MAIN_THREAD_ASYNC_EM_ASM(out('Free region '+ptrToString($0)+', size: ' + toString(Number($1)) + ' has a nonzero byte at '+ptrToString($2)+' above its zero tail '+ptrToString($3)+'!'),
+              fr, fr->size, p, zeroTail);
+            return 1;
+          }
+        }
+      }
+#endif
       prev = fr;
       fr = fr->next;
     }
@@ -480,6 +539,12 @@ static bool claim_more_memory(size_t numBytes) {
   assert(HAS_ALIGNMENT(startPtr, alignof(size_t)));
   uint8_t *endPtr = startPtr + numBytes;
 
+  // The new memory is still zero if sbrk() has not handed it out before (e.g. before the heap was trimmed).
+  bool fresh = startPtr >= sbrkHighWaterMark;
+  sbrkHighWaterMark = MAX(sbrkHighWaterMark, endPtr);
+  claimedBytes += numBytes;
+  peakClaimedBytes = MAX(peakClaimedBytes, claimedBytes);
+
   // Create a sentinel region at the end of the new heap block
   Region *endSentinelRegion = (Region*)(endPtr - sizeof(Region));
   create_used_region(endSentinelRegion, sizeof(Region));
@@ -504,9 +569,21 @@ static bool claim_more_memory(size_t numBytes) {
     // to cover a larger size.
     if (region_is_free(prevRegion)) {
       size_t newFreeRegionSize = (uint8_t*)endSentinelRegion - (uint8_t*)prevRegion;
+      uint8_t *zeroTail = fresh ? free_region_zero_tail(prevRegion) : NULL;
       unlink_from_free_list(prevRegion);
+      if (zeroTail) {
+        // The old ceiling size field and end sentinel become part of the payload. Clear them so that the zero tail
+        // of the old region extends over the new memory.
+        uint8_t *oldCeiling = region_payload_end_ptr(prevRegion);
+        memset(oldCeiling, 0, startPtr - oldCeiling);
+      } else if (fresh) {
+        zeroTail = startPtr;
+      }
       create_free_region(prevRegion, newFreeRegionSize);
       link_to_free_list(prevRegion);
+      if (zeroTail) {
+        set_free_region_zero_tail(prevRegion, zeroTail);
+      }
       return true;
     }
     // else: last region of the previous block was in use. Since we are joining two consecutive sbrk() blocks,
@@ -529,9 +606,13 @@ static bool claim_more_memory(size_t numBytes) {
     startPtr += sizeof(Region);
   }
 
-  // Create a new memory region for the new claimed free space.
+  // Create a new memory region for the new claimed free space. Everything after its header is fresh memory (when
+  // expanding the previous block, the header overlaps the old end sentinel).
   create_free_region(startPtr, (uint8_t*)endSentinelRegion - startPtr);
   link_to_free_list((Region*)startPtr);
+  if (fresh) {
+    set_free_region_zero_tail((Region*)startPtr, startPtr + sizeof(Region));
+  }
   return true;
 }
 
@@ -586,6 +667,7 @@ static void *attempt_allocate(Region *freeRegion, size_t alignment, size_t size)
 
   // We have enough free space, so the memory allocation will be made into this region. Remove this free region
   // from the list of free regions: whatever slop remains will be later added back to the free region pool.
+  uint8_t *zeroTail = free_region_zero_tail(freeRegion);
   unlink_from_free_list(freeRegion);
 
   // Before we proceed further, fix up the boundary between this and the preceding region,
@@ -614,6 +696,9 @@ static void *attempt_allocate(Region *freeRegion, size_t alignment, size_t size)
     Region *newFreeRegion = (Region *)((uint8_t*)freeRegion + REGION_HEADER_SIZE + size);
     create_free_region(newFreeRegion, freeRegion->size - size - REGION_HEADER_SIZE);
     link_to_free_list(newFreeRegion);
+    if (zeroTail) {
+      set_free_region_zero_tail(newFreeRegion, zeroTail);
+    }
 
     // Recreate the resized Region under its new size.
     create_used_region(freeRegion, size + REGION_HEADER_SIZE);
@@ -623,6 +708,7 @@ static void *attempt_allocate(Region *freeRegion, size_t alignment, size_t size)
     // Initialize the free region as used by resetting the ceiling size to the same value as the size at bottom.
     ((size_t*)((uint8_t*)freeRegion + freeRegion->size))[-1] = freeRegion->size;
   }
+  lastAllocationZeroTail = zeroTail;
 
 #ifdef __EMSCRIPTEN_TRACING__
   emscripten_trace_record_allocation(freeRegion, freeRegion->size);
@@ -891,7 +977,7 @@ void emmalloc_free(void *ptr) {
 
   // Check merging with left side
   size_t prevRegionSizeField = ((size_t*)region)[-1];
-  size_t prevRegionSize = prevRegionSizeField & ~FREE_REGION_FLAG;
+  size_t prevRegionSize = DECODE_CEILING_SIZE(prevRegionSizeField);
   if (prevRegionSizeField != prevRegionSize) { // Previous region is free?
     Region *prevRegion = (Region*)((uint8_t*)region - prevRegionSize);
     assert(debug_region_is_consistent(prevRegion));
@@ -900,17 +986,23 @@ void emmalloc_free(void *ptr) {
     size += prevRegionSize;
   }
 
-  // Check merging with right side
+  // Check merging with right side. The freed memory itself is not zero, but if the right side has a zero tail, the
+  // merged region keeps it.
   Region *nextRegion = next_region(region);
   assert(debug_region_is_consistent(nextRegion));
   size_t sizeAtEnd = *(size_t*)region_payload_end_ptr(nextRegion);
+  uint8_t *zeroTail = NULL;
   if (nextRegion->size != sizeAtEnd) {
+    zeroTail = free_region_zero_tail(nextRegion);
     unlink_from_free_list(nextRegion);
     size += nextRegion->size;
   }
 
   create_free_region(regionStartPtr, size);
   link_to_free_list((Region*)regionStartPtr);
+  if (zeroTail) {
+    set_free_region_zero_tail((Region*)regionStartPtr, zeroTail);
+  }
 
   MALLOC_RELEASE();
 
@@ -944,9 +1036,13 @@ static int attempt_region_resize(Region *region, size_t size) {
     assert(HAS_ALIGNMENT(newNextRegionStartPtr, sizeof(size_t)));
     // Next region does not shrink to too small size?
     if (newNextRegionStartPtr + sizeof(Region) <= nextRegionEndPtr) {
+      uint8_t *zeroTail = free_region_zero_tail(nextRegion);
       unlink_from_free_list(nextRegion);
       create_free_region(newNextRegionStartPtr, nextRegionEndPtr - newNextRegionStartPtr);
       link_to_free_list((Region*)newNextRegionStartPtr);
+      if (zeroTail) {
+        set_free_region_zero_tail((Region*)newNextRegionStartPtr, zeroTail);
+      }
       create_used_region(region, newNextRegionStartPtr - (uint8_t*)region);
       return 1;
     }
@@ -1134,9 +1230,18 @@ EMMALLOC_ALIAS(posix_memalign, emmalloc_posix_memalign);
 
 void *emmalloc_calloc(size_t num, size_t size) {
   size_t bytes = num*size;
-  void *ptr = emmalloc_memalign(MALLOC_ALIGNMENT, bytes);
+  MALLOC_ACQUIRE();
+  uint8_t *ptr = (uint8_t*)allocate_memory(MALLOC_ALIGNMENT, bytes);
+  uint8_t *zeroTail = lastAllocationZeroTail;
+  MALLOC_RELEASE();
   if (ptr) {
-    memset(ptr, 0, bytes);
+    // Only the bytes below the zero tail of the free region that the allocation was carved from need clearing.
+    // For allocations from fresh memory, this is just the few words that held the free region header.
+    size_t dirtyBytes = bytes;
+    if (zeroTail) {
+      dirtyBytes = zeroTail > ptr ? MIN((size_t)(zeroTail - ptr), bytes) : 0;
+    }
+    memset(ptr, 0, dirtyBytes);
   }
   return ptr;
 }
@@ -1257,12 +1362,16 @@ static int trim_dynamic_heap_reservation(size_t pad) {
   size_t shrinkAmount = lastActualRegion->size - newRegionSize;
   assert(HAS_ALIGNMENT(shrinkAmount, 4));
 
+  uint8_t *zeroTail = free_region_zero_tail(lastActualRegion);
   unlink_from_free_list(lastActualRegion);
   // If pad == 0, we should delete the last free region altogether. If pad > 0,
   // shrink the last free region to the desired size.
   if (newRegionSize > 0) {
     create_free_region(lastActualRegion, newRegionSize);
     link_to_free_list(lastActualRegion);
+    if (zeroTail) {
+      set_free_region_zero_tail(lastActualRegion, zeroTail);
+    }
   }
 
   // Recreate the sentinel region at the end of the last free region
@@ -1276,6 +1385,7 @@ static int trim_dynamic_heap_reservation(size_t pad) {
   void *oldSbrk = sbrk(-(intptr_t)shrinkAmount);
   assert((intptr_t)oldSbrk != -1); // Shrinking with sbrk() should never fail.
   assert(oldSbrk == previousSbrkEndAddress); // Another thread should not have raced to increase sbrk() on us!
+  claimedBytes -= shrinkAmount;
 
   // All successful, and we actually trimmed memory!
   return 1;
@@ -1367,6 +1477,40 @@ void emmalloc_dump_free_dynamic_memory_fragmentation_map() {
   }
 }
 
+int emmalloc_get_heap_stats(emscripten_heap_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->heap_size = emscripten_get_heap_size();
+
+  MALLOC_ACQUIRE();
+  stats->footprint = claimedBytes;
+  stats->peak_footprint = peakClaimedBytes;
+  for (RootRegion *root = listOfAllRegions; root; root = root->next) {
+    // Skip the used regions that start and end each root region block, they
+    // are not allocations.
+    Region *r = next_region((Region*)root);
+    uint8_t *endSentinel = root->endPtr - sizeof(Region);
+    while ((uint8_t*)r < endSentinel) {
+      assert(debug_region_is_consistent(r));
+      if (region_is_free(r)) {
+        size_t size = region_payload_end_ptr(r) - region_payload_start_ptr(r);
+        ++stats->num_free_blocks;
+        stats->free_bytes += size;
+        stats->largest_free_block = MAX(stats->largest_free_block, size);
+        ++stats->free_blocks_by_size_class[emscripten_heap_stats_size_class(size)];
+      } else {
+        size_t size = r->size - REGION_HEADER_SIZE;
+        ++stats->num_allocations;
+        stats->allocated_bytes += size;
+        ++stats->allocations_by_size_class[emscripten_heap_stats_size_class(size)];
+      }
+      r = next_region(r);
+    }
+  }
+  MALLOC_RELEASE();
+  return 0;
+}
+EMMALLOC_ALIAS(emscripten_get_heap_stats, emmalloc_get_heap_stats);
+
 size_t emmalloc_unclaimed_heap_memory(void) {
   return emscripten_get_heap_max() - (size_t)sbrk(0);
 }
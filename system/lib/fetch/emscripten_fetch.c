@@ -96,6 +96,9 @@ emscripten_fetch_t* emscripten_fetch(emscripten_fetch_attr_t* fetch_attr, const
   fetch->__attributes.withCredentials = fetch_attr->withCredentials;
   fetch->__attributes.requestData = fetch_attr->requestData;
   fetch->__attributes.requestDataSize = fetch_attr->requestDataSize;
+  fetch->__attributes.streamBuffer = fetch_attr->streamBuffer;
+  fetch->__attributes.streamBufferSize = fetch_attr->streamBufferSize;
+  fetch->__attributes.priority = fetch_attr->priority;
   strcpy(fetch->__attributes.requestMethod, fetch_attr->requestMethod);
   fetch->__attributes.onerror = fetch_attr->onerror;
   fetch->__attributes.onsuccess = fetch_attr->onsuccess;
@@ -218,6 +221,31 @@ EMSCRIPTEN_RESULT emscripten_fetch_close(emscripten_fetch_t* fetch) {
   return EMSCRIPTEN_RESULT_SUCCESS;
 }
 
+static EMSCRIPTEN_RESULT fetch_set_paused(emscripten_fetch_t* fetch, bool paused) {
+  if (!fetch || fetch->id == 0)
+    return EMSCRIPTEN_RESULT_INVALID_PARAM;
+  if (!(fetch->__attributes.attributes & EMSCRIPTEN_FETCH_STREAM_DATA))
+    return EMSCRIPTEN_RESULT_NOT_SUPPORTED;
+  if (!_emscripten_fetch_set_paused(fetch->id, paused))
+    return EMSCRIPTEN_RESULT_NOT_SUPPORTED;
+  return EMSCRIPTEN_RESULT_SUCCESS;
+}
+
+EMSCRIPTEN_RESULT emscripten_fetch_pause(emscripten_fetch_t* fetch) {
+  return fetch_set_paused(fetch, true);
+}
+
+EMSCRIPTEN_RESULT emscripten_fetch_resume(emscripten_fetch_t* fetch) {
+  return fetch_set_paused(fetch, false);
+}
+
+EMSCRIPTEN_RESULT emscripten_fetch_get_stats(emscripten_fetch_stats_t* stats) {
+  if (!stats)
+    return EMSCRIPTEN_RESULT_INVALID_PARAM;
+  _emscripten_fetch_get_stats(stats);
+  return EMSCRIPTEN_RESULT_SUCCESS;
+}
+
 size_t emscripten_fetch_get_response_headers_length(emscripten_fetch_t *fetch) {
   if (!fetch || fetch->readyState < STATE_HEADERS_RECEIVED) return 0;
 
@@ -282,7 +310,12 @@ void emscripten_fetch_free(unsigned int id) {
 static void fetch_free(emscripten_fetch_t* fetch) {
   emscripten_fetch_free(fetch->id);
   fetch->id = 0;
-  free((void*)fetch->data);
+  // Streamed chunks point into the stream buffer, which the fetch does not own
+  // (or which was already freed above, if it was allocated for this fetch).
+  if (!fetch->__attributes.streamBuffer || fetch->data < fetch->__attributes.streamBuffer ||
+      fetch->data >= fetch->__attributes.streamBuffer + fetch->__attributes.streamBufferSize) {
+    free((void*)fetch->data);
+  }
   free((void*)fetch->url);
   free((void*)fetch->__attributes.destinationPath);
   free((void*)fetch->__attributes.userName);
@@ -0,0 +1,171 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Single-producer/single-consumer ring of planar float audio. The producer
+// owns writeIndex and the consumer owns readIndex. Both indices count frames
+// and are allowed to wrap around 2^32, so the number of buffered frames is
+// always writeIndex - readIndex in unsigned arithmetic. The consumer side is
+// also implemented in JS in src/audio_worklet.js, which finds the fields of
+// emscripten_audio_ring_t via the struct info in src/struct_info.json.
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/webaudio.h>
+
+EM_BOOL emscripten_audio_ring_init(emscripten_audio_ring_t *ring,
+                                   float *data,
+                                   uint32_t capacity,
+                                   uint32_t numChannels) {
+  if (!ring || !data || !numChannels || !capacity ||
+      (capacity & (capacity - 1)) || capacity > 0x80000000u) {
+    return EM_FALSE;
+  }
+  atomic_init(&ring->writeIndex, 0);
+  atomic_init(&ring->readIndex, 0);
+  atomic_init(&ring->underruns, 0);
+  atomic_init(&ring->overruns, 0);
+  ring->capacity = capacity;
+  ring->numChannels = numChannels;
+  ring->data = data;
+  return EM_TRUE;
+}
+
+emscripten_audio_ring_t *emscripten_audio_ring_create(uint32_t capacity,
+                                                      uint32_t numChannels) {
+  if (!capacity || capacity > 0x80000000u || !numChannels) {
+    return NULL;
+  }
+  uint32_t pow2 = 1;
+  while (pow2 < capacity) {
+    pow2 <<= 1;
+  }
+  size_t dataSize = (size_t)pow2 * numChannels * sizeof(float);
+  if (dataSize / numChannels / sizeof(float) != pow2) {
+    return NULL;
+  }
+  // Keep the ring header and the samples in one allocation, with the samples
+  // starting on their own 16-byte boundary.
+  size_t headerSize = (sizeof(emscripten_audio_ring_t) + 15) & ~(size_t)15;
+  if (dataSize > SIZE_MAX - headerSize) {
+    return NULL;
+  }
+  emscripten_audio_ring_t *ring = aligned_alloc(16, headerSize + dataSize);
+  if (!ring) {
+    return NULL;
+  }
+  float *data = (float*)((char*)ring + headerSize);
+  memset(data, 0, dataSize);
+  emscripten_audio_ring_init(ring, data, pow2, numChannels);
+  return ring;
+}
+
+void emscripten_audio_ring_destroy(emscripten_audio_ring_t *ring) {
+  free(ring);
+}
+
+uint32_t emscripten_audio_ring_write_available(const emscripten_audio_ring_t *ring) {
+  uint32_t write = atomic_load_explicit(&ring->writeIndex, memory_order_relaxed);
+  uint32_t read = atomic_load_explicit(&ring->readIndex, memory_order_acquire);
+  return ring->capacity - (write - read);
+}
+
+uint32_t emscripten_audio_ring_read_available(const emscripten_audio_ring_t *ring) {
+  uint32_t read = atomic_load_explicit(&ring->readIndex, memory_order_relaxed);
+  uint32_t write = atomic_load_explicit(&ring->writeIndex, memory_order_acquire);
+  return write - read;
+}
+
+// Reserves up to numFrames frames for writing. Returns the number of frames
+// that fit, and stores the slot of the first one in *pos.
+static uint32_t begin_write(emscripten_audio_ring_t *ring,
+                            uint32_t numFrames,
+                            uint32_t *pos) {
+  uint32_t write = atomic_load_explicit(&ring->writeIndex, memory_order_relaxed);
+  // Acquire pairs with the release store of the consumer, so that it has
+  // finished reading the slots that we are about to overwrite.
+  uint32_t read = atomic_load_explicit(&ring->readIndex, memory_order_acquire);
+  uint32_t space = ring->capacity - (write - read);
+  if (numFrames > space) {
+    atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+    numFrames = space;
+  }
+  *pos = write & (ring->capacity - 1);
+  return numFrames;
+}
+
+static void end_write(emscripten_audio_ring_t *ring, uint32_t numFrames) {
+  // Publish the samples to the consumer.
+  uint32_t write = atomic_load_explicit(&ring->writeIndex, memory_order_relaxed);
+  atomic_store_explicit(&ring->writeIndex, write + numFrames, memory_order_release);
+}
+
+uint32_t emscripten_audio_ring_write(emscripten_audio_ring_t *ring,
+                                     const float *const *channels,
+                                     uint32_t numFrames) {
+  uint32_t pos;
+  uint32_t n = begin_write(ring, numFrames, &pos);
+  if (!n) {
+    return 0;
+  }
+  uint32_t capacity = ring->capacity;
+  uint32_t first = capacity - pos < n ? capacity - pos : n;
+  for (uint32_t c = 0; c < ring->numChannels; ++c) {
+    float *dst = ring->data + (size_t)c * capacity;
+    memcpy(dst + pos, channels[c], first * sizeof(float));
+    memcpy(dst, channels[c] + first, (n - first) * sizeof(float));
+  }
+  end_write(ring, n);
+  return n;
+}
+
+uint32_t emscripten_audio_ring_write_interleaved(emscripten_audio_ring_t *ring,
+                                                 const float *samples,
+                                                 uint32_t numFrames) {
+  uint32_t pos;
+  uint32_t n = begin_write(ring, numFrames, &pos);
+  if (!n) {
+    return 0;
+  }
+  uint32_t numChannels = ring->numChannels;
+  uint32_t mask = ring->capacity - 1;
+  for (uint32_t c = 0; c < numChannels; ++c) {
+    float *dst = ring->data + (size_t)c * ring->capacity;
+    const float *src = samples + c;
+    for (uint32_t i = 0; i < n; ++i) {
+      dst[(pos + i) & mask] = src[(size_t)i * numChannels];
+    }
+  }
+  end_write(ring, n);
+  return n;
+}
+
+uint32_t emscripten_audio_ring_read(emscripten_audio_ring_t *ring,
+                                    float *dst,
+                                    uint32_t numFrames) {
+  uint32_t read = atomic_load_explicit(&ring->readIndex, memory_order_relaxed);
+  // Acquire pairs with the release store in end_write(), so that the samples
+  // of all published frames are visible.
+  uint32_t write = atomic_load_explicit(&ring->writeIndex, memory_order_acquire);
+  uint32_t n = write - read;
+  if (n < numFrames) {
+    atomic_fetch_add_explicit(&ring->underruns, 1, memory_order_relaxed);
+  } else {
+    n = numFrames;
+  }
+  uint32_t capacity = ring->capacity;
+  uint32_t pos = read & (capacity - 1);
+  uint32_t first = capacity - pos < n ? capacity - pos : n;
+  for (uint32_t c = 0; c < ring->numChannels; ++c) {
+    const float *src = ring->data + (size_t)c * capacity;
+    float *out = dst + (size_t)c * numFrames;
+    memcpy(out, src + pos, first * sizeof(float));
+    memcpy(out + first, src, (n - first) * sizeof(float));
+    memset(out + n, 0, (numFrames - n) * sizeof(float));
+  }
+  // Hand the slots back to the producer only after we are done reading them.
+  atomic_store_explicit(&ring->readIndex, read + n, memory_order_release);
+  return n;
+}
@@ -131,10 +131,13 @@ void __handle_stack_overflow(void* addr);
 
 // Internal fetch API
 struct emscripten_fetch_t;
+struct emscripten_fetch_stats_t;
 void emscripten_start_fetch(struct emscripten_fetch_t* fetch);
 size_t _emscripten_fetch_get_response_headers_length(int32_t fetchID);
 size_t _emscripten_fetch_get_response_headers(int32_t fetchID, char *dst, size_t dstSizeBytes);
 void _emscripten_fetch_free(unsigned int);
+int _emscripten_fetch_set_paused(unsigned int fetchID, bool paused);
+void _emscripten_fetch_get_stats(struct emscripten_fetch_stats_t* stats);
 
 EMSCRIPTEN_RESULT _emscripten_set_offscreencanvas_size(const char *target, int width, int height);
 
@@ -25,6 +25,51 @@ static void *__memcpy(void *restrict dest, const void *restrict src, size_t n) {
   return emscripten_memcpy_bulkmem(dest, src, n);
 }
 
+#elif defined(__wasm_simd128__)
+
+#include <wasm_simd128.h>
+
+// Wasm SIMD loads and stores do not need to be aligned, so copy in 16-byte
+// vectors regardless of the relative alignment of the pointers, and finish with
+// a single vector that may overlap bytes that were already copied.
+static void *__memcpy(void *restrict dest, const void *restrict src, size_t n) {
+  unsigned char *d = dest;
+  const unsigned char *s = src;
+
+#if !defined(EMSCRIPTEN_STANDALONE_WASM)
+  if (n >= 512) {
+    emscripten_memcpy_js(dest, src, n);
+    return dest;
+  }
+#endif
+
+  if (n < 16) {
+    while (n--) {
+      *d++ = *s++;
+    }
+    return dest;
+  }
+  unsigned char *d_tail = d + n - 16;
+  const unsigned char *s_tail = s + n - 16;
+  for (; n >= 64; n -= 64, d += 64, s += 64) {
+    v128_t a = wasm_v128_load(s);
+    v128_t b = wasm_v128_load(s + 16);
+    v128_t c = wasm_v128_load(s + 32);
+    v128_t e = wasm_v128_load(s + 48);
+    wasm_v128_store(d, a);
+    wasm_v128_store(d + 16, b);
+    wasm_v128_store(d + 32, c);
+    wasm_v128_store(d + 48, e);
+  }
+  for (; n >= 16; n -= 16, d += 16, s += 16) {
+    wasm_v128_store(d, wasm_v128_load(s));
+  }
+  if (n) {
+    wasm_v128_store(d_tail, wasm_v128_load(s_tail));
+  }
+  return dest;
+}
+
 #else
 
 static void *__memcpy(void *restrict dest, const void *restrict src, size_t n) {
@@ -24,6 +24,26 @@ void *__memset(void *str, int c, size_t n) {
   return emscripten_memset_bulkmem(str, c, n);
 }
 
+#elif defined(__wasm_simd128__)
+
+#include <wasm_simd128.h>
+
+void *__memset(void *str, int c, size_t n) {
+  unsigned char *s = (unsigned char *)str;
+  if (n < 16) {
+    while (n--) *s++ = c;
+    return str;
+  }
+  v128_t v = wasm_i8x16_splat(c);
+  // The last store may overlap bytes that were already set.
+  unsigned char *tail = s + n - 16;
+  for (; s < tail; s += 16) {
+    wasm_v128_store(s, v);
+  }
+  wasm_v128_store(tail, v);
+  return str;
+}
+
 #else
 
 #define memset __memset
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Wasm SIMD versions of the musl string functions. These are built into
+// libc_simd, which is linked in before libc when compiling with -msimd128, so
+// that they take precedence over the scalar implementations.
+//
+// Functions that do not know the length of their input up front (strlen,
+// strcmp, and memchr, which must stop at the first match) may read past the
+// terminating byte. This is safe as long as a vector load never extends past
+// the end of linear memory: strlen and memchr only use 16-byte aligned loads,
+// which can not cross a 64KiB wasm page boundary, and strcmp only uses a vector
+// load if it stays within the wasm page of its first byte. This is not
+// compatible with ASan, which is why libc_simd is not used in ASan builds.
+
+#include <stdint.h>
+#include <string.h>
+#include <wasm_simd128.h>
+
+#include "libc.h"
+
+#define WASM_PAGE_MASK 0xffff
+
+// Bit i of the result is set if byte i of `v` equals the corresponding byte of
+// `c`.
+static inline uint32_t match_mask(v128_t v, v128_t c) {
+  return wasm_i8x16_bitmask(wasm_i8x16_eq(v, c));
+}
+
+void *memchr(const void *src, int c, size_t n) {
+  if (!n) {
+    return NULL;
+  }
+  const unsigned char *s = src;
+  v128_t needle = wasm_i8x16_splat(c);
+  // Start with the aligned block that contains `s`, and ignore the bytes of it
+  // that precede `s`.
+  uintptr_t misalign = (uintptr_t)s & 15;
+  uint32_t mask = match_mask(wasm_v128_load(s - misalign), needle) >> misalign;
+  size_t avail = 16 - misalign;
+  for (;;) {
+    if (mask) {
+      size_t i = __builtin_ctz(mask);
+      return i < n ? (void *)(s + i) : NULL;
+    }
+    if (n <= avail) {
+      return NULL;
+    }
+    s += avail;
+    n -= avail;
+    avail = 16;
+    mask = match_mask(wasm_v128_load(s), needle);
+  }
+}
+
+void *__memrchr(const void *src, int c, size_t n) {
+  const unsigned char *s = src;
+  v128_t needle = wasm_i8x16_splat(c);
+  while (n >= 16) {
+    n -= 16;
+    uint32_t mask = match_mask(wasm_v128_load(s + n), needle);
+    if (mask) {
+      return (void *)(s + n + 31 - __builtin_clz(mask));
+    }
+  }
+  c = (unsigned char)c;
+  while (n--) {
+    if (s[n] == c) {
+      return (void *)(s + n);
+    }
+  }
+  return NULL;
+}
+
+weak_alias(__memrchr, memrchr);
+
+size_t strlen(const char *str) {
+  v128_t zero = wasm_i64x2_const(0, 0);
+  uintptr_t misalign = (uintptr_t)str & 15;
+  const char *p = str - misalign;
+  uint32_t mask = match_mask(wasm_v128_load(p), zero) >> misalign;
+  if (mask) {
+    return __builtin_ctz(mask);
+  }
+  for (;;) {
+    p += 16;
+    mask = match_mask(wasm_v128_load(p), zero);
+    if (mask) {
+      return p + __builtin_ctz(mask) - str;
+    }
+  }
+}
+
+size_t strnlen(const char *s, size_t n) {
+  const char *p = memchr(s, 0, n);
+  return p ? p - s : n;
+}
+
+int memcmp(const void *vl, const void *vr, size_t n) {
+  const unsigned char *l = vl, *r = vr;
+  for (; n >= 16; n -= 16, l += 16, r += 16) {
+    uint32_t mask = wasm_i8x16_bitmask(
+      wasm_i8x16_ne(wasm_v128_load(l), wasm_v128_load(r)));
+    if (mask) {
+      size_t i = __builtin_ctz(mask);
+      return l[i] - r[i];
+    }
+  }
+  for (; n && *l == *r; n--, l++, r++);
+  return n ? *l - *r : 0;
+}
+
+int strcmp(const char *l, const char *r) {
+  v128_t zero = wasm_i64x2_const(0, 0);
+  for (;;) {
+    if (((uintptr_t)l & WASM_PAGE_MASK) <= WASM_PAGE_MASK - 15 &&
+        ((uintptr_t)r & WASM_PAGE_MASK) <= WASM_PAGE_MASK - 15) {
+      v128_t a = wasm_v128_load(l);
+      v128_t b = wasm_v128_load(r);
+      // Stop at the first byte that differs, or that terminates `l`.
+      uint32_t mask = wasm_i8x16_bitmask(
+        wasm_v128_or(wasm_i8x16_ne(a, b), wasm_i8x16_eq(a, zero)));
+      if (mask) {
+        size_t i = __builtin_ctz(mask);
+        return (unsigned char)l[i] - (unsigned char)r[i];
+      }
+      l += 16;
+      r += 16;
+    } else {
+      // One of the strings is near the end of a wasm page; step a byte at a
+      // time until both vector loads are safe again.
+      if (*l != *r || !*l) {
+        return (unsigned char)*l - (unsigned char)*r;
+      }
+      l++;
+      r++;
+    }
+  }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// UTF-8 to UTF-16 transcoding, see emscripten/utf8.h. This file is built both
+// into libc and, with -msimd128, into libc_simd, where the ASCII fast path
+// processes 16 bytes at a time.
+
+#include <stdint.h>
+#include <emscripten/utf8.h>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+#define REPLACEMENT_CHARACTER 0xFFFD
+
+// Decodes the multi-byte sequence (or invalid byte) at `s[*i]`, following the
+// WHATWG UTF-8 decoder. Advances `*i` past the maximal subpart that was
+// consumed, and returns the code point, or -1 if the subpart is not valid.
+static int32_t decode_sequence(const unsigned char *s, size_t len, size_t *i) {
+  uint32_t c = s[(*i)++];
+  uint32_t lower = 0x80, upper = 0xBF;
+  int need;
+  if (c >= 0xC2 && c <= 0xDF) {
+    need = 1;
+    c &= 0x1F;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    need = 2;
+    // Reject overlong encodings and surrogates.
+    if (c == 0xE0) lower = 0xA0;
+    if (c == 0xED) upper = 0x9F;
+    c &= 0xF;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    need = 3;
+    // Reject overlong encodings and code points above U+10FFFF.
+    if (c == 0xF0) lower = 0x90;
+    if (c == 0xF4) upper = 0x8F;
+    c &= 0x7;
+  } else {
+    return -1;
+  }
+  for (; need; need--) {
+    if (*i >= len || s[*i] < lower || s[*i] > upper) {
+      // The offending byte is not consumed, it starts the next sequence.
+      return -1;
+    }
+    c = (c << 6) | (s[(*i)++] & 0x3F);
+    lower = 0x80;
+    upper = 0xBF;
+  }
+  return c;
+}
+
+#ifndef __wasm_simd128__
+// The scalar version in libc is weak, so that the SIMD version in libc_simd
+// wins even when both archives are linked in full.
+__attribute__((weak))
+#endif
+size_t emscripten_utf8_to_utf16(const char *src, size_t len, char16_t *dst) {
+  const unsigned char *s = (const unsigned char *)src;
+  char16_t *d = dst;
+  size_t i = 0;
+  while (i < len) {
+#ifdef __wasm_simd128__
+    if (len - i >= 16) {
+      v128_t v = wasm_v128_load(s + i);
+      if (!wasm_i8x16_bitmask(v)) {
+        wasm_v128_store(d, wasm_u16x8_extend_low_u8x16(v));
+        wasm_v128_store(d + 8, wasm_u16x8_extend_high_u8x16(v));
+        i += 16;
+        d += 16;
+        continue;
+      }
+    }
+#endif
+    if (s[i] < 0x80) {
+      *d++ = s[i++];
+      continue;
+    }
+    int32_t c = decode_sequence(s, len, &i);
+    if (c < 0) {
+      *d++ = REPLACEMENT_CHARACTER;
+    } else if (c < 0x10000) {
+      *d++ = c;
+    } else {
+      c -= 0x10000;
+      *d++ = 0xD800 | (c >> 10);
+      *d++ = 0xDC00 | (c & 0x3FF);
+    }
+  }
+  return d - dst;
+}
@@ -99,9 +99,9 @@ int __syscall_utimensat(int dirfd, intptr_t path, intptr_t times, int flags);
 int __syscall_fallocate(int fd, int mode, off_t offset, off_t len);
 int __syscall_dup3(int fd, int suggestfd, int flags);
 int __syscall_pipe2(intptr_t fds, int flags);
-int __syscall_recvmmsg(int sockfd, intptr_t msgvec, size_t vlen, int flags, ...);
+int __syscall_recvmmsg(int sockfd, intptr_t msgvec, size_t vlen, int flags, intptr_t timeout);
 int __syscall_prlimit64(int pid, int resource, intptr_t new_limit, intptr_t old_limit);
-int __syscall_sendmmsg(int sockfd, intptr_t msgvec, size_t vlen, int flags, ...);
+int __syscall_sendmmsg(int sockfd, intptr_t msgvec, size_t vlen, int flags);
 int __syscall_socket(int domain, int type, int protocol, int dummy1, int dummy2, int dummy3);
 int __syscall_socketpair(int domain, int type, int protocol, intptr_t fds, int dummy, int dummy2);
 int __syscall_bind(int sockfd, intptr_t addr, size_t alen, int dummy, int dummy2, int dummy3);
@@ -93,6 +93,42 @@ void *sbrk(intptr_t increment_) {
   }
 }
 
+#ifdef __EMSCRIPTEN_SHARED_MEMORY__
+// Size of the chunks that emscripten_thread_sbrk() takes from the global
+// break. Requests of at least half a chunk go to sbrk() directly, so that at
+// most half a chunk is left unused when a thread moves on to a new chunk.
+#define THREAD_SBRK_CHUNK_SIZE (64 * 1024)
+
+static _Thread_local uintptr_t thread_brk;
+static _Thread_local uintptr_t thread_brk_end;
+#endif
+
+void *emscripten_thread_sbrk(size_t size) {
+#ifdef __EMSCRIPTEN_SHARED_MEMORY__
+  if (size > INTPTR_MAX - SBRK_ALIGNMENT) {
+    errno = ENOMEM;
+    return (void*)-1;
+  }
+  size = (size + (SBRK_ALIGNMENT-1)) & ~(SBRK_ALIGNMENT-1);
+  if (size == 0 || size > thread_brk_end - thread_brk) {
+    if (size == 0 || size >= THREAD_SBRK_CHUNK_SIZE / 2) {
+      return sbrk(size);
+    }
+    void *chunk = sbrk(THREAD_SBRK_CHUNK_SIZE);
+    if (chunk == (void*)-1) {
+      return chunk;
+    }
+    thread_brk = (uintptr_t)chunk;
+    thread_brk_end = thread_brk + THREAD_SBRK_CHUNK_SIZE;
+  }
+  void *ret = (void*)thread_brk;
+  thread_brk += size;
+  return ret;
+#else
+  return sbrk(size);
+#endif
+}
+
 int brk(void* ptr) {
 #ifdef __EMSCRIPTEN_SHARED_MEMORY__
   // FIXME
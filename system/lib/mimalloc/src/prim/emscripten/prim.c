@@ -169,6 +169,48 @@ void _mi_prim_process_info(mi_process_info_t* pinfo)
 }
 
 
+//----------------------------------------------------------------
+// Heap statistics, see emscripten/heap_stats.h
+//----------------------------------------------------------------
+
+#include <emscripten/heap_stats.h>
+
+extern int emmalloc_get_heap_stats(emscripten_heap_stats_t*);
+
+static bool mi_heap_stats_visit_area(const mi_heap_t* heap, const mi_heap_area_t* area, void* block, size_t block_size, void* arg) {
+  MI_UNUSED(heap); MI_UNUSED(block); MI_UNUSED(block_size);
+  emscripten_heap_stats_t* stats = (emscripten_heap_stats_t*)arg;
+  int size_class = emscripten_heap_stats_size_class(area->block_size);
+  stats->num_allocations += area->used;
+  stats->allocated_bytes += area->used * area->block_size;
+  stats->allocations_by_size_class[size_class] += area->used;
+  size_t capacity = area->committed / area->full_block_size;
+  if (capacity > area->used) {
+    size_t num_free = capacity - area->used;
+    stats->num_free_blocks += num_free;
+    stats->free_bytes += num_free * area->block_size;
+    stats->free_blocks_by_size_class[size_class] += num_free;
+    if (area->block_size > stats->largest_free_block) {
+      stats->largest_free_block = area->block_size;
+    }
+  }
+  return true;
+}
+
+int emscripten_get_heap_stats(emscripten_heap_stats_t* stats) {
+  // emmalloc hands out the memory that mimalloc takes from the system, so its
+  // footprint is ours, and its free blocks are free memory that mimalloc can
+  // still take. Its allocations are mimalloc's pages, which we replace with
+  // the blocks in them.
+  emmalloc_get_heap_stats(stats);
+  stats->num_allocations = 0;
+  stats->allocated_bytes = 0;
+  memset(stats->allocations_by_size_class, 0, sizeof(stats->allocations_by_size_class));
+  // Only the heap of the calling thread can safely be visited.
+  mi_heap_visit_blocks(mi_heap_get_default(), false, &mi_heap_stats_visit_area, stats);
+  return 0;
+}
+
 //----------------------------------------------------------------
 // Output
 //----------------------------------------------------------------
@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <emscripten/proxying.h>
 #include <emscripten/threading.h>
+#include <math.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdbool.h>
@@ -642,3 +643,91 @@ double _emscripten_run_on_main_thread_js(int func_index,
   }
   return 0;
 }
+
+// Each thread has a single preallocated slot for synchronously proxying JS
+// calls to the main thread. The JS side writes the call arguments directly into
+// the slot and the caller blocks on a futex until the main thread has run the
+// call, so blocking proxied calls (in particular syscalls) need neither a
+// stack-allocated argument buffer nor a mutex and condition variable. Nested
+// proxied calls on the same thread, which can happen while the thread processes
+// its own queue during the wait, find the slot busy and fall back to
+// _emscripten_run_on_main_thread_js.
+#define PROXY_SLOT_MAX_ARGS 32
+
+enum slot_state { SLOT_PENDING, SLOT_DONE, SLOT_CANCELED };
+
+typedef struct proxy_slot {
+  // Futex word that the calling thread waits on.
+  _Atomic uint32_t state;
+  bool busy;
+  // The arguments are plain doubles rather than tagged BigInt/Number pairs.
+  bool numbers;
+  int funcIndex;
+  void* emAsmAddr;
+  pthread_t callingThread;
+  int numArgs;
+  double result;
+  double args[PROXY_SLOT_MAX_ARGS];
+} proxy_slot;
+
+static _Thread_local proxy_slot slot;
+
+double* _emscripten_proxy_slot_acquire(int num_args) {
+  if (slot.busy || num_args > PROXY_SLOT_MAX_ARGS) {
+    return NULL;
+  }
+  slot.busy = true;
+  return slot.args;
+}
+
+static void run_slot(void* arg) {
+  proxy_slot* s = arg;
+  if (s->numbers) {
+    s->result = _emscripten_receive_numbers_on_main_thread_js(
+      s->funcIndex, s->callingThread, s->numArgs, s->args);
+  } else {
+    s->result = _emscripten_receive_on_main_thread_js(
+      s->funcIndex, s->emAsmAddr, s->callingThread, s->numArgs, s->args);
+  }
+  atomic_store_explicit(&s->state, SLOT_DONE, memory_order_release);
+  emscripten_futex_wake(&s->state, 1);
+}
+
+static void cancel_slot(void* arg) {
+  proxy_slot* s = arg;
+  atomic_store_explicit(&s->state, SLOT_CANCELED, memory_order_release);
+  emscripten_futex_wake(&s->state, 1);
+}
+
+double _emscripten_proxy_slot_run(int func_index,
+                                  void* em_asm_addr,
+                                  int num_args,
+                                  int numbers) {
+  assert(slot.busy && "_emscripten_proxy_slot_acquire must be called first");
+  slot.funcIndex = func_index;
+  slot.emAsmAddr = em_asm_addr;
+  slot.callingThread = pthread_self();
+  slot.numArgs = num_args;
+  slot.numbers = numbers;
+  atomic_store_explicit(&slot.state, SLOT_PENDING, memory_order_relaxed);
+
+  // There is no sensible value to return to the caller if the call is never
+  // run, so abort in release builds too.
+  if (!do_proxy(emscripten_proxy_get_system_queue(),
+                emscripten_main_runtime_thread_id(),
+                (task){run_slot, cancel_slot, &slot})) {
+    assert(false && "proxying to the main thread failed");
+    abort();
+  }
+  uint32_t state;
+  while ((state = atomic_load_explicit(&slot.state, memory_order_acquire)) ==
+         SLOT_PENDING) {
+    emscripten_futex_wait(&slot.state, SLOT_PENDING, INFINITY);
+  }
+  if (state != SLOT_DONE) {
+    assert(false && "proxied call was canceled");
+    abort();
+  }
+  slot.busy = false;
+  return slot.result;
+}
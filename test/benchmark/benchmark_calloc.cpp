@@ -0,0 +1,70 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures large calloc() calls. The first round of allocations is served
+// from memory that has never been used before, which the allocator may know
+// to be zero already. The second round reuses the memory freed by the first
+// round, which must be cleared.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+#include "tick.h"
+
+#ifndef ALLOC_SIZE
+#define ALLOC_SIZE 4*1024*1024
+#endif
+
+#ifndef NUM_ALLOCS
+#define NUM_ALLOCS 32
+#endif
+
+uint8_t resultCheckSum = 0;
+
+double __attribute__((noinline)) calloc_all(uint8_t **ptrs)
+{
+	tick_t t0 = tick();
+	for(int i = 0; i < NUM_ALLOCS; ++i)
+	{
+		ptrs[i] = (uint8_t*)calloc(1, ALLOC_SIZE);
+		if (!ptrs[i])
+		{
+			std::cout << "calloc failed!" << std::endl;
+			exit(1);
+		}
+		resultCheckSum += ptrs[i][i * 4099 % ALLOC_SIZE];
+	}
+	tick_t t1 = tick();
+	return (double)(t1 - t0) / ticks_per_sec();
+}
+
+void dirty_and_free_all(uint8_t **ptrs)
+{
+	for(int i = 0; i < NUM_ALLOCS; ++i)
+	{
+		memset(ptrs[i], 0xAA, ALLOC_SIZE);
+		free(ptrs[i]);
+	}
+}
+
+int main()
+{
+	uint8_t *ptrs[NUM_ALLOCS];
+
+	double freshSecs = calloc_all(ptrs);
+	dirty_and_free_all(ptrs);
+	double reusedSecs = calloc_all(ptrs);
+	for(int i = 0; i < NUM_ALLOCS; ++i)
+		free(ptrs[i]);
+
+	double mbytes = (double)NUM_ALLOCS * ALLOC_SIZE / (1024.0*1024.0);
+	std::cout << "Fresh memory: " << freshSecs << " secs (" << mbytes / freshSecs << " MB/sec)" << std::endl;
+	std::cout << "Reused memory: " << reusedSecs << " secs (" << mbytes / reusedSecs << " MB/sec)" << std::endl;
+	std::cout << "Result checksum: " << (int)resultCheckSum << std::endl;
+	std::cout << "Total time: " << freshSecs + reusedSecs << std::endl;
+}
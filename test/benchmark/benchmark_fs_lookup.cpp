@@ -0,0 +1,121 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures path lookups in a large, deep file tree, the way applications that
+// preload many assets open them. Every stat() and open() resolves its path one
+// component at a time through the FS name table, so this mostly measures how
+// that scales with the number of files.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tick.h"
+
+#ifndef NUM_DIRS
+#define NUM_DIRS 200
+#endif
+
+#ifndef FILES_PER_DIR
+#define FILES_PER_DIR 500
+#endif
+
+#define NUM_PASSES 5
+
+#define ROOT "/assets/textures/environment"
+
+uint32_t resultCheckSum = 0;
+
+static void file_path(char *buf, size_t size, int dir, int file)
+{
+	snprintf(buf, size, ROOT "/dir%d/file%d.dat", dir, file);
+}
+
+double __attribute__((noinline)) stat_calls()
+{
+	char path[256];
+	struct stat st;
+	tick_t t0 = tick();
+	for(int pass = 0; pass < NUM_PASSES; ++pass)
+		for(int i = 0; i < NUM_DIRS; ++i)
+			for(int j = 0; j < FILES_PER_DIR; ++j)
+			{
+				file_path(path, sizeof(path), i, j);
+				if (stat(path, &st))
+				{
+					printf("stat failed!\n");
+					exit(1);
+				}
+				resultCheckSum += st.st_size;
+			}
+	tick_t t1 = tick();
+	return (double)(t1 - t0) / ticks_per_sec();
+}
+
+double __attribute__((noinline)) open_calls()
+{
+	char path[256];
+	tick_t t0 = tick();
+	for(int pass = 0; pass < NUM_PASSES; ++pass)
+		// Go through the files in a different order than they were created in.
+		for(int j = 0; j < FILES_PER_DIR; ++j)
+			for(int i = 0; i < NUM_DIRS; ++i)
+			{
+				file_path(path, sizeof(path), i, j);
+				int fd = open(path, O_RDONLY);
+				if (fd < 0)
+				{
+					printf("open failed!\n");
+					exit(1);
+				}
+				resultCheckSum += fd;
+				close(fd);
+			}
+	tick_t t1 = tick();
+	return (double)(t1 - t0) / ticks_per_sec();
+}
+
+int main()
+{
+	char path[256];
+	mkdir("/assets", 0777);
+	mkdir("/assets/textures", 0777);
+	mkdir(ROOT, 0777);
+	tick_t t0 = tick();
+	for(int i = 0; i < NUM_DIRS; ++i)
+	{
+		snprintf(path, sizeof(path), ROOT "/dir%d", i);
+		mkdir(path, 0777);
+		for(int j = 0; j < FILES_PER_DIR; ++j)
+		{
+			file_path(path, sizeof(path), i, j);
+			int fd = open(path, O_WRONLY | O_CREAT, 0666);
+			if (fd < 0)
+			{
+				printf("create failed!\n");
+				return 1;
+			}
+			write(fd, &j, sizeof(j));
+			close(fd);
+		}
+	}
+	tick_t t1 = tick();
+	double createSecs = (double)(t1 - t0) / ticks_per_sec();
+
+	double statSecs = stat_calls();
+	double openSecs = open_calls();
+
+	const int numLookups = NUM_PASSES * NUM_DIRS * FILES_PER_DIR;
+	printf("files: %d\n", NUM_DIRS * FILES_PER_DIR);
+	printf("create: %.3f secs\n", createSecs);
+	printf("stat: %.0f calls/sec\n", numLookups / statSecs);
+	printf("open: %.0f calls/sec\n", numLookups / openSecs);
+	printf("Total time: %f\n", createSecs + statSecs + openSecs);
+	printf("Result checksum: %u\n", resultCheckSum);
+}
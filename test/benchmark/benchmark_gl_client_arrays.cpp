@@ -0,0 +1,105 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures the draw throughput of -sFULL_ES2 client-side vertex and index
+// arrays, the way legacy code renders many small meshes straight from memory.
+// Runs against the -sHEADLESS canvas, so it times the work that the GL library
+// does in JS to stream the client data to WebGL, not the GPU.
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <GLES2/gl2.h>
+#include <emscripten/emscripten.h>
+#include <emscripten/html5.h>
+
+#include "tick.h"
+
+#ifndef NUM_FRAMES
+#define NUM_FRAMES 200
+#endif
+
+// Draws per frame, each of a few quads.
+#define NUM_DRAWS 1000
+#define NUM_QUADS 16
+// Number of distinct meshes that the draws cycle through. Most draws share
+// their client arrays with earlier draws in the same frame.
+#define NUM_MESHES 8
+
+struct Vertex
+{
+	float pos[3];
+	uint8_t color[4];
+	float uv[2];
+};
+
+int main()
+{
+	EmscriptenWebGLContextAttributes attrs;
+	emscripten_webgl_init_context_attributes(&attrs);
+	EMSCRIPTEN_WEBGL_CONTEXT_HANDLE context = emscripten_webgl_create_context("#canvas", &attrs);
+	assert(context > 0);
+	emscripten_webgl_make_context_current(context);
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, glCreateShader(GL_VERTEX_SHADER));
+	glAttachShader(program, glCreateShader(GL_FRAGMENT_SHADER));
+	glLinkProgram(program);
+	glUseProgram(program);
+
+	Vertex *vertices = (Vertex*)malloc(NUM_MESHES * NUM_QUADS * 4 * sizeof(Vertex));
+	for(int i = 0; i < NUM_MESHES * NUM_QUADS * 4; ++i)
+	{
+		Vertex *v = &vertices[i];
+		v->pos[0] = (float)(i & 1);
+		v->pos[1] = (float)((i >> 1) & 1);
+		v->pos[2] = (float)(i / 4);
+		v->color[0] = v->color[1] = v->color[2] = v->color[3] = (uint8_t)i;
+		v->uv[0] = v->pos[0];
+		v->uv[1] = v->pos[1];
+	}
+	uint16_t *indices = (uint16_t*)malloc(NUM_QUADS * 6 * sizeof(uint16_t));
+	for(int i = 0; i < NUM_QUADS; ++i)
+	{
+		static const uint16_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+		for(int j = 0; j < 6; ++j)
+			indices[i * 6 + j] = (uint16_t)(i * 4 + quad[j]);
+	}
+
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+
+	tick_t t0 = tick();
+	for(int frame = 0; frame < NUM_FRAMES; ++frame)
+	{
+		// Animate one of the meshes, so that its data has to be uploaded again.
+		vertices[(frame % NUM_MESHES) * NUM_QUADS * 4].pos[2] += 1.0f;
+		for(int i = 0; i < NUM_DRAWS; ++i)
+		{
+			Vertex *mesh = &vertices[(i % NUM_MESHES) * NUM_QUADS * 4];
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), mesh->pos);
+			glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), mesh->color);
+			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), mesh->uv);
+			glDrawElements(GL_TRIANGLES, NUM_QUADS * 6, GL_UNSIGNED_SHORT, indices);
+		}
+		// What the main loop does at the start of each frame.
+		EM_ASM(GL.newRenderingFrameStarted());
+	}
+	tick_t t1 = tick();
+
+	EM_ASM({
+		var v = GL.currentContext.streamingVertexBuffer;
+		var i = GL.currentContext.streamingIndexBuffer;
+		out(`Vertex data: uploaded ${v.uploadedBytes} bytes, reused ${v.reusedBytes} bytes, orphaned ${v.orphanCount} times`);
+		out(`Index data: uploaded ${i.uploadedBytes} bytes, reused ${i.reusedBytes} bytes, orphaned ${i.orphanCount} times`);
+	});
+	printf("Draws: %d\n", NUM_FRAMES * NUM_DRAWS);
+	printf("Total time: %f msecs\n", (double)(t1 - t0) * 1000.0 / ticks_per_sec());
+	free(indices);
+	free(vertices);
+	return 0;
+}
@@ -0,0 +1,84 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures how long persisting an IDBFS mount takes against the number of
+// bytes that changed since the last sync, for a mount that holds one large
+// file and many small ones, like a save game directory.
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <emscripten.h>
+
+#define MOUNT "/save"
+#define BIG_FILE_SIZE (64 * 1024 * 1024)
+#define NUM_SMALL_FILES 1000
+#define SMALL_FILE_SIZE 1024
+
+EM_ASYNC_JS(double, sync_fs, (), {
+  var t0 = performance.now();
+  await new Promise((resolve, reject) => FS.syncfs((err) => err ? reject(err) : resolve()));
+  return performance.now() - t0;
+});
+
+static char buf[BIG_FILE_SIZE / 4];
+
+static void write_range(const char *path, off_t offset, size_t size) {
+  int fd = open(path, O_WRONLY);
+  assert(fd >= 0);
+  memset(buf, rand(), size);
+  ssize_t written = pwrite(fd, buf, size, offset);
+  assert(written == size);
+  close(fd);
+}
+
+int main() {
+  EM_ASM({
+    FS.mkdir('/save');
+    FS.mount(IDBFS, {}, '/save');
+  });
+
+  int fd = open(MOUNT "/big.dat", O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  assert(fd >= 0);
+  for (int i = 0; i < BIG_FILE_SIZE / sizeof(buf); i++) {
+    memset(buf, i, sizeof(buf));
+    write(fd, buf, sizeof(buf));
+  }
+  close(fd);
+
+  char path[64];
+  mkdir(MOUNT "/small", 0777);
+  for (int i = 0; i < NUM_SMALL_FILES; i++) {
+    snprintf(path, sizeof(path), MOUNT "/small/%d.dat", i);
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    assert(fd >= 0);
+    memset(buf, i, SMALL_FILE_SIZE);
+    write(fd, buf, SMALL_FILE_SIZE);
+    close(fd);
+  }
+
+  printf("initial sync: %.2f msecs\n", sync_fs());
+  printf("sync without changes: %.2f msecs\n", sync_fs());
+
+  size_t sizes[] = { 1, 4096, 1024 * 1024, BIG_FILE_SIZE / 4 };
+  for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    write_range(MOUNT "/big.dat", BIG_FILE_SIZE / 3, sizes[i]);
+    printf("sync after changing %zu bytes: %.2f msecs\n", sizes[i], sync_fs());
+  }
+
+  write_range(MOUNT "/small/500.dat", 10, 1);
+  printf("sync after changing 1 byte of a small file: %.2f msecs\n", sync_fs());
+
+  // Leave the database empty for the next run.
+  EM_ASM({
+    IDBFS.quit();
+    indexedDB.deleteDatabase('/save');
+  });
+  return 0;
+}
@@ -0,0 +1,63 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures JS code that does many small accesses to the heap, the way JS
+// library code such as the GL or string marshalling functions does. Built with
+// -pthread and -sALLOW_MEMORY_GROWTH, every one of these accesses first checks
+// whether the memory was grown by another thread (see src/growableHeap.js),
+// which -sRESERVE_MAXIMUM_MEMORY avoids.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/emscripten.h>
+
+#include "tick.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 2000
+#endif
+
+#define NUM_INTS 4096
+
+EM_JS_DEPS(deps, "$UTF8ToString,$stringToUTF8");
+
+int main()
+{
+	int32_t *ints = (int32_t*)malloc(NUM_INTS * sizeof(int32_t));
+	for(int i = 0; i < NUM_INTS; ++i)
+		ints[i] = i;
+	char *str = (char*)malloc(256);
+	strcpy(str, "The quick brown fox jumps over the lazy dog");
+
+	uint32_t resultCheckSum = 0;
+	tick_t t0 = tick();
+	for(int i = 0; i < NUM_ITERS; ++i)
+	{
+		// Read and write the integers one at a time from JS.
+		resultCheckSum += EM_ASM_INT({
+			var sum = 0;
+			for (var i = 0; i < $1; i++) {
+				sum = (sum + HEAP32[($0 >> 2) + i]) | 0;
+				HEAP32[($0 >> 2) + i] = sum;
+			}
+			return sum;
+		}, ints, NUM_INTS);
+		// Round trip a short string through the heap.
+		resultCheckSum += EM_ASM_INT({
+			var s = UTF8ToString($0);
+			stringToUTF8(s, $0, 256);
+			return s.length;
+		}, str);
+	}
+	tick_t t1 = tick();
+
+	printf("Checksum: %u\n", resultCheckSum);
+	printf("Total time: %f msecs\n", (double)(t1 - t0) * 1000.0 / ticks_per_sec());
+	free(str);
+	free(ints);
+	return 0;
+}
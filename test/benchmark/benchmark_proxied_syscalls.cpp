@@ -0,0 +1,132 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures the throughput of small stat(), fstat() and read() calls. When built
+// with -sPROXY_TO_PTHREAD, main() runs on a pthread and every one of these calls
+// is proxied synchronously to the main thread, so this mostly measures the cost
+// of the proxying round trip. These syscalls take only Number arguments and so
+// use the proxy slot fast path (proxyToMainThreadFast). pread() takes an i64
+// offset, which forces the generic proxyToMainThread path; it is timed
+// separately for comparison and is not part of the total.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tick.h"
+
+#ifndef NUM_CALLS
+#define NUM_CALLS 100000
+#endif
+
+#define FILENAME "proxied_syscalls.dat"
+
+uint32_t resultCheckSum = 0;
+
+double __attribute__((noinline)) stat_calls()
+{
+	struct stat st;
+	tick_t t0 = tick();
+	for(int i = 0; i < NUM_CALLS; ++i)
+	{
+		if (stat(FILENAME, &st))
+		{
+			printf("stat failed!\n");
+			exit(1);
+		}
+		resultCheckSum += st.st_size;
+	}
+	tick_t t1 = tick();
+	return (double)(t1 - t0) / ticks_per_sec();
+}
+
+double __attribute__((noinline)) fstat_calls(int fd)
+{
+	struct stat st;
+	tick_t t0 = tick();
+	for(int i = 0; i < NUM_CALLS; ++i)
+	{
+		if (fstat(fd, &st))
+		{
+			printf("fstat failed!\n");
+			exit(1);
+		}
+		resultCheckSum += st.st_size;
+	}
+	tick_t t1 = tick();
+	return (double)(t1 - t0) / ticks_per_sec();
+}
+
+double __attribute__((noinline)) read_calls(int fd)
+{
+	char buf[16];
+	tick_t t0 = tick();
+	for(int i = 0; i < NUM_CALLS; ++i)
+	{
+		// The file holds 256 blocks. Rewind once per pass; lseek() takes an i64
+		// offset and so is proxied on the slow path, but only once every 256
+		// calls.
+		if (i % 256 == 0)
+			lseek(fd, 0, SEEK_SET);
+		if (read(fd, buf, sizeof(buf)) != sizeof(buf))
+		{
+			printf("read failed!\n");
+			exit(1);
+		}
+		resultCheckSum += buf[i % sizeof(buf)];
+	}
+	tick_t t1 = tick();
+	return (double)(t1 - t0) / ticks_per_sec();
+}
+
+double __attribute__((noinline)) pread_calls(int fd)
+{
+	char buf[16];
+	tick_t t0 = tick();
+	for(int i = 0; i < NUM_CALLS; ++i)
+	{
+		if (pread(fd, buf, sizeof(buf), (i * 16) % 4096) != sizeof(buf))
+		{
+			printf("pread failed!\n");
+			exit(1);
+		}
+		resultCheckSum += buf[i % sizeof(buf)];
+	}
+	tick_t t1 = tick();
+	return (double)(t1 - t0) / ticks_per_sec();
+}
+
+int main()
+{
+	FILE *handle = fopen(FILENAME, "wb");
+	for(int i = 0; i < 4096; ++i)
+		fputc(i * 7, handle);
+	fclose(handle);
+
+	int fd = open(FILENAME, O_RDONLY);
+	if (fd < 0)
+	{
+		printf("open failed!\n");
+		return 1;
+	}
+
+	double statSecs = stat_calls();
+	double fstatSecs = fstat_calls(fd);
+	double readSecs = read_calls(fd);
+	double preadSecs = pread_calls(fd);
+	close(fd);
+	unlink(FILENAME);
+
+	printf("stat: %.0f calls/sec\n", NUM_CALLS / statSecs);
+	printf("fstat: %.0f calls/sec\n", NUM_CALLS / fstatSecs);
+	printf("read: %.0f calls/sec\n", NUM_CALLS / readSecs);
+	printf("pread (slow path): %.0f calls/sec\n", NUM_CALLS / preadSecs);
+	printf("Total time: %f\n", statSecs + fstatSecs + readSecs);
+	printf("Result checksum: %u\n", resultCheckSum);
+}
@@ -0,0 +1,158 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures the throughput of the libc string scanning functions (strlen,
+// strnlen, memchr, memrchr, memcmp and strcmp) for a range of string lengths,
+// in the same way as benchmark_memset.cpp does for memset.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // for memrchr
+#endif
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#endif
+
+#include "tick.h"
+
+#ifndef MAX_LEN
+#define MAX_LEN 1024*1024
+#endif
+
+#ifndef MIN_LEN
+#define MIN_LEN 1
+#endif
+
+char a[MAX_LEN+16] = {};
+char b[MAX_LEN+16] = {};
+
+size_t resultCheckSum = 0;
+
+enum { STRLEN, STRNLEN, MEMCHR, MEMRCHR, MEMCMP, STRCMP, NUM_FUNCS };
+const char *funcNames[NUM_FUNCS] = { "strlen", "strnlen", "memchr", "memrchr", "memcmp", "strcmp" };
+
+// Each function scans about `len` bytes before it finds what it is looking
+// for: the strings are equal up to their terminating zero at index `len`, and
+// memrchr searches backwards for the 1 at b[0].
+void __attribute__((noinline)) test_func(int func, int numTimes, int len)
+{
+	for(int i = 0; i < numTimes; ++i)
+	{
+		switch(func)
+		{
+		case STRLEN: resultCheckSum += strlen(a + (i & 1)); break;
+		case STRNLEN: resultCheckSum += strnlen(a + (i & 1), MAX_LEN); break;
+		case MEMCHR: resultCheckSum += (char*)memchr(a, 0, len + 1) - a; break;
+		case MEMRCHR: resultCheckSum += (char*)memrchr(b, 1, len + 1) - b; break;
+		case MEMCMP: resultCheckSum += memcmp(a, b, len + 1) < 0; break;
+		case STRCMP: resultCheckSum += strcmp(a, b) < 0; break;
+		}
+	}
+}
+
+std::vector<int> lengths;
+std::vector<double> results[NUM_FUNCS];
+
+std::vector<int> testCases;
+
+double totalTimeSecs = 0.0;
+
+void test_case(int len)
+{
+	const int minimumScanBytes = 1024*1024*16;
+
+	int numTimes = (minimumScanBytes + len-1) / len;
+	if (numTimes < 8) numTimes = 8;
+
+	memset(a, 'a', len);
+	a[len] = 0;
+	memcpy(b, a, len + 1);
+	// The last byte that memrchr finds, scanning backwards.
+	b[0] = 1;
+
+	lengths.push_back(len);
+
+#ifndef NUM_TRIALS
+#define NUM_TRIALS 5
+#endif
+
+	for(int func = 0; func < NUM_FUNCS; ++func)
+	{
+		tick_t bestResult = 1e9;
+		for(int i = 0; i < NUM_TRIALS; ++i)
+		{
+			double t0 = tick();
+			test_func(func, numTimes, len);
+			double t1 = tick();
+			if (t1 - t0 < bestResult) bestResult = t1 - t0;
+			totalTimeSecs += (double)(t1 - t0) / ticks_per_sec();
+		}
+		unsigned long long totalBytesScanned = (unsigned long long)numTimes * len;
+
+		tick_t ticksElapsed = bestResult;
+		if (ticksElapsed > 0)
+		{
+			double seconds = (double)ticksElapsed / ticks_per_sec();
+			double mbytesPerSecond = totalBytesScanned / seconds / (1024.0*1024.0);
+			results[func].push_back(mbytesPerSecond);
+		}
+		else
+		{
+			results[func].push_back(0.0);
+		}
+	}
+	b[0] = 'a';
+}
+
+void print_results()
+{
+	std::cout << "Test cases: " << std::endl;
+	for(size_t i = 0; i < lengths.size(); ++i)
+	{
+		std::cout << lengths[i];
+		if (i != lengths.size()-1) std::cout << ",";
+		else std::cout << std::endl;
+		if (i % 10 == 9) std::cout << std::endl;
+	}
+	std::cout << std::endl;
+	for(int func = 0; func < NUM_FUNCS; ++func)
+	{
+		std::cout << std::endl;
+		std::cout << "Test results (" << funcNames[func] << "): " << std::endl;
+		for(size_t i = 0; i < results[func].size(); ++i)
+		{
+			std::cout << results[func][i];
+			if (i != results[func].size()-1) std::cout << ",";
+			else std::cout << std::endl;
+			if (i % 10 == 9) std::cout << std::endl;
+		}
+	}
+
+	std::cout << "Result checksum: " << resultCheckSum << std::endl;
+	std::cout << "Total time: " << totalTimeSecs << std::endl;
+}
+
+int main()
+{
+	for(int len = MIN_LEN; len <= MAX_LEN; len <<= 1)
+	{
+		testCases.push_back(len);
+		if (len > 2) testCases.push_back(len - 1);
+	}
+	std::sort(testCases.begin(), testCases.end());
+
+	for(size_t i = 0; i < testCases.size(); ++i)
+	{
+		std::cout << (i+1) << "/" << testCases.size() << std::endl;
+		test_case(testCases[i]);
+	}
+	print_results();
+}
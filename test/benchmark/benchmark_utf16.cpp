@@ -10,14 +10,22 @@
 #include <cassert>
 #include <emscripten.h>
 
-double test(const unsigned short *str) {
+double encodeTime = 0;
+
+double test(const unsigned short *str, unsigned short *out, int outSize) {
   double res = EM_ASM_DOUBLE({
     var t0 = _emscripten_get_now();
     var str = Module.UTF16ToString($0);
     var t1 = _emscripten_get_now();
-    out('t: ' + (t1 - t0) + ', len(result): ' + str.length + ', result: ' + str.slice(0, 100));
+    Module.stringToUTF16(str, $1, $2);
+    var t2 = _emscripten_get_now();
+    HEAPF64[$3 >> 3] += t2 - t1;
     return (t1-t0);
-  }, str);
+  }, str, out, outSize, &encodeTime);
+  // Encoding the decoded string must round-trip.
+  int i = 0;
+  while (str[i] && str[i] == out[i]) ++i;
+  assert(str[i] == out[i]);
   return res;
 }
 
@@ -38,7 +46,7 @@ unsigned short *randomString(int len) {
     utf16_corpus[utf16_corpus_length] = 0;
   }
   int startIdx = rand() % (utf16_corpus_length - len);
-  while((utf16_corpus[startIdx] & 0xFF00) == 0xDC00) {
+  while((utf16_corpus[startIdx] & 0xFC00) == 0xDC00) {
     ++startIdx;
     if (startIdx + len > utf16_corpus_length) len = utf16_corpus_length - startIdx;
   }
@@ -46,7 +54,7 @@ unsigned short *randomString(int len) {
   unsigned short *s = new unsigned short[len+1];
   memcpy(s, utf16_corpus + startIdx, len*2);
   s[len] = 0;
-  while(((unsigned short)s[len-1] & 0xFF00) == 0xD800) { s[--len] = 0; }
+  while(len > 0 && ((unsigned short)s[len-1] & 0xFC00) == 0xD800) { s[--len] = 0; }
   assert(len >= 0);
   return s;
 }
@@ -55,13 +63,19 @@ int main() {
   srand(time(NULL));
   double t = 0;
   double t2 = emscripten_get_now();
-  for(int i = 0; i < 10; ++i) {
-    // FF Nightly: Already on small strings of 64 bytes in length, TextDecoder trumps in performance.
-    unsigned short *str = randomString(100);
-    t += test(str);
+  for(int i = 0; i < 100000; ++i) {
+    // UTF16ToString uses TextDecoder for strings longer than 16 code units, so
+    // mostly create strings of lengths 1-32 to test both paths. Every 64th
+    // string is longer.
+    int len = (i % 64 == 63) ? (rand() % 4096) + 1 : (i % 32) + 1;
+    unsigned short *str = randomString(len);
+    int outSize = (len + 1) * 2;
+    unsigned short *out = new unsigned short[len + 1];
+    t += test(str, out, outSize);
+    delete [] out;
     delete [] str;
   }
   double t3 = emscripten_get_now();
-  printf("OK. Time: %f (%f).\n", t, t3-t2);
+  printf("OK. Time: %f (%f), encode: %f.\n", t, t3-t2, encodeTime);
   return 0;
 }
@@ -10,16 +10,23 @@
 #include <emscripten.h>
 #include <time.h>
 
-EM_JS_DEPS(deps, "$UTF8ToString,emscripten_get_now");
+EM_JS_DEPS(deps, "$UTF8ToString,$stringToUTF8,$getValue,$setValue,emscripten_get_now");
 
-double test(const char *str) {
+double encodeTime = 0;
+
+double test(const char *str, char *out, int outSize) {
   double res = EM_ASM_DOUBLE({
     var t0 = _emscripten_get_now();
     var str = UTF8ToString($0);
     var t1 = _emscripten_get_now();
     // out('t: ' + (t1 - t0) + ', len(result): ' + str.length + ', result: ' + str.slice(0, 100));
+    stringToUTF8(str, $1, $2);
+    var t2 = _emscripten_get_now();
+    setValue($3, getValue($3, 'double') + (t2 - t1), 'double');
     return (t1-t0);
-  }, str);
+  }, str, out, outSize, &encodeTime);
+  // The corpus is valid UTF-8, so encoding the decoded string must round-trip.
+  assert(!strcmp(str, out));
   return res;
 }
 
@@ -63,11 +70,16 @@ int main() {
     // Create strings of lengths 1-32, because the internals of text decoding
     // have a cutoff of 16 for when to use TextDecoder, and we wish to test both
     // (see UTF8ArrayToString).
-    char *str = randomString((i % 32) + 1);
-    t += test(str);
+    // Every 64th string is longer, to also exercise the paths for long strings.
+    int len = (i % 64 == 63) ? (rand() % 4096) + 1 : (i % 32) + 1;
+    char *str = randomString(len);
+    int outSize = strlen(str) + 1;
+    char *out = malloc(outSize);
+    t += test(str, out, outSize);
+    free(out);
     free(str);
   }
   double t3 = emscripten_get_now();
-  printf("OK. Time: %f (%f).\n", t, t3-t2);
+  printf("OK. Time: %f (%f), encode: %f.\n", t, t3-t2, encodeTime);
   return 0;
 }
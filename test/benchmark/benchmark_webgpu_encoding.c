@@ -0,0 +1,99 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures the JS overhead of the WebGPU bindings for a renderer that creates
+// a bind group per draw every frame and binds it with a dynamic offset. Runs
+// against the do-nothing device in webgpu_mock.js, so it times the handle
+// bookkeeping and argument marshalling in library_webgpu.js, not the GPU.
+
+#include <assert.h>
+#include <stdio.h>
+#include <webgpu/webgpu.h>
+#include <emscripten/html5_webgpu.h>
+
+#include "tick.h"
+
+#ifndef NUM_FRAMES
+#define NUM_FRAMES 200
+#endif
+
+#define NUM_DRAWS 2000
+#define NUM_BUFFERS 16
+#define UNIFORM_SIZE 256
+
+int main() {
+  WGPUDevice device = emscripten_webgpu_get_device();
+  assert(device);
+  WGPUQueue queue = wgpuDeviceGetQueue(device);
+
+  WGPUBindGroupLayoutEntry layoutEntry = {
+    .binding = 0,
+    .visibility = WGPUShaderStage_Vertex,
+    .buffer = {
+      .type = WGPUBufferBindingType_Uniform,
+      .hasDynamicOffset = 1,
+      .minBindingSize = UNIFORM_SIZE,
+    },
+  };
+  WGPUBindGroupLayoutDescriptor layoutDesc = {
+    .entryCount = 1,
+    .entries = &layoutEntry,
+  };
+  WGPUBindGroupLayout layout = wgpuDeviceCreateBindGroupLayout(device, &layoutDesc);
+
+  WGPUBuffer buffers[NUM_BUFFERS];
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    WGPUBufferDescriptor bufferDesc = {
+      .usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
+      .size = 64 * 1024,
+    };
+    buffers[i] = wgpuDeviceCreateBuffer(device, &bufferDesc);
+  }
+
+  tick_t t0 = tick();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, NULL);
+    WGPURenderPassDescriptor passDesc = {0};
+    WGPURenderPassEncoder pass = wgpuCommandEncoderBeginRenderPass(encoder, &passDesc);
+    for (int i = 0; i < NUM_DRAWS; i++) {
+      WGPUBuffer buffer = buffers[i % NUM_BUFFERS];
+      WGPUBindGroupEntry entry = {
+        .binding = 0,
+        .buffer = buffer,
+        .size = UNIFORM_SIZE,
+      };
+      WGPUBindGroupDescriptor groupDesc = {
+        .layout = layout,
+        .entryCount = 1,
+        .entries = &entry,
+      };
+      WGPUBindGroup group = wgpuDeviceCreateBindGroup(device, &groupDesc);
+      uint32_t offset = (i % 64) * UNIFORM_SIZE;
+      wgpuRenderPassEncoderSetBindGroup(pass, 0, group, 1, &offset);
+      wgpuRenderPassEncoderSetVertexBuffer(pass, 0, buffer, 0, 1024);
+      wgpuRenderPassEncoderDraw(pass, 6, 1, 0, 0);
+      // The pass keeps the bind group alive until it is submitted.
+      wgpuBindGroupRelease(group);
+    }
+    wgpuRenderPassEncoderEnd(pass);
+    WGPUCommandBuffer commands = wgpuCommandEncoderFinish(encoder, NULL);
+    wgpuQueueSubmit(queue, 1, &commands);
+    wgpuCommandBufferRelease(commands);
+    wgpuRenderPassEncoderRelease(pass);
+    wgpuCommandEncoderRelease(encoder);
+  }
+  tick_t t1 = tick();
+
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    wgpuBufferRelease(buffers[i]);
+  }
+  wgpuBindGroupLayoutRelease(layout);
+  wgpuQueueRelease(queue);
+  wgpuDeviceRelease(device);
+
+  printf("Draws: %d\n", NUM_FRAMES * NUM_DRAWS);
+  printf("Total time: %f msecs\n", (double)(t1 - t0) * 1000.0 / ticks_per_sec());
+  return 0;
+}
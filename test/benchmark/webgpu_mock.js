@@ -0,0 +1,34 @@
+// A WebGPU device whose methods do nothing, for timing the JS side of the
+// WebGPU bindings in node, without a GPU.
+(function() {
+  function MockObject() {}
+  MockObject.prototype.destroy = () => {};
+  MockObject.prototype.createView = () => new MockObject();
+
+  var pass = {
+    setPipeline: () => {},
+    setBindGroup: () => {},
+    setVertexBuffer: () => {},
+    setIndexBuffer: () => {},
+    draw: () => {},
+    drawIndexed: () => {},
+    end: () => {},
+  };
+  var encoder = {
+    beginRenderPass: () => pass,
+    beginComputePass: () => pass,
+    finish: () => new MockObject(),
+  };
+
+  Module['preinitializedWebGPUDevice'] = {
+    'queue': {
+      submit: () => {},
+      writeBuffer: () => {},
+    },
+    createBuffer: (desc) => Object.assign(new MockObject(), {size: desc.size, usage: desc.usage}),
+    createTexture: () => new MockObject(),
+    createBindGroupLayout: () => new MockObject(),
+    createBindGroup: () => new MockObject(),
+    createCommandEncoder: () => encoder,
+  };
+})();
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// emmalloc skips clearing memory in calloc() when it knows that the memory is
+// already zero. Check that calloc() still returns zeroed memory after the
+// heap has been dirtied in various ways.
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/emmalloc.h>
+
+static void check_zero(const char *name, void *ptr, size_t size) {
+  assert(ptr);
+  for (size_t i = 0; i < size; ++i) {
+    if (((uint8_t*)ptr)[i]) {
+      printf("%s: nonzero byte at %zu of %zu\n", name, i, size);
+      abort();
+    }
+  }
+  assert(!emmalloc_validate_memory_regions());
+  printf("%s: ok\n", name);
+}
+
+static void *dirty_malloc(size_t size) {
+  void *ptr = malloc(size);
+  assert(ptr);
+  memset(ptr, 0xAA, size);
+  return ptr;
+}
+
+int main() {
+  // Fresh memory from sbrk().
+  void *a = calloc(1, 1024*1024);
+  check_zero("fresh", a, 1024*1024);
+  void *b = calloc(16, 3);
+  check_zero("fresh small", b, 16*3);
+
+  // Free a dirty block right in front of the fresh memory at the end of the
+  // heap, so that the two merge.
+  void *c = dirty_malloc(4096);
+  free(c);
+  c = calloc(1, 64*1024);
+  check_zero("merged", c, 64*1024);
+
+  // Grow an allocation in place into the free memory after it, and allocate
+  // after that.
+  void *d = dirty_malloc(100);
+  d = realloc(d, 8192);
+  memset(d, 0xBB, 8192);
+  void *e = calloc(1, 8192);
+  check_zero("after realloc", e, 8192);
+
+  // Reuse memory that has been freed.
+  free(a);
+  a = calloc(1, 512*1024);
+  check_zero("reused", a, 512*1024);
+
+  // Memory that sbrk() hands out again after trimming is not fresh.
+  free(e);
+  void *f = dirty_malloc(8*1024*1024);
+  free(f);
+  emmalloc_trim(0);
+  f = calloc(1, 8*1024*1024);
+  check_zero("after trim", f, 8*1024*1024);
+
+  free(a);
+  free(b);
+  free(c);
+  free(d);
+  free(f);
+  printf("done\n");
+  return 0;
+}
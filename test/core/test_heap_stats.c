@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <emscripten/heap_stats.h>
+
+#define NUM_ALLOCS 1000
+
+static void *allocs[NUM_ALLOCS];
+
+static void check_consistent(const emscripten_heap_stats_t *stats) {
+  size_t allocs = 0, frees = 0;
+  for (int i = 0; i < EMSCRIPTEN_HEAP_STATS_SIZE_CLASSES; i++) {
+    allocs += stats->allocations_by_size_class[i];
+    frees += stats->free_blocks_by_size_class[i];
+  }
+  assert(allocs == stats->num_allocations);
+  assert(frees == stats->num_free_blocks);
+  assert(stats->largest_free_block <= stats->free_bytes);
+  assert(stats->allocated_bytes + stats->free_bytes <= stats->footprint);
+  assert(stats->footprint <= stats->peak_footprint);
+  assert(stats->footprint <= stats->heap_size);
+  double fragmentation = emscripten_heap_stats_fragmentation(stats);
+  assert(fragmentation >= 0 && fragmentation <= 1);
+}
+
+int main() {
+  assert(emscripten_heap_stats_size_class(0) == 0);
+  assert(emscripten_heap_stats_size_class(1) == 0);
+  assert(emscripten_heap_stats_size_class(1023) == 9);
+  assert(emscripten_heap_stats_size_class(1024) == 10);
+
+  emscripten_heap_stats_t before;
+  assert(emscripten_get_heap_stats(&before) == 0);
+  check_consistent(&before);
+
+  // Allocate blocks of 1000 bytes, which are all in the [512, 1024) class.
+  for (int i = 0; i < NUM_ALLOCS; i++) {
+    allocs[i] = malloc(1000);
+    assert(allocs[i]);
+  }
+  emscripten_heap_stats_t full;
+  assert(emscripten_get_heap_stats(&full) == 0);
+  check_consistent(&full);
+  assert(full.num_allocations >= before.num_allocations + NUM_ALLOCS);
+  assert(full.allocated_bytes >= before.allocated_bytes + NUM_ALLOCS * 1000);
+  assert(full.allocations_by_size_class[9] + full.allocations_by_size_class[10] >= NUM_ALLOCS);
+
+  // Free every other block, which leaves the heap fragmented.
+  for (int i = 0; i < NUM_ALLOCS; i += 2) {
+    free(allocs[i]);
+  }
+  emscripten_heap_stats_t half;
+  assert(emscripten_get_heap_stats(&half) == 0);
+  check_consistent(&half);
+  assert(half.num_allocations <= full.num_allocations - NUM_ALLOCS / 2);
+  assert(half.num_free_blocks >= NUM_ALLOCS / 2);
+  assert(half.free_bytes >= full.free_bytes + NUM_ALLOCS / 2 * 1000);
+  assert(half.peak_footprint >= full.footprint);
+
+  for (int i = 1; i < NUM_ALLOCS; i += 2) {
+    free(allocs[i]);
+  }
+  emscripten_heap_stats_t after;
+  assert(emscripten_get_heap_stats(&after) == 0);
+  check_consistent(&after);
+  assert(after.num_allocations <= before.num_allocations);
+
+  printf("done\n");
+  return 0;
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+
+// stringToUTF8 uses TextEncoder.encodeInto for strings longer than 64 code
+// units (when it can), and encodes shorter strings in JS. Check that both agree
+// with TextEncoder on unpaired surrogates and surrogate pairs, also when the
+// output buffer is too small for the whole string.
+int check_surrogates(void);
+
+int main() {
+  assert(check_surrogates());
+  printf("OK.\n");
+  return 0;
+}
@@ -0,0 +1,44 @@
+addToLibrary({
+  check_surrogates__deps: ['$stringToUTF8', '$lengthBytesUTF8', 'malloc', 'free'],
+  check_surrogates: () => {
+    var encoder = new TextEncoder();
+    // The bytes that stringToUTF8 should write when it has room for only
+    // `size` bytes, including the terminator: as many whole characters as fit.
+    var expectedPrefix = (str, size) => {
+      var bytes = [];
+      for (var c of str) {
+        var encoded = encoder.encode(c);
+        if (bytes.length + encoded.length > size - 1) break;
+        bytes.push(...encoded);
+      }
+      return bytes;
+    };
+    var buf = _malloc(1024);
+    var cases = ['\uD800', '\uDBFF', '\uDC00', '\uDC00\uD800', '😀'];
+    var ok = 1;
+    for (var len of [63, 64, 65]) {
+      for (var c of cases) {
+        var pad = 'x'.repeat(len - c.length);
+        for (var str of [c + pad, pad + c, pad.slice(30) + c + pad.slice(0, 30)]) {
+          var full = encoder.encode(str).length;
+          if (lengthBytesUTF8(str) != full) {
+            out(`lengthBytesUTF8 mismatch: length ${len}, ${escape(c)}`);
+            ok = 0;
+          }
+          for (var size of [full + 1, full, full - 2]) {
+            HEAPU8.fill(0xAA, buf, buf + 1024);
+            var written = stringToUTF8(str, buf, size);
+            var expected = expectedPrefix(str, size);
+            if (written != expected.length || HEAPU8[buf + written] != 0 ||
+                expected.some((b, i) => HEAPU8[buf + i] != b)) {
+              out(`stringToUTF8 mismatch: length ${len}, ${escape(c)}, size ${size}`);
+              ok = 0;
+            }
+          }
+        }
+      }
+    }
+    _free(buf);
+    return ok;
+  },
+});
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Checks the string and memory functions against naive implementations, for
+// all small alignments and lengths. Built with -msimd128 this tests the Wasm
+// SIMD versions in libc_simd.
+
+#define _GNU_SOURCE
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static int sign(int x) {
+  return (x > 0) - (x < 0);
+}
+
+static size_t ref_strlen(const char *s) {
+  size_t n = 0;
+  while (s[n]) n++;
+  return n;
+}
+
+static const void *ref_memchr(const void *m, int c, size_t n) {
+  const unsigned char *s = m;
+  for (size_t i = 0; i < n; i++) {
+    if (s[i] == (unsigned char)c) return s + i;
+  }
+  return NULL;
+}
+
+static const void *ref_memrchr(const void *m, int c, size_t n) {
+  const unsigned char *s = m;
+  while (n--) {
+    if (s[n] == (unsigned char)c) return s + n;
+  }
+  return NULL;
+}
+
+static int ref_memcmp(const void *vl, const void *vr, size_t n) {
+  const unsigned char *l = vl, *r = vr;
+  for (size_t i = 0; i < n; i++) {
+    if (l[i] != r[i]) return l[i] - r[i];
+  }
+  return 0;
+}
+
+static int ref_strcmp(const char *l, const char *r) {
+  while (*l && *l == *r) l++, r++;
+  return (unsigned char)*l - (unsigned char)*r;
+}
+
+#define SIZE 256
+
+static char a[SIZE + 64], b[SIZE + 64];
+static unsigned char src[SIZE + 64], dst[SIZE + 64], expected[SIZE + 64];
+
+int main() {
+  unsigned seed = 1;
+  for (int align_a = 0; align_a < 16; align_a++) {
+    for (int align_b = 0; align_b < 16; align_b++) {
+      for (int len = 0; len < 80; len++) {
+        seed = seed * 1103515245 + 12345;
+        for (int i = 0; i < SIZE + 64; i++) {
+          // A small alphabet, including bytes with the high bit set, so that
+          // matches and mismatches are common.
+          a[i] = b[i] = "ab\x80\xff"[(seed >> (i % 16)) & 3];
+        }
+        char *l = a + align_a, *r = b + align_b;
+        memcpy(r, l, len + 16);
+        l[len] = 0;
+        r[len + (seed >> 20) % 3] = 0;
+        if (len && (seed >> 24) & 1) {
+          r[(seed >> 8) % len] = (seed >> 24) & 2 ? 'a' : '\x80';
+        }
+
+        assert(strlen(l) == ref_strlen(l));
+        assert(strnlen(l, len / 2) == (size_t)len / 2);
+        assert(strnlen(l, len + 8) == (size_t)len);
+        assert(sign(strcmp(l, r)) == sign(ref_strcmp(l, r)));
+        assert(sign(memcmp(l, r, len)) == sign(ref_memcmp(l, r, len)));
+        for (int c = 0; c < 4; c++) {
+          int ch = "b\x80x"[c];
+          assert(memchr(l, ch, len) == ref_memchr(l, ch, len));
+          assert(memrchr(l, ch, len) == ref_memrchr(l, ch, len));
+        }
+
+        for (int i = 0; i < SIZE + 64; i++) {
+          src[i] = i * 7;
+          dst[i] = expected[i] = 0xcc;
+        }
+        memcpy(dst + align_a, src + align_b, len * 3);
+        for (int i = 0; i < len * 3; i++) expected[align_a + i] = src[align_b + i];
+        assert(!memcmp(dst, expected, sizeof(dst)));
+        memset(dst + align_b, len, len * 3);
+        for (int i = 0; i < len * 3; i++) expected[align_b + i] = len;
+        assert(!memcmp(dst, expected, sizeof(dst)));
+      }
+    }
+  }
+  printf("OK.\n");
+  return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/emscripten.h>
+#include <emscripten/utf8.h>
+
+// Checks emscripten_utf8_to_utf16 against TextDecoder, on hand-picked malformed
+// input and on random bytes.
+
+static void check_utf8(const char *str, size_t len) {
+  char16_t *utf16 = malloc((len + 1) * sizeof(char16_t));
+  size_t n = emscripten_utf8_to_utf16(str, len, utf16);
+  assert(n <= len);
+  int ok = EM_ASM_INT({
+    var bytes = HEAPU8.slice($0, $0 + $1);
+    var expected = new TextDecoder().decode(bytes);
+    var actual = String.fromCharCode.apply(null, HEAPU16.subarray($2 >> 1, ($2 >> 1) + $3));
+    return expected === actual;
+  }, str, len, utf16, n);
+  assert(ok);
+  free(utf16);
+}
+
+static const char *malformed[] = {
+  "\x80",                       // lone continuation byte
+  "\xC0\xAF",                   // overlong '/'
+  "\xC2",                       // truncated 2-byte sequence
+  "\xE0\x80\xAF",               // overlong 3-byte sequence
+  "\xE2\x82",                   // truncated euro sign
+  "\xED\xA0\x80",               // surrogate U+D800
+  "\xF0\x8F\xBF\xBF",           // overlong 4-byte sequence
+  "\xF4\x90\x80\x80",           // above U+10FFFF
+  "\xF5\x80\x80\x80",           // invalid lead byte
+  "\xF0\x9F\x98",               // truncated emoji
+  "\xFF\xFE",
+  "abc\xE2\x82\xACxyz\xF0\x9F\x98\x80 0123456789abcdef\xC3",
+};
+
+int main() {
+  for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+    check_utf8(malformed[i], strlen(malformed[i]));
+  }
+
+  srand(42);
+  char buf[300];
+  for (int iter = 0; iter < 2000; iter++) {
+    size_t len = rand() % sizeof(buf);
+    for (size_t i = 0; i < len; i++) {
+      // Mostly ASCII, so that the fast paths get exercised, with some
+      // multi-byte characters and garbage mixed in.
+      int r = rand() % 16;
+      buf[i] = r < 12 ? rand() % 128 : r < 15 ? 0x80 + rand() % 0x40 : 0xC0 + rand() % 0x40;
+    }
+    check_utf8(buf, len);
+  }
+
+  printf("OK.\n");
+  return 0;
+}
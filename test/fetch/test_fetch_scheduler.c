@@ -0,0 +1,97 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/fetch.h>
+
+// With at most one request in flight, the requests must finish in priority
+// order, except for the first one, which starts right away.
+static const char *expectedOrder[] = {
+  "file0.txt", "file3.txt", "file1.txt", "file2.txt", "dup.txt",
+};
+static int numFinished = 0;
+static int numDuplicatesFinished = 0;
+
+static void check_done() {
+  if (numFinished < 5 || numDuplicatesFinished < 2) return;
+  emscripten_fetch_stats_t stats;
+  assert(emscripten_fetch_get_stats(&stats) == EMSCRIPTEN_RESULT_SUCCESS);
+  printf("stats: started %u, completed %u, deduplicated %u, cancelled %u, bytes %llu\n",
+    stats.started, stats.completed, stats.deduplicated, stats.cancelled, stats.bytesReceived);
+  assert(stats.queued == 0);
+  assert(stats.inFlight == 0);
+  assert(stats.waiting == 0);
+  // The cancelled request is never started, and the two duplicates share the
+  // request of dup.txt.
+  assert(stats.started == 5);
+  assert(stats.completed == 5);
+  assert(stats.deduplicated == 2);
+  assert(stats.cancelled == 1);
+  assert(stats.bytesReceived == 5 * 6);
+  exit(0);
+}
+
+static void success(emscripten_fetch_t *fetch) {
+  printf("Finished %s\n", fetch->url);
+  assert(fetch->numBytes == 6);
+  assert(!strcmp(fetch->url, expectedOrder[numFinished]));
+  numFinished++;
+  emscripten_fetch_close(fetch);
+  check_done();
+}
+
+static void duplicate_success(emscripten_fetch_t *fetch) {
+  printf("Finished duplicate of %s\n", fetch->url);
+  assert(fetch->numBytes == 6);
+  assert(!memcmp(fetch->data, "hello\n", 6));
+  numDuplicatesFinished++;
+  emscripten_fetch_close(fetch);
+  check_done();
+}
+
+static void failure(emscripten_fetch_t *fetch) {
+  printf("onerror: %s %d '%s'\n", fetch->url, fetch->status, fetch->statusText);
+  // Only the fetch that we close while it is queued may fail.
+  assert(!strcmp(fetch->url, "file4.txt"));
+  assert(fetch->status == (unsigned short)-1);
+}
+
+static emscripten_fetch_t *start(const char *url, int priority, void (*onsuccess)(emscripten_fetch_t *)) {
+  emscripten_fetch_attr_t attr;
+  emscripten_fetch_attr_init(&attr);
+  strcpy(attr.requestMethod, "GET");
+  attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY | EMSCRIPTEN_FETCH_REPLACE;
+  attr.priority = priority;
+  attr.onsuccess = onsuccess;
+  attr.onerror = failure;
+  return emscripten_fetch(&attr, url);
+}
+
+int main() {
+  emscripten_fetch_set_max_concurrent_per_origin(1);
+  emscripten_fetch_set_deduplication(EM_TRUE);
+
+  start("file0.txt", EMSCRIPTEN_FETCH_PRIORITY_NORMAL, success);
+  start("file1.txt", EMSCRIPTEN_FETCH_PRIORITY_NORMAL, success);
+  start("file2.txt", EMSCRIPTEN_FETCH_PRIORITY_LOW, success);
+  start("dup.txt", EMSCRIPTEN_FETCH_PRIORITY_LOW, success);
+  start("dup.txt", EMSCRIPTEN_FETCH_PRIORITY_LOW, duplicate_success);
+  start("dup.txt", EMSCRIPTEN_FETCH_PRIORITY_LOW, duplicate_success);
+  start("file3.txt", EMSCRIPTEN_FETCH_PRIORITY_HIGH, success);
+
+  // Cancel a request while it is still queued.
+  emscripten_fetch_close(start("file4.txt", EMSCRIPTEN_FETCH_PRIORITY_HIGH, success));
+
+  emscripten_fetch_stats_t stats;
+  emscripten_fetch_get_stats(&stats);
+  printf("queued %u, in flight %u, waiting %u\n", stats.queued, stats.inFlight, stats.waiting);
+  assert(stats.queued == 4);
+  assert(stats.inFlight == 1);
+  assert(stats.waiting == 2);
+  return 0;
+}
@@ -7,11 +7,18 @@
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
+#include <emscripten/eventloop.h>
 #include <emscripten/fetch.h>
 
 // Compute rudimentary checksum of data
 uint32_t checksum = 0;
 
+// The chunks are streamed into this buffer, which is much smaller than the
+// file.
+static char buffer[32768];
+int numChunks = 0;
+bool paused = false;
+
 int main()
 {
   emscripten_fetch_attr_t attr;
@@ -24,6 +31,7 @@ int main()
     assert(fetch->numBytes == 0);
     assert(fetch->totalBytes == 134217728);
     assert(checksum == 0xA7F8E858U);
+    assert(!paused);
     emscripten_fetch_close(fetch);
 
     exit(0);
@@ -34,15 +42,30 @@ int main()
       (fetch->totalBytes > 0) ? "%" : " bytes",
       fetch->dataOffset,
       fetch->dataOffset + fetch->numBytes);
-    assert(fetch->data != 0);
+    assert(!paused);
+    assert(fetch->data == buffer);
     assert(fetch->numBytes > 0);
+    assert(fetch->numBytes <= sizeof(buffer));
     assert(fetch->dataOffset + fetch->numBytes <= fetch->totalBytes);
     assert(fetch->totalBytes <= 134217728);
 
     for(int i = 0; i < fetch->numBytes; ++i)
       checksum = ((checksum << 8) | (checksum >> 24)) * fetch->data[i] + fetch->data[i];
+
+    // Every now and then, stop receiving data for a while to exercise
+    // backpressure.
+    if (++numChunks % 512 == 0) {
+      assert(emscripten_fetch_pause(fetch) == EMSCRIPTEN_RESULT_SUCCESS);
+      paused = true;
+      emscripten_set_timeout([](void *arg) {
+        paused = false;
+        assert(emscripten_fetch_resume((emscripten_fetch_t*)arg) == EMSCRIPTEN_RESULT_SUCCESS);
+      }, 10, fetch);
+    }
   };
-  attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY | EMSCRIPTEN_FETCH_APPEND | EMSCRIPTEN_FETCH_STREAM_DATA;
+  attr.attributes = EMSCRIPTEN_FETCH_STREAM_DATA;
+  attr.streamBuffer = buffer;
+  attr.streamBufferSize = sizeof(buffer);
   emscripten_fetch_t *fetch = emscripten_fetch(&attr, "largefile.txt");
   return 99;
 }
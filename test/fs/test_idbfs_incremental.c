@@ -0,0 +1,171 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// The FIRST run syncs a mount in full, changes it, and syncs again, which only
+// writes what changed: a renamed directory, a path that was unlinked and
+// created again, a rewrite in the middle of a file that is stored in chunks,
+// and a chunked file truncated below the chunk size. The second run loads the
+// mount from the database and checks every byte.
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <emscripten.h>
+
+#define MOUNT "/incremental"
+// IDBFS stores files larger than 1MB in 1MB chunks.
+#define BIG_SIZE (3 * 1024 * 1024 + 12345)
+#define REWRITE_OFFSET (1024 * 1024 - 1000)
+#define REWRITE_SIZE (200 * 1000)
+#define TRUNCATED_SIZE (700 * 1000)
+
+EM_ASYNC_JS(void, mount_and_populate, (int clear), {
+  if (clear) {
+    // Start from an empty database, whatever earlier runs left in it.
+    await new Promise((resolve, reject) => {
+      var req = indexedDB.deleteDatabase('/incremental');
+      req.onsuccess = resolve;
+      req.onerror = () => reject(req.error);
+    });
+  }
+  FS.mkdir('/incremental');
+  FS.mount(IDBFS, {}, '/incremental');
+  await new Promise((resolve, reject) => FS.syncfs(true, (err) => err ? reject(err) : resolve()));
+});
+
+EM_ASYNC_JS(void, sync_to_db, (), {
+  await new Promise((resolve, reject) => FS.syncfs(false, (err) => err ? reject(err) : resolve()));
+});
+
+// Differs between the chunks of a file, so that a chunk stored under the
+// wrong index is caught.
+static unsigned char initial_byte(int i) {
+  return (i * 31 + (i >> 20)) & 0xff;
+}
+
+static unsigned char rewritten_byte(int i) {
+  return ((i * 7 + 3) & 0xff) ^ 0x5a;
+}
+
+static unsigned char expected_big_byte(int i) {
+  if (i >= REWRITE_OFFSET && i < REWRITE_OFFSET + REWRITE_SIZE) {
+    return rewritten_byte(i);
+  }
+  return initial_byte(i);
+}
+
+static void write_file(const char *path, const void *data, size_t size) {
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  assert(fd >= 0);
+  assert(write(fd, data, size) == size);
+  assert(close(fd) == 0);
+}
+
+static void write_text(const char *path, const char *text) {
+  write_file(path, text, strlen(text));
+}
+
+static unsigned char *read_file(const char *path, size_t *size) {
+  struct stat st;
+  assert(stat(path, &st) == 0);
+  assert(S_ISREG(st.st_mode));
+  unsigned char *data = malloc(st.st_size + 1);
+  int fd = open(path, O_RDONLY);
+  assert(fd >= 0);
+  assert(read(fd, data, st.st_size) == st.st_size);
+  assert(close(fd) == 0);
+  data[st.st_size] = 0;
+  *size = st.st_size;
+  return data;
+}
+
+static void check_text(const char *path, const char *text) {
+  size_t size;
+  unsigned char *data = read_file(path, &size);
+  assert(size == strlen(text));
+  assert(strcmp((char *)data, text) == 0);
+  free(data);
+}
+
+static void check_missing(const char *path) {
+  struct stat st;
+  assert(stat(path, &st) == -1);
+  assert(errno == ENOENT);
+}
+
+int main() {
+#if FIRST
+  mount_and_populate(1);
+
+  assert(mkdir(MOUNT "/dir", 0777) == 0);
+  assert(mkdir(MOUNT "/dir/sub", 0777) == 0);
+  write_text(MOUNT "/dir/a.txt", "in dir");
+  write_text(MOUNT "/dir/sub/b.txt", "in dir/sub");
+  write_text(MOUNT "/replaced.txt", "old contents");
+  write_text(MOUNT "/file_then_dir", "a file");
+  unsigned char *big = malloc(BIG_SIZE);
+  for (int i = 0; i < BIG_SIZE; i++) {
+    big[i] = initial_byte(i);
+  }
+  write_file(MOUNT "/big.bin", big, BIG_SIZE);
+  write_file(MOUNT "/truncated.bin", big, BIG_SIZE);
+  free(big);
+  // The first sync of a mount writes all of it.
+  sync_to_db();
+
+  assert(rename(MOUNT "/dir", MOUNT "/renamed") == 0);
+  assert(unlink(MOUNT "/replaced.txt") == 0);
+  write_text(MOUNT "/replaced.txt", "new contents");
+  assert(unlink(MOUNT "/file_then_dir") == 0);
+  assert(mkdir(MOUNT "/file_then_dir", 0777) == 0);
+  write_text(MOUNT "/file_then_dir/c.txt", "now a dir");
+  // Spans the boundary between the first two chunks.
+  unsigned char *rewrite = malloc(REWRITE_SIZE);
+  for (int i = 0; i < REWRITE_SIZE; i++) {
+    rewrite[i] = rewritten_byte(REWRITE_OFFSET + i);
+  }
+  int fd = open(MOUNT "/big.bin", O_WRONLY);
+  assert(fd >= 0);
+  assert(pwrite(fd, rewrite, REWRITE_SIZE, REWRITE_OFFSET) == REWRITE_SIZE);
+  assert(close(fd) == 0);
+  free(rewrite);
+  assert(truncate(MOUNT "/truncated.bin", TRUNCATED_SIZE) == 0);
+  // Only writes the changes since the last sync.
+  sync_to_db();
+#else
+  mount_and_populate(0);
+
+  check_missing(MOUNT "/dir");
+  check_text(MOUNT "/renamed/a.txt", "in dir");
+  check_text(MOUNT "/renamed/sub/b.txt", "in dir/sub");
+  check_text(MOUNT "/replaced.txt", "new contents");
+  struct stat st;
+  assert(stat(MOUNT "/file_then_dir", &st) == 0);
+  assert(S_ISDIR(st.st_mode));
+  check_text(MOUNT "/file_then_dir/c.txt", "now a dir");
+
+  size_t size;
+  unsigned char *data = read_file(MOUNT "/big.bin", &size);
+  assert(size == BIG_SIZE);
+  for (int i = 0; i < BIG_SIZE; i++) {
+    assert(data[i] == expected_big_byte(i));
+  }
+  free(data);
+
+  data = read_file(MOUNT "/truncated.bin", &size);
+  assert(size == TRUNCATED_SIZE);
+  for (int i = 0; i < TRUNCATED_SIZE; i++) {
+    assert(data[i] == initial_byte(i));
+  }
+  free(data);
+#endif
+  return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <emscripten.h>
+
+// Loads a package built with `--lazy --lazy-prefetch /critical.txt`, see
+// test_file_packager_lazy.
+
+#define BIG_SIZE 100000
+
+static int is_lazy(const char* path) {
+  return EM_ASM_INT({ return !!FS.lookupPath(UTF8ToString($0)).node.lazy; }, path);
+}
+
+int main() {
+  // Only the prefetched file is loaded before main.
+  assert(!is_lazy("/critical.txt"));
+  assert(is_lazy("/big.dat"));
+  assert(is_lazy("/other.dat"));
+
+  char buf[32];
+  int fd = open("/critical.txt", O_RDONLY);
+  assert(read(fd, buf, sizeof(buf)) == 17);
+  buf[17] = 0;
+  assert(strcmp(buf, "needed at startup") == 0);
+  close(fd);
+
+  // The size is known without loading the file.
+  struct stat st;
+  assert(stat("/big.dat", &st) == 0);
+  assert(st.st_size == BIG_SIZE);
+  assert(is_lazy("/big.dat"));
+
+  // Reading loads it, and only it.
+  fd = open("/big.dat", O_RDONLY);
+  assert(is_lazy("/big.dat"));
+  assert(pread(fd, buf, 3, 50000) == 3);
+  assert(buf[0] == 'a' + 50000 % 26);
+  assert(buf[2] == 'a' + 50002 % 26);
+  assert(!is_lazy("/big.dat"));
+  assert(is_lazy("/other.dat"));
+  close(fd);
+
+  // Truncating loads the file first.
+  assert(truncate("/other.dat", 3) == 0);
+  assert(!is_lazy("/other.dat"));
+  fd = open("/other.dat", O_RDONLY);
+  assert(read(fd, buf, sizeof(buf)) == 3);
+  assert(memcmp(buf, "oth", 3) == 0);
+  close(fd);
+
+  printf("done\n");
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdio.h>
+#include <GL/gl.h>
+#include <SDL/SDL.h>
+#include <emscripten/emscripten.h>
+
+// Issues glBegin()/glEnd() groups against the headless canvas, and prints how
+// many of them -sGL_IMMEDIATE_BATCHING drew together, and how many draw calls
+// reached the WebGL context.
+
+static int last_groups, last_draws, last_webgl_draws;
+
+static int batched_groups() {
+  return EM_ASM_INT(return GLImmediate.batchStats.groups);
+}
+
+static int batched_draws() {
+  return EM_ASM_INT(return GLImmediate.batchStats.draws);
+}
+
+static int webgl_draws() {
+  return EM_ASM_INT(return GLctx.callCounts.drawArrays + GLctx.callCounts.drawElements);
+}
+
+static void report(const char* label) {
+  // The pending batch is drawn before any call that reaches the context.
+  int pending_draws = batched_draws() - last_draws;
+  glFlush();
+  int groups = batched_groups(), draws = batched_draws(), webgl = webgl_draws();
+  printf("%s: %d groups, %d draws before glFlush, %d after, %d WebGL draw calls\n",
+         label, groups - last_groups, pending_draws, draws - last_draws, webgl - last_webgl_draws);
+  last_groups = groups;
+  last_draws = draws;
+  last_webgl_draws = webgl;
+}
+
+static void quad(float x) {
+  glBegin(GL_QUADS);
+  glTexCoord2f(0, 0); glVertex2f(x, 0);
+  glTexCoord2f(1, 0); glVertex2f(x + 1, 0);
+  glTexCoord2f(1, 1); glVertex2f(x + 1, 1);
+  glTexCoord2f(0, 1); glVertex2f(x, 1);
+  glEnd();
+}
+
+int main() {
+  SDL_Init(SDL_INIT_VIDEO);
+  SDL_SetVideoMode(256, 256, 32, SDL_OPENGL);
+
+  GLuint textures[2];
+  glGenTextures(2, textures);
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glOrtho(0, 8, 0, 1, -1, 1);
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, textures[0]);
+  report("setup");
+
+  // Groups with the same state are drawn together, once something reaches the
+  // context.
+  for (int i = 0; i < 4; i++) quad(i);
+  report("same state");
+
+  // Each of these changes the state the following groups are drawn with, so
+  // the groups before it are drawn first.
+  quad(0); quad(1);
+  glBindTexture(GL_TEXTURE_2D, textures[1]);
+  quad(2); quad(3);
+  report("texture bind");
+
+  quad(0); quad(1);
+  glColor4f(1, 0, 0, 1);
+  quad(2); quad(3);
+  report("color");
+
+  quad(0); quad(1);
+  glTranslatef(1, 0, 0);
+  quad(2); quad(3);
+  report("matrix");
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <GLES2/gl2.h>
+#include <emscripten/emscripten.h>
+#include <emscripten/gl_profile.h>
+#include <emscripten/html5.h>
+
+// Renders a few frames against the headless canvas, and prints what
+// -sGL_PROFILE=2 recorded for them.
+
+static void print_stats(const char *what, const emscripten_gl_profile_t *stats) {
+  printf("%s: %u calls, %u draw calls, %u bytes uploaded\n", what, stats->calls, stats->draw_calls, stats->uploaded_bytes);
+}
+
+int main() {
+  emscripten_gl_profile_t stats;
+  assert(emscripten_gl_profile_get_frame_count() == 0);
+  assert(emscripten_gl_profile_get_last_frame(&stats) == -1);
+
+  EmscriptenWebGLContextAttributes attrs;
+  emscripten_webgl_init_context_attributes(&attrs);
+  EMSCRIPTEN_WEBGL_CONTEXT_HANDLE context = emscripten_webgl_create_context("#canvas", &attrs);
+  assert(context > 0);
+  emscripten_webgl_make_context_current(context);
+
+  // Startup: create and fill a vertex buffer and a 3x3 RGB texture, whose rows
+  // are padded to the default unpack alignment of 4 bytes.
+  static float vertices[3 * 64];
+  GLuint buffer;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  static unsigned char pixels[4 * 3 * 3];
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 3, 3, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+  // Allocating storage without data uploads nothing.
+  glBufferData(GL_ARRAY_BUFFER, 1024, NULL, GL_DYNAMIC_DRAW);
+  emscripten_gl_profile_end_frame();
+
+  for (int frame = 1; frame <= 3; ++frame) {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, 16 * frame, vertices);
+    for (int i = 0; i < frame * 10; ++i) {
+      glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glClear(GL_COLOR_BUFFER_BIT);
+    emscripten_gl_profile_end_frame();
+  }
+
+  printf("frames: %d\n", emscripten_gl_profile_get_frame_count());
+  assert(emscripten_gl_profile_get_last_frame(&stats) == 0);
+  print_stats("last frame", &stats);
+  assert(emscripten_gl_profile_get_max_frame(&stats) == 0);
+  print_stats("max frame", &stats);
+  // A budget check, as a test would do it.
+  assert(stats.draw_calls <= 500);
+  assert(stats.time >= 0);
+  assert(emscripten_gl_profile_get_function("glDrawArrays", &stats) == 0);
+  print_stats("glDrawArrays", &stats);
+  assert(emscripten_gl_profile_get_function("glBufferSubData", &stats) == 0);
+  print_stats("glBufferSubData", &stats);
+  assert(emscripten_gl_profile_get_function("glTexImage2D", &stats) == 0);
+  print_stats("glTexImage2D", &stats);
+
+  char *trace = emscripten_gl_profile_get_trace();
+  assert(trace);
+  EM_ASM({
+    var trace = JSON.parse(UTF8ToString($0));
+    var counts = {};
+    for (var event of trace.traceEvents) {
+      var key = `${event.name} (${event.ph})`;
+      counts[key] = (counts[key] || 0) + 1;
+    }
+    for (var key of ['frame (X)', 'frame totals (C)', 'glDrawArrays (X)', 'glTexImage2D (X)']) {
+      out(`trace: ${key}: ${counts[key]}`);
+    }
+    out(`trace: dropped ${trace.otherData.droppedEvents}`);
+  }, trace);
+  free(trace);
+  return 0;
+}
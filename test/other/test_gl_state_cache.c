@@ -0,0 +1,128 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <GLES2/gl2.h>
+#include <emscripten/emscripten.h>
+#include <emscripten/html5.h>
+
+// Issues redundant state changes against the headless canvas, and prints how
+// many calls of each function reached the WebGL context and how many were
+// dropped by -sGL_STATE_CACHE.
+
+static GLuint create_program() {
+  GLuint program = glCreateProgram();
+  GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+  GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+  glAttachShader(program, vs);
+  glAttachShader(program, fs);
+  glLinkProgram(program);
+  return program;
+}
+
+int main() {
+  EmscriptenWebGLContextAttributes attrs;
+  emscripten_webgl_init_context_attributes(&attrs);
+  EMSCRIPTEN_WEBGL_CONTEXT_HANDLE context = emscripten_webgl_create_context("#canvas", &attrs);
+  assert(context > 0);
+  emscripten_webgl_make_context_current(context);
+
+  // Caps are cached separately, and enabling and disabling is not redundant.
+  glEnable(GL_BLEND);
+  glEnable(GL_BLEND);
+  glEnable(GL_DEPTH_TEST);
+  glDisable(GL_BLEND);
+  glDisable(GL_BLEND);
+  glEnable(GL_BLEND);
+
+  // glBlendFunc(s, d) is the same as glBlendFuncSeparate(s, d, s, d).
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+  glBlendEquation(GL_FUNC_ADD);
+  glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+
+  glDepthFunc(GL_LEQUAL);
+  glDepthFunc(GL_LEQUAL);
+  glDepthMask(GL_FALSE);
+  glDepthMask(GL_FALSE);
+
+  // Texture bindings are per texture unit, and GL_TEXTURE0 is initially
+  // active.
+  GLuint textures[2];
+  glGenTextures(2, textures);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, textures[0]);
+  glBindTexture(GL_TEXTURE_2D, textures[0]);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, textures[0]);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, textures[0]);
+  glBindTexture(GL_TEXTURE_2D, textures[1]);
+  // Deleting a texture unbinds it, so binding its name again is not redundant.
+  glDeleteTextures(1, &textures[1]);
+  glBindTexture(GL_TEXTURE_2D, textures[1]);
+
+  GLuint buffers[2];
+  glGenBuffers(2, buffers);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[0]);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[0]);
+
+  GLuint program = create_program();
+  glUseProgram(program);
+  glUseProgram(program);
+  GLint loc = glGetUniformLocation(program, "activeUniform0");
+  GLint loc2 = glGetUniformLocation(program, "activeUniform1");
+  GLint loc3 = glGetUniformLocation(program, "activeUniform2");
+  assert(loc >= 0 && loc2 >= 0 && loc3 >= 0);
+
+  glUniform1i(loc, 3);
+  glUniform1i(loc, 3);
+  glUniform1i(loc2, 3);
+  glUniform1i(loc, 4);
+
+  float color[4] = { 1, 0.5f, 0.25f, 1 };
+  glUniform4fv(loc2, 1, color);
+  glUniform4fv(loc2, 1, color);
+  color[3] = 0;
+  glUniform4fv(loc2, 1, color);
+
+  float matrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+  glUniformMatrix4fv(loc3, 1, GL_FALSE, matrix);
+  glUniformMatrix4fv(loc3, 1, GL_FALSE, matrix);
+
+  // Uniform values belong to the program, and are reset by linking it again.
+  GLuint program2 = create_program();
+  glUseProgram(program2);
+  GLint loc4 = glGetUniformLocation(program2, "activeUniform0");
+  glUniform1f(loc4, 1.5f);
+  glUseProgram(program);
+  glUniform1i(loc, 4);
+  glUseProgram(program2);
+  glUniform1f(loc4, 1.5f);
+  glLinkProgram(program2);
+  glUniform1f(loc4, 1.5f);
+
+  // A deleted program stays in use, but binding its name again binds null.
+  glDeleteProgram(program2);
+  glUseProgram(program2);
+
+  EM_ASM({
+    ['glEnable', 'glDisable', 'glBlendFunc', 'glBlendFuncSeparate', 'glBlendEquation',
+     'glBlendEquationSeparate', 'glDepthFunc', 'glDepthMask', 'glActiveTexture',
+     'glBindTexture', 'glBindBuffer', 'glUseProgram', 'glUniform1i', 'glUniform1f',
+     'glUniform4fv', 'glUniformMatrix4fv'].forEach((name) => {
+      var webglName = name[2].toLowerCase() + name.slice(3);
+      out(`${name}: forwarded ${GLctx.callCounts[webglName]}, elided ${GL.stateCacheElided[name] || 0}`);
+    });
+  });
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/heap.h>
+
+#define NUM_THREADS 4
+#define NUM_ALLOCS 1000
+
+static void *allocs[NUM_THREADS][NUM_ALLOCS];
+
+static void *thread_main(void *arg) {
+  intptr_t id = (intptr_t)arg;
+  for (int i = 0; i < NUM_ALLOCS; i++) {
+    size_t size = 1 + (i * 37) % 300;
+    unsigned char *p = emscripten_thread_sbrk(size);
+    assert(p != (void*)-1);
+    assert((uintptr_t)p % _Alignof(max_align_t) == 0);
+    memset(p, id + 1, size);
+    allocs[id][i] = p;
+  }
+  // Check that no other thread overwrote our allocations.
+  for (int i = 0; i < NUM_ALLOCS; i++) {
+    size_t size = 1 + (i * 37) % 300;
+    unsigned char *p = allocs[id][i];
+    for (size_t j = 0; j < size; j++) {
+      assert(p[j] == id + 1);
+    }
+  }
+  return NULL;
+}
+
+int main() {
+  // The memory is created at its maximum size, and never grows.
+  size_t heap_size = emscripten_get_heap_size();
+  printf("heap size: %zu\n", heap_size);
+  assert(heap_size == emscripten_get_heap_max());
+
+  pthread_t threads[NUM_THREADS];
+  for (intptr_t i = 0; i < NUM_THREADS; i++) {
+    pthread_create(&threads[i], NULL, thread_main, (void*)i);
+  }
+  for (int i = 0; i < NUM_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  // Running out of the reservation is reported by malloc, like a failed grow.
+  int allocated = 0;
+  while (malloc(1024 * 1024)) {
+    allocated++;
+  }
+  printf("allocated %d MB\n", allocated);
+  assert(emscripten_get_heap_size() == heap_size);
+  printf("done\n");
+  return 0;
+}
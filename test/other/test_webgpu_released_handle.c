@@ -0,0 +1,34 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <webgpu/webgpu.h>
+#include <emscripten/html5_webgpu.h>
+
+// Uses a buffer handle after it was released and its slot was reused by
+// another buffer, which ASSERTIONS catch by the generation in the handle.
+
+#define SLOT_MASK ((1 << 20) - 1)
+
+int main() {
+  WGPUDevice device = emscripten_webgpu_get_device();
+  WGPUBufferDescriptor desc = {
+    .usage = WGPUBufferUsage_CopyDst,
+    .size = 16,
+  };
+  WGPUBuffer first = wgpuDeviceCreateBuffer(device, &desc);
+  wgpuBufferRelease(first);
+  WGPUBuffer second = wgpuDeviceCreateBuffer(device, &desc);
+  printf("same slot: %d\n", ((uintptr_t)first & SLOT_MASK) == ((uintptr_t)second & SLOT_MASK));
+  printf("same handle: %d\n", first == second);
+  printf("size: %d\n", (int)wgpuBufferGetSize(second));
+  fflush(stdout);
+  wgpuBufferGetSize(first);
+  printf("released handle was not caught\n");
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Copyright 2024 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Streams a ramp through an emscripten_audio_ring_t from a producer pthread to
+// the main thread, in chunks of varying size so that both sides wrap around
+// the end of the ring.
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <emscripten/webaudio.h>
+
+#define NUM_FRAMES 200000
+#define QUANTUM 128
+
+static emscripten_audio_ring_t *ring;
+
+static void *producer(void *arg) {
+  float left[100], right[100], interleaved[200];
+  uint32_t sent = 0;
+  for (int iter = 0; sent < NUM_FRAMES; ++iter) {
+    uint32_t n = 1 + iter % 100;
+    if (n > NUM_FRAMES - sent) {
+      n = NUM_FRAMES - sent;
+    }
+    if (emscripten_audio_ring_write_available(ring) < n) {
+      sched_yield();
+      continue;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+      left[i] = interleaved[2*i] = sent + i;
+      right[i] = interleaved[2*i+1] = -(float)(sent + i);
+    }
+    const float *channels[2] = { left, right };
+    uint32_t written = iter % 2 ? emscripten_audio_ring_write(ring, channels, n)
+                                : emscripten_audio_ring_write_interleaved(ring, interleaved, n);
+    assert(written == n);
+    sent += n;
+  }
+  return NULL;
+}
+
+int main() {
+  float storage[2 * 16];
+  emscripten_audio_ring_t fixed;
+  assert(!emscripten_audio_ring_init(&fixed, storage, 12, 2));
+  assert(emscripten_audio_ring_init(&fixed, storage, 16, 2));
+
+  // Reading from an empty ring produces silence and counts an underrun.
+  float out[2 * QUANTUM];
+  out[0] = out[QUANTUM + 5] = 1.0f;
+  assert(emscripten_audio_ring_read(&fixed, out, QUANTUM) == 0);
+  assert(out[0] == 0.0f && out[QUANTUM + 5] == 0.0f);
+  assert(fixed.underruns == 1);
+
+  // Writing more than fits drops the excess and counts an overrun.
+  float samples[2 * 20] = { 0 };
+  assert(emscripten_audio_ring_write_interleaved(&fixed, samples, 20) == 16);
+  assert(fixed.overruns == 1);
+  assert(emscripten_audio_ring_write_available(&fixed) == 0);
+  assert(emscripten_audio_ring_read_available(&fixed) == 16);
+
+  ring = emscripten_audio_ring_create(1000, 2);
+  assert(ring);
+  assert(ring->capacity == 1024);
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, producer, NULL);
+
+  uint32_t received = 0;
+  while (received < NUM_FRAMES) {
+    if (emscripten_audio_ring_read_available(ring) < QUANTUM &&
+        NUM_FRAMES - received >= QUANTUM) {
+      sched_yield();
+      continue;
+    }
+    uint32_t n = emscripten_audio_ring_read(ring, out, QUANTUM);
+    for (uint32_t i = 0; i < n; ++i) {
+      assert(out[i] == (float)(received + i));
+      assert(out[QUANTUM + i] == -(float)(received + i));
+    }
+    received += n;
+  }
+  pthread_join(thread, NULL);
+
+  // Only the final, partial quantum underruns.
+  printf("received %u frames, underruns %u, overruns %u\n",
+         received, ring->underruns, ring->overruns);
+  emscripten_audio_ring_destroy(ring);
+  return 0;
+}
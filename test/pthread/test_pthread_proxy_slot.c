@@ -0,0 +1,76 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Checks the per-thread proxy slot used for synchronously proxied JS library
+// calls, along with its fallbacks to the generic proxying path.
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+void track_generic_proxy_calls(void);
+int get_generic_proxy_calls(void);
+int proxied_add3(int a, int b, int c);
+int proxied_sum20(int a0, int a1, int a2, int a3, int a4, int a5, int a6,
+                  int a7, int a8, int a9, int a10, int a11, int a12, int a13,
+                  int a14, int a15, int a16, int a17, int a18, int a19);
+int nested_add3(int a, int b, int c);
+
+void* nested_thread(void* arg) {
+  track_generic_proxy_calls();
+  int* result = arg;
+  result[0] = nested_add3(4, 5, 6);
+  result[1] = get_generic_proxy_calls();
+  return NULL;
+}
+
+int main() {
+  track_generic_proxy_calls();
+
+  // Few Number arguments: the fast path, which never reaches the generic
+  // path.
+  int result = proxied_add3(1, 2, 3);
+  printf("add3: %d (generic calls: %d)\n", result, get_generic_proxy_calls());
+  assert(result == 123);
+  assert(get_generic_proxy_calls() == 0);
+
+  // Syscalls use the same path.
+  struct stat st;
+  result = stat("/", &st);
+  printf("stat: %d (generic calls: %d)\n", result, get_generic_proxy_calls());
+  assert(result == 0 && S_ISDIR(st.st_mode));
+  assert(get_generic_proxy_calls() == 0);
+
+  // Too many arguments for the fast path and for the slot.
+  result = proxied_sum20(1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                         11, 12, 13, 14, 15, 16, 17, 18, 19, 20);
+  printf("sum20: %d (generic calls: %d)\n", result, get_generic_proxy_calls());
+  assert(result == 2870);
+  assert(get_generic_proxy_calls() == 1);
+
+  // The slot is busy, so the fast path falls back to the generic path.
+  int nested[2];
+  pthread_t thread;
+  pthread_create(&thread, NULL, nested_thread, nested);
+  pthread_join(thread, NULL);
+  printf("nested add3: %d (generic calls: %d)\n", nested[0], nested[1]);
+  assert(nested[0] == 456);
+  assert(nested[1] == 1);
+
+  // The slot of this thread is unaffected. pthread_create itself may have
+  // used the generic path, so only count calls from here on.
+  int before = get_generic_proxy_calls();
+  result = proxied_add3(7, 8, 9);
+  printf("add3: %d (generic calls: %d)\n", result,
+         get_generic_proxy_calls() - before);
+  assert(result == 789);
+  assert(get_generic_proxy_calls() == before);
+
+  printf("done\n");
+  return 0;
+}
@@ -0,0 +1,42 @@
+addToLibrary({
+  // Counts, per thread, the calls that take the generic proxyToMainThread path
+  // rather than the proxy slot fast path.
+  $genericProxyCalls: 0,
+  track_generic_proxy_calls__deps: ['$proxyToMainThread', '$genericProxyCalls'],
+  track_generic_proxy_calls: () => {
+    var orig = proxyToMainThread;
+    proxyToMainThread = (...args) => {
+      genericProxyCalls++;
+      return orig(...args);
+    };
+  },
+
+  get_generic_proxy_calls__deps: ['$genericProxyCalls'],
+  get_generic_proxy_calls: () => genericProxyCalls,
+
+  proxied_add3__proxy: 'sync',
+  proxied_add3__sig: 'iiii',
+  proxied_add3: (a, b, c) => ENVIRONMENT_IS_PTHREAD ? -1 : a * 100 + b * 10 + c,
+
+  // Twenty arguments need forty tagged values, which is more than fit in the
+  // proxy slot, so this is always proxied through a stack allocated buffer.
+  proxied_sum20__proxy: 'sync',
+  proxied_sum20__sig: 'iiiiiiiiiiiiiiiiiiiii',
+  proxied_sum20: (a0, a1, a2, a3, a4, a5, a6, a7, a8, a9,
+                  a10, a11, a12, a13, a14, a15, a16, a17, a18, a19) => {
+    if (ENVIRONMENT_IS_PTHREAD) return -1;
+    var args = [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9,
+                a10, a11, a12, a13, a14, a15, a16, a17, a18, a19];
+    return args.reduce((sum, arg, i) => sum + arg * (i + 1), 0);
+  },
+
+  // Runs on the calling thread. Occupies its proxy slot, as an outer proxied
+  // call would, so that the proxied call below has to take the fallback path.
+  // The slot is never released, so this must be called on a thread that does
+  // nothing else.
+  nested_add3__deps: ['proxied_add3', '_emscripten_proxy_slot_acquire'],
+  nested_add3: (a, b, c) => {
+    if (!__emscripten_proxy_slot_acquire(0)) return -2;
+    return _proxied_add3(a, b, c);
+  },
+});
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Streams numbered UDP packets through test_sockets_mmsg_server.c, sending
+// and receiving them in batches with sendmmsg() and recvmmsg(). Each packet is
+// gathered from and scattered to two buffers, a sequence number and a payload.
+// Reports the round trip throughput in packets per second. Finally round trips
+// an empty datagram, which must be received as a message of its own.
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <emscripten.h>
+
+#ifndef NUM_PACKETS
+#define NUM_PACKETS 100000
+#endif
+// Maximum number of packets in flight.
+#define WINDOW 1024
+#define BATCH 64
+#define PAYLOAD 32
+
+static int fd;
+static struct sockaddr_in server_addr;
+static uint32_t num_sent, num_received;
+static double start_time;
+static int sent_empty;
+
+static void fill_payload(uint32_t seq, char *payload) {
+  for (int i = 0; i < PAYLOAD; i++) {
+    payload[i] = (char)(seq + i);
+  }
+}
+
+static void send_packets() {
+  static uint32_t seqs[BATCH];
+  static char payloads[BATCH][PAYLOAD];
+  static struct iovec iovs[BATCH][2];
+  static struct mmsghdr msgs[BATCH];
+
+  while (num_sent < NUM_PACKETS && num_sent - num_received < WINDOW) {
+    int n = 0;
+    for (; n < BATCH && num_sent + n < NUM_PACKETS; n++) {
+      seqs[n] = num_sent + n;
+      fill_payload(seqs[n], payloads[n]);
+      iovs[n][0].iov_base = &seqs[n];
+      iovs[n][0].iov_len = sizeof(seqs[n]);
+      iovs[n][1].iov_base = payloads[n];
+      iovs[n][1].iov_len = PAYLOAD;
+      memset(&msgs[n].msg_hdr, 0, sizeof(msgs[n].msg_hdr));
+      msgs[n].msg_hdr.msg_name = &server_addr;
+      msgs[n].msg_hdr.msg_namelen = sizeof(server_addr);
+      msgs[n].msg_hdr.msg_iov = iovs[n];
+      msgs[n].msg_hdr.msg_iovlen = 2;
+    }
+    int sent = sendmmsg(fd, msgs, n, 0);
+    assert(sent == n);
+    for (int i = 0; i < n; i++) {
+      assert(msgs[i].msg_len == sizeof(uint32_t) + PAYLOAD);
+    }
+    num_sent += n;
+  }
+}
+
+static void on_message(int fd_, void *userData) {
+  static uint32_t seqs[BATCH];
+  static char payloads[BATCH][PAYLOAD];
+  static struct iovec iovs[BATCH][2];
+  static struct mmsghdr msgs[BATCH];
+  char expected[PAYLOAD];
+
+  if (sent_empty) {
+    char buf[PAYLOAD];
+    struct sockaddr_in from;
+    socklen_t fromlen = sizeof(from);
+    int n = recvfrom(fd, buf, sizeof(buf), 0, (struct sockaddr *)&from, &fromlen);
+    if (n == -1) {
+      assert(errno == EAGAIN);
+      return;
+    }
+    assert(n == 0);
+    assert(from.sin_port == server_addr.sin_port);
+    printf("received empty datagram\n");
+    close(fd);
+    emscripten_force_exit(0);
+  }
+
+  for (;;) {
+    for (int i = 0; i < BATCH; i++) {
+      iovs[i][0].iov_base = &seqs[i];
+      iovs[i][0].iov_len = sizeof(seqs[i]);
+      iovs[i][1].iov_base = payloads[i];
+      iovs[i][1].iov_len = PAYLOAD;
+      memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+      msgs[i].msg_hdr.msg_iov = iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+    int n = recvmmsg(fd, msgs, BATCH, 0, NULL);
+    if (n == -1) {
+      assert(errno == EAGAIN);
+      break;
+    }
+    for (int i = 0; i < n; i++) {
+      // The packets travel over a WebSocket, so they can't be lost or
+      // reordered.
+      assert(msgs[i].msg_len == sizeof(uint32_t) + PAYLOAD);
+      assert(!(msgs[i].msg_hdr.msg_flags & MSG_TRUNC));
+      assert(seqs[i] == num_received);
+      fill_payload(seqs[i], expected);
+      assert(!memcmp(payloads[i], expected, PAYLOAD));
+      num_received++;
+    }
+  }
+
+  if (num_received == NUM_PACKETS) {
+    double elapsed = (emscripten_get_now() - start_time) / 1000.0;
+    printf("received %d echoes in order\n", NUM_PACKETS);
+    printf("%.0f packets/sec\n", NUM_PACKETS / elapsed);
+    assert(sendto(fd, "", 0, 0, (struct sockaddr *)&server_addr, sizeof(server_addr)) == 0);
+    sent_empty = 1;
+    return;
+  }
+  send_packets();
+}
+
+int main() {
+  fd = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (fd == -1) {
+    perror("cannot create socket");
+    exit(EXIT_FAILURE);
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+
+  memset(&server_addr, 0, sizeof(server_addr));
+  server_addr.sin_family = AF_INET;
+  server_addr.sin_port = htons(SOCKK);
+  if (inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr) != 1) {
+    perror("inet_pton failed");
+    exit(EXIT_FAILURE);
+  }
+
+  emscripten_set_socket_message_callback(NULL, on_message);
+  start_time = emscripten_get_now();
+  // The first packets are queued until the connection to the server opens.
+  send_packets();
+  return EXIT_SUCCESS;
+}
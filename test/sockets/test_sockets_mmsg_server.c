@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// UDP echo server that receives and sends its packets in batches with
+// recvmmsg() and sendmmsg().
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <emscripten.h>
+
+#define BATCH 64
+#define MAX_PACKET 1500
+
+static char buffers[BATCH][MAX_PACKET];
+static struct sockaddr_in addrs[BATCH];
+static struct iovec iovs[BATCH];
+static struct mmsghdr msgs[BATCH];
+
+static void on_message(int fd, void *userData) {
+  for (;;) {
+    for (int i = 0; i < BATCH; i++) {
+      iovs[i].iov_base = buffers[i];
+      iovs[i].iov_len = MAX_PACKET;
+      memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int n = recvmmsg(fd, msgs, BATCH, 0, NULL);
+    if (n == -1) {
+      assert(errno == EAGAIN);
+      return;
+    }
+    // Send back exactly what was received, to whoever sent it.
+    for (int i = 0; i < n; i++) {
+      iovs[i].iov_len = msgs[i].msg_len;
+    }
+    int sent = sendmmsg(fd, msgs, n, 0);
+    assert(sent == n);
+  }
+}
+
+int main() {
+  int fd = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (fd == -1) {
+    perror("cannot create socket");
+    exit(EXIT_FAILURE);
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(SOCKK);
+  if (inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr) != 1) {
+    perror("inet_pton failed");
+    exit(EXIT_FAILURE);
+  }
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+    perror("bind failed");
+    exit(EXIT_FAILURE);
+  }
+
+  emscripten_set_socket_message_callback(NULL, on_message);
+  return EXIT_SUCCESS;
+}
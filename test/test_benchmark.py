@@ -910,6 +910,130 @@ class benchmark(common.RunnerCore):
       return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
     self.do_benchmark('memset_16mb', read_file(test_file('benchmark/benchmark_memset.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-DMIN_COPY=1048576', '-DBUILD_FOR_SHELL', '-I' + test_file('benchmark')])
 
+  @non_core
+  def test_string_4k(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark('string_4k', read_file(test_file('benchmark/benchmark_string.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-DMAX_LEN=4096', '-I' + test_file('benchmark')])
+
+  @non_core
+  def test_string_4k_simd(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark('string_4k_simd', read_file(test_file('benchmark/benchmark_string.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-DMAX_LEN=4096', '-I' + test_file('benchmark')], emcc_args=['-msimd128'])
+
+  @non_core
+  def test_string_1mb_simd(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark('string_1mb_simd', read_file(test_file('benchmark/benchmark_string.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-DMIN_LEN=4096', '-I' + test_file('benchmark')], emcc_args=['-msimd128'])
+
+  @non_core
+  def test_memset_16k_simd(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark('memset_16k_simd', read_file(test_file('benchmark/benchmark_memset.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-DMIN_COPY=4096', '-DMAX_COPY=16384', '-DBUILD_FOR_SHELL', '-I' + test_file('benchmark')], emcc_args=['-msimd128', '-mno-bulk-memory'])
+
+  @non_core
+  def test_memcpy_4k_simd(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark('memcpy_4k_simd', read_file(test_file('benchmark/benchmark_memcpy.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-DMIN_COPY=128', '-DMAX_COPY=4096', '-DBUILD_FOR_SHELL', '-I' + test_file('benchmark')], emcc_args=['-msimd128', '-mno-bulk-memory'])
+
+  def utf_benchmark(self, name, filename, corpus, emcc_args, force_c=False):
+    def output_parser(output):
+      m = re.search(r'Time: ([\d\.]+) \([\d\.]+\), encode: ([\d\.]+)', output)
+      return (float(m.group(1)) + float(m.group(2))) / 1000
+    self.do_benchmark(name, read_file(test_file('benchmark/' + filename)), 'OK.', output_parser=output_parser,
+                      emcc_args=['--embed-file', test_file(corpus) + '@/' + corpus] + emcc_args,
+                      force_c=force_c, skip_native=True)
+
+  # The UTF-8 benchmarks decode and re-encode mostly short strings, with some
+  # long ones, so each variant exercises both the short and long string paths
+  # of UTF8ToString and stringToUTF8.
+  @non_core
+  def test_utf8_js(self):
+    self.utf_benchmark('utf8_js', 'benchmark_utf8.c', 'utf8_corpus.txt', ['-sTEXTDECODER=0'], force_c=True)
+
+  @non_core
+  def test_utf8_textdecoder(self):
+    self.utf_benchmark('utf8_textdecoder', 'benchmark_utf8.c', 'utf8_corpus.txt', [], force_c=True)
+
+  @non_core
+  def test_utf8_wasm(self):
+    self.utf_benchmark('utf8_wasm', 'benchmark_utf8.c', 'utf8_corpus.txt', ['-sWASM_UTF8_DECODING'], force_c=True)
+
+  @non_core
+  def test_utf8_wasm_simd(self):
+    self.utf_benchmark('utf8_wasm_simd', 'benchmark_utf8.c', 'utf8_corpus.txt', ['-sWASM_UTF8_DECODING', '-msimd128'], force_c=True)
+
+  @non_core
+  def test_utf16_js(self):
+    self.utf_benchmark('utf16_js', 'benchmark_utf16.cpp', 'utf16_corpus.txt', ['-sTEXTDECODER=0', '-sEXPORTED_RUNTIME_METHODS=UTF16ToString,stringToUTF16'])
+
+  @non_core
+  def test_utf16_textdecoder(self):
+    self.utf_benchmark('utf16_textdecoder', 'benchmark_utf16.cpp', 'utf16_corpus.txt', ['-sEXPORTED_RUNTIME_METHODS=UTF16ToString,stringToUTF16'])
+
+  @non_core
+  def test_calloc_128mb(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.e-]+)', output).group(1))
+    self.do_benchmark('calloc_128mb', read_file(test_file('benchmark/benchmark_calloc.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-I' + test_file('benchmark')], emcc_args=['-sMALLOC=emmalloc', '-sALLOW_MEMORY_GROWTH', '-sMAXIMUM_MEMORY=512MB'])
+
+  @non_core
+  def test_proxied_syscalls(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.e-]+)', output).group(1))
+    # With PROXY_TO_PTHREAD every syscall is a synchronous round trip to the
+    # main thread. The total covers only the calls that use the proxy slot fast
+    # path.
+    self.do_benchmark('proxied_syscalls', read_file(test_file('benchmark/benchmark_proxied_syscalls.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-I' + test_file('benchmark'), '-pthread'], emcc_args=['-sPROXY_TO_PTHREAD', '-sEXIT_RUNTIME'])
+
+  @non_core
+  def test_fs_lookup(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.e-]+)', output).group(1))
+    # 100,000 files, which is far more than the initial size of the FS name
+    # table.
+    self.do_benchmark('fs_lookup', read_file(test_file('benchmark/benchmark_fs_lookup.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-I' + test_file('benchmark')], emcc_args=['-sALLOW_MEMORY_GROWTH'], skip_native=True)
+
+  @non_core
+  def test_js_heap_growable(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    # Every heap access from JS goes through a GROWABLE_HEAP_* check.
+    self.do_benchmark('js_heap_growable', read_file(test_file('benchmark/benchmark_js_heap.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-I' + test_file('benchmark'), '-pthread'], emcc_args=['-sALLOW_MEMORY_GROWTH', '-sMAXIMUM_MEMORY=256MB', '-Wno-pthreads-mem-growth'], skip_native=True)
+
+  @non_core
+  def test_js_heap_reserved(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    self.do_benchmark('js_heap_reserved', read_file(test_file('benchmark/benchmark_js_heap.cpp')), 'Total time:', output_parser=output_parser, shared_args=['-I' + test_file('benchmark'), '-pthread'], emcc_args=['-sALLOW_MEMORY_GROWTH', '-sMAXIMUM_MEMORY=256MB', '-sRESERVE_MAXIMUM_MEMORY'], skip_native=True)
+
+  @non_core
+  def test_gl_client_arrays(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    # Runs against the headless canvas, which needs the Safari getContext()
+    # workaround to be disabled as there is no WebGLRenderingContext.
+    self.do_benchmark('gl_client_arrays', read_file(test_file('benchmark/benchmark_gl_client_arrays.cpp')), 'Total time:', output_parser=output_parser,
+                      shared_args=['-I' + test_file('benchmark')],
+                      emcc_args=['-sHEADLESS', '-sFULL_ES2', '-lGL', '-sDISABLE_DEPRECATED_FIND_EVENT_TARGET_BEHAVIOR=0', '-sGL_WORKAROUND_SAFARI_GETCONTEXT_BUG=0'],
+                      skip_native=True)
+
+  @non_core
+  def test_webgpu_encoding(self):
+    def output_parser(output):
+      return float(re.search(r'Total time: ([\d\.]+)', output).group(1))
+    # Runs against a mocked device, so it measures the JS overhead of the
+    # bindings only.
+    self.do_benchmark('webgpu_encoding', read_file(test_file('benchmark/benchmark_webgpu_encoding.c')), 'Total time:', output_parser=output_parser,
+                      shared_args=['-I' + test_file('benchmark')],
+                      emcc_args=['-sUSE_WEBGPU', '--pre-js', test_file('benchmark/webgpu_mock.js')],
+                      force_c=True,
+                      skip_native=True)
+
   def test_malloc_multithreading(self):
     # Multithreaded malloc test. For emcc we use mimalloc here.
     src = read_file(test_file('other/test_malloc_multithreading.cpp'))
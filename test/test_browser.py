@@ -205,6 +205,8 @@ def skipExecIf(cond, message):
 requires_graphics_hardware = skipExecIf(os.getenv('EMTEST_LACKS_GRAPHICS_HARDWARE'), 'This test requires graphics hardware')
 requires_sound_hardware = skipExecIf(os.getenv('EMTEST_LACKS_SOUND_HARDWARE'), 'This test requires sound hardware')
 requires_offscreen_canvas = skipExecIf(os.getenv('EMTEST_LACKS_OFFSCREEN_CANVAS'), 'This test requires a browser with OffscreenCanvas')
+# Benchmarks that take long and only print timings, so they don't run by default.
+requires_browser_benchmarks = unittest.skipIf(not os.getenv('EMTEST_BROWSER_BENCHMARKS'), 'Set EMTEST_BROWSER_BENCHMARKS=1 to run browser benchmarks')
 
 
 class browser(BrowserCore):
@@ -597,6 +599,64 @@ If manually bisecting:
     self.run_browser('page.html', '/report_result?exit:0')
     self.run_browser('page.html', '/report_result?exit:1')
 
+  def test_preload_caching_content_addressed(self):
+    self.set_setting('EXIT_RUNTIME')
+    create_file('main.c', r'''
+      #include <assert.h>
+      #include <stdio.h>
+      #include <string.h>
+
+      extern int fetchedChunks();
+
+      int main(int argc, char** argv) {
+        char buf[100];
+        FILE *f = fopen("dup.txt", "r");
+        fread(buf, 1, 20, f);
+        buf[20] = 0;
+        fclose(f);
+        printf("|%s|\n", buf);
+        assert(strcmp("load me right before", buf) == 0);
+
+        f = fopen("big.dat", "r");
+        fseek(f, 0, SEEK_END);
+        assert(ftell(f) == 200000);
+        fclose(f);
+        return fetchedChunks();
+      }
+    ''')
+    create_file('test.js', '''
+      addToLibrary({
+        fetchedChunks: () => Module['preloadResults']['files.data']['fetchedChunks'],
+      });
+    ''')
+
+    def package():
+      self.run_process([FILE_PACKAGER, 'files.data', '--use-preload-cache', '--content-addressed', '--content-chunk-size=65536',
+                        '--separate-metadata', '--js-output=files.js', '--preload', 'somefile.txt', 'dup.txt', 'big.dat'])
+
+    create_file('somefile.txt', 'load me right before running the code please')
+    shutil.copyfile('somefile.txt', 'dup.txt')
+    big = ''.join(chr(ord('a') + i % 26) for i in range(200000))
+    create_file('big.dat', big)
+    package()
+    self.compile_btest('main.c', ['--js-library', 'test.js', '--pre-js', 'files.js', '-o', 'page.html', '-sFORCE_FILESYSTEM'], reporting=Reporting.JS_ONLY)
+    # big.dat is split into 4 chunks, and the two text files share a chunk.
+    self.run_browser('page.html', '/report_result?exit:5')
+    self.run_browser('page.html', '/report_result?exit:0')
+    # Changing the end of a file only downloads its last chunk.
+    create_file('big.dat', big[:-1000] + 'z' * 1000)
+    package()
+    self.run_browser('page.html', '/report_result?exit:1')
+
+  def test_preload_lazy(self):
+    # The files are read with synchronous range requests on the main thread.
+    create_file('critical.txt', 'needed at startup')
+    create_file('big.dat', ''.join(chr(ord('a') + i % 26) for i in range(100000)))
+    create_file('other.dat', 'other data')
+    self.run_process([FILE_PACKAGER, 'test.data', '--preload', 'critical.txt', 'big.dat', 'other.dat',
+                      '--lazy', '--lazy-prefetch', '/critical.txt', '--js-output=test.js'])
+    self.btest_exit('fs/test_lazy_package.c', args=['--pre-js', 'test.js', '-sFORCE_FILESYSTEM'])
+
   def test_multifile(self):
     # a few files inside a directory
     ensure_dir('subdirr/moar')
@@ -1386,6 +1446,17 @@ keydown(100);keyup(100); // trigger the end
     self.btest('fs/test_idbfs_fsync.c', '1', args=args + ['-DFIRST', f'-DSECRET="{secret }"', '-sEXPORTED_FUNCTIONS=_main,_success', '-lidbfs.js'])
     self.btest('fs/test_idbfs_fsync.c', '1', args=args + [f'-DSECRET="{secret}"', '-sEXPORTED_FUNCTIONS=_main,_success', '-lidbfs.js'])
 
+  def test_fs_idbfs_incremental_sync(self):
+    args = ['-lidbfs.js', '-sASYNCIFY', '-sALLOW_MEMORY_GROWTH']
+    self.btest_exit('fs/test_idbfs_incremental.c', args=args + ['-DFIRST'])
+    self.btest_exit('fs/test_idbfs_incremental.c', args=args)
+
+  @requires_browser_benchmarks
+  def test_fs_idbfs_sync_benchmark(self):
+    # Prints the time that syncing takes after changes of different sizes to a
+    # large file, which only writes the chunks of the file that changed.
+    self.btest_exit('benchmark/benchmark_idbfs_sync.c', args=['-lidbfs.js', '-sASYNCIFY', '-sALLOW_MEMORY_GROWTH'])
+
   def test_fs_memfs_fsync(self):
     args = ['-sASYNCIFY', '-sEXIT_RUNTIME']
     secret = str(time.time())
@@ -1449,6 +1520,10 @@ keydown(100);keyup(100); // trigger the end
       </script>
     ''')
     self.run_browser('a.html', '/report_result?exit:2')
+    print('    chunk size and workers')
+    out = subprocess.check_output([FILE_PACKAGER, 'files.data', '--preload', 'file1.txt', 'subdir/file2.txt', 'file3.txt', '--lz4', '--lz4-chunk-size=65536', '--use-preload-plugins'])
+    create_file('files.js', out, binary=True)
+    self.btest_exit('fs/test_lz4fs.cpp', 2, args=['--pre-js', 'files.js', '-sLZ4', '-sLZ4_WORKERS=2', '-sFORCE_FILESYSTEM'])
 
     # load the data into LZ4FS manually at runtime. This means we compress on the client. This is generally not recommended
     print('manual')
@@ -1531,10 +1606,14 @@ keydown(100);keyup(100); // trigger the end
     self.btest_exit('test_sdl_gl_mapbuffers.c', args=['-sFULL_ES3', '-lSDL', '-lGL'])
 
   @requires_graphics_hardware
-  def test_sdl_ogl(self):
+  @parameterized({
+    '': ([],),
+    'immediate_batching': (['-sGL_IMMEDIATE_BATCHING'],),
+  })
+  def test_sdl_ogl(self, args):
     shutil.copyfile(test_file('screenshot.png'), 'screenshot.png')
     self.reftest('test_sdl_ogl.c', 'screenshot-gray-purple.png', reference_slack=1,
-                 args=['-O2', '--minify=0', '--preload-file', 'screenshot.png', '-sLEGACY_GL_EMULATION', '--use-preload-plugins', '-lSDL', '-lGL'])
+                 args=['-O2', '--minify=0', '--preload-file', 'screenshot.png', '-sLEGACY_GL_EMULATION', '--use-preload-plugins', '-lSDL', '-lGL'] + args)
 
   @requires_graphics_hardware
   def test_sdl_ogl_regal(self):
@@ -4633,10 +4712,9 @@ Module["preRun"] = () => {
     shutil.copyfile(test_file('gears.png'), 'gears.png')
     self.btest_exit('fetch/test_fetch_response_headers.cpp', args=['-sFETCH_DEBUG', '-sFETCH', '-pthread', '-sPROXY_TO_PTHREAD'])
 
-  # Test emscripten_fetch() usage to stream a XHR in to memory without storing the full file in memory
+  # Test emscripten_fetch() usage to stream a download in to memory without storing the full file in memory
   @also_with_wasm2js
   def test_fetch_stream_file(self):
-    self.skipTest('moz-chunked-arraybuffer was firefox-only and has been removed')
     # Strategy: create a large 128MB file, and compile with a small 16MB Emscripten heap, so that the tested file
     # won't fully fit in the heap. This verifies that streaming works properly.
     s = '12345678'
@@ -4645,7 +4723,14 @@ Module["preRun"] = () => {
     with open('largefile.txt', 'w') as f:
       for _ in range(1024):
         f.write(s)
-    self.btest_exit('fetch/test_fetch_stream_file.cpp', args=['-sFETCH_DEBUG', '-sFETCH'])
+    self.btest_exit('fetch/test_fetch_stream_file.cpp', args=['-sFETCH_DEBUG', '-sFETCH', '-sINITIAL_MEMORY=16MB'])
+
+  # Tests the per-origin concurrency limit, priorities, deduplication and
+  # cancellation of queued fetches.
+  def test_fetch_scheduler(self):
+    for name in ('file0.txt', 'file1.txt', 'file2.txt', 'file3.txt', 'file4.txt', 'dup.txt'):
+      create_file(name, 'hello\n')
+    self.btest_exit('fetch/test_fetch_scheduler.c', args=['-sFETCH'])
 
   def test_fetch_headers_received(self):
     create_file('myfile.dat', 'hello world\n')
@@ -5530,6 +5615,14 @@ Module["preRun"] = () => {
   def test_audio_worklet_modularize(self, args):
     self.btest_exit('webaudio/audioworklet.c', args=['-sAUDIO_WORKLET', '-sWASM_WORKERS', '-sMODULARIZE=1', '-sEXPORT_NAME=MyModule', '--shell-file', test_file('shell_that_launches_modularize.html')] + args)
 
+  # Tests feeding an Audio Worklet from a pthread through an emscripten_audio_ring_t
+  @parameterized({
+    '': ([],),
+    'closure': (['--closure', '1', '-Oz'],),
+  })
+  def test_audio_worklet_ring(self, args):
+    self.btest_exit('webaudio/audio_ring.c', args=['-sAUDIO_WORKLET', '-sWASM_WORKERS', '-pthread', '-sPTHREAD_POOL_SIZE=1'] + args)
+
   def test_error_reporting(self):
     # Test catching/reporting Error objects
     create_file('post.js', 'throw new Error("oops");')
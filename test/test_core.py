@@ -27,7 +27,7 @@ from common import RunnerCore, path_from_root, requires_native_clang, test_file,
 from common import skip_if, needs_dylink, no_windows, no_mac, is_slow_test, parameterized
 from common import env_modify, with_env_modify, disabled, flaky, node_pthreads, also_with_wasm_bigint
 from common import read_file, read_binary, requires_v8, requires_node, requires_wasm2js, requires_node_canary
-from common import compiler_for, crossplatform, no_4gb, no_2gb
+from common import compiler_for, crossplatform, no_4gb, no_2gb, no_wasm64
 from common import with_both_sjlj, also_with_standalone_wasm, can_do_standalone, no_wasm64
 from common import NON_ZERO, WEBIDL_BINDER, EMBUILDER, PYTHON
 import clang_native
@@ -874,6 +874,16 @@ base align: 0, 0, 0, 0'''])
 
     self.do_core_test('test_emmalloc_trim.cpp')
 
+  @no_asan('ASan does not support custom memory allocators')
+  @no_lsan('LSan does not support custom memory allocators')
+  @parameterized({
+    '': ['-sMALLOC=emmalloc'],
+    'memvalidate': ['-sMALLOC=emmalloc-memvalidate'],
+  })
+  def test_emmalloc_calloc(self, *args):
+    self.emcc_args += ['-sALLOW_MEMORY_GROWTH'] + list(args)
+    self.do_core_test('test_emmalloc_calloc.c')
+
   # Test case against https://github.com/emscripten-core/emscripten/issues/10363
   def test_emmalloc_memalign_corruption(self, *args):
     self.set_setting('MALLOC', 'emmalloc')
@@ -2476,6 +2486,10 @@ The current type of b is: 9
   def test_pthread_cancel_async(self):
     self.do_run_in_out_file_test('pthread/test_pthread_cancel_async.c')
 
+  @node_pthreads
+  def test_audio_ring(self):
+    self.do_run_in_out_file_test('pthread/test_audio_ring.c')
+
   @no_asan('test relies on null pointer reads')
   def test_pthread_specific(self):
     self.do_run_in_out_file_test('pthread/specific.c')
@@ -2618,6 +2632,14 @@ The current type of b is: 9
     self.set_setting('EXIT_RUNTIME')
     self.do_run_in_out_file_test('pthread/test_pthread_proxy_to_pthread.c')
 
+  @node_pthreads
+  @no_wasm64('proxyToMainThreadFast is not used under MEMORY64')
+  def test_pthread_proxy_slot(self):
+    self.set_setting('PROXY_TO_PTHREAD')
+    self.set_setting('EXIT_RUNTIME')
+    self.emcc_args += ['--js-library', test_file('pthread/test_pthread_proxy_slot.js')]
+    self.do_run_in_out_file_test('pthread/test_pthread_proxy_slot.c')
+
   @node_pthreads
   @needs_dylink
   def test_pthread_tls_dylink(self):
@@ -2728,6 +2750,11 @@ The current type of b is: 9
   def test_memset(self):
     self.do_core_test('test_memset.c')
 
+  @wasm_simd
+  def test_string_simd(self):
+    self.emcc_args += ['-msimd128', '-mno-bulk-memory']
+    self.do_runf('core/test_string_simd.c', 'OK.')
+
   def test_getopt(self):
     self.do_core_test('test_getopt.c', args=['-t', '12', '-n', 'foobar'])
 
@@ -5666,14 +5693,43 @@ Module = {
     self.emcc_args += ['--embed-file', test_file('utf8_corpus.txt') + '@/utf8_corpus.txt']
     self.do_runf('benchmark/benchmark_utf8.c', 'OK.')
 
+  def test_utf8_wasm_decoding(self):
+    self.set_setting('WASM_UTF8_DECODING')
+    self.emcc_args += ['--embed-file', test_file('utf8_corpus.txt') + '@/utf8_corpus.txt']
+    self.do_runf('benchmark/benchmark_utf8.c', 'OK.')
+
+  @wasm_simd
+  def test_utf8_wasm_decoding_simd(self):
+    self.set_setting('WASM_UTF8_DECODING')
+    self.emcc_args += ['-msimd128', '--embed-file', test_file('utf8_corpus.txt') + '@/utf8_corpus.txt']
+    self.do_runf('benchmark/benchmark_utf8.c', 'OK.')
+
+  def test_utf8_transcode(self):
+    self.do_runf('core/test_utf8_transcode.c', 'OK.')
+
+  @wasm_simd
+  def test_utf8_transcode_simd(self):
+    self.emcc_args.append('-msimd128')
+    self.do_runf('core/test_utf8_transcode.c', 'OK.')
+
   # Test that invalid character in UTF8 does not cause decoding to crash.
   def test_utf8_invalid(self):
     self.set_setting('EXPORTED_RUNTIME_METHODS', ['UTF8ToString', 'stringToUTF8'])
-    for decoder_mode in [[], ['-sTEXTDECODER']]:
+    for decoder_mode in [[], ['-sTEXTDECODER'], ['-sWASM_UTF8_DECODING']]:
       self.emcc_args += decoder_mode
       print(str(decoder_mode))
       self.do_runf('utf8_invalid.cpp', 'OK.')
 
+  @requires_node
+  @parameterized({
+    '': ([],),
+    'no_textdecoder': (['-sTEXTDECODER=0'],),
+    'textdecoder_only': (['-sTEXTDECODER=2'],),
+  })
+  def test_stringToUTF8_surrogates(self, args):
+    self.emcc_args += ['--js-library', test_file('core/test_stringToUTF8_surrogates.js')] + args
+    self.do_runf('core/test_stringToUTF8_surrogates.c', 'OK.')
+
   # Test that invalid character in UTF8 does not cause decoding to crash.
   @no_asan('TODO: ASan support in minimal runtime')
   def test_minimal_runtime_utf8_invalid(self):
@@ -8578,6 +8634,17 @@ NODEFS is no longer included by default; build with -lnodefs.js
   def test_mallinfo(self):
     self.do_core_test('test_mallinfo.c')
 
+  @no_asan('heap stats are not part of ASan malloc')
+  @no_lsan('heap stats are not part of LSan malloc')
+  @parameterized({
+    'dlmalloc': ('dlmalloc',),
+    'emmalloc': ('emmalloc',),
+    'mimalloc': ('mimalloc',),
+  })
+  def test_heap_stats(self, malloc):
+    self.set_setting('MALLOC', malloc)
+    self.do_runf('core/test_heap_stats.c', 'done\n')
+
   @no_asan('cannot replace malloc/free with ASan')
   @no_lsan('cannot replace malloc/free with LSan')
   def test_wrap_malloc(self):
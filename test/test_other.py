@@ -9,6 +9,7 @@
 from functools import wraps
 import glob
 import gzip
+import hashlib
 import importlib
 import itertools
 import json
@@ -3375,6 +3376,105 @@ More info: https://emscripten.org
 
     self.assertEqual(metadata['package_uuid'], 'sha256-53ddc03623f867c7d4a631ded19c2613f2cb61d47b6aa214f47ff3cc15445bcd')
 
+  def test_file_packager_content_addressed(self):
+    create_file('data1.txt', 'data1')
+    create_file('data2.txt', 'data1')
+    create_file('data3.txt', 'data3' * 10)
+
+    def package():
+      self.run_process([FILE_PACKAGER, 'test.data', '--quiet', '--content-addressed', '--content-chunk-size=16',
+                        '--preload', 'data1.txt', 'data2.txt', 'data3.txt', '--js-output=test.js', '--separate-metadata'])
+      return json.loads(read_file('test.js.metadata'))
+
+    metadata = package()
+    # Identical files share their data.
+    self.assertEqual(metadata['files'][0]['start'], metadata['files'][1]['start'])
+    self.assertEqual(metadata['files'][0]['end'], metadata['files'][1]['end'])
+    self.assertEqual(metadata['remote_package_size'], len('data1') + len('data3' * 10))
+    chunks = [c[0] for c in metadata['chunks']]
+    self.assertEqual(len(chunks), 5)
+    for chunk in chunks:
+      self.assertEqual(hashlib.sha256(utils.read_binary(os.path.join('test.data', chunk))).hexdigest(), chunk)
+
+    # Appending to a file only changes its last chunk, and the old chunks are
+    # kept.
+    create_file('data3.txt', 'data3' * 10 + '!')
+    new_chunks = [c[0] for c in package()['chunks']]
+    self.assertEqual(len(set(new_chunks) - set(chunks)), 1)
+    self.assertEqual(new_chunks[:-1], chunks[:-1])
+    self.assertEqual(len(os.listdir('test.data')), 6)
+
+    err = self.expect_fail([FILE_PACKAGER, 'test.data', '--content-addressed', '--lz4', '--preload', 'data1.txt'])
+    self.assertContained('--content-addressed cannot be used with --lz4', err)
+    for arg in ('--content-chunk-size', '--content-chunk-size=0', '--content-chunk-size=1k'):
+      err = self.expect_fail([FILE_PACKAGER, 'test.data', '--content-addressed', arg, '--preload', 'data1.txt'])
+      self.assertContained('error: --content-chunk-size requires a positive integer value', err)
+    err = self.expect_fail([FILE_PACKAGER, 'test.data', '--content-chunk-size=16', '--preload', 'data1.txt'])
+    self.assertContained('error: --content-chunk-size requires --content-addressed', err)
+
+    # The chunks are cached in a database of their own, which leaves the schema
+    # of the one that regular packages use unchanged.
+    self.run_process([FILE_PACKAGER, 'test.data', '--content-addressed', '--use-preload-cache',
+                      '--preload', 'data1.txt', '--js-output=test.js'])
+    self.assertContained('var DB_NAME = "EM_PRELOAD_CACHE-chunks";', read_file('test.js'))
+    self.assertContained('var DB_VERSION = 1;', read_file('test.js'))
+
+  def test_file_packager_lz4_chunk_size(self):
+    create_file('data.txt', 'data')
+    for arg in ('--lz4-chunk-size', '--lz4-chunk-size=0', '--lz4-chunk-size=-1', '--lz4-chunk-size=1k'):
+      err = self.expect_fail([FILE_PACKAGER, 'test.data', '--lz4', arg, '--preload', 'data.txt'])
+      self.assertContained('error: --lz4-chunk-size requires a positive integer value', err)
+    err = self.expect_fail([FILE_PACKAGER, 'test.data', '--lz4-chunk-size=1024', '--preload', 'data.txt'])
+    self.assertContained('error: --lz4-chunk-size requires --lz4', err)
+
+  def test_file_packager_lazy(self):
+    create_file('critical.txt', 'needed at startup')
+    create_file('big.dat', ''.join(chr(ord('a') + i % 26) for i in range(100000)))
+    create_file('other.dat', 'other data')
+    self.run_process([FILE_PACKAGER, 'test.data', '--quiet', '--preload', 'critical.txt', 'big.dat', 'other.dat',
+                      '--lazy', '--lazy-prefetch', '/critical.txt', '--js-output=test.js'])
+    self.do_runf(test_file('fs/test_lazy_package.c'), 'done\n', emcc_args=['--pre-js', 'test.js', '-sFORCE_FILESYSTEM'])
+    # WasmFS has no lazy files, so the package fails to load rather than
+    # downloading everything before running.
+    self.do_runf(test_file('fs/test_lazy_package.c'), 'was packaged with --lazy, which needs the JS filesystem',
+                 assert_returncode=NON_ZERO, emcc_args=['--pre-js', 'test.js', '-sFORCE_FILESYSTEM', '-sWASMFS'])
+
+    # With --use-preload-plugins, the files that the built-in plugins handle are
+    # prefetched, and prefetched files are handed to the plugins.
+    create_file('image.png', 'not really a png')
+    create_file('data.upper', 'made uppercase')
+    self.run_process([FILE_PACKAGER, 'test.data', '--quiet', '--preload', 'image.png', 'data.upper', 'other.dat',
+                      '--lazy', '--lazy-prefetch', '*.upper', '--use-preload-plugins', '--js-output=test.js', '--separate-metadata'])
+    prefetched = [f['filename'] for f in json.loads(read_file('test.js.metadata'))['files'] if f.get('prefetch')]
+    self.assertEqual(prefetched, ['/data.upper', '/image.png'])
+    self.run_process([FILE_PACKAGER, 'test.data', '--quiet', '--preload', 'data.upper', 'other.dat',
+                      '--lazy', '--lazy-prefetch', '*.upper', '--use-preload-plugins', '--js-output=test.js'])
+    create_file('pre.js', '''
+      Module.preloadPlugins = [{
+        'canHandle': (name) => name.endsWith('.upper'),
+        'handle': (byteArray, name, onload, onerror) => {
+          onload(new TextEncoder().encode(new TextDecoder().decode(byteArray).toUpperCase()));
+        },
+      }];
+    ''')
+    create_file('main.c', r'''
+      #include <stdio.h>
+      int main() {
+        char buf[32] = {0};
+        FILE *f = fopen("/data.upper", "r");
+        fread(buf, 1, sizeof(buf) - 1, f);
+        fclose(f);
+        printf("%s\n", buf);
+        return 0;
+      }
+    ''')
+    self.do_runf('main.c', 'MADE UPPERCASE\n', emcc_args=['--pre-js', 'pre.js', '--pre-js', 'test.js', '-sFORCE_FILESYSTEM'])
+
+    err = self.expect_fail([FILE_PACKAGER, 'test.data', '--preload', 'big.dat', '--lazy', '--lz4'])
+    self.assertContained('--lazy cannot be used with', err)
+    err = self.expect_fail([FILE_PACKAGER, 'test.data', '--preload', 'big.dat', '--lazy-prefetch', '/big.dat'])
+    self.assertContained('--lazy-prefetch requires --lazy', err)
+
   def test_file_packager_unicode(self):
     unicode_name = 'unicode…☃'
     try:
@@ -3467,6 +3567,26 @@ More info: https://emscripten.org
     shutil.copyfile(test_file('screenshot.png'), 'example.png')
     self.do_other_test('test_sdl_headless.c', emcc_args=['-sHEADLESS'])
 
+  def test_gl_state_cache(self):
+    # The headless canvas counts the calls that reach its WebGL context. The
+    # Safari getContext() workaround needs a real WebGLRenderingContext.
+    self.do_other_test('test_gl_state_cache.c', emcc_args=['-sHEADLESS', '-sGL_STATE_CACHE', '-lGL',
+                                                           '-sDISABLE_DEPRECATED_FIND_EVENT_TARGET_BEHAVIOR=0',
+                                                           '-sGL_WORKAROUND_SAFARI_GETCONTEXT_BUG=0'])
+    # LEGACY_GL_EMULATION changes context state behind the back of the cache.
+    err = self.expect_fail([EMCC, test_file('hello_world.c'), '-sGL_STATE_CACHE', '-sLEGACY_GL_EMULATION'])
+    self.assertContained('GL_STATE_CACHE is not compatible with LEGACY_GL_EMULATION', err)
+
+  def test_gl_immediate_batching(self):
+    self.do_other_test('test_gl_immediate_batching.c', emcc_args=['-sHEADLESS', '-sLEGACY_GL_EMULATION',
+                                                                  '-sGL_IMMEDIATE_BATCHING', '-lGL',
+                                                                  '-sGL_WORKAROUND_SAFARI_GETCONTEXT_BUG=0'])
+
+  def test_gl_profile(self):
+    self.do_other_test('test_gl_profile.c', emcc_args=['-sHEADLESS', '-sGL_PROFILE=2', '-lGL',
+                                                       '-sDISABLE_DEPRECATED_FIND_EVENT_TARGET_BEHAVIOR=0',
+                                                       '-sGL_WORKAROUND_SAFARI_GETCONTEXT_BUG=0'])
+
   def test_preprocess(self):
     # Pass -Werror to prevent regressions such as https://github.com/emscripten-core/emscripten/pull/9661
     out = self.run_process([EMCC, test_file('hello_world.c'), '-E', '-Werror'], stdout=PIPE).stdout
@@ -5717,6 +5837,16 @@ int main()
       self.run_process([EMXX, 'src.cpp', '-sDISABLE_EXCEPTION_CATCHING=0'])
     self.assertContained('Caught exception: std::exception', self.run_js('a.out.js'))
 
+  # libc_simd overrides parts of libc, so it must not be linked in when all of
+  # libc is.
+  @parameterized({
+    'main_module': [['-sMAIN_MODULE'], {}],
+    'force_stdlibs': [[], {'EMCC_FORCE_STDLIBS': '1'}],
+  })
+  def test_libc_simd_whole_libc(self, args, env):
+    with env_modify(env):
+      self.do_runf('hello_world.c', 'hello, world!', emcc_args=['-msimd128'] + args)
+
   def test_strftime_zZ(self):
     create_file('src.c', r'''
 #include <errno.h>
@@ -9657,6 +9787,23 @@ int main() {
     self.assertContained('GROWABLE_HEAP_I8().set([ 1, 2, 3 ], $0 >>> 0)',
                          read_file('a.out.js'))
 
+  @node_pthreads
+  def test_reserve_maximum_memory(self):
+    output = self.do_runf('other/test_reserve_maximum_memory.c', 'done\n',
+                          emcc_args=['-sALLOW_MEMORY_GROWTH', '-sMAXIMUM_MEMORY=64MB', '-sRESERVE_MAXIMUM_MEMORY',
+                                     '-sPTHREAD_POOL_SIZE=4', '-sEXIT_RUNTIME'])
+    self.assertContained('heap size: 67108864\n', output)
+    # The memory can never change size, so JS heap accesses are not wrapped
+    # in growable heap checks.
+    self.assertNotContained('GROWABLE_HEAP', read_file('test_reserve_maximum_memory.js'))
+
+    err = self.expect_fail([EMCC, test_file('hello_world.c'), '-sRESERVE_MAXIMUM_MEMORY'])
+    self.assertContained('RESERVE_MAXIMUM_MEMORY requires ALLOW_MEMORY_GROWTH', err)
+    err = self.expect_fail([EMCC, test_file('hello_world.c'), '-sRESERVE_MAXIMUM_MEMORY', '-sALLOW_MEMORY_GROWTH', '-sINITIAL_MEMORY=32MB'])
+    self.assertContained('RESERVE_MAXIMUM_MEMORY is not compatible with INITIAL_MEMORY', err)
+    err = self.expect_fail([EMCC, test_file('hello_world.c'), '-sRESERVE_MAXIMUM_MEMORY', '-sALLOW_MEMORY_GROWTH'])
+    self.assertContained('RESERVE_MAXIMUM_MEMORY requires an explicit MAXIMUM_MEMORY', err)
+
   @parameterized({
     '': ([],), # noqa
     'O3': (['-O3'],), # noqa
@@ -10305,6 +10452,27 @@ _d
     self.assertContained('[asyncify] g can', out)
     self.assertContained('[asyncify] i can', out)
 
+  def test_asyncify_profile(self):
+    self.emcc_args += ['-sASYNCIFY', '-sASYNCIFY_PROFILE', '-sASYNCIFY_IMPORTS=async_func', '-sEXIT_RUNTIME', '--profiling-funcs']
+    output = self.do_runf('other/asyncify_advise.c')
+    self.assertContained('[asyncify-profile] total: 2 unwinds, 2 rewinds', output)
+    self.assertContained('[asyncify-profile] import async_func: 2 unwinds, 2 rewinds', output)
+    self.assertContained('[asyncify-profile] export main: 2 unwinds, 2 rewinds', output)
+    self.assertContained('[asyncify-profile] -sASYNCIFY_IMPORTS=["async_func"]', output)
+
+    # Only the functions that were on the stack during an unwind should be
+    # suggested, and the suggested list should produce a working program.
+    only = re.search(r'-sASYNCIFY_ONLY=(\[.*\])', output).group(1)
+    for func in ('a', 'c', 'e', 'g', 'i'):
+      self.assertContained(f'"{func}"', only)
+    for func in ('b', 'd', 'f', 'h'):
+      self.assertNotContained(f'"{func}"', only)
+    self.do_runf('other/asyncify_advise.c', emcc_args=[f'-sASYNCIFY_ONLY={only}'])
+
+  def test_asyncify_profile_jspi(self):
+    err = self.expect_fail([EMCC, test_file('hello_world.c'), '-sASYNCIFY=2', '-sASYNCIFY_PROFILE'])
+    self.assertContained('ASYNCIFY_PROFILE requires ASYNCIFY=1', err)
+
   def test_asyncify_stack_overflow(self):
     self.emcc_args = ['-sASYNCIFY', '-sASYNCIFY_STACK_SIZE=4']
 
@@ -11945,6 +12113,14 @@ Aborted(`Module.arguments` has been replaced by `arguments_` (the initial value
   def test_webgpu_compiletest(self, args):
     self.run_process([EMXX, test_file('webgpu_jsvalstore.cpp'), '-sUSE_WEBGPU', '-sASYNCIFY'] + args)
 
+  def test_webgpu_released_handle(self):
+    # Runs against the no-op device of the WebGPU benchmark.
+    self.emcc_args += ['-sUSE_WEBGPU', '-sASSERTIONS', '--pre-js', test_file('benchmark/webgpu_mock.js')]
+    output = self.do_runf(test_file('other/test_webgpu_released_handle.c'), 'same slot: 1\nsame handle: 0\nsize: 16\n',
+                          assert_returncode=NON_ZERO)
+    self.assertContained('invalid or released WebGPU handle', output)
+    self.assertNotContained('released handle was not caught', output)
+
   def test_signature_mismatch(self):
     create_file('a.c', 'void foo(); int main() { foo(); return 0; }')
     create_file('b.c', 'int foo() { return 1; }')
@@ -12334,6 +12510,28 @@ exec "$@"
     proc = self.run_process([EMCC, test_file('hello_world.c'), '--js-library=lib.js'], stderr=PIPE)
     self.assertContained('lib.js: use of #ifdef in js library.  Use #if instead.', proc.stderr)
 
+  def test_jslib_symbol_cache_settings(self):
+    # The cached JS symbol lists are keyed on the settings that the JS compiler
+    # reads.  compiler.mjs converts INCOMING_MODULE_JS_API before it processes
+    # the libraries, and changing it must still not reuse the entry from an
+    # earlier link.
+    create_file('lib.js', '''
+      addToLibrary({
+      #if expectToReceiveOnModule('onCustomMessage')
+        custom_hook_enabled: () => 1,
+      #endif
+      });
+      ''')
+    create_file('main.c', '''
+      int custom_hook_enabled(void);
+      int main() { return custom_hook_enabled(); }
+      ''')
+    err = self.expect_fail([EMCC, 'main.c', '--js-library=lib.js', '-sINCOMING_MODULE_JS_API=print'])
+    self.assertContained('undefined symbol: custom_hook_enabled', err)
+    self.run_process([EMCC, 'main.c', '--js-library=lib.js', '-sINCOMING_MODULE_JS_API=print,onCustomMessage'])
+    err = self.expect_fail([EMCC, 'main.c', '--js-library=lib.js', '-sINCOMING_MODULE_JS_API=print'])
+    self.assertContained('undefined symbol: custom_hook_enabled', err)
+
   def test_jslib_mangling(self):
     create_file('lib.js', '''
       addToLibrary({
@@ -12401,6 +12599,47 @@ exec "$@"
     self.assertContained('--oformat=bare/--post-link are experimental and subject to change', err)
     err = self.assertContained('hello, world!', self.run_js('a.out.js'))
 
+  def test_postlink_cache(self):
+    # Relinking with only the HTML shell changed should reuse all of the
+    # post-link tool invocations, and produce the same output as before.
+    create_file('shell.html', read_file(path_from_root('src/shell_minimal.html')).replace('<title>', '<title>Changed '))
+    with env_modify({'EM_POSTLINK_CACHE': os.path.abspath('postlink'), 'EMCC_POSTLINK_CACHE_REPORT': 'report.json'}):
+      self.run_process([EMCC, test_file('hello_world.c'), '-Os', '-o', 'a.html'])
+      report = json.loads(read_file('report.json'))
+      self.assertEqual(report['wasm-opt']['hits'], 0)
+      self.assertGreater(report['wasm-opt']['misses'], 0)
+      js = read_file('a.js')
+      wasm = read_binary('a.wasm')
+
+      self.run_process([EMCC, test_file('hello_world.c'), '-Os', '-o', 'a.html', '--shell-file', 'shell.html'])
+      report = json.loads(read_file('report.json'))
+      for stage, stats in report.items():
+        self.assertEqual(stats['misses'], 0, stage)
+        self.assertGreater(stats['hits'], 0, stage)
+      self.assertIn('wasm-metadce', report)
+      self.assertIn('acorn:AJSDCE', report)
+      self.assertEqual(js, read_file('a.js'))
+      self.assertEqual(wasm, read_binary('a.wasm'))
+      self.assertContained('<title>Changed ', read_file('a.html'))
+
+    self.assertContained('hello, world!', self.run_js('a.js'))
+
+  def test_postlink_cache_closure(self):
+    with env_modify({'EM_POSTLINK_CACHE': os.path.abspath('postlink'), 'EMCC_POSTLINK_CACHE_REPORT': 'report.json'}):
+      self.run_process([EMCC, test_file('hello_world.c'), '-O2', '--closure=1', '-o', 'a.js'])
+      report = json.loads(read_file('report.json'))
+      self.assertEqual(report['closure']['hits'], 0)
+      self.assertEqual(report['closure']['misses'], 1)
+      js = read_file('a.js')
+
+      self.run_process([EMCC, test_file('hello_world.c'), '-O2', '--closure=1', '-o', 'a.js'])
+      report = json.loads(read_file('report.json'))
+      self.assertEqual(report['closure']['hits'], 1)
+      self.assertEqual(report['closure']['misses'], 0)
+      self.assertEqual(js, read_file('a.js'))
+
+    self.assertContained('hello, world!', self.run_js('a.js'))
+
   def compile_with_wasi_sdk(self, filename, output):
     sysroot = os.environ.get('EMTEST_WASI_SYSROOT')
     if not sysroot:
@@ -13794,6 +14033,70 @@ j1: 8589934599, j2: 30064771074, j3: 12884901891
       err = self.expect_fail([EMBUILDER, 'build', 'libc', '--force'], expect_traceback=True)
     self.assertContained('AssertionError: attempt to lock the cache while a parent process is holding the lock', err)
 
+  def test_cache_clear_waits_for_builds(self):
+    # Clearing the cache must wait for artifacts that are being built by other
+    # processes, and must keep their lock files.
+    if config.FROZEN_CACHE:
+      self.skipTest("test doesn't work with frozen cache")
+    with cache.artifact_lock('testing/artifact'):
+      self.assertEqual(os.environ.get('EM_CACHE_IS_LOCKED'), '1')
+      # Run the other process as if it was unrelated to this one.
+      env = os.environ.copy()
+      del env['EM_CACHE_IS_LOCKED']
+      proc = subprocess.Popen([EMCC, '--clear-cache'], env=env, stdout=PIPE, stderr=STDOUT, text=True)
+      time.sleep(2)
+      self.assertIsNone(proc.poll())
+    self.assertNotIn('EM_CACHE_IS_LOCKED', os.environ)
+    output = proc.communicate()[0]
+    self.assertEqual(proc.returncode, 0, output)
+    self.assertExists(cache.get_path('locks/testing/artifact.lock'))
+
+  def test_cache_concurrent_builds(self):
+    # Stress test for the per-artifact cache locks: many embuilder processes
+    # racing to build overlapping sets of libraries into a fresh cache should
+    # all succeed, and should leave behind complete libraries and no temporary
+    # files.
+    if config.FROZEN_CACHE:
+      self.skipTest("test doesn't work with frozen cache")
+    libs = ['libstubs', 'libstubs-debug', 'libnoexit', 'libsockets', 'libemmalloc', 'libemmalloc-debug']
+    with env_modify({'EM_CACHE': os.path.abspath('cache')}):
+      procs = []
+      for i in range(3):
+        for j in range(len(libs)):
+          # Each process builds a different pair of libraries, in a different
+          # order, so that they contend with one another.
+          args = [libs[j], libs[(j + i + 1) % len(libs)]]
+          procs.append(subprocess.Popen([EMBUILDER, 'build'] + args, stdout=PIPE, stderr=STDOUT, text=True))
+      for proc in procs:
+        output = proc.communicate()[0]
+        self.assertEqual(proc.returncode, 0, output)
+        self.assertNotContained('Traceback', output)
+    libdir = 'cache/sysroot/lib/wasm32-emscripten'
+    for lib in libs:
+      self.assertExists(os.path.join(libdir, lib + '.a'))
+      self.run_process([LLVM_AR, 't', os.path.join(libdir, lib + '.a')], stdout=PIPE)
+    self.assertEqual(os.listdir('cache/tmp'), [])
+
+  def test_object_store(self):
+    # Objects whose preprocessed source and codegen flags are the same in
+    # different variants of a library should be shared between them.  Only one
+    # of the two files in libstubs depends on NDEBUG.
+    if config.FROZEN_CACHE:
+      self.skipTest("test doesn't work with frozen cache")
+    with env_modify({'EM_CACHE': os.path.abspath('cache')}):
+      err = self.run_process([EMBUILDER, 'build', 'libstubs'], stderr=PIPE).stderr
+      self.assertContained('reused 0 of 2 objects from object store', err)
+      err = self.run_process([EMBUILDER, 'build', 'libstubs-debug'], stderr=PIPE).stderr
+      self.assertContained('reused 1 of 2 objects from object store', err)
+      lib = 'cache/sysroot/lib/wasm32-emscripten/libstubs-debug.a'
+      shared_lib = read_binary(lib)
+
+      # The result should be identical to building without the object store.
+      with env_modify({'EMCC_OBJECT_STORE': '0'}):
+        err = self.run_process([EMBUILDER, 'build', 'libstubs-debug', '--force'], stderr=PIPE).stderr
+      self.assertNotContained('object store', err)
+      self.assertEqual(shared_lib, read_binary(lib))
+
   @also_with_wasmfs
   def test_fs_icase(self):
     # c++20 for ends_with().
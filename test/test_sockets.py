@@ -323,6 +323,16 @@ class sockets(BrowserCore):
       self.assertContained('do_msg_read: read 14 bytes', out)
       self.assertContained('connect: ws://localhost:59168/testA/testB, text,base64,binary', out)
 
+  # Round trips UDP packets through a compiled echo server, in batches with
+  # sendmmsg()/recvmmsg() and with scatter/gather buffers, and reports the
+  # packets/sec it achieved. Then round trips an empty datagram.
+  @crossplatform
+  def test_nodejs_sockets_mmsg(self):
+    with CompiledServerHarness(test_file('sockets/test_sockets_mmsg_server.c'), ['-O2'], 59170) as harness:
+      out = self.do_runf('sockets/test_sockets_mmsg_client.c', 'received 100000 echoes in order', emcc_args=['-O2', '-DSOCKK=%d' % harness.listen_port])
+      self.assertContained('received empty datagram', out)
+      print(out.splitlines()[-2])
+
   # Test Emscripten WebSockets API to send and receive text and binary messages against an echo server.
   # N.B. running this test requires 'npm install ws' in Emscripten root directory
   # NOTE: Shared buffer is not allowed for websocket sending.
@@ -0,0 +1,102 @@
+#include <emscripten/webaudio.h>
+#include <emscripten/eventloop.h>
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// This test plays a sine tone that is generated on a pthread and handed to an
+// Audio Worklet through an emscripten_audio_ring_t. The worklet node copies the
+// audio straight out of the ring without calling into Wasm.
+
+#define RING_FRAMES 4096
+#define CHUNK_FRAMES 256
+
+static emscripten_audio_ring_t *ring;
+static _Atomic int framesProduced;
+static _Atomic int stopMixer;
+
+static void *mixer(void *arg) {
+  float samples[CHUNK_FRAMES];
+  const float *channels[1] = { samples };
+  float phase = 0.f;
+  while (!stopMixer) {
+    // Keep about half of the ring filled to absorb scheduling jitter.
+    if (emscripten_audio_ring_read_available(ring) > RING_FRAMES / 2) {
+      sched_yield();
+      continue;
+    }
+    for (int i = 0; i < CHUNK_FRAMES; ++i) {
+      samples[i] = sinf(phase) * 0.3f;
+      phase = fmodf(phase + 2.f * (float)M_PI * 440.f / 48000.f, 2.f * (float)M_PI);
+    }
+    assert(emscripten_audio_ring_write(ring, channels, CHUNK_FRAMES) == CHUNK_FRAMES);
+    framesProduced += CHUNK_FRAMES;
+  }
+  return NULL;
+}
+
+EM_JS(void, ConnectNode, (EMSCRIPTEN_WEBAUDIO_T audioContext, EMSCRIPTEN_AUDIO_WORKLET_NODE_T node), {
+  audioContext = emscriptenGetAudioObject(audioContext);
+  emscriptenGetAudioObject(node).connect(audioContext.destination);
+  audioContext.resume();
+});
+
+static EM_BOOL CheckProgress(double time, void *userData) {
+  uint32_t consumed = ring->readIndex;
+  // Wait until the worklet has consumed a good second of audio from the ring.
+  if (consumed < 48000) {
+    return EM_TRUE;
+  }
+  printf("consumed %u frames, produced %d, underruns %u, overruns %u\n",
+         consumed, framesProduced, ring->underruns, ring->overruns);
+  // The consumer can never get ahead of the producer.
+  assert(consumed <= (uint32_t)framesProduced);
+  // The mixer only writes when there is space, so it must never overrun.
+  assert(ring->overruns == 0);
+  stopMixer = 1;
+  exit(0);
+  return EM_FALSE;
+}
+
+void AudioWorkletProcessorCreated(EMSCRIPTEN_WEBAUDIO_T audioContext, EM_BOOL success, void *userData) {
+  assert(success);
+
+  int outputChannelCounts[1] = { 2 };
+  EmscriptenAudioWorkletNodeCreateOptions options = {
+    .numberOfInputs = 0,
+    .numberOfOutputs = 1,
+    .outputChannelCounts = outputChannelCounts
+  };
+  // The ring is mono, so the worklet copies it to both output channels.
+  EMSCRIPTEN_AUDIO_WORKLET_NODE_T node = emscripten_create_audio_ring_worklet_node(audioContext, "ring-player", &options, ring);
+  ConnectNode(audioContext, node);
+  emscripten_set_timeout_loop(CheckProgress, 10, 0);
+}
+
+void WebAudioWorkletThreadInitialized(EMSCRIPTEN_WEBAUDIO_T audioContext, EM_BOOL success, void *userData) {
+  assert(success);
+  WebAudioWorkletProcessorCreateOptions opts = {
+    .name = "ring-player",
+  };
+  emscripten_create_wasm_audio_worklet_processor_async(audioContext, &opts, AudioWorkletProcessorCreated, 0);
+}
+
+uint8_t wasmAudioWorkletStack[4096];
+
+int main() {
+  ring = emscripten_audio_ring_create(RING_FRAMES, 1);
+  assert(ring);
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, mixer, NULL);
+
+  EMSCRIPTEN_WEBAUDIO_T context = emscripten_create_audio_context(0);
+  emscripten_start_wasm_audio_worklet_thread_async(context, wasmAudioWorkletStack, sizeof(wasmAudioWorkletStack), WebAudioWorkletThreadInitialized, 0);
+  // Keep the runtime alive until CheckProgress() exits.
+  emscripten_runtime_keepalive_push();
+  return 0;
+}
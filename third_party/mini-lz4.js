@@ -116,8 +116,11 @@ var
 ,	hasher 			= /* XXX uint32( */ 2654435761 /* ) */
 
 assert(hashShift === 16);
-var hashTable = new Int16Array(1<<16);
-var empty = new Int16Array(hashTable.length);
+// Positions are stored offset by hashBase, which moves past each block that
+// is compressed, so that entries from earlier blocks read as negative and the
+// table only needs to be cleared once the offsets would overflow.
+var hashTable = new Int32Array(1<<16);
+var hashBase = 0;
 
 // CompressBound returns the maximum length of a lz4 block, given it's uncompressed length
 exports.compressBound = function (isize) {
@@ -129,8 +132,13 @@ exports.compressBound = function (isize) {
 /** @param {number=} sIdx
 	@param {number=} eIdx */
 exports.compress = function (src, dst, sIdx, eIdx) {
-	hashTable.set(empty);
-	return compressBlock(src, dst, 0, sIdx || 0, eIdx || dst.length)
+	if (hashBase > 0x7FFFFFFF - src.length - 1) {
+		hashTable.fill(0);
+		hashBase = 0;
+	}
+	var ret = compressBlock(src, dst, 0, sIdx || 0, eIdx || dst.length)
+	hashBase += src.length + 1
+	return ret
 }
 
 function compressBlock (src, dst, pos, sIdx, eIdx) {
@@ -168,9 +176,9 @@ function compressBlock (src, dst, pos, sIdx, eIdx) {
 			// NB. since 2 different sequences may have the same hash
 			// it is double-checked below
 			// do -1 to distinguish between initialized and uninitialized values
-			var ref = hashTable[hash] - 1
+			var ref = hashTable[hash] - hashBase - 1
 			// save position of current sequence in hash table
-			hashTable[hash] = pos + 1
+			hashTable[hash] = hashBase + pos + 1
 
 			// first reference or within 64k limit or current sequence !== hashed one: no match
 			if ( ref < 0 ||
@@ -275,9 +283,10 @@ function compressBlock (src, dst, pos, sIdx, eIdx) {
 
 exports.CHUNK_SIZE = 2048; // musl libc does readaheads of 1024 bytes, so a multiple of that is a good idea
 
-exports.compressPackage = function(data, verify) {
+exports.compressPackage = function(data, verify, chunkSize) {
+  chunkSize = chunkSize || exports.CHUNK_SIZE;
   if (verify) {
-    var temp = new Uint8Array(exports.CHUNK_SIZE);
+    var temp = new Uint8Array(chunkSize);
   }
   // compress the data in chunks
   assert(data instanceof ArrayBuffer);
@@ -288,9 +297,9 @@ exports.compressPackage = function(data, verify) {
   var offset = 0;
   var total = 0;
   while (offset < data.length) {
-    var chunk = data.subarray(offset, offset + exports.CHUNK_SIZE);
+    var chunk = data.subarray(offset, offset + chunkSize);
     //console.log('compress a chunk ' + [offset, total, data.length]);
-    offset += exports.CHUNK_SIZE;
+    offset += chunkSize;
     var bound = exports.compressBound(chunk.length);
     var compressed = new Uint8Array(bound);
     var compressedSize = exports.compress(chunk, compressed);
@@ -311,16 +320,14 @@ exports.compressPackage = function(data, verify) {
       assert(compressedSize === 0);
       // failure to compress :(
       compressedChunks.push(chunk);
-      total += chunk.length; // last chunk may not be the full exports.CHUNK_SIZE size
+      total += chunk.length; // last chunk may not be the full chunkSize size
       successes.push(0);
     }
   }
   data = null; // XXX null out pack['data'] too?
   var compressedData = {
-    'data': new Uint8Array(total + exports.CHUNK_SIZE*2), // store all the compressed data, plus room for two cached decompressed chunk, in one fast array
-    'cachedOffset': total,
-    'cachedIndexes': [-1, -1], // cache last two blocks, so that reading 1,2,3 + preloading another block won't trigger decompress thrashing
-    'cachedChunks': [null, null],
+    'data': new Uint8Array(total), // store all the compressed data in one fast array
+    'chunkSize': chunkSize,
     'offsets': [], // chunk# => start in compressed data
     'sizes': [],
     'successes': successes, // 1 if chunk is compressed
@@ -337,8 +344,6 @@ exports.compressPackage = function(data, verify) {
   return compressedData;
 };
 
-assert(exports.CHUNK_SIZE < (1 << 15)); // we use 16-bit ints as the type of the hash table, chunk size must be smaller
-
 return exports;
 
 })();
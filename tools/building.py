@@ -18,6 +18,7 @@ from subprocess import PIPE
 
 from . import cache
 from . import diagnostics
+from . import postlink_cache
 from . import response_file
 from . import shared
 from . import webassembly
@@ -372,8 +373,12 @@ def acorn_optimizer(filename, passes, extra_info=None, return_output=False):
     cmd += ['--exportES6']
   if settings.VERBOSE:
     cmd += ['verbose']
+  stage = 'acorn:' + passes[0]
+  tools = [config.NODE_JS[0], optimizer]
   if return_output:
-    return check_call(cmd, stdout=PIPE).stdout
+    args = postlink_cache.normalize_args(cmd[1:], {filename: '<input>'})
+    return postlink_cache.run(stage, tools, args, [filename], [],
+                              lambda: check_call(cmd, stdout=PIPE).stdout)
 
   acorn_optimizer.counter += 1
   basename = shared.unsuffixed(original_filename)
@@ -382,7 +387,11 @@ def acorn_optimizer(filename, passes, extra_info=None, return_output=False):
   output_file = basename + '.jso%d.js' % acorn_optimizer.counter
   shared.get_temp_files().note(output_file)
   cmd += ['-o', output_file]
-  check_call(cmd)
+  def run_optimizer():
+    check_call(cmd)
+
+  args = postlink_cache.normalize_args(cmd[1:], {filename: '<input>', output_file: '<output>'})
+  postlink_cache.run(stage, tools, args, [filename], [output_file], run_optimizer)
   save_intermediate(output_file, '%s.js' % passes[0])
   return output_file
 
@@ -614,12 +623,11 @@ def closure_compiler(filename, advanced=True, extra_closure_args=None):
     args += ['--externs', e]
   args += user_args
 
-  cmd = closure_cmd + args
-  return run_closure_cmd(cmd, filename, env)
+  return run_closure_cmd(closure_cmd, args, filename, env)
 
 
-def run_closure_cmd(cmd, filename, env):
-  cmd += ['--js', filename]
+def run_closure_cmd(closure_cmd, args, filename, env):
+  cmd = closure_cmd + args + ['--js', filename]
 
   # Closure compiler is unable to deal with path names that are not 7-bit ASCII:
   # https://github.com/google/closure-compiler/issues/3784
@@ -656,7 +664,26 @@ def run_closure_cmd(cmd, filename, env):
   # 7-bit ASCII range. Therefore make sure the command line we pass does not contain any such
   # input files by passing all input filenames relative to the cwd. (user temp directory might
   # be in user's home directory, and user's profile name might contain unicode characters)
-  proc = run_process(cmd, stderr=PIPE, check=False, env=env, cwd=tempfiles.tmpdir)
+  def run_closure():
+    proc = run_process(cmd, stderr=PIPE, check=False, env=env, cwd=tempfiles.tmpdir)
+    return [proc.returncode, proc.stderr]
+
+  # Only successful runs without any diagnostics are cached, so that warnings
+  # are reported every time.
+  placeholders = {os.path.relpath(outfile, tempfiles.tmpdir): '<output>'}
+  with utils.chdir(tempfiles.tmpdir):
+    args = postlink_cache.normalize_args(cmd[len(closure_cmd):], placeholders)
+  # The launcher (node and the closure script, or a user configured
+  # CLOSURE_COMPILER) is identified by path and mtime rather than by hashing it
+  # as an argument, which would read all of the node binary on every link.
+  # Also include the version of the npm package.
+  tools = list(closure_cmd)
+  package_json = path_from_root('node_modules/google-closure-compiler/package.json')
+  if os.path.exists(package_json):
+    tools.append(package_json)
+  returncode, stderr = postlink_cache.run('closure', tools, args, [], [outfile], run_closure,
+                                          store=lambda r: r[0] == 0 and not r[1].strip())
+  proc = subprocess.CompletedProcess(cmd, returncode, stderr=stderr)
 
   # XXX Closure bug: if Closure is invoked with --create_source_map, Closure should create a
   # outfile.map source map file (https://github.com/google/closure-compiler/wiki/Source-Maps)
@@ -1129,8 +1156,8 @@ def map_to_js_libs(library_name):
   library_map = {
     'embind': ['embind/embind.js', 'embind/emval.js'],
     'EGL': ['library_egl.js'],
-    'GL': ['library_webgl.js', 'library_html5_webgl.js'],
-    'webgl.js': ['library_webgl.js', 'library_html5_webgl.js'],
+    'GL': ['library_webgl.js', 'library_html5_webgl.js', 'library_glprofile.js'],
+    'webgl.js': ['library_webgl.js', 'library_html5_webgl.js', 'library_glprofile.js'],
     'GLESv2': ['library_webgl.js'],
     # N.b. there is no GLESv3 to link to (note [f] in https://www.khronos.org/registry/implementers_guide.html)
     'GLEW': ['library_glew.js'],
@@ -1287,7 +1314,10 @@ def run_binaryen_command(tool, infile, outfile=None, args=None, debug=False, std
   if settings.GENERATE_SOURCE_MAP and outfile and tool in ['wasm-opt', 'wasm-emscripten-finalize']:
     cmd += [f'--input-source-map={infile}.map']
     cmd += [f'--output-source-map={outfile}.map']
-  ret = check_call(cmd, stdout=stdout).stdout
+  if tool in CACHEABLE_BINARYEN_TOOLS and postlink_cache.enabled():
+    ret = run_binaryen_command_cached(tool, cmd, infile, outfile, stdout)
+  else:
+    ret = check_call(cmd, stdout=stdout).stdout
   if outfile:
     save_intermediate(outfile, '%s.wasm' % tool)
     global binaryen_kept_debug_info
@@ -1295,6 +1325,34 @@ def run_binaryen_command(tool, infile, outfile=None, args=None, debug=False, std
   return ret
 
 
+# Binaryen tools whose output is fully determined by their command line and
+# input file, and so can be reused via the post-link cache.
+CACHEABLE_BINARYEN_TOOLS = ('wasm-opt', 'wasm-metadce', 'wasm-ctor-eval')
+
+
+def run_binaryen_command_cached(tool, cmd, infile, outfile, stdout):
+  inputs = [infile]
+  outputs = []
+  placeholders = {infile: '<input>'}
+  if outfile:
+    outputs.append(outfile)
+    placeholders[outfile] = '<output>'
+  if settings.GENERATE_SOURCE_MAP and outfile and tool == 'wasm-opt':
+    inputs.append(infile + '.map')
+    outputs.append(outfile + '.map')
+    placeholders[infile + '.map'] = '<input-map>'
+    placeholders[outfile + '.map'] = '<output-map>'
+
+  # Capture the output even if the caller did not ask for it so that it can be
+  # replayed on a cache hit.
+  ret = postlink_cache.run(tool, [cmd[0]], postlink_cache.normalize_args(cmd[1:], placeholders),
+                           inputs, outputs, lambda: check_call(cmd, stdout=PIPE).stdout)
+  if stdout != PIPE:
+    sys.stdout.write(ret)
+    return None
+  return ret
+
+
 def run_wasm_opt(infile, outfile=None, args=[], **kwargs):  # noqa
   return run_binaryen_command('wasm-opt', infile, outfile, args=args, **kwargs)
 
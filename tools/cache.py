@@ -4,11 +4,29 @@
 # found in the LICENSE file.
 
 """Permanent cache for system libraries and ports.
+
+Individual artifacts (system libraries, ports, etc) are each guarded by their
+own lock, so that distinct artifacts can be built concurrently by different
+processes.  Artifacts are built into a temporary directory and then renamed
+into place, which means that readers never observe a partially written file and
+so never need to take a lock.
+
+Operations that affect the cache as a whole, such as clearing it, take the
+cache-wide lock (`lock()`).  Artifact locks are only taken while holding the
+cache-wide lock in shared mode (`shared_lock()`), so that such operations wait
+for running builds to finish, and builds don't start while they run.  File
+locks can only be exclusive on all platforms, so each holder of the shared lock
+registers itself by holding a lock file of its own under `locks/shared`.  These
+are taken while briefly holding the cache-wide lock, and whoever takes the
+cache-wide lock waits until it can take each of them.
 """
 
 import contextlib
 import logging
 import os
+import shutil
+import tempfile
+import uuid
 from pathlib import Path
 
 from . import filelock, config, utils
@@ -18,9 +36,51 @@ logger = logging.getLogger('cache')
 
 
 acquired_count = 0
+shared_count = 0
+shared_holder = None
+artifact_depth = 0
+artifact_set_env = False
 cachedir = None
 cachelock = None
 cachelock_name = None
+artifact_locks = {}
+
+
+def acquire_lock_file(lock, reason):
+  try:
+    lock.acquire(60)
+  except filelock.Timeout:
+    logger.warning(f'Accessing the Emscripten cache at "{cachedir}" (for "{reason}") is taking a long time, another process should be writing to it. If there are none and you suspect this process has deadlocked, try deleting the lock file "{lock.lock_file}" and try again. If this occurs deterministically, consider filing a bug.')
+    lock.acquire()
+
+
+def remove_lock_file(path):
+  # The file may already have been removed by the other side, or, on Windows,
+  # still be open there.  It is removed the next time the cache is locked.
+  try:
+    os.remove(path)
+  except OSError:
+    pass
+
+
+def get_shared_holders_dir():
+  return Path(cachedir, 'locks', 'shared')
+
+
+def wait_for_shared_holders(reason):
+  """Waits until no other process holds the cache-wide lock in shared mode.
+
+  Must be called with the cache-wide lock held, which stops new holders from
+  registering.
+  """
+  holders_dir = get_shared_holders_dir()
+  if not holders_dir.is_dir():
+    return
+  for name in os.listdir(holders_dir):
+    holder = filelock.FileLock(Path(holders_dir, name))
+    acquire_lock_file(holder, reason)
+    holder.release()
+    remove_lock_file(holder.lock_file)
 
 
 def acquire_cache_lock(reason):
@@ -33,11 +93,11 @@ def acquire_cache_lock(reason):
   if acquired_count == 0:
     logger.debug(f'PID {os.getpid()} acquiring multiprocess file lock to Emscripten cache at {cachedir}')
     assert 'EM_CACHE_IS_LOCKED' not in os.environ, f'attempt to lock the cache while a parent process is holding the lock ({reason})'
-    try:
-      cachelock.acquire(60)
-    except filelock.Timeout:
-      logger.warning(f'Accessing the Emscripten cache at "{cachedir}" (for "{reason}") is taking a long time, another process should be writing to it. If there are none and you suspect this process has deadlocked, try deleting the lock file "{cachelock_name}" and try again. If this occurs deterministically, consider filing a bug.')
-      cachelock.acquire()
+    # Waiting for the other holders of the shared lock would never finish if
+    # this process were one of them.
+    assert shared_count == 0, f'attempt to lock the cache while holding it in shared mode ({reason})'
+    acquire_lock_file(cachelock, reason)
+    wait_for_shared_holders(reason)
 
     os.environ['EM_CACHE_IS_LOCKED'] = '1'
     logger.debug('done')
@@ -65,6 +125,109 @@ def lock(reason):
     release_cache_lock()
 
 
+def acquire_shared_cache_lock(reason):
+  global shared_count, shared_holder
+  if config.FROZEN_CACHE:
+    raise Exception('Attempt to lock the cache but FROZEN_CACHE is set')
+
+  # Holding the cache-wide lock in this process implies holding it in shared
+  # mode.
+  if shared_count == 0 and acquired_count == 0:
+    assert 'EM_CACHE_IS_LOCKED' not in os.environ, f'attempt to lock the cache while a parent process is holding the lock ({reason})'
+    logger.debug(f'PID {os.getpid()} acquiring shared file lock to Emscripten cache at {cachedir}')
+    acquire_lock_file(cachelock, reason)
+    try:
+      holders_dir = get_shared_holders_dir()
+      utils.safe_ensure_dirs(holders_dir)
+      shared_holder = filelock.FileLock(Path(holders_dir, f'{os.getpid()}-{uuid.uuid4().hex}.lock'))
+      shared_holder.acquire()
+    finally:
+      cachelock.release()
+  shared_count += 1
+
+
+def release_shared_cache_lock():
+  global shared_count, shared_holder
+  shared_count -= 1
+  assert shared_count >= 0, "Called release more times than acquire"
+  if shared_count == 0 and shared_holder:
+    shared_holder.release()
+    remove_lock_file(shared_holder.lock_file)
+    shared_holder = None
+    logger.debug(f'PID {os.getpid()} released shared file lock to Emscripten cache at {cachedir}')
+
+
+@contextlib.contextmanager
+def shared_lock(reason):
+  """A context manager that holds the cache-wide lock in shared mode.
+
+  This doesn't exclude other holders of the shared lock, but it does exclude
+  operations on the whole cache, such as `erase()`.
+  """
+  acquire_shared_cache_lock(reason)
+  try:
+    yield
+  finally:
+    release_shared_cache_lock()
+
+
+def get_artifact_lock(shortname):
+  """Returns the lock that guards the creation of a single cache artifact.
+
+  `shortname` is relative to the cache directory.  The lock files are kept in a
+  separate `locks` tree so that they don't show up alongside the artifacts
+  themselves (e.g. in the library search path).
+  """
+  ensure_setup()
+  name = os.path.normpath(shortname)
+  assert not os.path.isabs(name) and not name.startswith('..'), shortname
+  lock_name = Path(cachedir, 'locks', name + '.lock')
+  lock = artifact_locks.get(lock_name)
+  if not lock:
+    utils.safe_ensure_dirs(lock_name.parent)
+    lock = filelock.FileLock(lock_name)
+    artifact_locks[lock_name] = lock
+  return lock
+
+
+@contextlib.contextmanager
+def artifact_lock(shortname):
+  """A context manager that holds the lock for a single cache artifact."""
+  global artifact_depth, artifact_set_env
+  if config.FROZEN_CACHE:
+    raise Exception(f'Attempt to lock cache artifact "{shortname}" but FROZEN_CACHE is set')
+
+  # If a parent process holds a cache lock then it is likely waiting on us, so
+  # taking another one could deadlock.  This is checked by
+  # acquire_shared_cache_lock, except when this process already holds a cache
+  # lock itself.
+  assert acquired_count or artifact_depth or 'EM_CACHE_IS_LOCKED' not in os.environ, f'attempt to lock the cache while a parent process is holding the lock ({shortname})'
+
+  with shared_lock(shortname):
+    lock = get_artifact_lock(shortname)
+    logger.debug(f'PID {os.getpid()} acquiring file lock for cache artifact {shortname}')
+    try:
+      lock.acquire(60)
+    except filelock.Timeout:
+      logger.warning(f'Accessing the Emscripten cache artifact "{shortname}" is taking a long time, another process should be building it. If there are none and you suspect this process has deadlocked, try deleting the lock file "{lock.lock_file}" and try again. If this occurs deterministically, consider filing a bug.')
+      lock.acquire()
+    # Let child processes (e.g. the compiler processes of a library build) know
+    # that they must not take cache locks themselves.
+    if artifact_depth == 0 and 'EM_CACHE_IS_LOCKED' not in os.environ:
+      os.environ['EM_CACHE_IS_LOCKED'] = '1'
+      artifact_set_env = True
+    artifact_depth += 1
+    try:
+      yield
+    finally:
+      artifact_depth -= 1
+      if artifact_depth == 0 and artifact_set_env:
+        del os.environ['EM_CACHE_IS_LOCKED']
+        artifact_set_env = False
+      lock.release()
+      logger.debug(f'PID {os.getpid()} released file lock for cache artifact {shortname}')
+
+
 def ensure():
   ensure_setup()
   utils.safe_ensure_dirs(cachedir)
@@ -73,8 +236,11 @@ def ensure():
 def erase():
   ensure_setup()
   with lock('erase'):
-    # Delete everything except the lockfile itself
-    utils.delete_contents(cachedir, exclude=[os.path.basename(cachelock_name)])
+    # Delete everything except the lock files.  Other processes may be waiting
+    # on them, and if one was deleted and created again it would no longer
+    # exclude them.
+    lock_files = [f for f in os.listdir(cachedir) if f.endswith('.lock')]
+    utils.delete_contents(cachedir, exclude=lock_files + ['locks'])
 
 
 def get_path(name):
@@ -127,7 +293,8 @@ def erase_lib(name):
 
 
 def erase_file(shortname):
-  with lock('erase: ' + shortname):
+  ensure_setup()
+  with artifact_lock(shortname):
     name = Path(cachedir, shortname)
     if name.exists():
       logger.info(f'deleting cached file: {name}')
@@ -140,8 +307,9 @@ def get_lib(libname, *args, **kwargs):
 
 
 # Request a cached file. If it isn't in the cache, it will be created with
-# the given creator function
-def get(shortname, creator, what=None, force=False, quiet=False, deferred=False):
+# the given creator function.  Unless `atomic` is False the creator is passed a
+# temporary path (with the same basename) which is then renamed into place.
+def get(shortname, creator, what=None, force=False, quiet=False, deferred=False, atomic=True):
   ensure_setup()
   cachename = Path(cachedir, shortname)
   # Check for existence before taking the lock in case we can avoid the
@@ -154,7 +322,7 @@ def get(shortname, creator, what=None, force=False, quiet=False, deferred=False)
     # should never happen
     raise Exception(f'FROZEN_CACHE is set, but cache file is missing: "{shortname}" (in cache root path "{cachedir}")')
 
-  with lock(shortname):
+  with artifact_lock(shortname):
     if cachename.exists() and not force:
       return str(cachename)
     if what is None:
@@ -165,9 +333,21 @@ def get(shortname, creator, what=None, force=False, quiet=False, deferred=False)
     message = f'generating {what}: {shortname}... (this will be cached in "{cachename}" for subsequent builds)'
     logger.info(message)
     utils.safe_ensure_dirs(cachename.parent)
-    creator(str(cachename))
-    if not deferred:
-      assert cachename.exists()
+    if atomic and not deferred:
+      tmproot = Path(cachedir, 'tmp')
+      utils.safe_ensure_dirs(tmproot)
+      tmpdir = tempfile.mkdtemp(prefix=cachename.name + '-', dir=tmproot)
+      try:
+        tmpname = Path(tmpdir, cachename.name)
+        creator(str(tmpname))
+        assert tmpname.exists()
+        os.replace(tmpname, cachename)
+      finally:
+        shutil.rmtree(tmpdir, ignore_errors=True)
+    else:
+      creator(str(cachename))
+      if not deferred:
+        assert cachename.exists()
     if not quiet:
       logger.info(' - ok')
 
@@ -34,6 +34,7 @@ WASMTIME = None
 WASM_ENGINES: List[List[str]] = []
 FROZEN_CACHE = None
 CACHE = None
+POSTLINK_CACHE = None
 PORTS = None
 COMPILER_WRAPPER = None
 
@@ -135,6 +136,7 @@ def parse_config_file():
     'WASM_ENGINES',
     'FROZEN_CACHE',
     'CACHE',
+    'POSTLINK_CACHE',
     'PORTS',
     'COMPILER_WRAPPER',
   )
@@ -47,3 +47,9 @@ NODE_JS = '{{{ NODE }}}' # executable
 # Other options
 #
 # FROZEN_CACHE = True # never clears the cache, and disallows building to the cache
+#
+# Reuse the results of post-link optimization passes (wasm-opt, closure, etc)
+# when their inputs are unchanged.  Set to 1 to store them in the cache, or to
+# the path of a directory to store them in.
+#
+# POSTLINK_CACHE = 1
@@ -913,6 +913,8 @@ def create_module(receiving, metadata, library_symbols):
     # that check for proper import use, and for ASYNCIFY=2 we use them to set up
     # the Promise API on the import side.
     module.append('Asyncify.instrumentWasmImports(wasmImports);\n')
+  if settings.GL_PROFILE:
+    module.append('GLProfiler.instrumentWasmImports(wasmImports);\n')
 
   if not settings.MINIMAL_RUNTIME:
     module.append("var wasmExports = createWasm();\n")
@@ -955,6 +957,9 @@ def create_pointer_conversion_wrappers(metadata):
     'memalign': 'ppp',
     'memcmp': '_ppp',
     'memcpy': 'pppp',
+    'strnlen': 'ppp',
+    'emscripten_utf8_to_utf16': 'pppp',
+    'emscripten_get_heap_stats': '_p',
     '__getTypeName': 'pp',
     'setThrew': '_p',
     'free': '_p',
@@ -985,6 +990,8 @@ def create_pointer_conversion_wrappers(metadata):
     '_wasmfs_read_file': 'pp',
     '__dl_seterr': '_pp',
     '_emscripten_run_on_main_thread_js': '__p_p_',
+    '_emscripten_proxy_slot_acquire': 'p_',
+    '_emscripten_proxy_slot_run': '__p__',
     '_emscripten_proxy_execute_task_queue': '_p',
     '_emscripten_thread_exit': '_p',
     '_emscripten_thread_init': '_p_____',
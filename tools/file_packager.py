@@ -21,7 +21,7 @@ data downloads.
 
 Usage:
 
-  file_packager TARGET [--preload A [B..]] [--embed C [D..]] [--exclude E [F..]]] [--js-output=OUTPUT.js] [--no-force] [--use-preload-cache] [--indexedDB-name=EM_PRELOAD_CACHE] [--separate-metadata] [--lz4] [--use-preload-plugins] [--no-node]
+  file_packager TARGET [--preload A [B..]] [--embed C [D..]] [--exclude E [F..]]] [--js-output=OUTPUT.js] [--no-force] [--use-preload-cache] [--indexedDB-name=EM_PRELOAD_CACHE] [--separate-metadata] [--lz4] [--lz4-chunk-size=N] [--content-addressed] [--content-chunk-size=N] [--lazy] [--lazy-prefetch P [Q..]] [--use-preload-plugins] [--no-node]
 
   --preload  ,
   --embed    See emcc --help for more details on those options.
@@ -52,6 +52,31 @@ Usage:
   --lz4 Uses LZ4. This compresses the data using LZ4 when this utility is run, then the client decompresses chunks on the fly, avoiding storing
         the entire decompressed data in memory at once. See LZ4 in src/settings.js, you must build the main program with that flag.
 
+  --lz4-chunk-size=N Compresses the data in chunks of N bytes (Default: 2048). Larger chunks compress better and decompress faster
+                     overall, but each read that misses the cache decompresses a whole chunk. Use large chunks with -sLZ4_WORKERS.
+
+  --content-addressed Writes the preloaded data as a directory TARGET of chunks named by the SHA-256 of their contents, instead of
+                      a single file. Files with identical contents are stored once, and chunks that are already in the directory
+                      are kept, so it can hold the chunks of several versions of the package at once. With --use-preload-cache
+                      the chunks are cached in IndexedDB (in the --indexedDB-name database with a -chunks suffix), and a new version of the package only downloads the chunks of the
+                      files that changed. Cannot be used with --lz4.
+
+  --content-chunk-size=N Splits each file into chunks of at most N bytes for --content-addressed (Default: 1MB).
+
+  --lazy Does not download the package before running. The preloaded files are created right away, and the contents of
+         each file are read from the package with a range request the first time the file is used (or taken from the
+         package if Module.getPreloadedPackage provides it). That request is a synchronous XMLHttpRequest, which blocks
+         the thread that reads the file, so in browsers read lazy files from a worker (e.g. with -sPROXY_TO_PTHREAD)
+         rather than the main thread. Requires the old JS filesystem, loading the package fails with WasmFS. Cannot be
+         used with --lz4, --content-addressed or --use-preload-cache.
+         With --use-preload-plugins, the files that the built-in preload plugins handle (images, audio and .so files) are
+         prefetched, see --lazy-prefetch, and handed to the plugins before running. Add the files of other plugins to
+         --lazy-prefetch.
+
+  --lazy-prefetch P [Q..] Specifies filename patterns of preloaded files (see --exclude, matched against the path in the
+                          virtual file system) that are downloaded before running with --lazy, like files that are
+                          needed during startup.
+
   --use-preload-plugins Tells the file packager to run preload plugins on the files as they are loaded. This performs tasks like decoding images
                         and audio using the browser's codecs.
 
@@ -90,6 +115,9 @@ DEBUG = os.environ.get('EMCC_DEBUG')
 
 IMAGE_SUFFIXES = ('.jpg', '.png', '.bmp')
 AUDIO_SUFFIXES = ('.ogg', '.wav', '.mp3')
+# The files that the preload plugins in library_browser.js and library_dylink.js
+# handle.
+PRELOAD_PLUGIN_SUFFIXES = ('.jpg', '.jpeg', '.png', '.bmp') + AUDIO_SUFFIXES + ('.so',)
 AUDIO_MIMETYPES = {'ogg': 'audio/ogg', 'wav': 'audio/wav', 'mp3': 'audio/mpeg'}
 
 DDS_HEADER_SIZE = 128
@@ -125,6 +153,17 @@ class Options:
     # which makes js-output file to mutate on each invocation of this packager tool.
     self.separate_metadata = False
     self.lz4 = False
+    self.lz4_chunk_size = None
+    # If set to True, the preloaded data is written as content-addressed chunks
+    # (see write_content_addressed) which the loader downloads separately, and
+    # with use_preload_cache only when they are not in the local cache.
+    self.content_addressed = False
+    self.content_chunk_size = None
+    # If set to True, the package is not downloaded before running, and each
+    # preloaded file is read from it when first used, except for the ones that
+    # match lazy_prefetch.
+    self.lazy = False
+    self.lazy_prefetch = []
     self.use_preload_plugins = False
     self.support_node = True
     self.wasm64 = False
@@ -145,6 +184,19 @@ def err(*args):
   print(*args, file=sys.stderr)
 
 
+def parse_positive_int(flag, value):
+  """Returns `value` as an int, or None after reporting an error if it is not
+  a positive integer."""
+  try:
+    result = int(value)
+  except (TypeError, ValueError):
+    result = 0
+  if result <= 0:
+    err(f'error: {flag} requires a positive integer value')
+    return None
+  return result
+
+
 def base64_encode(b):
   b64 = base64.b64encode(b)
   return b64.decode('ascii')
@@ -359,7 +411,7 @@ def generate_object_file(data_files):
 
 def main():
   if len(sys.argv) == 1:
-    err('''Usage: file_packager TARGET [--preload A [B..]] [--embed C [D..]] [--exclude E [F..]]] [--js-output=OUTPUT.js] [--no-force] [--use-preload-cache] [--indexedDB-name=EM_PRELOAD_CACHE] [--separate-metadata] [--lz4] [--use-preload-plugins]
+    err('''Usage: file_packager TARGET [--preload A [B..]] [--embed C [D..]] [--exclude E [F..]]] [--js-output=OUTPUT.js] [--no-force] [--use-preload-cache] [--indexedDB-name=EM_PRELOAD_CACHE] [--separate-metadata] [--lz4] [--lz4-chunk-size=N] [--content-addressed] [--content-chunk-size=N] [--lazy] [--lazy-prefetch P [Q..]] [--use-preload-plugins]
   See the source for more details.''')
     return 1
 
@@ -393,6 +445,24 @@ def main():
     elif arg == '--lz4':
       options.lz4 = True
       leading = ''
+    elif arg.startswith('--lz4-chunk-size'):
+      options.lz4_chunk_size = parse_positive_int('--lz4-chunk-size', arg.split('=', 1)[1] if '=' in arg else None)
+      if options.lz4_chunk_size is None:
+        return 1
+      leading = ''
+    elif arg == '--content-addressed':
+      options.content_addressed = True
+      leading = ''
+    elif arg.startswith('--content-chunk-size'):
+      options.content_chunk_size = parse_positive_int('--content-chunk-size', arg.split('=', 1)[1] if '=' in arg else None)
+      if options.content_chunk_size is None:
+        return 1
+      leading = ''
+    elif arg == '--lazy':
+      options.lazy = True
+      leading = ''
+    elif arg == '--lazy-prefetch':
+      leading = 'lazy-prefetch'
     elif arg == '--use-preload-plugins':
       options.use_preload_plugins = True
       leading = ''
@@ -446,6 +516,8 @@ def main():
         return 1
     elif leading == 'exclude':
       excluded_patterns.append(arg)
+    elif leading == 'lazy-prefetch':
+      options.lazy_prefetch.append(arg)
     else:
       err('Unknown parameter:', arg)
       return 1
@@ -459,6 +531,26 @@ def main():
           'and a specified --js-output')
       return 1
 
+  if options.lz4_chunk_size and not options.lz4:
+    err('error: --lz4-chunk-size requires --lz4')
+    return 1
+
+  if options.content_chunk_size and not options.content_addressed:
+    err('error: --content-chunk-size requires --content-addressed')
+    return 1
+
+  if options.content_addressed and options.lz4:
+    err('error: --content-addressed cannot be used with --lz4')
+    return 1
+
+  if options.lazy and (options.lz4 or options.content_addressed or options.use_preload_cache):
+    err('error: --lazy cannot be used with --lz4, --content-addressed or --use-preload-cache')
+    return 1
+
+  if options.lazy_prefetch and not options.lazy:
+    err('error: --lazy-prefetch requires --lazy')
+    return 1
+
   if not options.from_emcc and not options.quiet:
     err('Remember to build the main file with `-sFORCE_FILESYSTEM` '
         'so that it includes support for loading this file package')
@@ -597,6 +689,169 @@ def escape_for_makefile(fpath):
   return fpath.replace('$', '$$').replace('#', '\\#').replace(' ', '\\ ')
 
 
+def write_content_addressed(data_target, data_files, metadata):
+  """Lays out the preloaded files like a regular package, except that files
+  with identical contents share a single range, and writes the package as
+  chunks named by their SHA-256 into the directory data_target. Each file is
+  split into chunks on its own, so that changing a file does not change the
+  chunks of any other file. Returns the size of the package."""
+  utils.safe_ensure_dirs(data_target)
+  chunk_size = options.content_chunk_size or 1024 * 1024
+  chunks = []
+  ranges = {}
+  start = 0
+  for file_ in data_files:
+    if file_.mode != 'preload':
+      continue
+    curr = utils.read_binary(file_.srcpath)
+    digest = hashlib.sha256(curr).digest()
+    if digest not in ranges:
+      ranges[digest] = start
+      for offset in range(0, len(curr), chunk_size):
+        chunk = curr[offset:offset + chunk_size]
+        name = hashlib.sha256(chunk).hexdigest()
+        path = os.path.join(data_target, name)
+        if not os.path.exists(path):
+          utils.write_binary(path, chunk)
+        chunks.append([name, len(chunk)])
+      start += len(curr)
+    file_.data_start = ranges[digest]
+    file_.data_end = file_.data_start + len(curr)
+  metadata['chunks'] = chunks
+  return start
+
+
+def generate_lazy_js(data_target):
+  """Returns the code that creates the files of a --lazy package, which reads
+  their contents from the package when they are first used."""
+  node_support_code = ''
+  if options.support_node:
+    node_support_code = '''
+        if (typeof process === 'object' && typeof process.versions === 'object' && typeof process.versions.node === 'string') {
+          var fs = require('fs');
+          var fd = fs.openSync(REMOTE_PACKAGE_NAME, 'r');
+          var data = new Uint8Array(end - start);
+          try {
+            fs.readSync(fd, data, 0, data.length, start);
+          } finally {
+            fs.closeSync(fd);
+          }
+          return data;
+        }'''
+
+  if options.use_preload_plugins:
+    # This adds a run dependency until the plugin is done with the file.
+    create_file = '''Module['FS_createPreloadedFile'](file['filename'], null, byteArray, true, true, null, function() {
+              err(`Preloading file ${file['filename']} failed`);
+            }, false, true); // canOwn this data in the filesystem, it is a slice of the data we fetched'''
+  else:
+    create_file = '''// canOwn this data in the filesystem, it is a slice of the data we fetched
+            Module['FS_createDataFile'](file['filename'], null, byteArray, true, true, true);'''
+
+  return '''
+      // The whole package, if we have it, otherwise the contents of each file
+      // are requested from the server.
+      var packageData = null;
+      if (Module['getPreloadedPackage']) {
+        var preloaded = Module['getPreloadedPackage'](REMOTE_PACKAGE_NAME, REMOTE_PACKAGE_SIZE);
+        if (preloaded) packageData = new Uint8Array(preloaded);
+      }
+
+      // Reads files that are not prefetched on first use. The read cannot
+      // wait for a callback, so this is a synchronous request, which blocks
+      // the thread that does it. In browsers that should be a worker (e.g.
+      // with -sPROXY_TO_PTHREAD), since on the main thread it freezes the page
+      // for the length of the download.
+      function readRange(start, end) {
+        if (packageData) return packageData.subarray(start, end);
+        if (start == end) return new Uint8Array(0);
+        %(node_support_code)s
+        var xhr = new XMLHttpRequest();
+        xhr.open('GET', REMOTE_PACKAGE_NAME, false);
+        xhr.setRequestHeader('Range', `bytes=${start}-${end - 1}`);
+        // Synchronous requests cannot return an ArrayBuffer on the main thread,
+        // so read the bytes from the text of the response instead.
+        xhr.overrideMimeType('text/plain; charset=x-user-defined');
+        xhr.send(null);
+        if (!(xhr.status >= 200 && xhr.status < 300 || (xhr.status == 0 && xhr.responseText))) {
+          throw new Error(xhr.statusText + " : " + REMOTE_PACKAGE_NAME);
+        }
+        var text = xhr.responseText;
+        var data = new Uint8Array(text.length);
+        for (var i = 0; i < text.length; i++) {
+          data[i] = text.charCodeAt(i) & 0xff;
+        }
+        if (xhr.status != 206) {
+          // The server does not support ranges and sent the whole package.
+          packageData = data;
+          return data.subarray(start, end);
+        }
+        return data;
+      }
+
+      function fetchRange(start, end, callback, errback) {
+        if (packageData || start == end || typeof XMLHttpRequest == 'undefined') {
+          callback(readRange(start, end));
+          return;
+        }
+        var xhr = new XMLHttpRequest();
+        xhr.open('GET', REMOTE_PACKAGE_NAME, true);
+        xhr.setRequestHeader('Range', `bytes=${start}-${end - 1}`);
+        xhr.responseType = 'arraybuffer';
+        xhr.onerror = function(event) {
+          errback(new Error("NetworkError for: " + REMOTE_PACKAGE_NAME));
+        };
+        xhr.onload = function(event) {
+          if (xhr.status == 206) {
+            callback(new Uint8Array(xhr.response));
+          } else if (xhr.status == 200 || xhr.status == 304 || (xhr.status == 0 && xhr.response)) {
+            packageData = new Uint8Array(xhr.response);
+            callback(packageData.subarray(start, end));
+          } else {
+            errback(new Error(xhr.statusText + " : " + xhr.responseURL));
+          }
+        };
+        xhr.send(null);
+      }
+
+      Module.preloadResults[PACKAGE_NAME] = {fromCache: false};
+      var files = metadata['files'];
+      if (!Module['FS_createLazyDataFile']) {
+        // WasmFS has no lazy files. Loading the whole package up front instead
+        // would quietly defeat the point of --lazy.
+        throw new Error(`${PACKAGE_NAME} was packaged with --lazy, which needs the JS filesystem (FS_createLazyDataFile) and does not work with WasmFS`);
+      }
+      files.forEach(function(file) {
+        if (file['prefetch']) return;
+        Module['FS_createLazyDataFile'](file['filename'], null, file['end'] - file['start'],
+                                        readRange.bind(null, file['start'], file['end']), true, true);
+      });
+
+      // Files that are next to each other in the package are fetched together.
+      var ranges = [];
+      files.forEach(function(file) {
+        if (!file['prefetch']) return;
+        var last = ranges[ranges.length - 1];
+        if (last && last.end == file['start']) {
+          last.end = file['end'];
+          last.files.push(file);
+        } else {
+          ranges.push({start: file['start'], end: file['end'], files: [file]});
+        }
+      });
+      ranges.forEach(function(range) {
+        var dep = `fp ${range.files[0]['filename']}`;
+        Module['addRunDependency'](dep);
+        fetchRange(range.start, range.end, function(data) {
+          range.files.forEach(function(file) {
+            var byteArray = data.subarray(file['start'] - range.start, file['end'] - range.start);
+            %(create_file)s
+          });
+          Module['removeRunDependency'](dep);
+        }, handleError);
+      });\n''' % {'node_support_code': node_support_code.strip(), 'create_file': create_file}
+
+
 def generate_js(data_target, data_files, metadata):
   # emcc will add this to the output itself, so it is only needed for
   # standalone calls
@@ -637,18 +892,21 @@ def generate_js(data_target, data_files, metadata):
           partial_dirs.append(partial)
 
   if options.has_preloaded:
-    # Bundle all datafiles into one archive. Avoids doing lots of simultaneous
-    # XHRs which has overhead.
-    start = 0
-    with open(data_target, 'wb') as data:
-      for file_ in data_files:
-        file_.data_start = start
-        curr = utils.read_binary(file_.srcpath)
-        file_.data_end = start + len(curr)
-        if AV_WORKAROUND:
-            curr += '\x00'
-        start += len(curr)
-        data.write(curr)
+    if options.content_addressed:
+      start = write_content_addressed(data_target, data_files, metadata)
+    else:
+      # Bundle all datafiles into one archive. Avoids doing lots of simultaneous
+      # XHRs which has overhead.
+      start = 0
+      with open(data_target, 'wb') as data:
+        for file_ in data_files:
+          file_.data_start = start
+          curr = utils.read_binary(file_.srcpath)
+          file_.data_end = start + len(curr)
+          if AV_WORKAROUND:
+              curr += '\x00'
+          start += len(curr)
+          data.write(curr)
 
     if start > 256 * 1024 * 1024:
       err('warning: file packager is creating an asset bundle of %d MB. '
@@ -666,7 +924,7 @@ def generate_js(data_target, data_files, metadata):
           Module['FS_createDataFile'](this.name, null, byteArray, true, true, true);
           Module['removeRunDependency'](`fp ${that.name}`);'''
 
-    if not options.lz4:
+    if not options.lz4 and not options.lazy:
       # Data requests - for getting a block of data out of the big archive - have
       # a similar API to XHRs
       code += '''
@@ -724,6 +982,12 @@ def generate_js(data_target, data_files, metadata):
       }
       if filename[-4:] in AUDIO_SUFFIXES:
         metadata_el['audio'] = 1
+      if any(fnmatch.fnmatch(filename, p) for p in options.lazy_prefetch):
+        metadata_el['prefetch'] = 1
+      elif options.lazy and options.use_preload_plugins and filename.lower().endswith(PRELOAD_PLUGIN_SUFFIXES):
+        # Preload plugins run before the program does, so they need the data
+        # up front.
+        metadata_el['prefetch'] = 1
 
       metadata['files'].append(metadata_el)
     else:
@@ -745,8 +1009,11 @@ def generate_js(data_target, data_files, metadata):
       # LZ4FS usage
       temp = data_target + '.orig'
       shutil.move(data_target, temp)
+      lz4_args = [temp, data_target]
+      if options.lz4_chunk_size:
+        lz4_args.append(str(options.lz4_chunk_size))
       meta = shared.run_js_tool(utils.path_from_root('tools/lz4-compress.mjs'),
-                                [temp, data_target], stdout=PIPE)
+                                lz4_args, stdout=PIPE)
       os.unlink(temp)
       use_data = '''var compressedData = %s;
             compressedData['data'] = byteArray;
@@ -755,7 +1022,10 @@ def generate_js(data_target, data_files, metadata):
             Module['removeRunDependency']('datafile_%s');''' % (meta, "true" if options.use_preload_plugins else "false", js_manipulation.escape_for_js_string(data_target))
 
     package_name = data_target
-    remote_package_size = os.path.getsize(package_name)
+    if options.content_addressed:
+      remote_package_size = start
+    else:
+      remote_package_size = os.path.getsize(package_name)
     remote_package_name = os.path.basename(package_name)
     ret += '''
       var PACKAGE_PATH = '';
@@ -778,10 +1048,24 @@ def generate_js(data_target, data_files, metadata):
     if options.use_preload_cache:
       # Set the id to a hash of the preloaded data, so that caches survive over multiple builds
       # if the data has not changed.
-      data = utils.read_binary(data_target)
+      if options.content_addressed:
+        data = json.dumps(metadata['chunks']).encode('utf-8')
+      else:
+        data = utils.read_binary(data_target)
       package_uuid = 'sha256-' + hashlib.sha256(data).hexdigest()
       metadata['package_uuid'] = str(package_uuid)
 
+      db_name = options.indexeddb_name
+      create_chunk_store = ''
+      if options.content_addressed:
+        # Content-addressed packages cache their chunks in a database of their
+        # own, so the schema of the shared one, and the packages already cached
+        # in it, stay as they are.
+        db_name += '-chunks'
+        create_chunk_store = '''
+            db.createObjectStore(CHUNK_STORE_NAME);
+'''
+
       code += r'''
         var PACKAGE_UUID = metadata['package_uuid'];
         var indexedDB;
@@ -795,7 +1079,7 @@ def generate_js(data_target, data_files, metadata):
         }
         var IDB_RO = "readonly";
         var IDB_RW = "readwrite";
-        var DB_NAME = "''' + options.indexeddb_name + '''";
+        var DB_NAME = "''' + db_name + '''";
         var DB_VERSION = 1;
         var METADATA_STORE_NAME = 'METADATA';
         var PACKAGE_STORE_NAME = 'PACKAGES';
@@ -817,7 +1101,7 @@ def generate_js(data_target, data_files, metadata):
               db.deleteObjectStore(METADATA_STORE_NAME);
             }
             var metadata = db.createObjectStore(METADATA_STORE_NAME);
-          };
+''' + create_chunk_store + '''          };
           openRequest.onsuccess = function(event) {
             var db = /** @type {IDBDatabase} */ (event.target.result);
             callback(db);
@@ -949,6 +1233,68 @@ def generate_js(data_target, data_files, metadata):
           }
         }\n'''
 
+      if options.content_addressed:
+        code += '''
+        var CHUNK_STORE_NAME = 'CHUNKS';
+
+        /* Passes each of the chunks in hashes that is in the chunk store to onChunk, then the others to callback */
+        function getCachedChunks(db, hashes, onChunk, callback, errback) {
+          var transaction = db.transaction([CHUNK_STORE_NAME], IDB_RO);
+          var chunks = transaction.objectStore(CHUNK_STORE_NAME);
+          var missing = [];
+          hashes.forEach(function(hash) {
+            var getRequest = chunks.get(hash);
+            getRequest.onsuccess = function(event) {
+              if (event.target.result) {
+                onChunk(hash, event.target.result);
+              } else {
+                missing.push(hash);
+              }
+            };
+          });
+          transaction.oncomplete = function(event) {
+            callback(missing);
+          };
+          transaction.onabort = function(event) {
+            errback(transaction.error);
+          };
+        }
+
+        /* Stores the downloaded chunks, and removes the ones only the previous version of the package used */
+        function cacheChunks(db, packageName, fetchedChunks, callback, errback) {
+          var transaction = db.transaction([CHUNK_STORE_NAME, METADATA_STORE_NAME], IDB_RW);
+          var chunks = transaction.objectStore(CHUNK_STORE_NAME);
+          var metadataStore = transaction.objectStore(METADATA_STORE_NAME);
+          for (var hash in fetchedChunks) {
+            chunks.put(fetchedChunks[hash], hash);
+          }
+          var used = {};
+          metadata['chunks'].forEach(function(chunk) {
+            used[chunk[0]] = 1;
+          });
+          var getRequest = metadataStore.get(`metadata/${packageName}`);
+          getRequest.onsuccess = function(event) {
+            var previous = event.target.result;
+            // Another package may share some of these chunks, in which case it
+            // downloads them again the next time it is loaded.
+            if (previous && previous['chunks']) {
+              previous['chunks'].forEach(function(hash) {
+                if (!used[hash]) chunks.delete(hash);
+              });
+            }
+            metadataStore.put({
+              'uuid': PACKAGE_UUID,
+              'chunks': Object.keys(used)
+            }, `metadata/${packageName}`);
+          };
+          transaction.oncomplete = function(event) {
+            callback();
+          };
+          transaction.onabort = function(event) {
+            errback(transaction.error);
+          };
+        }\n'''
+
     # add Node.js support code, if necessary
     node_support_code = ''
     if options.support_node:
@@ -1017,7 +1363,98 @@ def generate_js(data_target, data_files, metadata):
         console.error('package error:', error);
       };\n''' % {'node_support_code': node_support_code}
 
-    code += '''
+    if options.content_addressed:
+      node_digest_code = ''
+      if options.support_node:
+        node_digest_code = '''
+        if (typeof process === 'object' && typeof process.versions === 'object' && typeof process.versions.node === 'string') {
+          check(require('crypto').createHash('sha256').update(new Uint8Array(chunkData)).digest());
+          return;
+        }'''.strip()
+      ret += '''
+      // Checks that a downloaded chunk hashes to its name, so that a truncated
+      // or stale response never ends up in the package or in the chunk store.
+      function verifyChunk(hash, chunkData, callback, errback) {
+        function check(digest) {
+          var hex = Array.from(new Uint8Array(digest), (b) => b.toString(16).padStart(2, '0')).join('');
+          if (hex == hash) {
+            callback();
+          } else {
+            errback(new Error(`chunk ${hash} of ${REMOTE_PACKAGE_NAME} does not match its SHA-256`));
+          }
+        }
+        ''' + node_digest_code + '''
+        if (typeof crypto === 'object' && crypto.subtle) {
+          crypto.subtle.digest('SHA-256', chunkData).then(check, errback);
+        } else {
+          // crypto.subtle only exists in secure contexts (https or localhost),
+          // elsewhere the chunks are used as they are.
+          callback();
+        }
+      };
+
+      // Assembles the package from its chunks, downloading the ones that
+      // getCachedChunks (if given) does not find in the chunk store. Calls
+      // callback with the package data and the downloaded chunks by hash.
+      function fetchChunkedPackage(getCachedChunks, callback, errback) {
+        var packageData = new Uint8Array(REMOTE_PACKAGE_SIZE);
+        var offsets = {};
+        var sizes = {};
+        var offset = 0;
+        metadata['chunks'].forEach(function(chunk) {
+          var hash = chunk[0];
+          if (!offsets[hash]) offsets[hash] = [];
+          offsets[hash].push(offset);
+          sizes[hash] = chunk[1];
+          offset += chunk[1];
+        });
+        function placeChunk(hash, chunkData) {
+          chunkData = new Uint8Array(chunkData);
+          offsets[hash].forEach(function(offset) {
+            packageData.set(chunkData, offset);
+          });
+        }
+        function fetchChunks(hashes) {
+          var fetchedChunks = {};
+          var next = 0;
+          var done = 0;
+          // Each chunk counts as a download for the progress in setStatus.
+          Module.expectedDataFileDownloads += hashes.length - 1;
+          if (!hashes.length) {
+            callback(packageData.buffer, fetchedChunks);
+            return;
+          }
+          function fetchNext() {
+            var hash = hashes[next++];
+            fetchRemotePackage(`${REMOTE_PACKAGE_NAME}/${hash}`, sizes[hash], function(chunkData) {
+              verifyChunk(hash, chunkData, function() {
+                placeChunk(hash, chunkData);
+                fetchedChunks[hash] = chunkData;
+                if (++done == hashes.length) {
+                  callback(packageData.buffer, fetchedChunks);
+                } else if (next < hashes.length) {
+                  fetchNext();
+                }
+              }, errback);
+            }, errback);
+          }
+          // Keep a few requests in flight rather than one per chunk at once.
+          for (var i = 0; i < Math.min(hashes.length, 8); i++) {
+            fetchNext();
+          }
+        }
+        if (getCachedChunks) {
+          getCachedChunks(Object.keys(offsets), placeChunk, fetchChunks, errback);
+        } else {
+          fetchChunks(Object.keys(offsets));
+        }
+      };\n'''
+    fetch_package = 'fetchRemotePackage(REMOTE_PACKAGE_NAME, REMOTE_PACKAGE_SIZE,'
+    if options.content_addressed:
+      fetch_package = 'fetchChunkedPackage(null,'
+
+    if not options.lazy:
+      code += '''
       function processPackageData(arrayBuffer) {
         assert(arrayBuffer, 'Loading data file failed.');
         assert(arrayBuffer.constructor.name === ArrayBuffer.name, 'bad input to processPackageData');
@@ -1037,9 +1474,33 @@ def generate_js(data_target, data_files, metadata):
         function preloadFallback(error) {
           console.error(error);
           console.error('falling back to default preload behavior');
-          fetchRemotePackage(REMOTE_PACKAGE_NAME, REMOTE_PACKAGE_SIZE, processPackageData, handleError);
-        };
+          %s processPackageData, handleError);
+        };\n''' % fetch_package
 
+    if options.use_preload_cache and options.content_addressed:
+      code += '''
+        openDatabase(
+          function(db) {
+            fetchChunkedPackage(getCachedChunks.bind(null, db),
+              function(packageData, fetchedChunks) {
+                var fetched = Object.keys(fetchedChunks).length;
+                Module.preloadResults[PACKAGE_NAME] = {fromCache: !fetched, fetchedChunks: fetched};
+                cacheChunks(db, PACKAGE_PATH + PACKAGE_NAME, fetchedChunks,
+                  function() {
+                    processPackageData(packageData);
+                  },
+                  function(error) {
+                    console.error(error);
+                    processPackageData(packageData);
+                  });
+              }
+            , preloadFallback);
+          }
+        , preloadFallback);
+
+        if (Module['setStatus']) Module['setStatus']('Downloading...');\n'''
+    elif options.use_preload_cache:
+      code += '''
         openDatabase(
           function(db) {
             checkCachedPackage(db, PACKAGE_PATH + PACKAGE_NAME,
@@ -1064,6 +1525,8 @@ def generate_js(data_target, data_files, metadata):
         , preloadFallback);
 
         if (Module['setStatus']) Module['setStatus']('Downloading...');\n'''
+    elif options.lazy:
+      code += generate_lazy_js(data_target)
     else:
       # Not using preload cache, so we might as well start the xhr ASAP,
       # potentially before JS parsing of the main codebase if it's after us.
@@ -1073,14 +1536,14 @@ def generate_js(data_target, data_files, metadata):
       var fetchedCallback = null;
       var fetched = Module['getPreloadedPackage'] ? Module['getPreloadedPackage'](REMOTE_PACKAGE_NAME, REMOTE_PACKAGE_SIZE) : null;
 
-      if (!fetched) fetchRemotePackage(REMOTE_PACKAGE_NAME, REMOTE_PACKAGE_SIZE, function(data) {
+      if (!fetched) %s function(data) {
         if (fetchedCallback) {
           fetchedCallback(data);
           fetchedCallback = null;
         } else {
           fetched = data;
         }
-      }, handleError);\n'''
+      }, handleError);\n''' % fetch_package
 
       code += '''
       Module.preloadResults[PACKAGE_NAME] = {fromCache: false};
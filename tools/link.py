@@ -29,6 +29,7 @@ from . import feature_matrix
 from . import filelock
 from . import js_manipulation
 from . import ports
+from . import postlink_cache
 from . import shared
 from . import system_libs
 from . import utils
@@ -195,11 +196,9 @@ def setup_environment_settings():
 
 def generate_js_sym_info():
   # Runs the js compiler to generate a list of all symbols available in the JS
-  # libraries.  This must be done separately for each linker invocation since the
-  # list of symbols depends on what settings are used.
-  # TODO(sbc): Find a way to optimize this.  Potentially we could add a super-set
-  # mode of the js compiler that would generate a list of all possible symbols
-  # that could be checked in.
+  # libraries.  The list of symbols depends on what settings are used, so the
+  # compiler also reports which settings it read (`usedSettings`).  See
+  # get_js_sym_info.
   _, forwarded_data = emscripten.compile_javascript(symbols_only=True)
   # When running in symbols_only mode compiler.mjs outputs a flat list of C symbols.
   return json.loads(forwarded_data)
@@ -212,41 +211,64 @@ def get_js_sym_info():
   if DEBUG or settings.BOOTSTRAPPING_STRUCT_INFO or config.FROZEN_CACHE:
     return generate_js_sym_info()
 
-  # We define a cache hit as when the settings and `--js-library` contents are
-  # identical.
-  # Ignore certain settings that can are no relevant to library deps.  Here we
-  # skip PRE_JS_FILES/POST_JS_FILES which don't effect the library symbol list
-  # and can contain full paths to temporary files.
-  skip_settings = {'PRE_JS_FILES', 'POST_JS_FILES'}
-  input_files = [json.dumps(settings.external_dict(skip_keys=skip_settings), sort_keys=True, indent=2)]
+  # The symbol information is a function of the contents of the JS libraries
+  # and of the values of those settings that the JS compiler reads while
+  # processing them.  We therefore keep an index per set of library contents,
+  # where each entry records the values of the settings that the compiler
+  # reported as used.  Any link whose settings agree with an entry on those
+  # values can reuse its symbol list without running the JS compiler at all,
+  # regardless of how its other settings differ.
+  input_files = []
   for jslib in sorted(glob.glob(utils.path_from_root('src') + '/library*.js')):
     input_files.append(read_file(jslib))
   for jslib in settings.JS_LIBRARIES:
     if not os.path.isabs(jslib):
       jslib = utils.path_from_root('src', jslib)
     input_files.append(read_file(jslib))
-  content = '\n'.join(input_files)
-  content_hash = hashlib.sha1(content.encode('utf-8')).hexdigest()
+  library_hash = hashlib.sha1('\n'.join(input_files).encode('utf-8')).hexdigest()
+
+  # Round trip through JSON so that values compare equal to the ones that we
+  # read back from the index.
+  current_settings = json.loads(json.dumps(settings.external_dict()))
+
+  def matches(entry):
+    return all(k in current_settings and current_settings[k] == v for k, v in entry['settings'].items())
+
+  # We use a separate lock here for symbol lists because, unlike with system
+  # libraries, it's normal for these files to get pruned as part of normal
+  # operation, and the index must be kept consistent with the entries.  The
+  # shared cache lock keeps the cache from being cleared meanwhile.
+  root = cache.get_path('symbol_lists')
+  with cache.shared_lock('symbol lists'), filelock.FileLock(cache.get_path('symbol_lists.lock')):
+    utils.safe_ensure_dirs(root)
+    index_file = os.path.join(root, f'index-{library_hash}.json')
+    index = json.loads(read_file(index_file)) if os.path.exists(index_file) else []
+
+    for entry in index:
+      filename = os.path.join(root, entry['file'])
+      if matches(entry) and os.path.exists(filename):
+        logger.debug(f'using cached JS symbol list: {filename}')
+        # Touch the files that we used so that they are pruned last.
+        os.utime(filename)
+        os.utime(index_file)
+        return json.loads(read_file(filename))
 
-  def build_symbol_list(filename):
-    """Only called when there is no existing symbol list for a given content hash.
-    """
     library_syms = generate_js_sym_info()
-
-    write_file(filename, json.dumps(library_syms, separators=(',', ':'), indent=2))
-
-  # We need to use a separate lock here for symbol lists because, unlike with system libraries,
-  # it's normally for these file to get pruned as part of normal operation.  This means that it
-  # can be deleted between the `cache.get()` then the `read_file`.
-  with filelock.FileLock(cache.get_path(cache.get_path('symbol_lists.lock'))):
-    filename = cache.get(f'symbol_lists/{content_hash}.json', build_symbol_list)
-    library_syms = json.loads(read_file(filename))
-
-    # Limit of the overall size of the cache to 100 files.
+    used_settings = library_syms.pop('usedSettings')
+    entry_settings = {k: current_settings[k] for k in used_settings if k in current_settings}
+    entry_hash = hashlib.sha1((library_hash + json.dumps(entry_settings, sort_keys=True)).encode('utf-8')).hexdigest()
+    entry_file = f'{entry_hash}.json'
+    write_file(os.path.join(root, entry_file), json.dumps(library_syms, separators=(',', ':'), indent=2))
+
+    # Drop any entries whose files have since been pruned.
+    index = [e for e in index if e['file'] != entry_file and os.path.exists(os.path.join(root, e['file']))]
+    index.append({'settings': entry_settings, 'file': entry_file})
+    write_file(index_file, json.dumps(index, separators=(',', ':')))
+
+    # Limit of the overall size of the cache to 500 files.
     # This code will get test coverage since a full test run of `other` or `core`
     # generates ~1000 unique symbol lists.
     cache_limit = 500
-    root = cache.get_path('symbol_lists')
     if len(os.listdir(root)) > cache_limit:
       files = []
       for f in os.listdir(root):
@@ -486,6 +508,8 @@ def setup_pthreads(target):
     'emscripten_main_runtime_thread_id',
     'emscripten_main_thread_process_queued_calls',
     '_emscripten_run_on_main_thread_js',
+    '_emscripten_proxy_slot_acquire',
+    '_emscripten_proxy_slot_run',
     'emscripten_stack_set_limits',
   ]
 
@@ -611,7 +635,7 @@ def set_max_memory():
   initial_memory_known = settings.INITIAL_MEMORY != -1
 
   if not settings.ALLOW_MEMORY_GROWTH:
-    if 'MAXIMUM_MEMORY' in user_settings:
+    if 'MAXIMUM_MEMORY' in user_settings and not settings.RESERVE_MAXIMUM_MEMORY:
       diagnostics.warning('unused-command-line-argument', 'MAXIMUM_MEMORY is only meaningful with ALLOW_MEMORY_GROWTH')
     # Optimization: lower the default maximum memory to initial memory if possible.
     if initial_memory_known:
@@ -1072,6 +1096,11 @@ def phase_linker_setup(options, state, newargs):
                                   'emscripten_stack_get_base',
                                   'emscripten_stack_get_end',
                                   'emscripten_stack_get_current']
+    # The memory profiler samples the allocator's heap statistics, into a
+    # buffer on the stack.
+    if settings.MALLOC != 'none':
+      settings.REQUIRED_EXPORTS += ['emscripten_get_heap_stats',
+                                    'stackSave', 'stackAlloc', 'stackRestore']
 
   if settings.ASYNCIFY_LAZY_LOAD_CODE:
     settings.ASYNCIFY = 1
@@ -1081,6 +1110,9 @@ def phase_linker_setup(options, state, newargs):
     # See: https://github.com/emscripten-core/emscripten/issues/12066
     settings.DYNCALLS = 1
 
+  if settings.ASYNCIFY_PROFILE and settings.ASYNCIFY != 1:
+    exit_with_error('ASYNCIFY_PROFILE requires ASYNCIFY=1')
+
   settings.ASYNCIFY_ADD = unmangle_symbols_from_cmdline(settings.ASYNCIFY_ADD)
   settings.ASYNCIFY_REMOVE = unmangle_symbols_from_cmdline(settings.ASYNCIFY_REMOVE)
   settings.ASYNCIFY_ONLY = unmangle_symbols_from_cmdline(settings.ASYNCIFY_ONLY)
@@ -1294,6 +1326,15 @@ def phase_linker_setup(options, state, newargs):
     settings.FULL_ES2 = 1
     settings.MAX_WEBGL_VERSION = max(2, settings.MAX_WEBGL_VERSION)
 
+  if settings.GL_STATE_CACHE and settings.LEGACY_GL_EMULATION:
+    # The emulation layer changes context state behind the back of the cache.
+    exit_with_error('GL_STATE_CACHE is not compatible with LEGACY_GL_EMULATION')
+
+  if settings.GL_PROFILE:
+    # Needed by the wrappers that are installed around the wasm imports as the
+    # module is created.
+    settings.DEFAULT_LIBRARY_FUNCS_TO_INCLUDE += ['$GLProfiler']
+
   # WASM_SYSTEM_EXPORTS are actually native function but they are allowed to be exported
   # via EXPORTED_RUNTIME_METHODS for backwards compat.
   for sym in settings.WASM_SYSTEM_EXPORTS:
@@ -1346,6 +1387,21 @@ def phase_linker_setup(options, state, newargs):
     # overrides that.
     default_setting('ABORTING_MALLOC', 0)
 
+  if settings.RESERVE_MAXIMUM_MEMORY:
+    if not settings.ALLOW_MEMORY_GROWTH:
+      exit_with_error('RESERVE_MAXIMUM_MEMORY requires ALLOW_MEMORY_GROWTH')
+    if 'INITIAL_MEMORY' in user_settings or 'INITIAL_HEAP' in user_settings:
+      exit_with_error('RESERVE_MAXIMUM_MEMORY is not compatible with INITIAL_MEMORY or INITIAL_HEAP (the initial size is always MAXIMUM_MEMORY)')
+    # The default MAXIMUM_MEMORY is far more address space than most
+    # applications need, and may not be available to reserve at all.
+    if 'MAXIMUM_MEMORY' not in user_settings:
+      exit_with_error('RESERVE_MAXIMUM_MEMORY requires an explicit MAXIMUM_MEMORY')
+    # Create the memory at its maximum size up front, and from then on treat
+    # it like a fixed-size memory. Keep the ABORTING_MALLOC default from above,
+    # so that malloc still returns NULL when the reservation runs out.
+    settings.INITIAL_MEMORY = settings.MAXIMUM_MEMORY
+    settings.ALLOW_MEMORY_GROWTH = 0
+
   if '-lembind' in [x for _, x in state.link_flags]:
     settings.EMBIND = 1
 
@@ -1421,6 +1477,7 @@ def phase_linker_setup(options, state, newargs):
       # The old FS has some functionality that WasmFS lacks.
       settings.EXPORTED_RUNTIME_METHODS += [
         'FS_createLazyFile',
+        'FS_createLazyDataFile',
         'FS_createDevice'
       ]
 
@@ -1474,6 +1531,7 @@ def phase_linker_setup(options, state, newargs):
       not settings.ASSERTIONS and \
       not settings.RELOCATABLE and \
       not settings.ASYNCIFY_LAZY_LOAD_CODE and \
+      not settings.GL_PROFILE and \
           settings.MINIFY_WASM_EXPORT_NAMES:
     settings.MINIFY_WASM_IMPORTS_AND_EXPORTS = 1
     settings.MINIFY_WASM_IMPORTED_MODULES = 1
@@ -2921,6 +2979,7 @@ def run_post_link(wasm_input, options, state, newargs):
   target, wasm_target = phase_linker_setup(options, state, newargs)
   process_libraries(state, [])
   phase_post_link(options, state, wasm_input, wasm_target, target, {})
+  postlink_cache.report()
 
 
 def run(linker_inputs, options, state, newargs):
@@ -2987,5 +3046,6 @@ def run(linker_inputs, options, state, newargs):
   # Perform post-link steps (unless we are running bare mode)
   if options.oformat != OFormat.BARE:
     phase_post_link(options, state, wasm_target, wasm_target, target, js_syms)
+    postlink_cache.report()
 
   return 0
@@ -33,10 +33,11 @@ function readBinary(filename) {
 const arguments_ = process.argv.slice(2);
 const input = arguments_[0];
 const output = arguments_[1];
+const chunkSize = arguments_[2] ? Number(arguments_[2]) : undefined;
 
 const data = new Uint8Array(readBinary(input)).buffer;
 const start = Date.now();
-const compressedData = MiniLZ4.compressPackage(data);
+const compressedData = MiniLZ4.compressPackage(data, false, chunkSize);
 fs.writeFileSync(output, Buffer.from(compressedData['data']));
 compressedData['data'] = null;
 printErr('compressed in ' + (Date.now() - start) + ' ms');
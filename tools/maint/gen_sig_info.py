@@ -45,6 +45,7 @@ c_header = '''/* Auto-generated by %s */
 #include <emscripten/trace.h>
 #include <emscripten/proxying.h>
 #include <emscripten/exports.h>
+#include <emscripten/gl_profile.h>
 #include <wasi/api.h>
 
 // Internal emscripten headers
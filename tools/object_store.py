@@ -0,0 +1,216 @@
+# Copyright 2024 The Emscripten Authors.  All rights reserved.
+# Emscripten is available under two separate licenses, the MIT license and the
+# University of Illinois/NCSA Open Source License.  Both these licenses can be
+# found in the LICENSE file.
+
+"""Content-addressed store for the object files of system libraries.
+
+Many of the objects in the different variants of a system library (e.g.
+libc, libc-debug, libc-mt-debug) are identical: the variants differ only in
+macros such as NDEBUG, which most source files never look at.  This module
+keys each object on the preprocessed source together with the clang flags
+that affect code generation (i.e. all of them except `-D`, `-U` and `-I`),
+which allows such objects to be compiled once and shared between variants.
+
+The store lives in `build/objects` in the emscripten cache, and so is cleared
+along with the rest of the cache.  Least recently used objects are pruned once
+the store grows beyond `EMCC_OBJECT_STORE_MAX_SIZE` bytes (1GB by default).
+Set `EMCC_OBJECT_STORE=0` to disable it.
+
+The store is only used when emcc drives the compiles itself.  Builds with
+`EMCC_USE_NINJA` do not use it: ninja tracks each variant's objects in its own
+build directory and already skips the ones that are up to date.
+
+Computing the key costs a preprocessor run per source file, which is pure
+overhead when nothing is found in the store.  The time it takes is logged
+along with the number of objects reused.
+"""
+
+import hashlib
+import json
+import logging
+import os
+import shlex
+import shutil
+import tempfile
+import time
+from subprocess import PIPE
+
+from . import cache, shared, utils
+
+logger = logging.getLogger('object_store')
+
+# Bump this to invalidate all existing objects.
+VERSION = 1
+
+# Source files that can be preprocessed, and so stored.
+SOURCE_ENDINGS = ('.c', '.cc', '.cpp', '.cxx')
+
+ENABLED = os.environ.get('EMCC_OBJECT_STORE', '1') != '0'
+MAX_SIZE = int(os.environ.get('EMCC_OBJECT_STORE_MAX_SIZE', 1024 * 1024 * 1024))
+
+# Maps emcc compile commands (minus the inputs) to the equivalent clang command.
+clang_commands = {}
+
+
+def get_dir():
+  return cache.get_path(os.path.join('build', 'objects'))
+
+
+def write_atomic(filename, write):
+  """Writes a file in the store via a temporary file, so that concurrent builds
+  never see a partial file."""
+  utils.safe_ensure_dirs(os.path.dirname(filename))
+  fd, temp = tempfile.mkstemp(prefix='tmp', suffix=os.path.splitext(filename)[1], dir=os.path.dirname(filename))
+  os.close(fd)
+  try:
+    write(temp)
+    os.replace(temp, filename)
+  finally:
+    utils.delete_file(temp)
+
+
+def get_clang_command(cmd, env):
+  """Returns the clang command line that emcc would use for `cmd`.
+
+  `emcc --cflags` reports the flags that emcc passes to clang.  Running it
+  takes about as long as starting emcc, so the results are kept in the store
+  rather than only in memory.  Like the objects, they are keyed on the
+  emscripten version and are cleared along with the rest of the cache.
+  """
+  cmd = tuple(cmd)
+  if cmd not in clang_commands:
+    key = hashlib.sha256(json.dumps([VERSION, shared.EMSCRIPTEN_VERSION, cmd]).encode()).hexdigest()
+    cached = os.path.join(get_dir(), 'cflags', key + '.json')
+    try:
+      clang_commands[cmd] = json.loads(utils.read_file(cached))
+    except (OSError, ValueError):
+      out = shared.run_process([cmd[0], '--cflags'] + [a for a in cmd[1:] if a != '-c'], stdout=PIPE, env=env).stdout
+      compiler = shared.CLANG_CXX if cmd[0] == shared.EMXX else shared.CLANG_CC
+      clang_commands[cmd] = [compiler] + shlex.split(out)
+      write_atomic(cached, lambda f: utils.write_file(f, json.dumps(clang_commands[cmd])))
+  return clang_commands[cmd]
+
+
+def is_preprocessor_flag(flag):
+  return flag.startswith(('-D', '-U', '-I'))
+
+
+def get_flags_key(clang_cmd):
+  h = hashlib.sha256()
+  s = os.stat(clang_cmd[0])
+  h.update(f'{VERSION}:{shared.EMSCRIPTEN_VERSION}:{s.st_size}:{s.st_mtime_ns}\n'.encode())
+  h.update('\n'.join(f for f in clang_cmd[1:] if not is_preprocessor_flag(f)).encode())
+  return h.hexdigest()
+
+
+def hash_file(filename):
+  h = hashlib.sha256()
+  with open(filename, 'rb') as f:
+    for chunk in iter(lambda: f.read(1024 * 1024), b''):
+      h.update(chunk)
+  return h.hexdigest()
+
+
+def get_path(key):
+  return os.path.join(get_dir(), key[:2], key + '.o')
+
+
+def fetch(compiles, build_dir, env):
+  """Split `compiles` into those that can be satisfied from the store, and
+  those that still need to be compiled.
+
+  `compiles` is a list of tuples whose first three elements are `cmd`, `src`
+  and `obj`.  `cmd` is the emcc compile command minus the input and output,
+  `src` is the input exactly as it will be passed to the compiler (which runs
+  in `build_dir`), and `obj` is the absolute path of the output.  Objects that
+  are found in the store are copied to their destination.  Returns the
+  remaining compiles, along with the keys under which their objects should be
+  stored once built.
+  """
+  if not ENABLED or not compiles:
+    return compiles, {}
+
+  start = time.time()
+  preprocess = []
+  preprocessed = {}
+  for cmd, src, obj, *_ in compiles:
+    if shared.suffix(src) not in SOURCE_ENDINGS:
+      continue
+    # Preprocess in the same way as the compile will, so that the line markers
+    # (and so the debug info) match.
+    out = obj + '.i'
+    preprocess.append(get_clang_command(cmd, env) + ['-E', src, '-o', out])
+    preprocessed[obj] = out
+  if preprocess:
+    shared.run_multiple_processes(preprocess, env=env, cwd=build_dir)
+
+  misses = []
+  keys = {}
+  for compile in compiles:
+    cmd, src, obj, *_ = compile
+    if obj not in preprocessed:
+      misses.append(compile)
+      continue
+    key = hashlib.sha256((get_flags_key(get_clang_command(cmd, env)) + hash_file(preprocessed[obj])).encode()).hexdigest()
+    utils.delete_file(preprocessed[obj])
+    stored = get_path(key)
+    try:
+      shutil.copyfile(stored, obj)
+      # Mark the object as recently used, see `prune`.
+      os.utime(stored)
+    except OSError:
+      # Not in the store, or pruned by another process just now.
+      misses.append(compile)
+      keys[obj] = key
+
+  logger.info(f'reused {len(compiles) - len(misses)} of {len(compiles)} objects from object store ({time.time() - start:.2f}s to compute keys)')
+  return misses, keys
+
+
+def store(keys):
+  """Add newly built objects to the store.  See `fetch`."""
+  for obj, key in keys.items():
+    dest = get_path(key)
+    if os.path.exists(dest):
+      continue
+    write_atomic(dest, lambda f: shutil.copyfile(obj, f))
+  if keys:
+    prune()
+
+
+def prune():
+  """Deletes the least recently used objects until the store is no larger than
+  `MAX_SIZE`."""
+  objects = []
+  total = 0
+  root = get_dir()
+  if not os.path.isdir(root):
+    return
+  for subdir in os.listdir(root):
+    if len(subdir) != 2:
+      continue
+    subdir = os.path.join(root, subdir)
+    for name in os.listdir(subdir):
+      # Skip the temporary files of objects that are being stored.
+      if name.startswith('tmp'):
+        continue
+      filename = os.path.join(subdir, name)
+      try:
+        s = os.stat(filename)
+      except OSError:
+        continue
+      objects.append((s.st_mtime, s.st_size, filename))
+      total += s.st_size
+  if total <= MAX_SIZE:
+    return
+  objects.sort()
+  for _, size, filename in objects:
+    logger.debug(f'pruning object store entry {filename}')
+    try:
+      os.remove(filename)
+    except OSError:
+      pass
+    total -= size
+    if total <= MAX_SIZE:
+      break
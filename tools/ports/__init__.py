@@ -8,6 +8,7 @@ import hashlib
 import os
 import shutil
 import glob
+import tempfile
 import importlib.util
 import sys
 import subprocess
@@ -195,17 +196,24 @@ class Ports:
       cflags.append('-I' + include)
 
     if system_libs.USE_NINJA:
-      os.makedirs(build_dir, exist_ok=True)
-      ninja_file = os.path.join(build_dir, 'build.ninja')
+      # All the variants of a port share its ninja build directory, so those are
+      # built one at a time.
       system_libs.ensure_sysroot()
-      system_libs.create_ninja_file(srcs, ninja_file, output_path, cflags=cflags)
-      system_libs.run_ninja(build_dir)
+      with cache.artifact_lock(os.path.join('ports-builds', port_name)):
+        os.makedirs(build_dir, exist_ok=True)
+        ninja_file = os.path.join(build_dir, 'build.ninja')
+        system_libs.create_ninja_file(srcs, ninja_file, output_path, cflags=cflags)
+        system_libs.run_ninja(build_dir)
     else:
+      # Different variants of the same port can be built concurrently, so each
+      # build gets its own object directory.
+      os.makedirs(build_dir, exist_ok=True)
+      obj_dir = tempfile.mkdtemp(prefix='objs-', dir=build_dir)
       commands = []
       objects = []
       for src in srcs:
         relpath = os.path.relpath(src, src_dir)
-        obj = os.path.join(build_dir, relpath) + '.o'
+        obj = os.path.join(obj_dir, relpath) + '.o'
         dirname = os.path.dirname(obj)
         os.makedirs(dirname, exist_ok=True)
         cmd = [shared.EMCC, '-c', src, '-o', obj] + cflags
@@ -217,6 +225,8 @@ class Ports:
 
       system_libs.run_build_commands(commands, num_inputs=len(srcs))
       system_libs.create_lib(output_path, objects)
+      if not shared.DEBUG:
+        utils.delete_dir(obj_dir)
 
     return output_path
 
@@ -279,7 +289,7 @@ class Ports:
           if os.path.exists(target) and dir_is_newer(path, target):
             logger.warning(uptodate_message)
             return
-          with cache.lock('unpack local port'):
+          with cache.artifact_lock(f'ports/{name}'):
             # Another early out in case another process unpackage the library while we were
             # waiting for the lock
             if os.path.exists(target) and not dir_is_newer(path, target):
@@ -335,9 +345,9 @@ class Ports:
     if up_to_date():
       return
 
-    # main logic. do this under a cache lock, since we don't want multiple jobs to
+    # main logic. do this under a lock, since we don't want multiple jobs to
     # retrieve the same port at once
-    with cache.lock('unpack port'):
+    with cache.artifact_lock(f'ports/{name}'):
       if os.path.exists(fullpath):
         # Another early out in case another process unpackage the library while we were
         # waiting for the lock
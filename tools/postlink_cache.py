@@ -0,0 +1,275 @@
+# Copyright 2024 The Emscripten Authors.  All rights reserved.
+# Emscripten is available under two separate licenses, the MIT license and the
+# University of Illinois/NCSA Open Source License.  Both these licenses can be
+# found in the LICENSE file.
+
+"""Content-addressed cache for the post-link tool invocations.
+
+The post-link stages (wasm-opt, wasm-metadce, wasm-ctor-eval, the acorn JS
+optimizer passes and closure compiler) are pure functions of their command
+line, their input files and the version of the tool being run.  When all of
+those are identical to a previous run we can copy the previous outputs into
+place instead of re-running the tool.  This is common when relinking after
+changing only things that are applied after these stages, such as the HTML
+shell.
+
+The cache is opt-in, via the `POSTLINK_CACHE` config setting (or the
+`EM_POSTLINK_CACHE` environment variable).  Setting it to `1` stores entries in
+`postlink` in the emscripten cache, while any other value is used as the path
+of the directory to store them in.
+
+Each entry is a directory named after the hash of its inputs, containing the
+output files and a `meta.json` that holds the captured stdout and the time it
+originally took to run the tool.  Entries are published atomically by renaming
+them into place, so no locking is needed.  Least recently used entries are
+pruned once the total size exceeds `MAX_SIZE`.
+
+Setting `EMCC_POSTLINK_CACHE_REPORT=1` prints the per-stage hit/miss counts
+and estimated time saved at the end of the link.  Any other value is
+interpreted as a filename to write the report to as JSON.
+"""
+
+import hashlib
+import json
+import logging
+import os
+import shutil
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+from . import cache, config, shared, utils
+
+logger = logging.getLogger('postlink_cache')
+
+# Version of the entry format.  Bump this to invalidate all existing entries.
+VERSION = 1
+MAX_SIZE = 1024 * 1024 * 1024
+
+# Per-stage statistics for the report: {stage: {hits, misses, saved, spent}}
+stats = {}
+# Whether anything was added to the cache (and so whether we should prune).
+added = False
+# The identity of each tool, keyed on the path to its executable/script.
+tool_ids = {}
+
+
+def get_dir():
+  if not config.POSTLINK_CACHE:
+    return None
+  if config.POSTLINK_CACHE in ('1', True):
+    if config.FROZEN_CACHE:
+      return None
+    return Path(cache.get_path('postlink'))
+  return Path(config.POSTLINK_CACHE)
+
+
+def enabled():
+  return get_dir() is not None
+
+
+def hash_file(filename):
+  h = hashlib.sha256()
+  with open(filename, 'rb') as f:
+    for chunk in iter(lambda: f.read(1024 * 1024), b''):
+      h.update(chunk)
+  return h.hexdigest()
+
+
+def get_tool_id(path):
+  """Returns a string that changes whenever the given tool is updated.
+
+  For binary tools we use size and modification time, which is cheap and good
+  enough to notice a new install.  For scripts (which are small and are often
+  edited in place) we hash the contents.
+  """
+  if path not in tool_ids:
+    filename = path if os.path.exists(path) else shutil.which(path)
+    if not filename:
+      tool_ids[path] = path
+    elif filename.endswith(('.js', '.mjs', '.py')):
+      tool_ids[path] = hash_file(filename)
+    else:
+      s = os.stat(filename)
+      tool_ids[path] = f'{filename}:{s.st_size}:{s.st_mtime_ns}'
+  return tool_ids[path]
+
+
+def normalize_args(args, placeholders):
+  """Replace file arguments with something independent of the path.
+
+  Files that we know about (such as the input and output) are replaced with a
+  fixed placeholder.  Any other argument that names an existing file (either
+  by itself, or as the value in `--flag=value`) is replaced with the hash of
+  its contents, since temporary files get different names on every run.
+
+  When the cache is disabled the arguments are returned as they are, since
+  they will not be used.
+  """
+  if not enabled():
+    return args
+  rtn = []
+  for arg in args:
+    arg = str(arg)
+    if arg in placeholders:
+      rtn.append(placeholders[arg])
+      continue
+    prefix = ''
+    value = arg
+    if arg.startswith('-') and '=' in arg:
+      prefix, value = arg.split('=', 1)
+      prefix += '='
+    if value in placeholders:
+      rtn.append(prefix + placeholders[value])
+    elif value and not value.startswith('-') and os.path.isfile(value):
+      rtn.append(prefix + '<file:' + hash_file(value) + '>')
+    else:
+      rtn.append(arg)
+  return rtn
+
+
+def get_key(tools, args, inputs):
+  h = hashlib.sha256()
+  h.update(f'{VERSION}\n{shared.EMSCRIPTEN_VERSION}\n'.encode())
+  for tool in tools:
+    h.update(f'tool:{tool}:{get_tool_id(tool)}\n'.encode())
+  h.update(json.dumps(args).encode())
+  for i in inputs:
+    if os.path.exists(i):
+      h.update(f'\ninput:{hash_file(i)}'.encode())
+    else:
+      h.update(b'\ninput:<none>')
+  return h.hexdigest()
+
+
+def get_stats(stage):
+  return stats.setdefault(stage, {'hits': 0, 'misses': 0, 'saved': 0.0, 'spent': 0.0})
+
+
+def run(stage, tools, args, inputs, outputs, runner, store=None):
+  """Run `runner` (or reuse its previous results) and return its result.
+
+  `tools` are the paths of the executables/scripts involved, `args` is the
+  normalized command line (see `normalize_args`), `inputs` are the files that
+  are read and `outputs` are the files that are written.  Outputs that
+  `runner` does not create are recorded as such, and deleted on a cache hit.
+
+  The result of `runner` (normally the tool's stdout, or None) should be JSON
+  serializable, and is not cached otherwise.  If `store` is given, the results
+  are only cached when `store(result)` returns True.
+  """
+  global added
+  cachedir = get_dir()
+  if not cachedir:
+    return runner()
+
+  start = time.time()
+  key = get_key(tools, args, inputs)
+  entry = cachedir / key[:2] / key
+  meta_file = entry / 'meta.json'
+  stage_stats = get_stats(stage)
+
+  if meta_file.exists():
+    try:
+      meta = json.loads(utils.read_file(meta_file))
+      for i, output in enumerate(outputs):
+        if meta['outputs'][i]:
+          shutil.copyfile(entry / str(i), output)
+        else:
+          utils.delete_file(output)
+    except (OSError, ValueError, KeyError, IndexError) as e:
+      # Most likely pruned by another process while we were reading it.
+      logger.debug(f'ignoring bad post-link cache entry {entry}: {e}')
+    else:
+      # Touch the entry so that it is considered recently used.
+      os.utime(meta_file)
+      elapsed = time.time() - start
+      stage_stats['hits'] += 1
+      stage_stats['spent'] += elapsed
+      stage_stats['saved'] += max(meta['time'] - elapsed, 0)
+      logger.debug(f'post-link cache hit for {stage}: {key}')
+      return meta['stdout']
+
+  stdout = runner()
+  elapsed = time.time() - start
+  stage_stats['misses'] += 1
+  stage_stats['spent'] += elapsed
+  logger.debug(f'post-link cache miss for {stage}: {key}')
+  if store and not store(stdout):
+    return stdout
+
+  present = [os.path.exists(output) for output in outputs]
+  meta = {'stdout': stdout, 'time': elapsed, 'outputs': present, 'stage': stage}
+  try:
+    meta = json.dumps(meta)
+  except (TypeError, ValueError) as e:
+    logger.debug(f'not storing post-link cache entry for {stage}: {e}')
+    return stdout
+
+  tmpdir = None
+  try:
+    utils.safe_ensure_dirs(entry.parent)
+    tmpdir = tempfile.mkdtemp(prefix=key + '-', dir=entry.parent)
+    for i, output in enumerate(outputs):
+      if present[i]:
+        shutil.copyfile(output, os.path.join(tmpdir, str(i)))
+    utils.write_file(os.path.join(tmpdir, 'meta.json'), meta)
+    try:
+      os.replace(tmpdir, entry)
+      added = True
+    except OSError:
+      # Another process beat us to it.
+      pass
+  except OSError as e:
+    logger.debug(f'failed to store post-link cache entry {entry}: {e}')
+  finally:
+    if tmpdir:
+      shutil.rmtree(tmpdir, ignore_errors=True)
+
+  return stdout
+
+
+def prune():
+  cachedir = get_dir()
+  if not cachedir or not cachedir.exists():
+    return
+  entries = []
+  total = 0
+  for meta_file in cachedir.glob('*/*/meta.json'):
+    entry = meta_file.parent
+    try:
+      size = sum(f.stat().st_size for f in entry.iterdir())
+      entries.append((meta_file.stat().st_mtime, size, entry))
+    except OSError:
+      continue
+    total += size
+  if total <= MAX_SIZE:
+    return
+  entries.sort()
+  for _, size, entry in entries:
+    logger.debug(f'pruning post-link cache entry {entry}')
+    shutil.rmtree(entry, ignore_errors=True)
+    total -= size
+    if total <= MAX_SIZE:
+      break
+
+
+def report():
+  """Called at the end of the link to prune the cache and emit the report."""
+  if not enabled():
+    return
+  if added:
+    prune()
+  if not stats:
+    return
+  lines = []
+  for stage, s in sorted(stats.items()):
+    lines.append(f'{stage}: {s["hits"]} hits, {s["misses"]} misses, {s["saved"]:.3f}s saved')
+  for line in lines:
+    logger.debug(line)
+  destination = os.environ.get('EMCC_POSTLINK_CACHE_REPORT')
+  if destination == '1':
+    print('post-link cache report:\n  ' + '\n  '.join(lines), file=sys.stderr)
+  elif destination:
+    utils.write_file(destination, json.dumps(stats, indent=2, sort_keys=True) + '\n')
@@ -95,6 +95,7 @@ COMPILE_TIME_SETTINGS = {
     'WASM_OBJECT_FILES',
     'WASM_WORKERS',
     'BULK_MEMORY',
+    'WASM_SIMD',
 
     # Internal settings used during compilation
     'EXCEPTION_CATCHING_ALLOWED',
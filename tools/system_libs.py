@@ -11,6 +11,7 @@ import itertools
 import logging
 import os
 import shutil
+import tempfile
 import textwrap
 from enum import IntEnum, auto
 from glob import iglob
@@ -19,6 +20,7 @@ from typing import List, Optional
 from . import shared, building, utils
 from . import diagnostics
 from . import cache
+from . import object_store
 from .settings import settings
 from .utils import read_file
 
@@ -427,7 +429,10 @@ class Library:
     This will trigger a build if this library is not in the cache.
     """
     self.deterministic_paths = deterministic_paths
-    return cache.get(self.get_path(), self.do_build, force=USE_NINJA == 2, quiet=USE_NINJA)
+    # The ninja build files refer to the final output path, so in that mode the
+    # library cannot be built into a temporary location first.
+    return cache.get(self.get_path(), self.do_build, force=USE_NINJA == 2, quiet=USE_NINJA,
+                     atomic=not USE_NINJA)
 
   def generate(self):
     self.deterministic_paths = False
@@ -492,6 +497,7 @@ class Library:
     batch_inputs = int(os.environ.get('EMCC_BATCH_BUILD', '1'))
     batches = {}
     commands = []
+    compiles = []
     objects = set()
     cflags = self.get_cflags()
     if self.deterministic_paths:
@@ -534,22 +540,34 @@ class Library:
         while o in objects:
           object_uuid += 1
           o = os.path.join(build_dir, f'{object_basename}__{object_uuid}.o')
-        commands.append(cmd + [src, '-o', o])
-      elif batch_inputs:
-        # Use relative paths to reduce the length of the command line.
-        # This allows to avoid switching to a response file as often.
-        src = os.path.relpath(src, build_dir)
-        src = utils.normalize_path(src)
+        unique = True
+      else:
+        unique = False
+        if batch_inputs:
+          # Use relative paths to reduce the length of the command line.
+          # This allows to avoid switching to a response file as often.
+          src = os.path.relpath(src, build_dir)
+          src = utils.normalize_path(src)
+      compiles.append((cmd, src, o, unique))
+      objects.add(o)
+
+    # Objects that are shared with other variants of this library (or that
+    # are unchanged since an earlier build) can be taken from the object
+    # store rather than compiled.
+    ensure_sysroot()
+    compiles, store_keys = object_store.fetch(compiles, build_dir, clean_env())
+
+    for cmd, src, o, unique in compiles:
+      if batch_inputs and not unique:
         batches.setdefault(tuple(cmd), []).append(src)
       else:
         commands.append(cmd + [src, '-o', o])
-      objects.add(o)
 
     if batch_inputs:
       # Choose a chunk size that is large enough to avoid too many subprocesses
       # but not too large to avoid task starvation.
       # For now the heuristic is to split inputs by 2x number of cores.
-      chunk_size = max(1, len(objects) // (2 * shared.get_num_cores()))
+      chunk_size = max(1, len(compiles) // (2 * shared.get_num_cores()))
       # Convert batches to commands.
       for cmd, srcs in batches.items():
         cmd = list(cmd)
@@ -557,7 +575,9 @@ class Library:
           chunk_srcs = srcs[i:i + chunk_size]
           commands.append(building.get_command_with_possible_response_file(cmd + chunk_srcs))
 
-    run_build_commands(commands, num_inputs=len(objects), build_dir=build_dir)
+    if commands:
+      run_build_commands(commands, num_inputs=len(compiles), build_dir=build_dir)
+    object_store.store(store_keys)
     return objects
 
   def customize_build_cmd(self, cmd, _filename):
@@ -568,17 +588,25 @@ class Library:
 
   def do_build(self, out_filename, generate_only=False):
     """Builds the library and returns the path to the file."""
-    assert out_filename == self.get_path(absolute=True)
-    build_dir = os.path.join(cache.get_path('build'), self.get_base_name())
     if USE_NINJA:
-      self.generate_ninja(build_dir, out_filename)
-      if not generate_only:
-        run_ninja(build_dir)
+      assert out_filename == self.get_path(absolute=True)
+      # The ninja build directory is shared by all the variants that have the
+      # same base name (e.g. for wasm64 or LTO), so those are built one at a
+      # time.  The object store is not used here, see tools/object_store.py.
+      build_name = os.path.join('build', self.get_base_name())
+      build_dir = cache.get_path(build_name)
+      with cache.artifact_lock(build_name):
+        self.generate_ninja(build_dir, out_filename)
+        if not generate_only:
+          run_ninja(build_dir)
     else:
+      assert os.path.basename(out_filename) == self.get_filename()
       # Use a separate build directory to the ninja flavor so that building without
-      # EMCC_USE_NINJA doesn't clobber the ninja build tree
-      build_dir += '-tmp'
-      utils.safe_ensure_dirs(build_dir)
+      # EMCC_USE_NINJA doesn't clobber the ninja build tree.  The directory is
+      # unique to this build since other processes may concurrently be building
+      # variants that share the same base name (e.g. for wasm64 or LTO).
+      utils.safe_ensure_dirs(cache.get_path('build'))
+      build_dir = tempfile.mkdtemp(prefix=self.get_base_name() + '-tmp-', dir=cache.get_path('build'))
       create_lib(out_filename, self.build_objects(build_dir))
       if not shared.DEBUG:
         utils.delete_dir(build_dir)
@@ -1248,6 +1276,7 @@ class libc(MuslInternalLibrary,
     libc_files += files_in_path(
         path='system/lib/libc',
         filenames=[
+          'emscripten_audio_ring.c',
           'emscripten_console.c',
           'emscripten_fiber.c',
           'emscripten_get_heap_size.c',
@@ -1257,6 +1286,7 @@ class libc(MuslInternalLibrary,
           'emscripten_mmap.c',
           'emscripten_scan_stack.c',
           'emscripten_time.c',
+          'emscripten_utf8.c',
           'mktime.c',
           'tzset.c',
           'kill.c',
@@ -1368,6 +1398,30 @@ class libbulkmemory(MuslInternalLibrary, AsanInstrumentedLibrary):
     return super(libbulkmemory, self).can_use() and settings.BULK_MEMORY
 
 
+# Wasm SIMD versions of the libc string, memory and UTF-8 functions, which
+# override the ones in libc when building with -msimd128. When bulk memory is also
+# enabled libbulkmemory comes first in the link order, so its memcpy and memset
+# win.
+class libc_simd(MuslInternalLibrary):
+  name = 'libc_simd'
+  src_dir = 'system/lib/libc'
+  src_files = ['emscripten_memcpy.c', 'emscripten_memset.c',
+               'emscripten_string_simd.c', 'emscripten_utf8.c']
+  cflags = ['-O2', '-fno-builtin', '-msimd128']
+  # memcpy and memset are libcalls, see the comment in
+  # libc.get_libcall_files.
+  force_object_files = True
+
+  def can_use(self):
+    # The string functions read past the end of their inputs, in a way that is
+    # safe in wasm but not understood by ASan.  Like libc_optz, this overrides
+    # parts of libc, and so can't be used when all of libc is linked in (see
+    # the comment in libc_optz.can_use).
+    return super(libc_simd, self).can_use() and settings.WASM_SIMD and \
+        not settings.USE_ASAN and not settings.LINKABLE and \
+        not os.environ.get('EMCC_FORCE_STDLIBS')
+
+
 class libprintf_long_double(libc):
   name = 'libprintf_long_double'
   cflags = ['-DEMSCRIPTEN_PRINTF_LONG_DOUBLE']
@@ -2295,6 +2349,10 @@ def get_libs_to_link(args, forced, only_forced):
     add_library('libc_optz')
   if settings.BULK_MEMORY:
     add_library('libbulkmemory')
+  # See comment in libc_simd itself
+  if settings.WASM_SIMD and not settings.USE_ASAN and not settings.LINKABLE and \
+     not os.environ.get('EMCC_FORCE_STDLIBS'):
+    add_library('libc_simd')
   if settings.STANDALONE_WASM:
     add_library('libstandalonewasm')
   if settings.ALLOW_UNIMPLEMENTED_SYSCALLS: